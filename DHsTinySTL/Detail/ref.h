@@ -1,12 +1,165 @@
 #ifndef _REF_H_
 #define _REF_H_
 
+// shared_ptr / weak_ptr 的引用计数策略和控制块
+//  * prt_count<Counter>              控制块的基类, 保存计数
+//  * prt_count_ptr<T, Counter>       shared_ptr(p), 用 delete 释放对象
+//  * prt_count_inplace<T, Alloc, C>  make_shared / allocate_shared, 对象存放在控制块中
+//  * Detail::ref_t<T, D, Alloc, C>   shared_ptr(p, d, alloc), 保存删除器, 控制块由 Alloc 分配
+// 删除器和分配器的类型由控制块的模板参数记录, 通过 dispose / destroy 两个虚函数擦除,
+// 不需要 std::function 那样额外分配内存
+
 #include <atomic>
-#include <functional>
-#include <memory>
+#include <cstddef>
+#include <type_traits>
+
+#include "../allocator.h"
+#include "../construct.h"
+#include "../util.h"
 
 namespace dhsstl{
-    namespace Detail{
+
+namespace detail
+{
+
+// 把静态接口的分配器 Alloc<T, ...> 换成 Alloc<U, ...>, 用于分配 T 以外的类型(例如控制块)
+template <typename Alloc, typename U>
+struct allocator_rebind;
+
+template <template <typename> class Alloc, typename T, typename U>
+struct allocator_rebind<Alloc<T>, U>
+{
+    typedef Alloc<U> type;
+};
+
+// aligned_allocator<T, Align>, huge_page_allocator<T, Threshold>
+template <template <typename, size_t> class Alloc, typename T, size_t N, typename U>
+struct allocator_rebind<Alloc<T, N>, U>
+{
+    typedef Alloc<U, N> type;
+};
+
+} // namespace detail
+
+// 引用计数策略
+// 提供计数的类型 type, 以及 load / increment / decrement / increment_if_not_zero, decrement 在减到 0 时返回 true
+//
+// thread_safe_counter: 原子计数
+//  * 加一只需要保证原子性, 用 relaxed: 能复制出新的引用, 说明调用者已经持有一个引用, 对象不会在此期间被释放
+//  * 减一用 release, 减到 0 时再加一个 acquire fence: 其他线程在释放引用之前对对象的读写,
+//    都发生在析构对象之前. 只有最后一次减一需要 acquire, 所以用 fence 而不是 acq_rel
+// thread_unsafe_counter: 普通整数计数, 用于只在一个线程中使用的对象
+struct thread_safe_counter
+{
+    typedef std::atomic<size_t> type;
+
+    static size_t load(const type& c) noexcept { return c.load(std::memory_order_relaxed); }
+    static void   increment(type& c) noexcept { c.fetch_add(1, std::memory_order_relaxed); }
+
+    static bool decrement(type& c) noexcept{
+        if(c.fetch_sub(1, std::memory_order_release) == 1){
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return true;
+        }
+        return false;
+    }
+
+    static bool increment_if_not_zero(type& c) noexcept{
+        size_t n = c.load(std::memory_order_relaxed);
+        do{
+            if(n == 0)
+                return false;
+        }while(!c.compare_exchange_weak(n, n + 1, std::memory_order_acq_rel, std::memory_order_relaxed));
+        return true;
+    }
+};
+
+struct thread_unsafe_counter
+{
+    typedef size_t type;
+
+    static size_t load(const type& c) noexcept { return c; }
+    static void   increment(type& c) noexcept { ++c; }
+    static bool   decrement(type& c) noexcept { return --c == 0; }
+
+    static bool increment_if_not_zero(type& c) noexcept{
+        if(c == 0)
+            return false;
+        ++c;
+        return true;
+    }
+};
+
+// 计数类, 也即 shared_ptr / weak_ptr 共用的控制块
+// ncount_ 为 shared_ptr 的个数; wcount_ 为 weak_ptr 的个数, 只要还有 shared_ptr, wcount_ 就额外加一
+//  * ncount_ 减到 0 时调用 dispose() 析构管理的对象
+//  * wcount_ 减到 0 时调用 destroy() 释放控制块
+// 因此 weak_ptr 只让控制块存活, 对象在最后一个 shared_ptr 析构时就会被析构
+template <typename Counter>
+struct prt_count{
+    typedef typename Counter::type count_type;
+
+    prt_count():ncount_(1), wcount_(1){}
+    prt_count(const prt_count&) = delete;
+    prt_count& operator=(const prt_count&) = delete;
+    virtual ~prt_count() = default;
+
+    virtual void dispose() noexcept = 0;
+    virtual void destroy() noexcept = 0;
+
+    void add_ref() noexcept { Counter::increment(ncount_); }
+    void add_weak_ref() noexcept { Counter::increment(wcount_); }
+
+    // weak_ptr::lock 使用, ncount_ 不为 0 时才加一
+    bool add_ref_lock() noexcept { return Counter::increment_if_not_zero(ncount_); }
+
+    void release() noexcept{
+        if(Counter::decrement(ncount_)){
+            dispose();
+            weak_release();
+        }
+    }
+
+    void weak_release() noexcept{
+        if(Counter::decrement(wcount_))
+            destroy();
+    }
+
+    size_t use_count() const noexcept { return Counter::load(ncount_); }
+
+    count_type ncount_;
+    count_type wcount_;
+};
+
+// shared_ptr(T* p) 使用的控制块, 对象和控制块各分配一次
+template <typename T, typename Counter>
+struct prt_count_ptr : prt_count<Counter>{
+    explicit prt_count_ptr(T* p) noexcept : ptr_(p){}
+
+    void dispose() noexcept override { delete ptr_; }
+    void destroy() noexcept override { delete this; }
+
+    T* ptr_;
+};
+
+// make_shared / allocate_shared 使用的控制块, 对象就存放在控制块中, 只需要分配一次
+// 控制块由 Alloc 分配和释放, 对象析构后这块内存一直保留到最后一个 weak_ptr 析构
+template <typename T, typename Alloc, typename Counter>
+struct prt_count_inplace : prt_count<Counter>{
+    typedef typename detail::allocator_rebind<Alloc, prt_count_inplace>::type  block_allocator;
+
+    T* ptr() noexcept { return reinterpret_cast<T*>(&storage_); }
+
+    void dispose() noexcept override { dhsstl::destroy(ptr()); }
+    void destroy() noexcept override{
+        this->~prt_count_inplace();
+        block_allocator::deallocate(this);
+    }
+
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type storage_;
+};
+
+namespace Detail{
         template<typename T>
         struct _default_delete{
             void operator()(T* ptr){
@@ -16,71 +169,28 @@ namespace dhsstl{
             }
         };
 
-
-        template<typename T>
-        struct ref_t
+        // shared_ptr(p, d, alloc) 使用的控制块
+        // 计数减到 0 时调用 deleter_(data_), 控制块本身由 Alloc 分配和释放
+        template<typename T, typename D, typename Alloc, typename Counter>
+        struct ref_t : prt_count<Counter>
         {
-            using deleter_type = std::function <void(T*)>;
+            typedef D                                                           deleter_type;
+            typedef typename detail::allocator_rebind<Alloc, ref_t>::type      block_allocator;
 
-            std::atomic<size_t> ncount_;
-            std::atomic<size_t> wcount_;
             T* data_;
             deleter_type deleter_;
 
-            explicit ref_t(T* p = nullptr, deleter_type pfunc = deleter_type(_default_delete<T>()))
-                : ncount_(0), wcount_(0) ,data_(p), deleter_(pfunc){
-                    if(data_){
-                        ncount_ = 1;
-                    }
-            }
-
-            ref_t(const ref_t&) = delete;
-            ref_t& operator = (const ref_t&) = delete;
-
-            ~ref_t(){
-                --ncount_;
-                if(ncount_ == 0){
-                    deleter_(data_);
-                }
-            }
-
-            size_t count() const { return ncount_.load(); }
-            T* get_data()  const { return data_; }
+            ref_t(T* p, deleter_type d) : data_(p), deleter_(dhsstl::move(d)){}
 
-            ref_t& operator++(){
-                ++ncount_;
-                return *this;
+            void dispose() noexcept override { deleter_(data_); }
+            void destroy() noexcept override{
+                this->~ref_t();
+                block_allocator::deallocate(this);
             }
 
-            ref_t operator++(int){
-                auto t = *this;
-                ++*this;
-                return t;
-            }
-
-            ref_t& operator --(){
-                --ncount_;
-                return *this;
-            }
-
-            ref_t operator--(int){
-                auto t = *this;
-                --*this;
-                return t;
-            }
+            T* get_data() const { return data_; }
         };
-
-        template<typename T>
-        bool operator==(const ref_t<T>& lhs, const ref_t<T>& rhs){
-            return lhs.get_data() == rhs.get_data();
-        }
-
-        template<typename T> 
-        bool operator!=(const ref_t<T>& lhs, const ref_t<T>& rhs){
-            return !(lhs == rhs);
-        }
-
     }
 }
 
-#endif
\ No newline at end of file
+#endif
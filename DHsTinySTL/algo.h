@@ -7,10 +7,12 @@
 #endif
 
 #include <cstddef>
+#include <cstring>
 #include <ctime>
 #include "algobase.h"
 #include "memory.h"
 #include "functional.h"
+#include "heap_algo.h"
 
 
 namespace dhsstl
@@ -44,6 +46,842 @@ template <typename BidirectionalIter>
 void reverse(BidirectionalIter first, BidirectionalIter last){
     dhsstl::reverse_dispatch(first, last, iterator_category(first));
 }
+
+/*!
+ * @brief 在[first, last)区间内找到等于 value 的元素, 返回指向该元素的迭代器
+ */
+template <typename InputIter, typename T>
+InputIter unchecked_find(InputIter first, InputIter last, const T& value){
+    while(first != last && !(*first == value))
+        ++first;
+    return first;
+}
+
+//! 为单字节整数类型的原生指针提供特化版本, 使用 memchr
+template <typename Tp, typename Up>
+typename std::enable_if<
+    std::is_integral<Tp>::value && sizeof(Tp) == 1 &&
+    !std::is_same<typename std::remove_const<Tp>::type, bool>::value &&
+    std::is_integral<Up>::value,
+    Tp*
+>::type
+unchecked_find(Tp* first, Tp* last, const Up& value){
+    // value 超出 Tp 的取值范围时不可能找到
+    if(static_cast<Up>(static_cast<Tp>(value)) != value)
+        return last;
+    const void* p = std::memchr(first, static_cast<unsigned char>(value), static_cast<size_t>(last - first));
+    return p == nullptr ? last : first + (static_cast<const unsigned char*>(p) -
+                                          reinterpret_cast<const unsigned char*>(first));
+}
+
+template <typename InputIter, typename T>
+InputIter find(InputIter first, InputIter last, const T& value);
+
+//! 分段迭代器版本: 逐段在原生指针区间内查找
+template <typename InputIter, typename T>
+InputIter find_segmented(InputIter first, InputIter last, const T& value, std::true_type){
+    typedef segmented_iterator_traits<InputIter> traits;
+    auto sfirst = traits::segment(first);
+    const auto slast = traits::segment(last);
+    if(sfirst == slast){
+        const auto l = traits::local(last);
+        return first + (dhsstl::find(traits::local(first), l, value) - traits::local(first));
+    }
+    auto lfirst = traits::local(first);
+    while(true){
+        const auto llast = traits::segment_end(sfirst);
+        const auto pos = dhsstl::find(lfirst, llast, value);
+        if(pos != llast)
+            return first + (pos - lfirst);
+        first += llast - lfirst;
+        if(++sfirst == slast)
+            break;
+        lfirst = traits::segment_begin(sfirst);
+    }
+    lfirst = traits::segment_begin(slast);
+    return first + (dhsstl::find(lfirst, traits::local(last), value) - lfirst);
+}
+
+template <typename InputIter, typename T>
+InputIter find_segmented(InputIter first, InputIter last, const T& value, std::false_type){
+    return dhsstl::unchecked_find(first, last, value);
+}
+
+template <typename InputIter, typename T>
+InputIter find(InputIter first, InputIter last, const T& value){
+    return dhsstl::find_segmented(first, last, value,
+                                  std::integral_constant<bool, is_segmented_iterator<InputIter>::value>{});
+}
+
+/*!
+ * @brief 对[first, last)区间内的每个元素调用 unary_op, 结果依次写到以 result 为起始的位置
+ *        返回最后一个结果的下一个位置
+ */
+template <typename InputIter, typename OutputIter, typename UnaryOperation>
+OutputIter transform(InputIter first, InputIter last, OutputIter result, UnaryOperation unary_op){
+    for(; first != last; ++first, ++result)
+        *result = unary_op(*first);
+    return result;
+}
+
+//! 重载版本: 对两个序列中对应的元素调用 binary_op
+template <typename InputIter1, typename InputIter2, typename OutputIter, typename BinaryOperation>
+OutputIter transform(InputIter1 first1, InputIter1 last1, InputIter2 first2,
+                     OutputIter result, BinaryOperation binary_op){
+    for(; first1 != last1; ++first1, ++first2, ++result)
+        *result = binary_op(*first1, *first2);
+    return result;
+}
+
+/*!
+ * @brief 在已排序的[first, last)区间内找到第一个不小于 value 的元素
+ */
+template <typename ForwardIter, typename T, typename Compared>
+ForwardIter lower_bound(ForwardIter first, ForwardIter last, const T& value, Compared comp){
+    auto len = dhsstl::distance(first, last);
+    while(len > 0){
+        auto half = len / 2;
+        ForwardIter middle = first;
+        dhsstl::advance(middle, half);
+        if(comp(*middle, value)){
+            first = ++middle;
+            len -= half + 1;
+        }
+        else{
+            len = half;
+        }
+    }
+    return first;
+}
+
+template <typename ForwardIter, typename T>
+ForwardIter lower_bound(ForwardIter first, ForwardIter last, const T& value){
+    return dhsstl::lower_bound(first, last, value, dhsstl::less<T>());
+}
+
+/*!
+ * @brief 在已排序的[first, last)区间内找到第一个大于 value 的元素
+ */
+template <typename ForwardIter, typename T, typename Compared>
+ForwardIter upper_bound(ForwardIter first, ForwardIter last, const T& value, Compared comp){
+    auto len = dhsstl::distance(first, last);
+    while(len > 0){
+        auto half = len / 2;
+        ForwardIter middle = first;
+        dhsstl::advance(middle, half);
+        if(comp(value, *middle)){
+            len = half;
+        }
+        else{
+            first = ++middle;
+            len -= half + 1;
+        }
+    }
+    return first;
+}
+
+template <typename ForwardIter, typename T>
+ForwardIter upper_bound(ForwardIter first, ForwardIter last, const T& value){
+    return dhsstl::upper_bound(first, last, value, dhsstl::less<T>());
+}
+
+/*!
+ * @brief 将[first, middle)和[middle, last)两段互换, 返回原来的 first 现在的位置
+ */
+template <typename ForwardIter>
+ForwardIter rotate(ForwardIter first, ForwardIter middle, ForwardIter last){
+    if(first == middle)
+        return last;
+    if(middle == last)
+        return first;
+    // 第一轮交换结束时, first 指向原来的 *first 移动到的位置, 即返回值
+    ForwardIter first2 = middle;
+    do{
+        dhsstl::iter_swap(first++, first2++);
+        if(first == middle)
+            middle = first2;
+    }while(first2 != last);
+    ForwardIter result = first;
+    // 剩下的部分继续按同样的方式交换
+    first2 = middle;
+    while(first2 != last){
+        dhsstl::iter_swap(first++, first2++);
+        if(first == middle)
+            middle = first2;
+        else if(first2 == last)
+            first2 = middle;
+    }
+    return result;
+}
+
+/*!
+ * @brief 判断[first, last)区间是否已经按 comp 排好序
+ *        is_sorted_until 返回第一个破坏顺序的元素
+ */
+template <typename ForwardIter, typename Compared>
+ForwardIter is_sorted_until(ForwardIter first, ForwardIter last, Compared comp){
+    if(first == last)
+        return last;
+    ForwardIter next = first;
+    while(++next != last){
+        if(comp(*next, *first))
+            return next;
+        first = next;
+    }
+    return last;
+}
+
+template <typename ForwardIter>
+ForwardIter is_sorted_until(ForwardIter first, ForwardIter last){
+    return dhsstl::is_sorted_until(first, last,
+                                   dhsstl::less<typename iterator_traits<ForwardIter>::value_type>());
+}
+
+template <typename ForwardIter, typename Compared>
+bool is_sorted(ForwardIter first, ForwardIter last, Compared comp){
+    return dhsstl::is_sorted_until(first, last, comp) == last;
+}
+
+template <typename ForwardIter>
+bool is_sorted(ForwardIter first, ForwardIter last){
+    return dhsstl::is_sorted_until(first, last) == last;
+}
+
+// ---------------------------------------------------
+// sort
+// pattern-defeating quicksort (Orson Peters, pdqsort):
+//  1. 少于 24 个元素时插入排序
+//  2. 枢轴取三点中值, 超过 128 个元素时取九点中值(ninther)
+//  3. 默认比较器下的算术类型使用无分支的块划分(BlockQuicksort), 比较结果只用来计算偏移, 不产生分支预测失败
+//  4. 划分严重不均衡时打乱几个元素以破坏对抗性的输入, 次数超过 log2(n) 时改用堆排序(make_heap / sort_heap)
+//  5. 划分时没有发生交换, 说明区间可能已经有序, 尝试有限次数的插入排序, 已排序 / 逆序的输入为 O(n)
+//  6. 与前一个枢轴相等的元素全部放到左边, 大量重复元素的输入为 O(n log k)
+// ---------------------------------------------------
+namespace detail
+{
+
+constexpr ptrdiff_t pdq_insertion_sort_threshold = 24;
+constexpr ptrdiff_t pdq_ninther_threshold = 128;
+constexpr size_t    pdq_partial_insertion_limit = 8;
+constexpr size_t    pdq_block_size = 64;
+
+// 比较器是否是默认的 less / greater
+template <typename Compared, typename T>
+struct is_default_compare : public std::false_type {};
+template <typename T>
+struct is_default_compare<dhsstl::less<T>, T> : public std::true_type {};
+template <typename T>
+struct is_default_compare<dhsstl::greater<T>, T> : public std::true_type {};
+
+// 算术类型配合默认比较器时使用无分支的划分
+template <typename RandomIter, typename Compared>
+struct use_branchless_partition
+    : public std::integral_constant<bool,
+        std::is_arithmetic<typename iterator_traits<RandomIter>::value_type>::value &&
+        is_default_compare<Compared, typename iterator_traits<RandomIter>::value_type>::value> {};
+
+template <typename RandomIter, typename Compared>
+void insertion_sort(RandomIter first, RandomIter last, Compared comp){
+    typedef typename iterator_traits<RandomIter>::value_type value_type;
+    if(first == last)
+        return;
+    for(RandomIter cur = first + 1; cur != last; ++cur){
+        RandomIter sift = cur;
+        RandomIter sift_1 = cur - 1;
+        // 先比较一次, 已经在正确位置上的元素不用移动
+        if(comp(*sift, *sift_1)){
+            value_type tmp = dhsstl::move(*sift);
+            do{
+                *sift-- = dhsstl::move(*sift_1);
+            }while(sift != first && comp(tmp, *--sift_1));
+            *sift = dhsstl::move(tmp);
+        }
+    }
+}
+
+// first 之前的元素不大于区间内的任何元素, 可以省去边界检查
+template <typename RandomIter, typename Compared>
+void unguarded_insertion_sort(RandomIter first, RandomIter last, Compared comp){
+    typedef typename iterator_traits<RandomIter>::value_type value_type;
+    if(first == last)
+        return;
+    for(RandomIter cur = first + 1; cur != last; ++cur){
+        RandomIter sift = cur;
+        RandomIter sift_1 = cur - 1;
+        if(comp(*sift, *sift_1)){
+            value_type tmp = dhsstl::move(*sift);
+            do{
+                *sift-- = dhsstl::move(*sift_1);
+            }while(comp(tmp, *--sift_1));
+            *sift = dhsstl::move(tmp);
+        }
+    }
+}
+
+// 插入排序, 移动的元素总数超过 pdq_partial_insertion_limit 时放弃并返回 false
+template <typename RandomIter, typename Compared>
+bool partial_insertion_sort(RandomIter first, RandomIter last, Compared comp){
+    typedef typename iterator_traits<RandomIter>::value_type value_type;
+    if(first == last)
+        return true;
+    size_t limit = 0;
+    for(RandomIter cur = first + 1; cur != last; ++cur){
+        RandomIter sift = cur;
+        RandomIter sift_1 = cur - 1;
+        if(comp(*sift, *sift_1)){
+            value_type tmp = dhsstl::move(*sift);
+            do{
+                *sift-- = dhsstl::move(*sift_1);
+            }while(sift != first && comp(tmp, *--sift_1));
+            *sift = dhsstl::move(tmp);
+            limit += static_cast<size_t>(cur - sift);
+        }
+        if(limit > pdq_partial_insertion_limit)
+            return false;
+    }
+    return true;
+}
+
+template <typename RandomIter, typename Compared>
+void sort2(RandomIter a, RandomIter b, Compared comp){
+    if(comp(*b, *a))
+        dhsstl::iter_swap(a, b);
+}
+
+// 排序三个元素, 结果 *a <= *b <= *c
+template <typename RandomIter, typename Compared>
+void sort3(RandomIter a, RandomIter b, RandomIter c, Compared comp){
+    detail::sort2(a, b, comp);
+    detail::sort2(b, c, comp);
+    detail::sort2(a, b, comp);
+}
+
+// 按两组偏移交换元素, 数量相等时逐对交换, 否则用一个临时变量做环形移动, 减少一半的写
+template <typename RandomIter>
+void swap_offsets(RandomIter first, RandomIter last, const unsigned char* offsets_l,
+                  const unsigned char* offsets_r, size_t num, bool use_swaps){
+    typedef typename iterator_traits<RandomIter>::value_type value_type;
+    if(use_swaps){
+        for(size_t i = 0; i < num; ++i)
+            dhsstl::iter_swap(first + offsets_l[i], last - offsets_r[i]);
+    }
+    else if(num > 0){
+        RandomIter l = first + offsets_l[0];
+        RandomIter r = last - offsets_r[0];
+        value_type tmp(dhsstl::move(*l));
+        *l = dhsstl::move(*r);
+        for(size_t i = 1; i < num; ++i){
+            l = first + offsets_l[i];
+            *r = dhsstl::move(*l);
+            r = last - offsets_r[i];
+            *l = dhsstl::move(*r);
+        }
+        *r = dhsstl::move(tmp);
+    }
+}
+
+// 以 *first 为枢轴划分, 小于枢轴的元素在左边, 不小于的在右边
+// 返回枢轴的最终位置, 以及划分前区间是否已经划分好(没有发生交换)
+// 要求 [first, last) 中存在不小于枢轴的元素作为右侧扫描的哨兵
+template <typename RandomIter, typename Compared>
+dhsstl::pair<RandomIter, bool> partition_right(RandomIter begin, RandomIter end, Compared comp){
+    typedef typename iterator_traits<RandomIter>::value_type value_type;
+    value_type pivot(dhsstl::move(*begin));
+    RandomIter first = begin;
+    RandomIter last = end;
+
+    // 找到第一个不小于枢轴的元素, 中值选择保证它存在
+    while(comp(*++first, pivot));
+    // 左边没有小于枢轴的元素时, 右侧扫描需要边界检查
+    if(first - 1 == begin)
+        while(first < last && !comp(*--last, pivot));
+    else
+        while(!comp(*--last, pivot));
+
+    const bool already_partitioned = first >= last;
+    while(first < last){
+        dhsstl::iter_swap(first, last);
+        while(comp(*++first, pivot));
+        while(!comp(*--last, pivot));
+    }
+
+    RandomIter pivot_pos = first - 1;
+    *begin = dhsstl::move(*pivot_pos);
+    *pivot_pos = dhsstl::move(pivot);
+    return dhsstl::pair<RandomIter, bool>(pivot_pos, already_partitioned);
+}
+
+// 无分支版本, 每次在左右各扫描 pdq_block_size 个元素, 把需要交换的元素偏移记录下来再统一交换
+template <typename RandomIter, typename Compared>
+dhsstl::pair<RandomIter, bool> partition_right_branchless(RandomIter begin, RandomIter end, Compared comp){
+    typedef typename iterator_traits<RandomIter>::value_type value_type;
+    value_type pivot(dhsstl::move(*begin));
+    RandomIter first = begin;
+    RandomIter last = end;
+
+    while(comp(*++first, pivot));
+    if(first - 1 == begin)
+        while(first < last && !comp(*--last, pivot));
+    else
+        while(!comp(*--last, pivot));
+
+    const bool already_partitioned = first >= last;
+    if(!already_partitioned){
+        dhsstl::iter_swap(first, last);
+        ++first;
+
+        alignas(64) unsigned char offsets_l[pdq_block_size];
+        alignas(64) unsigned char offsets_r[pdq_block_size];
+        RandomIter offsets_l_base = first;
+        RandomIter offsets_r_base = last;
+        size_t num_l = 0, num_r = 0, start_l = 0, start_r = 0;
+
+        while(first < last){
+            // 一侧还有待交换的元素时只填充另一侧
+            const size_t num_unknown = static_cast<size_t>(last - first);
+            const size_t left_split = num_l == 0 ? (num_r == 0 ? num_unknown / 2 : num_unknown) : 0;
+            const size_t right_split = num_r == 0 ? (num_unknown - left_split) : 0;
+
+            if(left_split >= pdq_block_size){
+                for(size_t i = 0; i < pdq_block_size; ){
+                    offsets_l[num_l] = static_cast<unsigned char>(i++); num_l += !comp(*first, pivot); ++first;
+                    offsets_l[num_l] = static_cast<unsigned char>(i++); num_l += !comp(*first, pivot); ++first;
+                    offsets_l[num_l] = static_cast<unsigned char>(i++); num_l += !comp(*first, pivot); ++first;
+                    offsets_l[num_l] = static_cast<unsigned char>(i++); num_l += !comp(*first, pivot); ++first;
+                }
+            }
+            else{
+                for(size_t i = 0; i < left_split; ){
+                    offsets_l[num_l] = static_cast<unsigned char>(i++); num_l += !comp(*first, pivot); ++first;
+                }
+            }
+
+            if(right_split >= pdq_block_size){
+                for(size_t i = 0; i < pdq_block_size; ){
+                    offsets_r[num_r] = static_cast<unsigned char>(++i); num_r += comp(*--last, pivot);
+                    offsets_r[num_r] = static_cast<unsigned char>(++i); num_r += comp(*--last, pivot);
+                    offsets_r[num_r] = static_cast<unsigned char>(++i); num_r += comp(*--last, pivot);
+                    offsets_r[num_r] = static_cast<unsigned char>(++i); num_r += comp(*--last, pivot);
+                }
+            }
+            else{
+                for(size_t i = 0; i < right_split; ){
+                    offsets_r[num_r] = static_cast<unsigned char>(++i); num_r += comp(*--last, pivot);
+                }
+            }
+
+            const size_t num = dhsstl::min(num_l, num_r);
+            detail::swap_offsets(offsets_l_base, offsets_r_base, offsets_l + start_l, offsets_r + start_r,
+                                 num, num_l == num_r);
+            num_l -= num;
+            num_r -= num;
+            start_l += num;
+            start_r += num;
+            if(num_l == 0){
+                start_l = 0;
+                offsets_l_base = first;
+            }
+            if(num_r == 0){
+                start_r = 0;
+                offsets_r_base = last;
+            }
+        }
+
+        // 剩下的只有一侧, 把它们交换到中间
+        if(num_l != 0){
+            const unsigned char* offs = offsets_l + start_l;
+            while(num_l--)
+                dhsstl::iter_swap(offsets_l_base + offs[num_l], --last);
+            first = last;
+        }
+        if(num_r != 0){
+            const unsigned char* offs = offsets_r + start_r;
+            while(num_r--){
+                dhsstl::iter_swap(offsets_r_base - offs[num_r], first);
+                ++first;
+            }
+            last = first;
+        }
+    }
+
+    RandomIter pivot_pos = first - 1;
+    *begin = dhsstl::move(*pivot_pos);
+    *pivot_pos = dhsstl::move(pivot);
+    return dhsstl::pair<RandomIter, bool>(pivot_pos, already_partitioned);
+}
+
+// 与 partition_right 相反, 等于枢轴的元素放在左边, 返回枢轴的位置
+// 用于枢轴等于前一个枢轴的情况, 调用之后左边的元素全部等于枢轴, 不再需要排序
+template <typename RandomIter, typename Compared>
+RandomIter partition_left(RandomIter begin, RandomIter end, Compared comp){
+    typedef typename iterator_traits<RandomIter>::value_type value_type;
+    value_type pivot(dhsstl::move(*begin));
+    RandomIter first = begin;
+    RandomIter last = end;
+
+    while(comp(pivot, *--last));
+    if(last + 1 == end)
+        while(first < last && !comp(pivot, *++first));
+    else
+        while(!comp(pivot, *++first));
+
+    while(first < last){
+        dhsstl::iter_swap(first, last);
+        while(comp(pivot, *--last));
+        while(!comp(pivot, *++first));
+    }
+
+    RandomIter pivot_pos = last;
+    *begin = dhsstl::move(*pivot_pos);
+    *pivot_pos = dhsstl::move(pivot);
+    return pivot_pos;
+}
+
+template <typename RandomIter, typename Compared>
+dhsstl::pair<RandomIter, bool>
+partition_right_dispatch(RandomIter first, RandomIter last, Compared comp, std::true_type){
+    return detail::partition_right_branchless(first, last, comp);
+}
+
+template <typename RandomIter, typename Compared>
+dhsstl::pair<RandomIter, bool>
+partition_right_dispatch(RandomIter first, RandomIter last, Compared comp, std::false_type){
+    return detail::partition_right(first, last, comp);
+}
+
+// 选出枢轴并放到 *first: 三点中值或九点中值
+template <typename RandomIter, typename Compared>
+void choose_pivot(RandomIter first, RandomIter last, Compared comp){
+    const auto size = last - first;
+    const auto s2 = size / 2;
+    if(size > pdq_ninther_threshold){
+        detail::sort3(first, first + s2, last - 1, comp);
+        detail::sort3(first + 1, first + (s2 - 1), last - 2, comp);
+        detail::sort3(first + 2, first + (s2 + 1), last - 3, comp);
+        detail::sort3(first + (s2 - 1), first + s2, first + (s2 + 1), comp);
+        dhsstl::iter_swap(first, first + s2);
+    }
+    else{
+        detail::sort3(first + s2, first, last - 1, comp);
+    }
+}
+
+// 划分严重不均衡时, 交换几个元素打乱对抗性的模式
+template <typename RandomIter>
+void break_patterns(RandomIter first, RandomIter pivot_pos, RandomIter last){
+    const auto l_size = pivot_pos - first;
+    const auto r_size = last - (pivot_pos + 1);
+    if(l_size >= pdq_insertion_sort_threshold){
+        dhsstl::iter_swap(first, first + l_size / 4);
+        dhsstl::iter_swap(pivot_pos - 1, pivot_pos - l_size / 4);
+        if(l_size > pdq_ninther_threshold){
+            dhsstl::iter_swap(first + 1, first + (l_size / 4 + 1));
+            dhsstl::iter_swap(first + 2, first + (l_size / 4 + 2));
+            dhsstl::iter_swap(pivot_pos - 2, pivot_pos - (l_size / 4 + 1));
+            dhsstl::iter_swap(pivot_pos - 3, pivot_pos - (l_size / 4 + 2));
+        }
+    }
+    if(r_size >= pdq_insertion_sort_threshold){
+        dhsstl::iter_swap(pivot_pos + 1, pivot_pos + (1 + r_size / 4));
+        dhsstl::iter_swap(last - 1, last - r_size / 4);
+        if(r_size > pdq_ninther_threshold){
+            dhsstl::iter_swap(pivot_pos + 2, pivot_pos + (2 + r_size / 4));
+            dhsstl::iter_swap(pivot_pos + 3, pivot_pos + (3 + r_size / 4));
+            dhsstl::iter_swap(last - 2, last - (1 + r_size / 4));
+            dhsstl::iter_swap(last - 3, last - (2 + r_size / 4));
+        }
+    }
+}
+
+// bad_allowed: 还允许出现几次严重不均衡的划分
+// leftmost: 区间是否位于整个序列的最左边, 不是时 *(first - 1) 可以作为插入排序和 partition_left 的哨兵
+template <typename RandomIter, typename Compared, typename Branchless>
+void pdqsort_loop(RandomIter first, RandomIter last, Compared comp, int bad_allowed, bool leftmost,
+                  Branchless branchless){
+    while(true){
+        const auto size = last - first;
+        if(size < pdq_insertion_sort_threshold){
+            if(leftmost)
+                detail::insertion_sort(first, last, comp);
+            else
+                detail::unguarded_insertion_sort(first, last, comp);
+            return;
+        }
+
+        detail::choose_pivot(first, last, comp);
+
+        // 枢轴等于前一个枢轴(它在 first - 1 处), 说明有大量重复元素, 等于枢轴的元素都放到左边并跳过
+        if(!leftmost && !comp(*(first - 1), *first)){
+            first = detail::partition_left(first, last, comp) + 1;
+            continue;
+        }
+
+        const auto part = detail::partition_right_dispatch(first, last, comp, branchless);
+        const RandomIter pivot_pos = part.first;
+        const auto l_size = pivot_pos - first;
+        const auto r_size = last - (pivot_pos + 1);
+
+        if(l_size < size / 8 || r_size < size / 8){
+            if(--bad_allowed == 0){
+                dhsstl::make_heap(first, last, comp);
+                dhsstl::sort_heap(first, last, comp);
+                return;
+            }
+            detail::break_patterns(first, pivot_pos, last);
+        }
+        else if(part.second && detail::partial_insertion_sort(first, pivot_pos, comp) &&
+                detail::partial_insertion_sort(pivot_pos + 1, last, comp)){
+            // 没有发生交换, 两边也几乎有序
+            return;
+        }
+
+        // 递归处理左边, 循环处理右边
+        detail::pdqsort_loop(first, pivot_pos, comp, bad_allowed, leftmost, branchless);
+        first = pivot_pos + 1;
+        leftmost = false;
+    }
+}
+
+template <typename Size>
+int log2_floor(Size n){
+    int log = 0;
+    while(n >>= 1)
+        ++log;
+    return log;
+}
+
+} // namespace detail
+
+template <typename RandomIter, typename Compared>
+void sort(RandomIter first, RandomIter last, Compared comp){
+    if(last - first < 2)
+        return;
+    detail::pdqsort_loop(first, last, comp, detail::log2_floor(last - first), true,
+                         detail::use_branchless_partition<RandomIter, Compared>{});
+}
+
+template <typename RandomIter>
+void sort(RandomIter first, RandomIter last){
+    dhsstl::sort(first, last, dhsstl::less<typename iterator_traits<RandomIter>::value_type>());
+}
+
+// ---------------------------------------------------
+// partial_sort
+// 把[first, last)中最小的 middle - first 个元素按顺序放到[first, middle)中
+// 先对[first, middle)建大根堆, 后面比堆顶小的元素与堆顶交换, 最后 sort_heap
+// ---------------------------------------------------
+template <typename RandomIter, typename Compared>
+void partial_sort(RandomIter first, RandomIter middle, RandomIter last, Compared comp){
+    if(first == middle)
+        return;
+    dhsstl::make_heap(first, middle, comp);
+    for(RandomIter i = middle; i < last; ++i){
+        if(comp(*i, *first))
+            dhsstl::__pop_heap_aux(first, middle, i, *i, distance_type(first), comp);
+    }
+    dhsstl::sort_heap(first, middle, comp);
+}
+
+template <typename RandomIter>
+void partial_sort(RandomIter first, RandomIter middle, RandomIter last){
+    dhsstl::partial_sort(first, middle, last, dhsstl::less<typename iterator_traits<RandomIter>::value_type>());
+}
+
+// ---------------------------------------------------
+// nth_element
+// 重排[first, last), 使 *nth 为排序后位于该位置的元素, 它左边的元素都不大于它, 右边的都不小于它
+// introselect: 用 pdqsort 的中值选择和划分只处理 nth 所在的一侧, 划分次数过多时改用 partial_sort
+// ---------------------------------------------------
+template <typename RandomIter, typename Compared>
+void nth_element(RandomIter first, RandomIter nth, RandomIter last, Compared comp){
+    if(nth == last)
+        return;
+    int bad_allowed = detail::log2_floor(last - first) * 2;
+    while(last - first > 3){
+        if(bad_allowed-- == 0){
+            dhsstl::partial_sort(first, nth + 1, last, comp);
+            return;
+        }
+        detail::choose_pivot(first, last, comp);
+        const RandomIter pivot_pos = detail::partition_right(first, last, comp).first;
+        if(pivot_pos == nth)
+            return;
+        if(nth < pivot_pos)
+            last = pivot_pos;
+        else
+            first = pivot_pos + 1;
+    }
+    detail::insertion_sort(first, last, comp);
+}
+
+template <typename RandomIter>
+void nth_element(RandomIter first, RandomIter nth, RandomIter last){
+    dhsstl::nth_element(first, nth, last, dhsstl::less<typename iterator_traits<RandomIter>::value_type>());
+}
+
+// ---------------------------------------------------
+// stable_sort
+// 归并排序, 相等元素保持原来的相对顺序
+//  1. 每 32 个元素一组先做插入排序
+//  2. 合并两段时把较短的一段移动构造到临时缓冲区中, 再从两端向目标区间归并, 只需要 n / 2 的缓冲区
+//     缓冲区是 get_temporary_buffer 得到的未初始化空间, 只需要元素可以移动, 不会复制元素
+//  3. 缓冲区申请不到足够的大小时, 用 rotate 把区间切成更小的两组分别合并(不需要缓冲区也能完成)
+// ---------------------------------------------------
+namespace detail
+{
+
+constexpr ptrdiff_t stable_sort_chunk = 32;
+
+// get_temporary_buffer 得到的未初始化空间, 离开作用域时释放
+template <typename T>
+struct merge_buffer
+{
+    pair<T*, ptrdiff_t> buf;
+
+    explicit merge_buffer(ptrdiff_t len) : buf(dhsstl::get_temporary_buffer<T>(len)) {}
+    ~merge_buffer() { dhsstl::release_temporary_buffer(buf.first); }
+
+    merge_buffer(const merge_buffer&) = delete;
+    merge_buffer& operator=(const merge_buffer&) = delete;
+};
+
+// 析构缓冲区中 [first, last) 上构造的对象, 比较或者移动抛出异常时也会执行
+template <typename Pointer>
+struct merge_buffer_guard
+{
+    Pointer first;
+    Pointer last;
+
+    ~merge_buffer_guard() { dhsstl::destroy(first, last); }
+};
+
+// 合并 [first, middle) 和 [middle, last), 其中前一段已经移动构造到 buf 中
+template <typename RandomIter, typename Pointer, typename Compared>
+void merge_forward(Pointer buf, Pointer buf_end, RandomIter middle, RandomIter last,
+                   RandomIter result, Compared comp){
+    while(buf != buf_end && middle != last){
+        // 相等时取前一段的元素, 保持稳定
+        if(comp(*middle, *buf))
+            *result++ = dhsstl::move(*middle++);
+        else
+            *result++ = dhsstl::move(*buf++);
+    }
+    dhsstl::move(buf, buf_end, result);
+}
+
+// 后一段已经移到 buf 中, 从尾部向前合并
+template <typename RandomIter, typename Pointer, typename Compared>
+void merge_backward(RandomIter first, RandomIter middle, Pointer buf, Pointer buf_end,
+                    RandomIter result, Compared comp){
+    while(first != middle && buf != buf_end){
+        // 相等时取后一段的元素, 保持稳定
+        if(comp(*(buf_end - 1), *(middle - 1)))
+            *--result = dhsstl::move(*--middle);
+        else
+            *--result = dhsstl::move(*--buf_end);
+    }
+    dhsstl::move_backward(buf, buf_end, result);
+}
+
+template <typename RandomIter, typename Distance, typename Pointer, typename Compared>
+void merge_adaptive(RandomIter first, RandomIter middle, RandomIter last, Distance len1, Distance len2,
+                    Pointer buf, Distance buf_size, Compared comp){
+    if(len1 == 0 || len2 == 0)
+        return;
+    // 已经有序时不用合并
+    if(!comp(*middle, *(middle - 1)))
+        return;
+    // buf 是未初始化空间, 移动构造进去, 合并之后析构(其中的元素已经被移走)
+    if(len1 <= len2 && len1 <= buf_size){
+        merge_buffer_guard<Pointer> guard{ buf, buf };
+        guard.last = dhsstl::uninitialized_move(first, middle, buf);
+        detail::merge_forward(buf, guard.last, middle, last, first, comp);
+    }
+    else if(len2 <= buf_size){
+        merge_buffer_guard<Pointer> guard{ buf, buf };
+        guard.last = dhsstl::uninitialized_move(middle, last, buf);
+        detail::merge_backward(first, middle, buf, guard.last, last, comp);
+    }
+    else if(len1 + len2 == 2){
+        dhsstl::iter_swap(first, middle);
+    }
+    else{
+        // 在较长的一段取中点, 在另一段二分找到对应的位置, 交换中间的两块之后分别合并
+        RandomIter cut1, cut2;
+        Distance len11, len22;
+        if(len1 > len2){
+            len11 = len1 / 2;
+            cut1 = first + len11;
+            cut2 = dhsstl::lower_bound(middle, last, *cut1, comp);
+            len22 = cut2 - middle;
+        }
+        else{
+            len22 = len2 / 2;
+            cut2 = middle + len22;
+            cut1 = dhsstl::upper_bound(first, middle, *cut2, comp);
+            len11 = cut1 - first;
+        }
+        RandomIter new_middle = dhsstl::rotate(cut1, middle, cut2);
+        detail::merge_adaptive(first, cut1, new_middle, len11, len22, buf, buf_size, comp);
+        detail::merge_adaptive(new_middle, cut2, last, len1 - len11, len2 - len22, buf, buf_size, comp);
+    }
+}
+
+template <typename RandomIter, typename Pointer, typename Distance, typename Compared>
+void stable_sort_adaptive(RandomIter first, RandomIter last, Pointer buf, Distance buf_size, Compared comp){
+    const Distance len = last - first;
+    if(len <= stable_sort_chunk){
+        detail::insertion_sort(first, last, comp);
+        return;
+    }
+    const RandomIter middle = first + len / 2;
+    detail::stable_sort_adaptive(first, middle, buf, buf_size, comp);
+    detail::stable_sort_adaptive(middle, last, buf, buf_size, comp);
+    detail::merge_adaptive(first, middle, last, Distance(middle - first), Distance(last - middle),
+                           buf, buf_size, comp);
+}
+
+} // namespace detail
+
+template <typename RandomIter, typename Compared>
+void stable_sort(RandomIter first, RandomIter last, Compared comp){
+    typedef typename iterator_traits<RandomIter>::value_type      value_type;
+    typedef typename iterator_traits<RandomIter>::difference_type difference_type;
+    if(last - first < 2)
+        return;
+    // 合并时缓冲区只保存较短的一段
+    detail::merge_buffer<value_type> buf((last - first + 1) / 2);
+    detail::stable_sort_adaptive(first, last, buf.buf.first, static_cast<difference_type>(buf.buf.second), comp);
+}
+
+template <typename RandomIter>
+void stable_sort(RandomIter first, RandomIter last){
+    dhsstl::stable_sort(first, last, dhsstl::less<typename iterator_traits<RandomIter>::value_type>());
+}
+
+// ---------------------------------------------------
+// inplace_merge
+// 把相邻的两段有序区间 [first, middle) 和 [middle, last) 合并成一段, 相等元素保持原来的相对顺序
+// 较短的一段移动构造到临时缓冲区中再归并, 见 merge_adaptive
+// ---------------------------------------------------
+template <typename RandomIter, typename Compared>
+void inplace_merge(RandomIter first, RandomIter middle, RandomIter last, Compared comp){
+    typedef typename iterator_traits<RandomIter>::value_type      value_type;
+    typedef typename iterator_traits<RandomIter>::difference_type difference_type;
+    const difference_type len1 = middle - first;
+    const difference_type len2 = last - middle;
+    if(len1 == 0 || len2 == 0)
+        return;
+    detail::merge_buffer<value_type> buf(dhsstl::min(len1, len2));
+    detail::merge_adaptive(first, middle, last, len1, len2, buf.buf.first,
+                           static_cast<difference_type>(buf.buf.second), comp);
+}
+
+template <typename RandomIter>
+void inplace_merge(RandomIter first, RandomIter middle, RandomIter last){
+    dhsstl::inplace_merge(first, middle, last, dhsstl::less<typename iterator_traits<RandomIter>::value_type>());
+}
+
 }
 
 #ifdef _MSC_VER
@@ -112,9 +112,60 @@ unchecked_copy(Tp *first, Tp *last, Up *result){
     return result + n;
 }
 
+// 分段迭代器版本
+// 输入区间为分段迭代器(例如 deque 的迭代器)时, 逐段按原生指针区间复制, 每一段都可以走 memmove
+template <typename InputIter, typename OutputIter>
+OutputIter copy(InputIter first, InputIter last, OutputIter result);
+
+template <typename InputIter, typename OutputIter>
+OutputIter
+copy_segmented_in(InputIter first, InputIter last, OutputIter result, std::true_type){
+    typedef segmented_iterator_traits<InputIter> traits;
+    auto sfirst = traits::segment(first);
+    const auto slast = traits::segment(last);
+    if(sfirst == slast)
+        return dhsstl::copy(traits::local(first), traits::local(last), result);
+    result = dhsstl::copy(traits::local(first), traits::segment_end(sfirst), result);
+    for(++sfirst; sfirst != slast; ++sfirst)
+        result = dhsstl::copy(traits::segment_begin(sfirst), traits::segment_end(sfirst), result);
+    return dhsstl::copy(traits::segment_begin(slast), traits::local(last), result);
+}
+
+// 输出区间为分段迭代器, 输入为随机访问迭代器时, 按输出区间的段切分
+template <typename RandomIter, typename OutputIter>
+OutputIter
+copy_segmented_out(RandomIter first, RandomIter last, OutputIter result, std::true_type){
+    typedef segmented_iterator_traits<OutputIter> traits;
+    for(auto n = last - first; n > 0;){
+        const auto cur = traits::local(result);
+        const auto len = dhsstl::min(n, static_cast<decltype(n)>(
+            traits::segment_end(traits::segment(result)) - cur));
+        dhsstl::copy(first, first + len, cur);
+        first += len;
+        result += len;
+        n -= len;
+    }
+    return result;
+}
+
+template <typename InputIter, typename OutputIter>
+OutputIter
+copy_segmented_out(InputIter first, InputIter last, OutputIter result, std::false_type){
+    return unchecked_copy(first, last, result);
+}
+
+template <typename InputIter, typename OutputIter>
+OutputIter
+copy_segmented_in(InputIter first, InputIter last, OutputIter result, std::false_type){
+    return copy_segmented_out(first, last, result, std::integral_constant<bool,
+                              is_segmented_iterator<OutputIter>::value &&
+                              is_random_access_iterator<InputIter>::value>{});
+}
+
 template<typename InputIter, typename OutputIter>
-OutputIter copy(InputIter fisrt, InputIter last, OutputIter result){
-    return unchecked_copy(fisrt, last, result);
+OutputIter copy(InputIter first, InputIter last, OutputIter result){
+    return copy_segmented_in(first, last, result,
+                             std::integral_constant<bool, is_segmented_iterator<InputIter>::value>{});
 }
 // ---------------------------------------------------
 // copy_bcakward
@@ -247,7 +298,7 @@ unchecked_move_cat(RandomIter first, RandomIter last, OutputIter result,
 template <typename InputIter, typename OutputIter>
 OutputIter
 unchecked_move(InputIter first, InputIter last, OutputIter result){
-    return unchecked_move_cat(first, last, iterator_category(first));
+    return unchecked_move_cat(first, last, result, iterator_category(first));
 }
 // 为 trivially_copy_assignable 类型提供特化版本
 template <typename Tp, typename Up>
@@ -263,11 +314,60 @@ unchecked_move(Tp* first, Tp* last, Up* result){
     return result + n;
 }
 
+// 分段迭代器版本, 与 copy 相同
 template <typename InputIter, typename OutputIter>
+OutputIter move(InputIter first, InputIter last, OutputIter result);
+
+template <typename InputIter, typename OutputIter>
+OutputIter
+move_segmented_in(InputIter first, InputIter last, OutputIter result, std::true_type){
+    typedef segmented_iterator_traits<InputIter> traits;
+    auto sfirst = traits::segment(first);
+    const auto slast = traits::segment(last);
+    if(sfirst == slast)
+        return dhsstl::move(traits::local(first), traits::local(last), result);
+    result = dhsstl::move(traits::local(first), traits::segment_end(sfirst), result);
+    for(++sfirst; sfirst != slast; ++sfirst)
+        result = dhsstl::move(traits::segment_begin(sfirst), traits::segment_end(sfirst), result);
+    return dhsstl::move(traits::segment_begin(slast), traits::local(last), result);
+}
+
+template <typename RandomIter, typename OutputIter>
 OutputIter
-move(InputIter first,InputIter last, OutputIter result){
+move_segmented_out(RandomIter first, RandomIter last, OutputIter result, std::true_type){
+    typedef segmented_iterator_traits<OutputIter> traits;
+    for(auto n = last - first; n > 0;){
+        const auto cur = traits::local(result);
+        const auto len = dhsstl::min(n, static_cast<decltype(n)>(
+            traits::segment_end(traits::segment(result)) - cur));
+        dhsstl::move(first, first + len, cur);
+        first += len;
+        result += len;
+        n -= len;
+    }
+    return result;
+}
+
+template <typename InputIter, typename OutputIter>
+OutputIter
+move_segmented_out(InputIter first, InputIter last, OutputIter result, std::false_type){
     return unchecked_move(first, last, result);
 }
+
+template <typename InputIter, typename OutputIter>
+OutputIter
+move_segmented_in(InputIter first, InputIter last, OutputIter result, std::false_type){
+    return move_segmented_out(first, last, result, std::integral_constant<bool,
+                              is_segmented_iterator<OutputIter>::value &&
+                              is_random_access_iterator<InputIter>::value>{});
+}
+
+template <typename InputIter, typename OutputIter>
+OutputIter
+move(InputIter first, InputIter last, OutputIter result){
+    return move_segmented_in(first, last, result,
+                             std::integral_constant<bool, is_segmented_iterator<InputIter>::value>{});
+}
 // ---------------------------------------------------
 // move_backward
 // 把[first, last)区间内的元素move到[result - (last - first), result)内 
@@ -323,15 +423,87 @@ move_backward(BidirectionalIter1 first, BidirectionalIter1 last, BidirectionalIt
 // 比较第一序列在 [first, last) 区间上的元素值是否和第二序列相等
 // ---------------------------------------------------
 template<typename InputIter1, typename InputIter2>
-bool equal(InputIter1 first1, InputIter1 last1, InputIter2 first2){
+bool unchecked_equal(InputIter1 first1, InputIter1 last1, InputIter2 first2){
     for(; first1 != last1; ++first1, ++first2){
-        if(*first1 != !first2){
+        if(!(*first1 == *first2)){
             return false;
         }
     }
     return true;
 }
 
+// 为整数类型的原生指针提供特化版本, 逐字节比较即可
+template <typename Tp, typename Up>
+typename std::enable_if<
+    std::is_same<typename std::remove_const<Tp>::type, typename std::remove_const<Up>::type>::value &&
+    std::is_integral<Tp>::value && !std::is_same<typename std::remove_const<Tp>::type, bool>::value,
+    bool
+>::type
+unchecked_equal(Tp* first1, Tp* last1, Up* first2){
+    const auto n = static_cast<size_t>(last1 - first1);
+    return n == 0 || std::memcmp(first1, first2, n * sizeof(Tp)) == 0;
+}
+
+// 分段迭代器版本: 第一序列为分段迭代器时逐段比较
+template<typename InputIter1, typename InputIter2>
+bool equal(InputIter1 first1, InputIter1 last1, InputIter2 first2);
+
+template<typename InputIter1, typename InputIter2>
+bool equal_segmented_in(InputIter1 first1, InputIter1 last1, InputIter2 first2, std::true_type){
+    typedef segmented_iterator_traits<InputIter1> traits;
+    auto sfirst = traits::segment(first1);
+    const auto slast = traits::segment(last1);
+    if(sfirst == slast)
+        return dhsstl::equal(traits::local(first1), traits::local(last1), first2);
+    auto lfirst = traits::local(first1);
+    auto llast = traits::segment_end(sfirst);
+    while(true){
+        if(!dhsstl::equal(lfirst, llast, first2))
+            return false;
+        dhsstl::advance(first2, llast - lfirst);
+        if(++sfirst == slast)
+            break;
+        lfirst = traits::segment_begin(sfirst);
+        llast = traits::segment_end(sfirst);
+    }
+    return dhsstl::equal(traits::segment_begin(slast), traits::local(last1), first2);
+}
+
+// 第二序列为分段迭代器, 第一序列为随机访问迭代器时, 按第二序列的段切分
+template<typename RandomIter, typename InputIter2>
+bool equal_segmented_out(RandomIter first1, RandomIter last1, InputIter2 first2, std::true_type){
+    typedef segmented_iterator_traits<InputIter2> traits;
+    for(auto n = last1 - first1; n > 0;){
+        const auto cur = traits::local(first2);
+        const auto len = dhsstl::min(n, static_cast<decltype(n)>(
+            traits::segment_end(traits::segment(first2)) - cur));
+        if(!dhsstl::equal(first1, first1 + len, cur))
+            return false;
+        first1 += len;
+        first2 += len;
+        n -= len;
+    }
+    return true;
+}
+
+template<typename InputIter1, typename InputIter2>
+bool equal_segmented_out(InputIter1 first1, InputIter1 last1, InputIter2 first2, std::false_type){
+    return unchecked_equal(first1, last1, first2);
+}
+
+template<typename InputIter1, typename InputIter2>
+bool equal_segmented_in(InputIter1 first1, InputIter1 last1, InputIter2 first2, std::false_type){
+    return equal_segmented_out(first1, last1, first2, std::integral_constant<bool,
+                               is_segmented_iterator<InputIter2>::value &&
+                               is_random_access_iterator<InputIter1>::value>{});
+}
+
+template<typename InputIter1, typename InputIter2>
+bool equal(InputIter1 first1, InputIter1 last1, InputIter2 first2){
+    return equal_segmented_in(first1, last1, first2,
+                              std::integral_constant<bool, is_segmented_iterator<InputIter1>::value>{});
+}
+
 template <typename InputIter1, typename InputIter2, typename Compared>
 bool equal(InputIter1 first1, InputIter1 last1, InputIter2 first2, Compared comp){
     for(; first1 != last1; ++first1, ++first2){
@@ -362,20 +534,58 @@ OutputIter unchecked_fill_n(OutputIter first, Size n, const T &value){
 template<typename Tp, typename Size, typename Up>
 typename std::enable_if<
     std::is_integral<Tp>::value && sizeof(Tp) == 1 &&
-    std::is_same<Tp, bool>::value &&
+    !std::is_same<Tp, bool>::value &&
     std::is_integral<Up>::value && sizeof(Up) == 1,
     Tp*
 >::type
 unchecked_fill_n(Tp* first, Size n , Up value){
     if(n > 0){
-        std::memmove(first, (unsigned char)value, (size_t)(n));
+        std::memset(first, static_cast<unsigned char>(value), static_cast<size_t>(n));
     }
     return first + n;
 }
+
+// 为算术类型的原生指针提供特化版本: 先把 value 复制到局部变量, 编译器不必担心 value 与区间重叠, 可以向量化
+template<typename Tp, typename Size, typename Up>
+typename std::enable_if<
+    std::is_arithmetic<Tp>::value &&
+    !(std::is_integral<Tp>::value && sizeof(Tp) == 1 && !std::is_same<Tp, bool>::value &&
+      std::is_integral<Up>::value && sizeof(Up) == 1),
+    Tp*
+>::type
+unchecked_fill_n(Tp* first, Size n, const Up& value){
+    const Tp tmp = static_cast<Tp>(value);
+    for(; n > 0; --n, ++first){
+        *first = tmp;
+    }
+    return first;
+}
+
+// 分段迭代器版本: 逐段按原生指针区间填充
 template <typename OutputIter, typename Size, typename T>
-OutputIter fill_n(OutputIter first, Size n, const T& value){
+OutputIter fill_n_segmented(OutputIter first, Size n, const T& value, std::true_type){
+    typedef segmented_iterator_traits<OutputIter> traits;
+    while(n > 0){
+        const auto cur = traits::local(first);
+        const auto len = dhsstl::min(static_cast<size_t>(n), static_cast<size_t>(
+            traits::segment_end(traits::segment(first)) - cur));
+        unchecked_fill_n(cur, len, value);
+        first += len;
+        n -= static_cast<Size>(len);
+    }
+    return first;
+}
+
+template <typename OutputIter, typename Size, typename T>
+OutputIter fill_n_segmented(OutputIter first, Size n, const T& value, std::false_type){
     return unchecked_fill_n(first, n, value);
 }
+
+template <typename OutputIter, typename Size, typename T>
+OutputIter fill_n(OutputIter first, Size n, const T& value){
+    return fill_n_segmented(first, n, value,
+                            std::integral_constant<bool, is_segmented_iterator<OutputIter>::value>{});
+}
 // ---------------------------------------------------
 // fill
 // 为 [first, last) 区间内的所有元素填充新值
@@ -389,15 +599,37 @@ void fill_cat(ForwardIter first, ForwardIter last, const T &value,
 }
 
 template <typename RandomIter, typename T>
-void flii_cat(RandomIter first, RandomIter last, const T &value,
+void fill_cat(RandomIter first, RandomIter last, const T &value,
               dhsstl::random_access_iterator_tag){
     fill_n(first, last - first, value);
 }
 
+// 分段迭代器版本: 逐段按原生指针区间填充
 template <typename ForwardIter, typename T>
-void fill(ForwardIter first, ForwardIter last, const T &value){
+void fill_segmented(ForwardIter first, ForwardIter last, const T& value, std::true_type){
+    typedef segmented_iterator_traits<ForwardIter> traits;
+    auto sfirst = traits::segment(first);
+    const auto slast = traits::segment(last);
+    if(sfirst == slast){
+        dhsstl::fill_n(traits::local(first), traits::local(last) - traits::local(first), value);
+        return;
+    }
+    dhsstl::fill_n(traits::local(first), traits::segment_end(sfirst) - traits::local(first), value);
+    for(++sfirst; sfirst != slast; ++sfirst)
+        dhsstl::fill_n(traits::segment_begin(sfirst), traits::segment_end(sfirst) - traits::segment_begin(sfirst), value);
+    dhsstl::fill_n(traits::segment_begin(slast), traits::local(last) - traits::segment_begin(slast), value);
+}
+
+template <typename ForwardIter, typename T>
+void fill_segmented(ForwardIter first, ForwardIter last, const T& value, std::false_type){
     fill_cat(first, last, value, iterator_category(first));
 }
+
+template <typename ForwardIter, typename T>
+void fill(ForwardIter first, ForwardIter last, const T &value){
+    fill_segmented(first, last, value,
+                   std::integral_constant<bool, is_segmented_iterator<ForwardIter>::value>{});
+}
 // ---------------------------------------------------
 // lexicographical_compare
 // 以字典序排列对两个序列进行比较, 当在某个位置发现第一组不想等元素时, 有以下几种情况:
@@ -450,7 +682,7 @@ bool lexicograhical_compare(const unsigned char* first1,
 // ---------------------------------------------------
 template <typename InputIter1, typename InputIter2>
 dhsstl::pair<InputIter1, InputIter2>
-mismatch(InputIter1 first1, InputIter2 last1, InputIter2 first2){
+mismatch(InputIter1 first1, InputIter1 last1, InputIter2 first2){
     while(first1 != last1 && *first1 == *first2){
         ++first1;
         ++first2;
@@ -0,0 +1,134 @@
+#ifndef DHSTINYSTL_ALIGNED_ALLOCATOR_H_
+#define DHSTINYSTL_ALIGNED_ALLOCATOR_H_
+
+// 这个头文件包含一个模板类 aligned_allocator, 按照指定的对齐值分配内存
+// 接口和 dhsstl::allocator 相同, 可以作为 vector / deque 的 Alloc 参数, 例如:
+//      dhsstl::vector<float, dhsstl::aligned_allocator<float, 64>> v;
+// 使缓冲区的起始地址按 cache line 或者 SIMD 寄存器宽度对齐
+//
+// 注: 对齐的内存不能交给 realloc, 所以 can_reallocate 总是 false
+
+#include <cstring>
+#include <new>
+
+#include "algobase.h"
+#include "construct.h"
+#include "util.h"
+
+namespace dhsstl
+{
+
+// 模板类: aligned_allocator
+// 模板参数 T 代表数据类型, Align 代表对齐值(字节), 必须是 2 的幂
+template <class T, size_t Align = 64>
+class aligned_allocator
+{
+    static_assert(Align != 0 && (Align & (Align - 1)) == 0, "aligned_allocator: Align must be a power of two");
+    static_assert(Align >= alignof(T), "aligned_allocator: Align must not be less than alignof(T)");
+
+public:
+    typedef T               value_type;
+    typedef T*              pointer;
+    typedef const T*        const_pointer;
+    typedef T&              reference;
+    typedef const T&        const_reference;
+    typedef size_t          size_type;
+    typedef ptrdiff_t       difference_type;
+
+    static constexpr size_t alignment = Align;
+
+    static T*   allocate();
+    static T*   allocate(size_type n);
+
+    static void deallocate(T* ptr);
+    static void deallocate(T* ptr, size_type n);
+
+    static void construct(T* ptr);
+    static void construct(T* ptr, const T& value);
+    static void construct(T* ptr, T&& value);
+
+    template <class... Args>
+    static void construct(T* ptr, Args&& ...args);
+
+    static void destroy(T* ptr);
+    static void destroy(T* first, T* last);
+
+    template <typename U = T>
+    static constexpr bool can_reallocate(){
+        return false;
+    }
+
+    // 只是为了满足 dhsstl::allocator 的接口, 由于 can_reallocate 为 false, 容器不会调用它
+    static T*   reallocate(T* ptr, size_type old_n, size_type new_n);
+};
+
+// 定义
+template <class T, size_t Align>
+T* aligned_allocator<T, Align>::allocate(){
+    return allocate(1);
+}
+
+template <class T, size_t Align>
+T* aligned_allocator<T, Align>::allocate(size_type n){
+    if(n == 0)
+        return nullptr;
+    return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Align)));
+}
+
+template <class T, size_t Align>
+void aligned_allocator<T, Align>::deallocate(T* ptr){
+    if(ptr == nullptr)
+        return;
+    ::operator delete(ptr, std::align_val_t(Align));
+}
+
+template <class T, size_t Align>
+void aligned_allocator<T, Align>::deallocate(T* ptr, size_type /*n*/){
+    deallocate(ptr);
+}
+
+template <class T, size_t Align>
+T* aligned_allocator<T, Align>::reallocate(T* ptr, size_type old_n, size_type new_n){
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "aligned_allocator<T>::reallocate requires a trivially copyable T");
+    T* p = allocate(new_n);
+    if(ptr != nullptr && p != nullptr)
+        std::memcpy(static_cast<void*>(p), static_cast<const void*>(ptr), dhsstl::min(old_n, new_n) * sizeof(T));
+    deallocate(ptr);
+    return p;
+}
+
+template <class T, size_t Align>
+void aligned_allocator<T, Align>::construct(T* ptr){
+    dhsstl::construct(ptr);
+}
+
+template <class T, size_t Align>
+void aligned_allocator<T, Align>::construct(T* ptr, const T& value){
+    dhsstl::construct(ptr, value);
+}
+
+template <class T, size_t Align>
+void aligned_allocator<T, Align>::construct(T* ptr, T&& value){
+    dhsstl::construct(ptr, dhsstl::move(value));
+}
+
+template <class T, size_t Align>
+template <class ...Args>
+void aligned_allocator<T, Align>::construct(T* ptr, Args&& ...args){
+    dhsstl::construct(ptr, dhsstl::forward<Args>(args)...);
+}
+
+template <class T, size_t Align>
+void aligned_allocator<T, Align>::destroy(T* ptr){
+    dhsstl::destroy(ptr);
+}
+
+template <class T, size_t Align>
+void aligned_allocator<T, Align>::destroy(T* first, T* last){
+    dhsstl::destroy(first, last);
+}
+
+} // namespace dhsstl
+
+#endif // DHSTINYSTL_ALIGNED_ALLOCATOR_H_
@@ -6,6 +6,14 @@
 // 1. operator new
 // 2. placemnet new
 // 这个头文件包含一个模板类 allocator, 用于管理内存的分配以及释放, 对象的构造以及析构
+//
+// 注: trivially copyable 的类型使用 malloc / free 管理内存, 这样 reallocate 可以交给 realloc,
+//     由分配器原地扩展内存块; 对于 glibc, 超过 mmap 阈值的大块内存在 realloc 时会走 mremap,
+//     只重新映射页表而不会复制数据
+//     其他类型(包括对齐要求超过 max_align_t 的类型)使用 operator new / delete, 按 alignof(T) 对齐
+#include <cstdlib>
+#include <new>
+
 #include "construct.h"
 #include "util.h"
 
@@ -31,6 +39,10 @@ public:
     static void deallocate(T* ptr);
     static void deallocate(T* ptr, size_type value);
 
+    // 把 ptr 处的 old_n 个元素的空间调整为 new_n 个元素, 原有元素按字节保留, 失败时抛出 std::bad_alloc 且 ptr 保持不变
+    // 只能用于 trivially copyable 的类型
+    static T*   reallocate(T* ptr, size_type old_n, size_type new_n);
+
     static void construct(T* ptr);
     static void construct(T* ptr, const T& value);
     static void construct(T* ptr, T&& value);
@@ -40,34 +52,88 @@ public:
     
     static void destroy(T* ptr);
     static void destroy(T* first, T* last);
-    
+
+    // 是否使用 malloc / free 管理内存, 也即能否调用 reallocate
+    // 写成模板是为了推迟到使用时才求值, 以免 T 还是不完整类型
+    template <typename U = T>
+    static constexpr bool can_reallocate(){
+        return std::is_trivially_copyable<U>::value && alignof(U) <= alignof(std::max_align_t);
+    }
+
+private:
+    static void* raw_allocate(size_type bytes, std::true_type);
+    static void* raw_allocate(size_type bytes, std::false_type);
+    static void  raw_deallocate(void* ptr, std::true_type);
+    static void  raw_deallocate(void* ptr, std::false_type);
 };
 
 // 定义
 template<class T>
 T* allocator<T>::allocate(){
-    return static_cast<T*>(::operator new(sizeof(T)));
+    return static_cast<T*>(raw_allocate(sizeof(T), std::integral_constant<bool, can_reallocate()>{}));
 }
 
 template<class T>
 T* allocator<T>::allocate(size_type n){
     if(n == 0)
         return nullptr;
-    return static_cast<T*>(::operator new(n * sizeof(T)));
+    return static_cast<T*>(raw_allocate(n * sizeof(T), std::integral_constant<bool, can_reallocate()>{}));
 }
 
 template<class T>
 void allocator<T>::deallocate(T* ptr){
     if(ptr == nullptr)
         return;
-    ::operator delete(ptr);
+    raw_deallocate(ptr, std::integral_constant<bool, can_reallocate()>{});
 }
 
 template<class T>
 void allocator<T>::deallocate(T* ptr, size_type /*size*/){
     if(ptr == nullptr)
         return;
-    ::operator delete(ptr);
+    raw_deallocate(ptr, std::integral_constant<bool, can_reallocate()>{});
+}
+
+template<class T>
+T* allocator<T>::reallocate(T* ptr, size_type /*old_n*/, size_type new_n){
+    static_assert(can_reallocate(), "allocator<T>::reallocate requires a trivially copyable T");
+    if(new_n == 0){
+        deallocate(ptr);
+        return nullptr;
+    }
+    void* p = std::realloc(ptr, new_n * sizeof(T));
+    if(p == nullptr)
+        throw std::bad_alloc();
+    return static_cast<T*>(p);
+}
+
+template<class T>
+void* allocator<T>::raw_allocate(size_type bytes, std::true_type){
+    void* p = std::malloc(bytes);
+    if(p == nullptr)
+        throw std::bad_alloc();
+    return p;
+}
+
+// 对齐要求超过 operator new 默认对齐的类型使用带 align_val_t 的版本
+template<class T>
+void* allocator<T>::raw_allocate(size_type bytes, std::false_type){
+    if(alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+        return ::operator new(bytes, std::align_val_t(alignof(T)));
+    return ::operator new(bytes);
+}
+
+template<class T>
+void allocator<T>::raw_deallocate(void* ptr, std::true_type){
+    std::free(ptr);
+}
+
+template<class T>
+void allocator<T>::raw_deallocate(void* ptr, std::false_type){
+    if(alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+        ::operator delete(ptr, std::align_val_t(alignof(T)));
+    else
+        ::operator delete(ptr);
 }
 
 template<class T>
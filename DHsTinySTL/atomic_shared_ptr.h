@@ -0,0 +1,147 @@
+#ifndef DHSTINYSTL_ATOMIC_SHARED_PTR_H_
+#define DHSTINYSTL_ATOMIC_SHARED_PTR_H_
+
+// 这个头文件包含 atomic_shared_ptr: 可以被多个线程同时读写的 shared_ptr, 用于发布读多写少的快照(例如配置)
+//
+// 内部只保存一个指向不可变节点 holder 的原子指针, holder 中是一个 shared_ptr<T>
+//   load()  : 用 hazard pointer 保护当前的 holder, 复制其中的 shared_ptr, 引用计数加一
+//   read()  : 只用 hazard pointer 保护 holder, 返回 snapshot, 不修改引用计数,
+//             读者之间不会写同一个 cache line, 读者数增加时吞吐量随之增加
+//   store() : 分配新的 holder, exchange 之后 retire 旧的 holder, 由 hazard_domain 在没有读者时释放
+// 每次写都会分配一个 holder, 适合写远少于读的场景
+// 比较 compare_exchange 中的 expected 时只比较所指的对象, 不区分控制块
+
+#include <atomic>
+
+#include "memory.h"
+#include "reclaim.h"
+#include "util.h"
+
+namespace dhsstl
+{
+
+template <class T>
+class atomic_shared_ptr
+{
+public:
+    typedef shared_ptr<T> value_type;
+
+private:
+    struct holder
+    {
+        value_type value;
+
+        explicit holder(value_type&& v) :value(dhsstl::move(v)) {}
+    };
+
+    std::atomic<holder*> ptr_;
+
+public:
+    /*****************************************************************************************/
+    // snapshot
+    // 在 snapshot 析构之前所指的对象一直有效, 即使此期间 atomic_shared_ptr 已经被重新赋值
+    // 持有 hazard_domain 的一个槽位, 每个线程同时持有的 snapshot 不能超过 DHSSTL_HAZARD_SLOTS 个
+    /*****************************************************************************************/
+    class snapshot
+    {
+        friend class atomic_shared_ptr;
+
+        hazard_pointer hp_;
+        const holder*  holder_;
+
+        explicit snapshot(const std::atomic<holder*>& src) :hp_(), holder_(hp_.protect(src)) {}
+
+    public:
+        const T* get() const noexcept { return holder_ ? holder_->value.get() : nullptr; }
+        const T& operator*()  const noexcept { return *get(); }
+        const T* operator->() const noexcept { return get(); }
+        explicit operator bool() const noexcept { return get() != nullptr; }
+
+        // 需要在 snapshot 之外继续持有对象时, 复制出一个 shared_ptr
+        value_type lock() const { return holder_ ? holder_->value : value_type(); }
+    };
+
+public:
+    atomic_shared_ptr() noexcept :ptr_(nullptr) {}
+    explicit atomic_shared_ptr(value_type v) :ptr_(make_holder(dhsstl::move(v))) {}
+
+    atomic_shared_ptr(const atomic_shared_ptr&) = delete;
+    atomic_shared_ptr& operator=(const atomic_shared_ptr&) = delete;
+
+    // 析构时不能有其他线程访问
+    ~atomic_shared_ptr(){
+        delete ptr_.load(std::memory_order_relaxed);
+    }
+
+public:
+    // 写一侧不需要加锁, 但每次写都要分配 holder
+    bool is_lock_free() const noexcept { return ptr_.is_lock_free(); }
+
+    value_type load() const{
+        hazard_pointer hp;
+        holder* h = hp.protect(ptr_);
+        return h ? h->value : value_type();
+    }
+
+    snapshot read() const { return snapshot(ptr_); }
+
+    void store(value_type v){
+        retire(ptr_.exchange(make_holder(dhsstl::move(v)), std::memory_order_acq_rel));
+    }
+
+    value_type exchange(value_type v){
+        holder* old = ptr_.exchange(make_holder(dhsstl::move(v)), std::memory_order_acq_rel);
+        if(old == nullptr)
+            return value_type();
+        // old 已经不可达, 其他线程只会读它
+        value_type result = old->value;
+        retire(old);
+        return result;
+    }
+
+    // 当前值与 expected 指向同一个对象时换成 desired, 否则把当前值写入 expected 并返回 false
+    bool compare_exchange_strong(value_type& expected, value_type desired);
+
+    bool compare_exchange_weak(value_type& expected, value_type desired){
+        return compare_exchange_strong(expected, dhsstl::move(desired));
+    }
+
+    operator value_type() const { return load(); }
+
+private:
+    static holder* make_holder(value_type&& v){
+        return v ? new holder(dhsstl::move(v)) : nullptr;
+    }
+
+    static void retire(holder* h){
+        if(h != nullptr)
+            hazard_retire(h);
+    }
+};
+
+// holder 的地址没变但对象相同时(同一个 shared_ptr 被 store 了两次)需要重试
+template <class T>
+bool atomic_shared_ptr<T>::compare_exchange_strong(value_type& expected, value_type desired){
+    hazard_pointer hp;
+    for(;;){
+        holder* cur = hp.protect(ptr_);
+        const T* cur_data = cur ? cur->value.get() : nullptr;
+        if(cur_data != static_cast<const value_type&>(expected).get()){
+            expected = cur ? cur->value : value_type();
+            return false;
+        }
+        holder* h = make_holder(dhsstl::move(desired));
+        if(ptr_.compare_exchange_strong(cur, h, std::memory_order_acq_rel, std::memory_order_relaxed)){
+            retire(cur);
+            return true;
+        }
+        if(h != nullptr){
+            desired = dhsstl::move(h->value);
+            delete h;
+        }
+    }
+}
+
+} // namespace dhsstl
+
+#endif // !DHSTINYSTL_ATOMIC_SHARED_PTR_H_
@@ -0,0 +1,826 @@
+#ifndef DHSTINYSTL_CONCURRENT_QUEUE_H_
+#define DHSTINYSTL_CONCURRENT_QUEUE_H_
+
+// 这个头文件包含两个无锁的有界队列: spsc_queue 和 mpmc_queue, 以及无界的多生产者单消费者队列 mpsc_queue
+// 有界队列是容量固定的环形缓冲区, 容量在构造时给定并向上取整为 2 的幂
+//
+// spsc_queue : 单生产者单消费者, try_push / try_pop 都是 wait-free 的
+//              head 和 tail 分别放在不同的 cache line, 并且各自缓存对方的下标, 减少 cache line 在核之间来回传递
+// mpmc_queue : 多生产者多消费者, Dmitry Vyukov 的有界队列, 每个槽位带一个序号
+//              生产者 / 消费者用 CAS 抢占下标, 再通过槽位的序号发布数据
+//
+// 类本身按 cache line 对齐, 相邻的对象也不会和最后一个下标共用 cache line
+// 两者都提供批量接口 push_n / pop_n, 一次抢占多个槽位, 把同步的开销摊到多个元素上
+//
+// 注: mpmc_queue 在抢占槽位之后才构造 / 移出元素, 中途抛出异常会让槽位永远无法发布,
+//     所以要求 T 的移动构造, 移动赋值和析构都不抛出异常
+//
+// intrusive_mpsc_queue : Dmitry Vyukov 的侵入式 MPSC 链表队列, 元素继承 mpsc_node
+//                        push 只有一次 exchange, 任意多个生产者都是 wait-free 的, pop 只能由一个消费者调用
+// mpsc_queue           : 在 intrusive_mpsc_queue 之上保存值的无界队列, 接口和 queue 类似
+//                        节点由 mpsc_node_pool 回收复用, 稳定之后 push / pop 不再调用 malloc / free
+
+#include <atomic>
+#include <cstdint>
+#include <new>
+#include <thread>
+#include <type_traits>
+
+#include "algobase.h"
+#include "allocator.h"
+#include "construct.h"
+#include "exceptdef.h"
+#include "util.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace dhsstl
+{
+
+// cache line 的大小, 用来把不同线程频繁写的变量隔开, 避免伪共享
+#ifndef DHSSTL_CACHE_LINE_SIZE
+#define DHSSTL_CACHE_LINE_SIZE 64
+#endif
+
+constexpr size_t cache_line_size = DHSSTL_CACHE_LINE_SIZE;
+
+// 自旋等待时调用, 提示 CPU 当前处于忙等
+inline void spin_pause() noexcept{
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#else
+    std::this_thread::yield();
+#endif
+}
+
+// 指数退避: 先自旋, 次数逐渐加倍, 之后让出时间片
+// 核数少于线程数时, 一直自旋会占住对方需要的 CPU
+class backoff
+{
+    unsigned step_ = 0;
+public:
+    void pause() noexcept{
+        if(step_ < 6){
+            for(unsigned i = 0; i < (1u << step_); ++i)
+                spin_pause();
+            ++step_;
+        }
+        else{
+            std::this_thread::yield();
+        }
+    }
+    void reset() noexcept { step_ = 0; }
+};
+
+namespace detail
+{
+
+// 把容量向上取整为 2 的幂, 下标可以用 & mask 代替取模
+inline size_t ring_capacity(size_t n, size_t min_n){
+    THROW_LENGTH_ERROR_IF(n > (static_cast<size_t>(1) << (sizeof(size_t) * 8 - 2)),
+                          "concurrent queue capacity too big");
+    size_t cap = min_n;
+    while(cap < n)
+        cap <<= 1;
+    return cap;
+}
+
+} // namespace detail
+
+/*****************************************************************************************/
+// spsc_queue
+// 单生产者单消费者的有界队列
+// 生产者线程只能调用 try_push / try_emplace / push / push_n, 消费者线程只能调用 try_pop / pop / pop_n / front
+/*****************************************************************************************/
+template <class T>
+class spsc_queue
+{
+public:
+    typedef T                   value_type;
+    typedef T&                  reference;
+    typedef const T&            const_reference;
+    typedef size_t              size_type;
+    typedef dhsstl::allocator<T> data_allocator;
+
+private:
+    // 两端只读的数据
+    alignas(cache_line_size) T*       buffer_;
+    size_type                         mask_;
+
+    // 消费者写 head_, 并缓存 tail_ 的值
+    alignas(cache_line_size) std::atomic<size_type> head_;
+    size_type                                       cached_tail_;
+
+    // 生产者写 tail_, 并缓存 head_ 的值
+    alignas(cache_line_size) std::atomic<size_type> tail_;
+    size_type                                       cached_head_;
+
+public:
+    explicit spsc_queue(size_type capacity)
+        :buffer_(nullptr), mask_(0), head_(0), cached_tail_(0), tail_(0), cached_head_(0)
+    {
+        const size_type cap = detail::ring_capacity(capacity, 1);
+        buffer_ = data_allocator::allocate(cap);
+        mask_ = cap - 1;
+    }
+
+    spsc_queue(const spsc_queue&) = delete;
+    spsc_queue& operator=(const spsc_queue&) = delete;
+
+    ~spsc_queue(){
+        const size_type tail = tail_.load(std::memory_order_relaxed);
+        for(size_type i = head_.load(std::memory_order_relaxed); i != tail; ++i)
+            data_allocator::destroy(buffer_ + (i & mask_));
+        data_allocator::deallocate(buffer_, mask_ + 1);
+    }
+
+public:
+    // 容量相关操作
+    size_type capacity() const noexcept { return mask_ + 1; }
+
+    // 其他线程同时操作时只是一个近似值
+    size_type size_approx() const noexcept{
+        const size_type head = head_.load(std::memory_order_acquire);
+        const size_type tail = tail_.load(std::memory_order_acquire);
+        return tail - head;
+    }
+    bool empty() const noexcept { return size_approx() == 0; }
+
+    // 生产者接口, 队列已满时返回 false
+    template <class ...Args>
+    bool try_emplace(Args&& ...args);
+
+    bool try_push(const value_type& value) { return try_emplace(value); }
+    bool try_push(value_type&& value)      { return try_emplace(dhsstl::move(value)); }
+
+    // 队列已满时自旋等待, 见 backoff
+    void push(const value_type& value) { backoff b; while(!try_emplace(value)) b.pause(); }
+    void push(value_type&& value)      { backoff b; while(!try_emplace(dhsstl::move(value))) b.pause(); }
+
+    // 从 first 开始最多放入 n 个元素, 返回实际放入的个数, 只发布一次 tail_
+    template <class InputIter>
+    size_type push_n(InputIter first, size_type n);
+
+    // 消费者接口, 队列为空时 front 返回 nullptr, try_pop 返回 false
+    value_type* front() noexcept;
+    bool try_pop(value_type& value);
+    void pop(value_type& value) { backoff b; while(!try_pop(value)) b.pause(); }
+
+    // 最多取出 n 个元素写到 out, 返回实际取出的个数, 只发布一次 head_
+    template <class OutputIter>
+    size_type pop_n(OutputIter out, size_type n);
+};
+
+/*****************************************************************************************/
+
+// 在队尾构造一个元素
+template <class T>
+template <class ...Args>
+bool spsc_queue<T>::try_emplace(Args&& ...args){
+    const size_type tail = tail_.load(std::memory_order_relaxed);
+    if(tail - cached_head_ > mask_){
+        cached_head_ = head_.load(std::memory_order_acquire);
+        if(tail - cached_head_ > mask_)
+            return false;
+    }
+    data_allocator::construct(buffer_ + (tail & mask_), dhsstl::forward<Args>(args)...);
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+template <class T>
+template <class InputIter>
+typename spsc_queue<T>::size_type
+spsc_queue<T>::push_n(InputIter first, size_type n){
+    const size_type tail = tail_.load(std::memory_order_relaxed);
+    size_type room = capacity() - (tail - cached_head_);
+    if(room < n){
+        cached_head_ = head_.load(std::memory_order_acquire);
+        room = capacity() - (tail - cached_head_);
+    }
+    const size_type k = dhsstl::min(room, n);
+    size_type i = 0;
+    try{
+        for(; i < k; ++i, ++first)
+            data_allocator::construct(buffer_ + ((tail + i) & mask_), *first);
+    }
+    catch(...){
+        // 已经构造好的元素照常发布
+        tail_.store(tail + i, std::memory_order_release);
+        throw;
+    }
+    tail_.store(tail + k, std::memory_order_release);
+    return k;
+}
+
+template <class T>
+typename spsc_queue<T>::value_type*
+spsc_queue<T>::front() noexcept{
+    const size_type head = head_.load(std::memory_order_relaxed);
+    if(head == cached_tail_){
+        cached_tail_ = tail_.load(std::memory_order_acquire);
+        if(head == cached_tail_)
+            return nullptr;
+    }
+    return buffer_ + (head & mask_);
+}
+
+template <class T>
+bool spsc_queue<T>::try_pop(value_type& value){
+    const size_type head = head_.load(std::memory_order_relaxed);
+    if(head == cached_tail_){
+        cached_tail_ = tail_.load(std::memory_order_acquire);
+        if(head == cached_tail_)
+            return false;
+    }
+    value_type* p = buffer_ + (head & mask_);
+    value = dhsstl::move(*p);
+    data_allocator::destroy(p);
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+template <class T>
+template <class OutputIter>
+typename spsc_queue<T>::size_type
+spsc_queue<T>::pop_n(OutputIter out, size_type n){
+    const size_type head = head_.load(std::memory_order_relaxed);
+    if(cached_tail_ - head < n)
+        cached_tail_ = tail_.load(std::memory_order_acquire);
+    const size_type k = dhsstl::min(cached_tail_ - head, n);
+    size_type i = 0;
+    try{
+        for(; i < k; ++i, ++out){
+            value_type* p = buffer_ + ((head + i) & mask_);
+            *out = dhsstl::move(*p);
+            data_allocator::destroy(p);
+        }
+    }
+    catch(...){
+        // 第 i 个元素仍然留在队列中
+        head_.store(head + i, std::memory_order_release);
+        throw;
+    }
+    head_.store(head + k, std::memory_order_release);
+    return k;
+}
+
+/*****************************************************************************************/
+// mpmc_queue
+// 多生产者多消费者的有界队列, 任意线程都可以调用所有接口
+// 槽位 i 的序号 seq:
+//      seq == pos          : 槽位空闲, 等待下标为 pos 的生产者
+//      seq == pos + 1      : 槽位已写入, 等待下标为 pos 的消费者
+//      取出后 seq = pos + capacity, 留给下一轮的生产者
+/*****************************************************************************************/
+template <class T>
+class mpmc_queue
+{
+    static_assert(std::is_nothrow_move_constructible<T>::value &&
+                  std::is_nothrow_move_assignable<T>::value &&
+                  std::is_nothrow_destructible<T>::value,
+                  "mpmc_queue<T> requires T to be nothrow move constructible, move assignable and destructible");
+
+public:
+    typedef T                   value_type;
+    typedef T&                  reference;
+    typedef const T&            const_reference;
+    typedef size_t              size_type;
+
+private:
+    struct cell
+    {
+        std::atomic<size_type>                                     seq;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+
+        T* value() noexcept { return reinterpret_cast<T*>(&storage); }
+    };
+    typedef dhsstl::allocator<cell> cell_allocator;
+
+    // 两端只读的数据
+    alignas(cache_line_size) cell*    buffer_;
+    size_type                         mask_;
+
+    // 生产者和消费者各自抢占的下标, 放在不同的 cache line
+    alignas(cache_line_size) std::atomic<size_type> enqueue_pos_;
+    alignas(cache_line_size) std::atomic<size_type> dequeue_pos_;
+
+public:
+    explicit mpmc_queue(size_type capacity)
+        :buffer_(nullptr), mask_(0), enqueue_pos_(0), dequeue_pos_(0)
+    {
+        // 容量为 1 时 "已写入" 和 "下一轮空闲" 的序号相同, 所以至少为 2
+        const size_type cap = detail::ring_capacity(capacity, 2);
+        buffer_ = cell_allocator::allocate(cap);
+        for(size_type i = 0; i < cap; ++i)
+            ::new (static_cast<void*>(&buffer_[i].seq)) std::atomic<size_type>(i);
+        mask_ = cap - 1;
+    }
+
+    mpmc_queue(const mpmc_queue&) = delete;
+    mpmc_queue& operator=(const mpmc_queue&) = delete;
+
+    ~mpmc_queue(){
+        // 析构时没有其他线程访问, [dequeue_pos_, enqueue_pos_) 中的槽位都已经发布
+        const size_type tail = enqueue_pos_.load(std::memory_order_relaxed);
+        for(size_type i = dequeue_pos_.load(std::memory_order_relaxed); i != tail; ++i)
+            dhsstl::destroy(buffer_[i & mask_].value());
+        cell_allocator::deallocate(buffer_, mask_ + 1);
+    }
+
+public:
+    size_type capacity() const noexcept { return mask_ + 1; }
+
+    size_type size_approx() const noexcept{
+        const size_type head = dequeue_pos_.load(std::memory_order_acquire);
+        const size_type tail = enqueue_pos_.load(std::memory_order_acquire);
+        return tail > head ? tail - head : 0;
+    }
+    bool empty() const noexcept { return size_approx() == 0; }
+
+    // 构造元素的参数必须不抛出异常, 否则先构造一个临时对象再 try_push(T&&)
+    template <class ...Args>
+    bool try_emplace(Args&& ...args);
+
+    bool try_push(const value_type& value){
+        return try_push_aux(value, std::integral_constant<bool,
+                            std::is_nothrow_copy_constructible<T>::value>{});
+    }
+    bool try_push(value_type&& value) { return try_emplace(dhsstl::move(value)); }
+
+    void push(const value_type& value) { backoff b; while(!try_push(value)) b.pause(); }
+    void push(value_type&& value)      { backoff b; while(!try_emplace(dhsstl::move(value))) b.pause(); }
+
+    // 一次 CAS 抢占连续的至多 n 个空闲槽位, 返回实际放入的个数
+    template <class InputIter>
+    size_type push_n(InputIter first, size_type n);
+
+    bool try_pop(value_type& value);
+    void pop(value_type& value) { backoff b; while(!try_pop(value)) b.pause(); }
+
+    // 一次 CAS 抢占连续的至多 n 个已写入的槽位, 返回实际取出的个数
+    // out 的赋值和自增不能抛出异常
+    template <class OutputIter>
+    size_type pop_n(OutputIter out, size_type n);
+
+private:
+    bool try_push_aux(const value_type& value, std::true_type) { return try_emplace(value); }
+    bool try_push_aux(const value_type& value, std::false_type){
+        value_type tmp(value);
+        return try_emplace(dhsstl::move(tmp));
+    }
+
+    template <class InputIter>
+    size_type push_n_aux(InputIter first, size_type n, std::true_type);
+    template <class InputIter>
+    size_type push_n_aux(InputIter first, size_type n, std::false_type);
+
+    // 从 pos 开始数出至多 n 个序号等于 pos + i + offset 的连续槽位
+    // 返回 0 时 *diff 给出第一个槽位的序号差: 小于 0 表示队列满 / 空, 大于 0 表示 pos 已经过时
+    size_type count_ready(size_type pos, size_type n, size_type offset, intptr_t* diff) const noexcept;
+};
+
+/*****************************************************************************************/
+
+template <class T>
+typename mpmc_queue<T>::size_type
+mpmc_queue<T>::count_ready(size_type pos, size_type n, size_type offset, intptr_t* diff) const noexcept{
+    size_type k = 0;
+    for(; k < n; ++k){
+        const size_type seq = buffer_[(pos + k) & mask_].seq.load(std::memory_order_acquire);
+        const intptr_t d = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + k + offset);
+        if(d != 0){
+            if(k == 0)
+                *diff = d;
+            break;
+        }
+    }
+    return k;
+}
+
+template <class T>
+template <class ...Args>
+bool mpmc_queue<T>::try_emplace(Args&& ...args){
+    static_assert(std::is_nothrow_constructible<T, Args...>::value,
+                  "mpmc_queue<T>::try_emplace requires a nothrow constructor");
+    cell* c;
+    size_type pos = enqueue_pos_.load(std::memory_order_relaxed);
+    for(;;){
+        c = buffer_ + (pos & mask_);
+        const size_type seq = c->seq.load(std::memory_order_acquire);
+        const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+        if(diff == 0){
+            if(enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if(diff < 0){
+            return false;
+        }
+        else{
+            pos = enqueue_pos_.load(std::memory_order_relaxed);
+        }
+    }
+    dhsstl::construct(c->value(), dhsstl::forward<Args>(args)...);
+    c->seq.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+template <class T>
+template <class InputIter>
+typename mpmc_queue<T>::size_type
+mpmc_queue<T>::push_n(InputIter first, size_type n){
+    if(n == 0)
+        return 0;
+    return push_n_aux(first, n, std::integral_constant<bool,
+                      std::is_nothrow_constructible<T, decltype(*first)>::value>{});
+}
+
+// 从 *first 构造不会抛出异常, 批量抢占槽位
+template <class T>
+template <class InputIter>
+typename mpmc_queue<T>::size_type
+mpmc_queue<T>::push_n_aux(InputIter first, size_type n, std::true_type){
+    size_type k;
+    size_type pos = enqueue_pos_.load(std::memory_order_relaxed);
+    for(;;){
+        intptr_t diff = 0;
+        k = count_ready(pos, n, 0, &diff);
+        if(k != 0){
+            if(enqueue_pos_.compare_exchange_weak(pos, pos + k, std::memory_order_relaxed))
+                break;
+        }
+        else if(diff < 0){
+            return 0;
+        }
+        else{
+            pos = enqueue_pos_.load(std::memory_order_relaxed);
+        }
+    }
+    for(size_type i = 0; i < k; ++i, ++first){
+        cell* c = buffer_ + ((pos + i) & mask_);
+        dhsstl::construct(c->value(), *first);
+        c->seq.store(pos + i + 1, std::memory_order_release);
+    }
+    return k;
+}
+
+// 构造可能抛出异常, 先在槽位外构造好再逐个放入
+template <class T>
+template <class InputIter>
+typename mpmc_queue<T>::size_type
+mpmc_queue<T>::push_n_aux(InputIter first, size_type n, std::false_type){
+    size_type k = 0;
+    for(; k < n; ++k, ++first){
+        value_type tmp(*first);
+        if(!try_emplace(dhsstl::move(tmp)))
+            break;
+    }
+    return k;
+}
+
+template <class T>
+bool mpmc_queue<T>::try_pop(value_type& value){
+    cell* c;
+    size_type pos = dequeue_pos_.load(std::memory_order_relaxed);
+    for(;;){
+        c = buffer_ + (pos & mask_);
+        const size_type seq = c->seq.load(std::memory_order_acquire);
+        const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+        if(diff == 0){
+            if(dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if(diff < 0){
+            return false;
+        }
+        else{
+            pos = dequeue_pos_.load(std::memory_order_relaxed);
+        }
+    }
+    value = dhsstl::move(*c->value());
+    dhsstl::destroy(c->value());
+    c->seq.store(pos + mask_ + 1, std::memory_order_release);
+    return true;
+}
+
+template <class T>
+template <class OutputIter>
+typename mpmc_queue<T>::size_type
+mpmc_queue<T>::pop_n(OutputIter out, size_type n){
+    if(n == 0)
+        return 0;
+    size_type k;
+    size_type pos = dequeue_pos_.load(std::memory_order_relaxed);
+    for(;;){
+        intptr_t diff = 0;
+        k = count_ready(pos, n, 1, &diff);
+        if(k != 0){
+            if(dequeue_pos_.compare_exchange_weak(pos, pos + k, std::memory_order_relaxed))
+                break;
+        }
+        else if(diff < 0){
+            return 0;
+        }
+        else{
+            pos = dequeue_pos_.load(std::memory_order_relaxed);
+        }
+    }
+    for(size_type i = 0; i < k; ++i, ++out){
+        cell* c = buffer_ + ((pos + i) & mask_);
+        *out = dhsstl::move(*c->value());
+        dhsstl::destroy(c->value());
+        c->seq.store(pos + i + mask_ + 1, std::memory_order_release);
+    }
+    return k;
+}
+
+/*****************************************************************************************/
+// mpsc_node
+// intrusive_mpsc_queue 的链接字段, 元素类型需要公有继承它
+// 节点不在队列中时, mpsc_node_pool 借用同一个字段串起空闲链表
+/*****************************************************************************************/
+struct mpsc_node
+{
+    std::atomic<mpsc_node*> mpsc_next{nullptr};
+};
+
+/*****************************************************************************************/
+// intrusive_mpsc_queue
+// 不负责节点的分配和释放, push 进来的节点在 pop 出去之前必须保持有效
+// 生产者: push 用 exchange 把自己挂到 head_ 上, 再把前一个节点的 next 指向自己
+// 消费者: 从 tail_ 开始沿 next 读取, 队列中只剩最后一个节点时补入 stub_, 保证总能把它取出
+// 生产者执行完 exchange 还没有链接 next 时, 消费者会暂时看不到后面的节点, 此时 pop 返回 nullptr
+/*****************************************************************************************/
+template <class Node>
+class intrusive_mpsc_queue
+{
+    static_assert(std::is_base_of<mpsc_node, Node>::value,
+                  "intrusive_mpsc_queue<Node> requires Node to derive from mpsc_node");
+
+private:
+    alignas(cache_line_size) std::atomic<mpsc_node*> head_;   // 生产者写
+    alignas(cache_line_size) mpsc_node*              tail_;   // 只有消费者访问
+    mpsc_node                                        stub_;
+
+public:
+    intrusive_mpsc_queue() noexcept
+        :head_(&stub_), tail_(&stub_) {}
+
+    intrusive_mpsc_queue(const intrusive_mpsc_queue&) = delete;
+    intrusive_mpsc_queue& operator=(const intrusive_mpsc_queue&) = delete;
+
+    // 任意线程都可以调用
+    void push(Node* node) noexcept { push_node(node); }
+
+    // 只能由消费者调用, 没有可以取出的节点时返回 nullptr
+    Node* pop() noexcept;
+
+private:
+    void push_node(mpsc_node* node) noexcept{
+        node->mpsc_next.store(nullptr, std::memory_order_relaxed);
+        mpsc_node* prev = head_.exchange(node, std::memory_order_acq_rel);
+        prev->mpsc_next.store(node, std::memory_order_release);
+    }
+};
+
+template <class Node>
+Node* intrusive_mpsc_queue<Node>::pop() noexcept{
+    mpsc_node* tail = tail_;
+    mpsc_node* next = tail->mpsc_next.load(std::memory_order_acquire);
+    // 跳过 stub_
+    if(tail == &stub_){
+        if(next == nullptr)
+            return nullptr;
+        tail_ = next;
+        tail = next;
+        next = next->mpsc_next.load(std::memory_order_acquire);
+    }
+    if(next != nullptr){
+        tail_ = next;
+        return static_cast<Node*>(tail);
+    }
+    // tail 是最后一个节点, 或者有生产者还没有链接完成
+    if(tail != head_.load(std::memory_order_acquire))
+        return nullptr;
+    push_node(&stub_);
+    next = tail->mpsc_next.load(std::memory_order_acquire);
+    if(next != nullptr){
+        tail_ = next;
+        return static_cast<Node*>(tail);
+    }
+    return nullptr;
+}
+
+/*****************************************************************************************/
+// mpsc_node_pool
+// 节点的回收池, 同一种 Node 的所有队列共用
+// 每个线程有自己的缓存, 释放的节点先放进本线程的缓存, 攒够 batch 个之后整串交给全局的 depot
+// 分配时依次从本线程释放的节点, 从 depot 取来的节点中获取, 都没有时才向 allocator 申请
+// depot 只支持 "整串放入" 和 "全部取走(exchange)", 所以不会出现 ABA 问题
+/*****************************************************************************************/
+template <class Node, size_t Batch = 64>
+class mpsc_node_pool
+{
+    typedef dhsstl::allocator<Node> node_allocator;
+
+    static mpsc_node* next_of(mpsc_node* p) noexcept{
+        return p->mpsc_next.load(std::memory_order_relaxed);
+    }
+    static void set_next(mpsc_node* p, mpsc_node* next) noexcept{
+        p->mpsc_next.store(next, std::memory_order_relaxed);
+    }
+
+    // 全局的 depot, 程序结束时释放剩下的节点
+    struct depot
+    {
+        std::atomic<mpsc_node*> head{nullptr};
+
+        void give(mpsc_node* first, mpsc_node* last) noexcept{
+            mpsc_node* old = head.load(std::memory_order_relaxed);
+            do{
+                set_next(last, old);
+            }while(!head.compare_exchange_weak(old, first, std::memory_order_release,
+                                               std::memory_order_relaxed));
+        }
+        mpsc_node* take() noexcept{
+            if(head.load(std::memory_order_relaxed) == nullptr)
+                return nullptr;
+            return head.exchange(nullptr, std::memory_order_acquire);
+        }
+        ~depot(){
+            for(mpsc_node* p = head.load(std::memory_order_relaxed); p != nullptr; ){
+                mpsc_node* next = next_of(p);
+                node_allocator::deallocate(static_cast<Node*>(p));
+                p = next;
+            }
+        }
+    };
+
+    // 线程退出时把缓存的节点交还给 depot
+    struct local_cache
+    {
+        depot&     shared;
+        mpsc_node* freed = nullptr;      // 本线程释放的节点
+        mpsc_node* freed_last = nullptr;
+        size_t     freed_count = 0;
+        mpsc_node* taken = nullptr;      // 从 depot 取来的节点
+
+        explicit local_cache(depot& d) noexcept :shared(d) {}
+        ~local_cache(){
+            flush();
+            if(taken != nullptr){
+                mpsc_node* last = taken;
+                while(next_of(last) != nullptr)
+                    last = next_of(last);
+                shared.give(taken, last);
+            }
+        }
+        void flush() noexcept{
+            if(freed != nullptr)
+                shared.give(freed, freed_last);
+            freed = freed_last = nullptr;
+            freed_count = 0;
+        }
+    };
+
+    static depot& shared_depot(){
+        static depot d;
+        return d;
+    }
+    // depot 先于 local_cache 构造, 因而在它之后析构
+    static local_cache& local(){
+        static thread_local local_cache c(shared_depot());
+        return c;
+    }
+
+public:
+    // 返回未构造的节点内存
+    static Node* allocate(){
+        local_cache& c = local();
+        mpsc_node* p = c.freed;
+        if(p != nullptr){
+            c.freed = next_of(p);
+            if(--c.freed_count == 0)
+                c.freed_last = nullptr;
+            return static_cast<Node*>(p);
+        }
+        if(c.taken == nullptr)
+            c.taken = c.shared.take();
+        p = c.taken;
+        if(p != nullptr){
+            c.taken = next_of(p);
+            return static_cast<Node*>(p);
+        }
+        return node_allocator::allocate();
+    }
+
+    // 节点上的对象必须已经析构
+    static void deallocate(Node* node) noexcept{
+        local_cache& c = local();
+        set_next(node, c.freed);
+        if(c.freed == nullptr)
+            c.freed_last = node;
+        c.freed = node;
+        if(++c.freed_count >= Batch)
+            c.flush();
+    }
+};
+
+/*****************************************************************************************/
+// mpsc_queue
+// 无界的多生产者单消费者队列
+// 生产者线程可以调用 push / emplace, 消费者线程调用 front / pop / try_pop / empty
+/*****************************************************************************************/
+template <class T>
+class mpsc_queue
+{
+public:
+    typedef T           value_type;
+    typedef T&          reference;
+    typedef const T&    const_reference;
+    typedef size_t      size_type;
+
+private:
+    struct node : public mpsc_node
+    {
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+
+        T* value() noexcept { return reinterpret_cast<T*>(&storage); }
+    };
+    typedef mpsc_node_pool<node> node_pool;
+
+    intrusive_mpsc_queue<node> q_;
+    node*                      front_ = nullptr;  // 消费者已经取出, 但还没有 pop 的节点
+
+public:
+    mpsc_queue() = default;
+
+    mpsc_queue(const mpsc_queue&) = delete;
+    mpsc_queue& operator=(const mpsc_queue&) = delete;
+
+    // 析构时不能有其他线程访问
+    ~mpsc_queue(){
+        while(front_node() != nullptr)
+            pop();
+    }
+
+public:
+    // 生产者接口
+    template <class ...Args>
+    void emplace(Args&& ...args){
+        node* p = node_pool::allocate();
+        try{
+            dhsstl::construct(p->value(), dhsstl::forward<Args>(args)...);
+        }
+        catch(...){
+            node_pool::deallocate(p);
+            throw;
+        }
+        q_.push(p);
+    }
+
+    void push(const value_type& value) { emplace(value); }
+    void push(value_type&& value)      { emplace(dhsstl::move(value)); }
+
+    // 消费者接口
+    // 生产者正在链接时, 已经 push 的元素可能暂时不可见, 此时 empty 返回 true
+    bool empty() noexcept { return front_node() == nullptr; }
+
+    // 队列不能为空
+    reference front() noexcept{
+        DHSSTL_DEBUG(front_node() != nullptr);
+        return *front_node()->value();
+    }
+
+    void pop() noexcept{
+        node* p = front_node();
+        DHSSTL_DEBUG(p != nullptr);
+        dhsstl::destroy(p->value());
+        node_pool::deallocate(p);
+        front_ = nullptr;
+    }
+
+    bool try_pop(value_type& value){
+        node* p = front_node();
+        if(p == nullptr)
+            return false;
+        value = dhsstl::move(*p->value());
+        pop();
+        return true;
+    }
+
+private:
+    node* front_node() noexcept{
+        if(front_ == nullptr)
+            front_ = q_.pop();
+        return front_;
+    }
+};
+
+} // namespace dhsstl
+
+#endif // !DHSTINYSTL_CONCURRENT_QUEUE_H_
@@ -49,6 +49,12 @@ void destroy_one(Ty *pointer, std::false_type)
     }
 }
 
+template <class Ty>
+void destroy(Ty* pointer)
+{
+    destroy_one(pointer, std::is_trivially_destructible<Ty>{});
+}
+
 template <class ForwardIter>
 void destroy_cat(ForwardIter, ForwardIter, std::true_type) {}
 
@@ -59,12 +65,6 @@ void destroy_cat(ForwardIter first, ForwardIter last, std::false_type)
         destroy(&*first);
 }
 
-template <class Ty>
-void destroy(Ty* pointer)
-{
-    destroy_one(pointer, std::is_trivially_destructible<Ty>{});
-}
-
 template <class ForwardIter>
 void destroy(ForwardIter first, ForwardIter last)
 {
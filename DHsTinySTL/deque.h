@@ -15,6 +15,10 @@
 //  *push_front
 //  *push_back
 //  *insert
+//
+// 当 dhsstl::is_trivially_relocatable<T>::value == true 时, 在中间位置 insert / erase 会按字节搬移元素,
+// 而不会逐个调用赋值操作符和析构函数
+// 每个缓冲区的元素个数由模板参数 BufSize 决定, 释放的缓冲区先放入空闲缓存(DEQUE_SPARE_BLOCKS), 供之后复用
 
 #include <initializer_list>
 
@@ -40,16 +44,24 @@ namespace dhsstl{
 #define DEQUE_MAP_INIT_SIZE 8
 #endif
 
-template<typename T>
+// 每个 deque 最多缓存的空闲缓冲区数目
+#ifndef DEQUE_SPARE_BLOCKS
+#define DEQUE_SPARE_BLOCKS 4
+#endif
+
+// 每个缓冲区的元素个数
+// BufSize 不为 0 时直接使用 BufSize, 否则每个缓冲区 4096 字节(T 不小于 256 字节时为 16 个元素)
+template<typename T, size_t BufSize = 0>
 struct deque_buf_size{
-    static constexpr size_t value = sizeof(T) < 256 ? 4096 / sizeof(T) : 16;
+    static constexpr size_t value = BufSize != 0 ? BufSize
+                                  : (sizeof(T) < 256 ? 4096 / sizeof(T) : 16);
 };
 
 // deque 的迭代器设计
-template<typename T, typename Ref, typename Ptr>
+template<typename T, typename Ref, typename Ptr, size_t BufSize = 0>
 struct deque_iterator : public iterator<random_access_iterator_tag, T>{
-    typedef deque_iterator<T, T&, T*>                   iterator;
-    typedef deque_iterator<T, const T&, const T*>       const_iterator;
+    typedef deque_iterator<T, T&, T*, BufSize>             iterator;
+    typedef deque_iterator<T, const T&, const T*, BufSize> const_iterator;
     typedef deque_iterator                              self;
 
     typedef T               value_type;
@@ -60,7 +72,7 @@ struct deque_iterator : public iterator<random_access_iterator_tag, T>{
     typedef T*              value_pointer;
     typedef T**             map_pointer;
 
-    static const size_type buffer_size = deque_buf_size<T>::value;
+    static const size_type buffer_size = deque_buf_size<T, BufSize>::value;
 
     // 迭代器所含成员数据
     value_pointer cur;      // 指向所在缓冲区的当前元素
@@ -187,14 +199,32 @@ struct deque_iterator : public iterator<random_access_iterator_tag, T>{
     bool operator>=(const self& rhs) const { return !(*this < rhs); }
 };
 
+// deque_iterator 是分段迭代器: 每个缓冲区是一段, 用 map 中的节点标识
+template<typename T, typename Ref, typename Ptr, size_t BufSize>
+struct segmented_iterator_traits<deque_iterator<T, Ref, Ptr, BufSize>>{
+    typedef deque_iterator<T, Ref, Ptr, BufSize>        iterator;
+    typedef typename iterator::map_pointer              segment_iterator;
+    typedef Ptr                                         local_iterator;
+
+    static constexpr bool is_segmented = true;
+
+    static segment_iterator segment(const iterator& it)       { return it.node; }
+    static local_iterator   local(const iterator& it)         { return it.cur; }
+    static local_iterator   segment_begin(segment_iterator s) { return *s; }
+    static local_iterator   segment_end(segment_iterator s)   { return *s + iterator::buffer_size; }
+};
+
 // 模板类 deque
-// 模板参数代表数据类型
-template<typename T>
+// 模板参数 T 代表数据类型, Alloc 代表缓冲区的分配器, BufSize 代表每个缓冲区的元素个数(0 表示使用默认值)
+// 注: Alloc 需要提供和 dhsstl::allocator 相同的静态接口, map 本身很小, 总是使用 dhsstl::allocator
+//     被释放的缓冲区会先放入最多 DEQUE_SPARE_BLOCKS 个的空闲缓存, 作为 FIFO 使用时,
+//     pop_front 释放的缓冲区马上会被 push_back 复用, 稳定之后不再分配内存
+template<typename T, typename Alloc = dhsstl::allocator<T>, size_t BufSize = 0>
 class deque{
 public:
     // deque 的型别定义
-    typedef dhsstl::allocator<T>                        allocator_type;
-    typedef dhsstl::allocator<T>                        data_allocator;
+    typedef Alloc                                       allocator_type;
+    typedef Alloc                                       data_allocator;
     typedef dhsstl::allocator<T*>                       map_allocator;
     
     typedef typename allocator_type::value_type         value_type;
@@ -207,16 +237,20 @@ public:
     typedef pointer*                                    map_pointer;
     typedef const_pointer*                              const_map_pointer;
 
-    typedef deque_iterator<T, T&, T*>                   iterator;
-    typedef deque_iterator<T, const T&, const T*>       const_iterator;
+    typedef deque_iterator<T, T&, T*, BufSize>             iterator;
+    typedef deque_iterator<T, const T&, const T*, BufSize> const_iterator;
     typedef dhsstl::reverse_iterator<iterator>          reverse_iterator;
     typedef dhsstl::reverse_iterator<const_iterator>    const_reverse_iterator;
 
     allocator_type get_allocator() { return allocator_type(); }
 
-    static const size_type buffer_size = deque_buf_size<T>::value;
+    static const size_type buffer_size = deque_buf_size<T, BufSize>::value;
 
 private:
+    // 元素能否按字节搬移, 用于选择 insert / erase 时的搬移方式
+    typedef std::integral_constant<bool,
+        dhsstl::is_trivially_relocatable<T>::value>     is_relocatable;
+
     // 用以下四个数据来表现一个 deque
     // 注: map_ 不一定和 begin_.node的地址相同
     //     map_ 所指的内存块一定包含 bgein_ -> end_ , 但是首和尾不能保证没有空余
@@ -224,12 +258,14 @@ private:
     iterator        end_;           // 指向最后一个节点
     map_pointer     map_;           // 指向一块map, map中的每一个元素都是一个指针, 指向一个缓冲区
     size_type       map_size_;      // map 内指针的数目
+    pointer         spare_[DEQUE_SPARE_BLOCKS];  // 空闲缓冲区缓存
+    size_type       spare_count_ = 0;            // 空闲缓冲区的数目
 
 public:
     // 构造, 复制, 移动, 析构函数
 
     deque()
-    { fill_init(0, value_type()); }
+    { map_init(0); }
 
     explicit deque(size_type n)
     { fill_init(n, value_type()); }
@@ -278,6 +314,7 @@ public:
             map_allocator::deallocate(map_, map_size_);
             map_ = nullptr;
         }
+        release_spare();
     }
 
 public:
@@ -413,6 +450,12 @@ private:
     map_pointer     create_map(size_type size);
     void            create_buffer(map_pointer nstart, map_pointer nfinish);
     void            destroy_buffer(map_pointer nstart, map_pointer nfinish);
+
+    // spare block cache
+    pointer         allocate_buffer();
+    void            deallocate_buffer(pointer buffer) noexcept;
+    void            release_spare() noexcept;
+    void            trim_map() noexcept;
     
     // initialize
     void            map_init(size_type nelem);
@@ -432,6 +475,10 @@ private:
     // insert
     template <typename ...Args>
     iterator        insert_aux(iterator position, Args&& ...args);
+    template <typename ...Args>
+    iterator        insert_aux_dispatch(iterator position, std::true_type, Args&& ...args);
+    template <typename ...Args>
+    iterator        insert_aux_dispatch(iterator position, std::false_type, Args&& ...args);
     void            fill_insert(iterator position, size_type n, const value_type& x);
     template <typename FIter>
     void            copy_insert(iterator, FIter, FIter, size_type);
@@ -440,17 +487,22 @@ private:
     template <typename FIter>
     void            insert_dispatch(iterator, FIter, FIter, forward_iterator_tag);
 
+    // erase
+    iterator        erase_dispatch(iterator first, iterator last, std::true_type);
+    iterator        erase_dispatch(iterator first, iterator last, std::false_type);
+
     // reallocate
     void            require_capacity(size_type n, bool front);
     void            reallocate_map_at_front(size_type need);
     void            reallocate_map_at_back(size_type need);
+    void            recenter_map(size_type need, bool front);
 };
 
 // -----------------------------------------------------------------------------
 
 // 复制赋值运算符
-template <typename T>
-deque<T>& deque<T>::operator=(const deque& rhs){
+template <typename T, typename Alloc, size_t BufSize>
+deque<T, Alloc, BufSize>& deque<T, Alloc, BufSize>::operator=(const deque& rhs){
     if(this != &rhs){
         const auto len = size();
         if(len >= rhs.size()){
@@ -465,21 +517,17 @@ deque<T>& deque<T>::operator=(const deque& rhs){
 }
 
 // 移动赋值运算符
-template <typename T>
-deque<T>&   deque<T>::operator=(deque&& rhs){
-    clear();
-    begin_ = dhsstl::move(rhs.begin_);
-    end_ = dhsstl::move(rhs.end_);
-    map_ = rhs.map_;
-    map_size_ = rhs.map_size_;
-    rhs.map_ = nullptr;
-    rhs.map_size_ = 0;
+template <typename T, typename Alloc, size_t BufSize>
+deque<T, Alloc, BufSize>&   deque<T, Alloc, BufSize>::operator=(deque&& rhs){
+    // 原有的 map 和缓冲区交给 tmp 释放
+    deque tmp(dhsstl::move(rhs));
+    swap(tmp);
     return *this;
 }
 
 // 重置容器大小
-template <typename T>
-void deque<T>::resize(size_type new_size, const value_type& value){
+template <typename T, typename Alloc, size_t BufSize>
+void deque<T, Alloc, BufSize>::resize(size_type new_size, const value_type& value){
     const auto len = size();
     if(new_size < len){
         erase(begin_ + new_size, end_);
@@ -489,24 +537,18 @@ void deque<T>::resize(size_type new_size, const value_type& value){
 }
 
 // 减小容器容量
-template <typename T>
-void deque<T>::shrink_to_fit() noexcept{
-    // 注: map_ 没变, 只不过map_中的多余缓冲区全给删除了
+template <typename T, typename Alloc, size_t BufSize>
+void deque<T, Alloc, BufSize>::shrink_to_fit() noexcept{
+    // 注: map_ 没变, 只不过map_中的多余缓冲区以及空闲缓存全给删除了
     // 至少会留下头部缓冲区
-    for(auto cur = map_; cur < begin_.node; ++cur){
-        data_allocator::deallocate(*cur, buffer_size);
-        *cur = nullptr;
-    }
-    for(auto cur = end_.node + 1; cur < map_ + map_size_; ++cur){
-        data_allocator::deallocate(*cur, buffer_size);
-        *cur = nullptr;
-    }
+    trim_map();
+    release_spare();
 }
 
 // 在头部就地构建元素
-template <typename T>
+template <typename T, typename Alloc, size_t BufSize>
 template <typename ...Args>
-void deque<T>::emplace_front(Args&& ...args){
+void deque<T, Alloc, BufSize>::emplace_front(Args&& ...args){
     if(begin_.cur != begin_.first){
         data_allocator::construct(begin_.cur - 1, dhsstl::forward<Args>(args)...);
         --begin_.cur;
@@ -523,9 +565,9 @@ void deque<T>::emplace_front(Args&& ...args){
 }
 
 // 在尾部就地构建元素
-template <typename T>
+template <typename T, typename Alloc, size_t BufSize>
 template <typename ...Args>
-void deque<T>::emplace_back(Args&& ...args){
+void deque<T, Alloc, BufSize>::emplace_back(Args&& ...args){
     if(end_.cur != end_.last - 1){
         data_allocator::construct(end_.cur, dhsstl::forward<Args>(args)...);
         ++end_.cur;
@@ -537,9 +579,9 @@ void deque<T>::emplace_back(Args&& ...args){
 }
 
 // 在 pos 位置前就地构建元素, 返回这个元素所在位置的迭代器
-template <typename T>
+template <typename T, typename Alloc, size_t BufSize>
 template <typename ...Args>
-typename deque<T>::iterator deque<T>::emplace(iterator pos, Args&& ...args){
+typename deque<T, Alloc, BufSize>::iterator deque<T, Alloc, BufSize>::emplace(iterator pos, Args&& ...args){
     if(pos.cur == begin_.cur){
         emplace_front(dhsstl::forward<Args>(args)...);
         return begin_;
@@ -551,8 +593,8 @@ typename deque<T>::iterator deque<T>::emplace(iterator pos, Args&& ...args){
 }
 
 // 在头部插入元素
-template <typename T>
-void deque<T>::push_front(const value_type& value){
+template <typename T, typename Alloc, size_t BufSize>
+void deque<T, Alloc, BufSize>::push_front(const value_type& value){
     if(begin_.cur != begin_.first){
         data_allocator::construct(begin_.cur - 1, value);
         --begin_.cur;
@@ -569,8 +611,8 @@ void deque<T>::push_front(const value_type& value){
 }
 
 // 在尾部插入元素
-template <typename T>
-void deque<T>::push_back(const value_type& value){
+template <typename T, typename Alloc, size_t BufSize>
+void deque<T, Alloc, BufSize>::push_back(const value_type& value){
     if(end_.cur != end_.last -1){
         data_allocator::construct(end_.cur, value);
         ++end_.cur;
@@ -582,8 +624,8 @@ void deque<T>::push_back(const value_type& value){
 }
 
 // 弹出头部元素
-template <typename T>
-void deque<T>::pop_front(){
+template <typename T, typename Alloc, size_t BufSize>
+void deque<T, Alloc, BufSize>::pop_front(){
     DHSSTL_DEBUG(!empty());
     if(begin_.cur != begin_.last - 1){
         data_allocator::destroy(begin_.cur);
@@ -596,8 +638,8 @@ void deque<T>::pop_front(){
 }
 
 // 弹出尾部元素
-template <typename T>
-void deque<T>::pop_back(){
+template <typename T, typename Alloc, size_t BufSize>
+void deque<T, Alloc, BufSize>::pop_back(){
     DHSSTL_DEBUG(!empty());
     if(end_.cur != end_.first){
         --end_.cur;
@@ -610,9 +652,9 @@ void deque<T>::pop_back(){
 }
 
 // 在position处插入元素
-template <typename T>
-typename deque<T>::iterator
-deque<T>::insert(iterator position, const value_type& value){
+template <typename T, typename Alloc, size_t BufSize>
+typename deque<T, Alloc, BufSize>::iterator
+deque<T, Alloc, BufSize>::insert(iterator position, const value_type& value){
     if(position.cur == begin_.cur){
         push_front(value);
         return begin_;
@@ -626,9 +668,9 @@ deque<T>::insert(iterator position, const value_type& value){
     }
 }
 
-template <typename T>
-typename deque<T>::iterator
-deque<T>::insert(iterator position, value_type&& value){
+template <typename T, typename Alloc, size_t BufSize>
+typename deque<T, Alloc, BufSize>::iterator
+deque<T, Alloc, BufSize>::insert(iterator position, value_type&& value){
     if(position.cur == begin_.cur){
         emplace_front(dhsstl::move(value));
         return begin_;
@@ -643,8 +685,8 @@ deque<T>::insert(iterator position, value_type&& value){
 }
 
 // 在 position 位置处插入 n 个元素
-template <typename T>
-void deque<T>::insert(iterator position, size_type n, const value_type& value){
+template <typename T, typename Alloc, size_t BufSize>
+void deque<T, Alloc, BufSize>::insert(iterator position, size_type n, const value_type& value){
     if(position.cur == begin_.cur){
         require_capacity(n, true);
         auto new_begin = begin_ - n;
@@ -661,50 +703,29 @@ void deque<T>::insert(iterator position, size_type n, const value_type& value){
 }
 
 // 删除 position 处的元素
-template <typename T>
-typename deque<T>::iterator
-deque<T>::erase(iterator position){
+template <typename T, typename Alloc, size_t BufSize>
+typename deque<T, Alloc, BufSize>::iterator
+deque<T, Alloc, BufSize>::erase(iterator position){
     auto next = position;
     ++next;
-    const size_type elems_before = position - begin_;
-    if(elems_before < (size() / 2)){
-        dhsstl::copy_backward(begin_, position, next);
-        pop_front();
-    }else{
-        dhsstl::copy(next, end_, position);
-        pop_back();
-    }
-    return begin_ + elems_before;
+    return erase_dispatch(position, next, is_relocatable());
 }
 
 // 删除[first, last)上的元素
-template <typename T>
-typename deque<T>::iterator
-deque<T>::erase(iterator first, iterator last){
+template <typename T, typename Alloc, size_t BufSize>
+typename deque<T, Alloc, BufSize>::iterator
+deque<T, Alloc, BufSize>::erase(iterator first, iterator last){
     if(first == begin_ && last == end_){
         clear();
         return end_;
     }else{
-        const size_type len = last - first;
-        const size_type elems_before = first - begin_;
-        if(elems_before < (size() - len / 2)){
-            dhsstl::copy_backward(begin_, first, last);
-            auto new_begin = begin_ + len;
-            data_allocator::destroy(begin_.cur, new_begin.cur);
-            begin_ = new_begin;
-        }else{
-            dhsstl::copy(last, end_, first);
-            auto new_end = end_ - len;
-            data_allocator::destroy(new_end.cur, end_.cur);
-            end_ = new_end;
-        }
-        return begin_ + elems_before;
+        return erase_dispatch(first, last, is_relocatable());
     }
 }
 
 // 清空 deque
-template <typename T>
-void deque<T>::clear(){
+template <typename T, typename Alloc, size_t BufSize>
+void deque<T, Alloc, BufSize>::clear(){
     // clear 会保留头部的缓冲区
     for(map_pointer cur = begin_.node + 1; cur < end_.node; ++cur){
         data_allocator::destroy(*cur, *cur + buffer_size);
@@ -716,13 +737,13 @@ void deque<T>::clear(){
     }else{
         dhsstl::destroy(begin_.cur, end_.cur);
     }
-    shrink_to_fit();
     end_ = begin_;
+    trim_map();
 }
 
 // 交换两个deque
-template <typename T>
-void deque<T>::swap(deque& rhs)noexcept{
+template <typename T, typename Alloc, size_t BufSize>
+void deque<T, Alloc, BufSize>::swap(deque& rhs)noexcept{
     if(this != &rhs){
         dhsstl::swap(begin_, rhs.begin_);
         dhsstl::swap(end_, rhs.end_);
@@ -735,9 +756,9 @@ void deque<T>::swap(deque& rhs)noexcept{
 // helper function
 
 // create_map
-template <typename T>
-typename deque<T>::map_pointer
-deque<T>::create_map(size_type size){
+template <typename T, typename Alloc, size_t BufSize>
+typename deque<T, Alloc, BufSize>::map_pointer
+deque<T, Alloc, BufSize>::create_map(size_type size){
     map_pointer mp = nullptr;
     mp = map_allocator::allocate(size);
     for(size_type i = 0; i < size; ++i)
@@ -746,18 +767,20 @@ deque<T>::create_map(size_type size){
 }
 
 // create_buffer
-template <typename T>
-void deque<T>::
+template <typename T, typename Alloc, size_t BufSize>
+void deque<T, Alloc, BufSize>::
 create_buffer(map_pointer nstart, map_pointer nfinish){
     map_pointer cur;
     try{
         for(cur = nstart; cur <= nfinish; ++cur){
-            *cur = data_allocator::allocate(buffer_size);
+            // erase 之后 [begin_, end_) 之外可能还保留着缓冲区, 直接复用
+            if(*cur == nullptr)
+                *cur = allocate_buffer();
         }
     }catch(...){
         while(cur != nstart){
             --cur;
-            data_allocator::deallocate(*cur, buffer_size);
+            deallocate_buffer(*cur);
             *cur = nullptr;
         }
         throw;
@@ -765,18 +788,58 @@ create_buffer(map_pointer nstart, map_pointer nfinish){
 }
 
 // destroy_buffer函数
-template <typename T>
-void deque<T>::
+template <typename T, typename Alloc, size_t BufSize>
+void deque<T, Alloc, BufSize>::
 destroy_buffer(map_pointer nstart, map_pointer nfinish){
     for(map_pointer n = nstart; n <= nfinish; ++n){
-        data_allocator::deallocate(*n, buffer_size);
+        deallocate_buffer(*n);
         *n = nullptr;
     }
 }
 
+// allocate_buffer 函数, 优先从空闲缓存中取出缓冲区
+template <typename T, typename Alloc, size_t BufSize>
+typename deque<T, Alloc, BufSize>::pointer
+deque<T, Alloc, BufSize>::allocate_buffer(){
+    if(spare_count_ != 0)
+        return spare_[--spare_count_];
+    return data_allocator::allocate(buffer_size);
+}
+
+// deallocate_buffer 函数, 空闲缓存未满时放入缓存, 否则直接释放
+template <typename T, typename Alloc, size_t BufSize>
+void deque<T, Alloc, BufSize>::deallocate_buffer(pointer buffer) noexcept{
+    if(buffer == nullptr)
+        return;
+    if(spare_count_ < DEQUE_SPARE_BLOCKS)
+        spare_[spare_count_++] = buffer;
+    else
+        data_allocator::deallocate(buffer, buffer_size);
+}
+
+// release_spare 函数, 释放空闲缓存中的所有缓冲区
+template <typename T, typename Alloc, size_t BufSize>
+void deque<T, Alloc, BufSize>::release_spare() noexcept{
+    while(spare_count_ != 0)
+        data_allocator::deallocate(spare_[--spare_count_], buffer_size);
+}
+
+// trim_map 函数, 把 map 中 [begin_.node, end_.node] 之外的缓冲区交还给空闲缓存
+template <typename T, typename Alloc, size_t BufSize>
+void deque<T, Alloc, BufSize>::trim_map() noexcept{
+    for(auto cur = map_; cur < begin_.node; ++cur){
+        deallocate_buffer(*cur);
+        *cur = nullptr;
+    }
+    for(auto cur = end_.node + 1; cur < map_ + map_size_; ++cur){
+        deallocate_buffer(*cur);
+        *cur = nullptr;
+    }
+}
+
 // map_init函数
-template <typename T>
-void deque<T>::
+template <typename T, typename Alloc, size_t BufSize>
+void deque<T, Alloc, BufSize>::
 map_init(size_type nElem){
     const size_type nNode = nElem / buffer_size + 1;    //  需要分配的缓冲区的个数
     map_size_ = dhsstl::max(static_cast<size_type>(DEQUE_MAP_INIT_SIZE), nNode + 2);
@@ -808,8 +871,8 @@ map_init(size_type nElem){
 
 
 // fill_init()
-template <typename T>
-void deque<T>::
+template <typename T, typename Alloc, size_t BufSize>
+void deque<T, Alloc, BufSize>::
 fill_init(size_type n, const value_type& value){
     map_init(n);
     if(n != 0){
@@ -821,9 +884,9 @@ fill_init(size_type n, const value_type& value){
 }
 
 // copy_init()
-template <typename T>
+template <typename T, typename Alloc, size_t BufSize>
 template <typename IIter>
-void deque<T>::
+void deque<T, Alloc, BufSize>::
 copy_init(IIter first, IIter last, input_iterator_tag){
      const size_type n = dhsstl::distance(first, last);
     map_init(n);
@@ -831,9 +894,9 @@ copy_init(IIter first, IIter last, input_iterator_tag){
         emplace_back(*first);
 }
 
-template <typename T>
+template <typename T, typename Alloc, size_t BufSize>
 template <typename FIter>
-void deque<T>::
+void deque<T, Alloc, BufSize>::
 copy_init(FIter first, FIter last, forward_iterator_tag){
     const size_type n = dhsstl::distance(first, last);
     map_init(n);
@@ -847,8 +910,8 @@ copy_init(FIter first, FIter last, forward_iterator_tag){
 }
 
 // fill_assign 函数
-template <typename T>
-void deque<T>::
+template <typename T, typename Alloc, size_t BufSize>
+void deque<T, Alloc, BufSize>::
 fill_assign(size_type n, const value_type& value){
     if(n > size()){
         dhsstl::fill(begin(), end(), value);
@@ -860,9 +923,9 @@ fill_assign(size_type n, const value_type& value){
 }
 
 // copy_assgin 函数
-template <typename T>
+template <typename T, typename Alloc, size_t BufSize>
 template <typename IIter>
-void deque<T>::
+void deque<T, Alloc, BufSize>::
 copy_assign(IIter first, IIter last, input_iterator_tag){
     auto first1 = begin();
     auto last1 = end();
@@ -876,9 +939,9 @@ copy_assign(IIter first, IIter last, input_iterator_tag){
     }
 }
 
-template <typename T>
+template <typename T, typename Alloc, size_t BufSize>
 template <typename FIter>
-void deque<T>::
+void deque<T, Alloc, BufSize>::
 copy_assign(FIter first, FIter last, forward_iterator_tag)
 {
   const size_type len1 = size();
@@ -897,11 +960,56 @@ copy_assign(FIter first, FIter last, forward_iterator_tag)
 }
 
 // insert_aux 函数
-template <typename T>
+template <typename T, typename Alloc, size_t BufSize>
 template <typename ...Args>
-typename deque<T>::iterator
-deque<T>::
+typename deque<T, Alloc, BufSize>::iterator
+deque<T, Alloc, BufSize>::
 insert_aux(iterator position, Args&& ...args){
+    return insert_aux_dispatch(position, is_relocatable(), dhsstl::forward<Args>(args)...);
+}
+
+// trivially relocatable 版本: 先在临时空间构造新元素, 把较短的一侧按字节挪开一位, 再把新元素搬进来
+template <typename T, typename Alloc, size_t BufSize>
+template <typename ...Args>
+typename deque<T, Alloc, BufSize>::iterator
+deque<T, Alloc, BufSize>::
+insert_aux_dispatch(iterator position, std::true_type, Args&& ...args){
+    const size_type elems_before = position - begin_;
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type buf;
+    auto tmp = reinterpret_cast<pointer>(&buf);
+    data_allocator::construct(tmp, dhsstl::forward<Args>(args)...);
+    if(elems_before < (size() / 2)){
+        try{
+            require_capacity(1, true);
+        }catch(...){
+            data_allocator::destroy(tmp);
+            throw;
+        }
+        // require_capacity 之后原来的迭代器可能会失效
+        auto new_begin = begin_ - 1;
+        position = dhsstl::uninitialized_relocate(begin_, begin_ + elems_before, new_begin);
+        begin_ = new_begin;
+    }else{
+        try{
+            require_capacity(1, false);
+        }catch(...){
+            data_allocator::destroy(tmp);
+            throw;
+        }
+        position = begin_ + elems_before;
+        auto new_end = end_ + 1;
+        dhsstl::uninitialized_relocate_backward(position, end_, new_end);
+        end_ = new_end;
+    }
+    dhsstl::uninitialized_relocate(tmp, tmp + 1, position);
+    return position;
+}
+
+template <typename T, typename Alloc, size_t BufSize>
+template <typename ...Args>
+typename deque<T, Alloc, BufSize>::iterator
+deque<T, Alloc, BufSize>::
+insert_aux_dispatch(iterator position, std::false_type, Args&& ...args){
     const size_type elems_before = position - begin_;
     value_type value_copy = value_type(dhsstl::forward<Args>(args)...);
     if(elems_before < (size() / 2)){
@@ -930,8 +1038,8 @@ insert_aux(iterator position, Args&& ...args){
 }
 
 // fill_insert函数
-template <typename T>
-void deque<T>::
+template <typename T, typename Alloc, size_t BufSize>
+void deque<T, Alloc, BufSize>::
 fill_insert(iterator position, size_type n, const value_type& value){
     const size_type elems_before = position - begin_;
     const size_type len = size();
@@ -994,9 +1102,9 @@ fill_insert(iterator position, size_type n, const value_type& value){
 }
         
 // copy_insert()
-template <typename T>
+template <typename T, typename Alloc, size_t BufSize>
 template <typename FIter>
-void deque<T>::
+void deque<T, Alloc, BufSize>::
 copy_insert(iterator position, FIter first, FIter last, size_type n){
     const size_type elems_before = position - begin_;
     auto len = size();
@@ -1056,10 +1164,47 @@ copy_insert(iterator position, FIter first, FIter last, size_type n){
     }
 }
 
+// erase_dispatch 函数
+// trivially relocatable 版本: 析构被删除的元素, 再把较短的一侧按字节搬过来填补空位
+template <typename T, typename Alloc, size_t BufSize>
+typename deque<T, Alloc, BufSize>::iterator
+deque<T, Alloc, BufSize>::
+erase_dispatch(iterator first, iterator last, std::true_type){
+    const size_type len = last - first;
+    const size_type elems_before = first - begin_;
+    dhsstl::destroy(first, last);
+    if(elems_before < (size() - len) / 2){
+        begin_ = dhsstl::uninitialized_relocate_backward(begin_, first, last);
+    }else{
+        end_ = dhsstl::uninitialized_relocate(last, end_, first);
+    }
+    return begin_ + elems_before;
+}
+
+template <typename T, typename Alloc, size_t BufSize>
+typename deque<T, Alloc, BufSize>::iterator
+deque<T, Alloc, BufSize>::
+erase_dispatch(iterator first, iterator last, std::false_type){
+    const size_type len = last - first;
+    const size_type elems_before = first - begin_;
+    if(elems_before < (size() - len) / 2){
+        dhsstl::copy_backward(begin_, first, last);
+        auto new_begin = begin_ + len;
+        dhsstl::destroy(begin_, new_begin);
+        begin_ = new_begin;
+    }else{
+        dhsstl::copy(last, end_, first);
+        auto new_end = end_ - len;
+        dhsstl::destroy(new_end, end_);
+        end_ = new_end;
+    }
+    return begin_ + elems_before;
+}
+
 // insert_dispatch 函数
-template <typename T>
+template <typename T, typename Alloc, size_t BufSize>
 template <typename IIter>
-void deque<T>::
+void deque<T, Alloc, BufSize>::
 insert_dispatch(iterator position, IIter first, IIter last, input_iterator_tag){
     if(last <= first) return;
     const size_type n = dhsstl::distance(first, last);
@@ -1078,9 +1223,9 @@ insert_dispatch(iterator position, IIter first, IIter last, input_iterator_tag){
     }
 }
 
-template <typename T>
+template <typename T, typename Alloc, size_t BufSize>
 template <typename FIter>
-void deque<T>::
+void deque<T, Alloc, BufSize>::
 insert_dispatch(iterator position, FIter first, FIter last, forward_iterator_tag){
     if(last <= first) return;
     const size_type n = dhsstl::distance(first, last);
@@ -1112,8 +1257,8 @@ insert_dispatch(iterator position, FIter first, FIter last, forward_iterator_tag
 }
 
 // require_capacity 函数
-template <typename T>
-void deque<T>::require_capacity(size_type n, bool front){
+template <typename T, typename Alloc, size_t BufSize>
+void deque<T, Alloc, BufSize>::require_capacity(size_type n, bool front){
     if(front && (static_cast<size_type>(begin_.cur - begin_.first) < n)){
         const size_type need_buffer = (n - (begin_.cur - begin_.first)) / buffer_size + 1;
         if(need_buffer > static_cast<size_type>(begin_.node - map_)){
@@ -1132,8 +1277,15 @@ void deque<T>::require_capacity(size_type n, bool front){
 }
 
 // reallocate_map_at_front()
-template <typename T>
-void deque<T>::reallocate_map_at_front(size_type need_buffer){
+template <typename T, typename Alloc, size_t BufSize>
+void deque<T, Alloc, BufSize>::reallocate_map_at_front(size_type need_buffer){
+    // 旧 map 中 [begin_.node, end_.node] 之外的缓冲区不会被搬到新 map, 先交还给空闲缓存
+    trim_map();
+    if(map_size_ > 2 * (end_.node - begin_.node + 1 + need_buffer)){
+        // map 还很空, 只是偏向了一侧(比如作为 FIFO 使用), 在原 map 内重新居中即可
+        recenter_map(need_buffer, true);
+        return;
+    }
     const size_type new_map_size = dhsstl::max(
         map_size_ << 1,
         map_size_ + need_buffer + DEQUE_MAP_INIT_SIZE
@@ -1160,8 +1312,14 @@ void deque<T>::reallocate_map_at_front(size_type need_buffer){
 }
 
 // reallocate_map_at_back()
-template <typename T>
-void deque<T>::reallocate_map_at_back(size_type need_buffer){
+template <typename T, typename Alloc, size_t BufSize>
+void deque<T, Alloc, BufSize>::reallocate_map_at_back(size_type need_buffer){
+    // 旧 map 中 [begin_.node, end_.node] 之外的缓冲区不会被搬到新 map, 先交还给空闲缓存
+    trim_map();
+    if(map_size_ > 2 * (end_.node - begin_.node + 1 + need_buffer)){
+        recenter_map(need_buffer, false);
+        return;
+    }
     const size_type new_map_size = dhsstl::max(
         map_size_ << 1,
         map_size_ + need_buffer + DEQUE_MAP_INIT_SIZE
@@ -1187,35 +1345,57 @@ void deque<T>::reallocate_map_at_back(size_type need_buffer){
     end_   = iterator(*(mid - 1) + (end_.cur - end_.first), mid - 1);
 }
 
+// recenter_map()
+// 在原 map 内把 [begin_.node, end_.node] 搬到中间, 并在 front 指定的一侧开辟 need_buffer 个缓冲区
+// 注: 调用前 [begin_.node, end_.node] 之外的槽位必须都为 nullptr
+template <typename T, typename Alloc, size_t BufSize>
+void deque<T, Alloc, BufSize>::recenter_map(size_type need_buffer, bool front){
+    const size_type old_buffer = end_.node - begin_.node + 1;
+    const size_type new_buffer = old_buffer + need_buffer;
+    auto begin = map_ + (map_size_ - new_buffer) / 2 + (front ? need_buffer : 0);
+    std::memmove(static_cast<void*>(begin), static_cast<const void*>(begin_.node),
+                 old_buffer * sizeof(pointer));
+    for(auto cur = map_; cur < begin; ++cur)
+        *cur = nullptr;
+    for(auto cur = begin + old_buffer; cur < map_ + map_size_; ++cur)
+        *cur = nullptr;
+    begin_ = iterator(*begin + (begin_.cur - begin_.first), begin);
+    end_ = iterator(*(begin + old_buffer - 1) + (end_.cur - end_.first), begin + old_buffer - 1);
+    if(front)
+        create_buffer(begin - need_buffer, begin - 1);
+    else
+        create_buffer(begin + old_buffer, begin + new_buffer - 1);
+}
+
 // 重载操作符
-template <typename T>
-bool operator==(const deque<T>& lhs, const deque<T>& rhs){
+template <typename T, typename Alloc, size_t BufSize>
+bool operator==(const deque<T, Alloc, BufSize>& lhs, const deque<T, Alloc, BufSize>& rhs){
     return lhs.size() == rhs.size() &&
         dhsstl::equal(lhs.begin(), lhs.end(), rhs.begin());
 }
 
-template <typename T>
-bool operator<(const deque<T>& lhs, const deque<T>& rhs){
+template <typename T, typename Alloc, size_t BufSize>
+bool operator<(const deque<T, Alloc, BufSize>& lhs, const deque<T, Alloc, BufSize>& rhs){
     return dhsstl::lexicograhical_compare(
         lhs.begin(), lhs.end(), rhs.begin(), rhs.end()
     );
 }
 
-template <typename T>
-bool operator!=(const deque<T>& lhs, const deque<T>& rhs) { return !(lhs == rhs); }
+template <typename T, typename Alloc, size_t BufSize>
+bool operator!=(const deque<T, Alloc, BufSize>& lhs, const deque<T, Alloc, BufSize>& rhs) { return !(lhs == rhs); }
 
-template <typename T>
-bool operator>(const deque<T>& lhs, const deque<T>& rhs) { return rhs < lhs; }
+template <typename T, typename Alloc, size_t BufSize>
+bool operator>(const deque<T, Alloc, BufSize>& lhs, const deque<T, Alloc, BufSize>& rhs) { return rhs < lhs; }
 
-template <typename T>
-bool operator<=(const deque<T>& lhs, const deque<T>& rhs) { return !(rhs < lhs); }
+template <typename T, typename Alloc, size_t BufSize>
+bool operator<=(const deque<T, Alloc, BufSize>& lhs, const deque<T, Alloc, BufSize>& rhs) { return !(rhs < lhs); }
 
-template <typename T>
-bool operator>=(const deque<T>& lhs, const deque<T>& rhs) { return !(lhs < rhs); }
+template <typename T, typename Alloc, size_t BufSize>
+bool operator>=(const deque<T, Alloc, BufSize>& lhs, const deque<T, Alloc, BufSize>& rhs) { return !(lhs < rhs); }
 
 // 重载 dhsstl 的 swap
-template <typename T>
-void swap(deque<T>& lhs, deque<T>& rhs) { lhs.swap(rhs); }
+template <typename T, typename Alloc, size_t BufSize>
+void swap(deque<T, Alloc, BufSize>& lhs, deque<T, Alloc, BufSize>& rhs) { lhs.swap(rhs); }
 
 } // namespace dhsstl
 #endif // DHSTINYSTL_DEQUE_H_
\ No newline at end of file
@@ -0,0 +1,604 @@
+#ifndef DHSTINYSTL_EXECUTION_H_
+#define DHSTINYSTL_EXECUTION_H_
+
+// 这个头文件包含执行策略 dhsstl::execution::seq / par / par_unseq, 以及带执行策略的算法重载:
+//      copy, move, fill, equal, mismatch, reverse, transform, reduce, sort, radix_sort
+//
+// seq       : 直接调用串行版本
+// par       : 把区间切成若干连续的块, 在 default_thread_pool()(或者 par.on(pool) 指定的线程池)上并行处理,
+//             每块内部调用串行版本
+//             块数约为线程数的 4 倍, 每块至少 DHSSTL_PARALLEL_GRAIN 个元素, 元素太少时直接串行执行
+// par_unseq : 与 par 相同, 块内部的串行版本本身已经可以被向量化(memmove / memset / 简单循环)
+//
+// 注: 并行版本要求迭代器是随机访问迭代器, 否则退化为串行版本
+//     与标准库不同, 块中抛出的异常会在所有块结束之后重新抛出, 而不是调用 std::terminate
+
+#include <atomic>
+#include <type_traits>
+
+#include "algo.h"
+#include "algobase.h"
+#include "iterator.h"
+#include "numeric.h"
+#include "radix_sort.h"
+#include "thread_pool.h"
+#include "vector.h"
+
+// 每块最少的元素个数
+#ifndef DHSSTL_PARALLEL_GRAIN
+#define DHSSTL_PARALLEL_GRAIN 16384
+#endif
+
+namespace dhsstl
+{
+namespace execution
+{
+
+struct sequenced_policy {};
+
+// par / par_unseq 默认使用 default_thread_pool(), 可以用 on 指定其他的线程池, 例如:
+//      dhsstl::thread_pool pool(4);
+//      dhsstl::fill(dhsstl::execution::par.on(pool), v.begin(), v.end(), 0);
+struct parallel_policy
+{
+    thread_pool* pool = nullptr;
+
+    parallel_policy on(thread_pool& p) const noexcept { parallel_policy r(*this); r.pool = &p; return r; }
+};
+
+struct parallel_unsequenced_policy
+{
+    thread_pool* pool = nullptr;
+
+    parallel_unsequenced_policy on(thread_pool& p) const noexcept{
+        parallel_unsequenced_policy r(*this);
+        r.pool = &p;
+        return r;
+    }
+};
+
+constexpr sequenced_policy             seq{};
+constexpr parallel_policy              par{};
+constexpr parallel_unsequenced_policy  par_unseq{};
+
+} // namespace execution
+
+template <typename T>
+struct is_execution_policy : public std::false_type {};
+
+template <> struct is_execution_policy<execution::sequenced_policy> : public std::true_type {};
+template <> struct is_execution_policy<execution::parallel_policy> : public std::true_type {};
+template <> struct is_execution_policy<execution::parallel_unsequenced_policy> : public std::true_type {};
+
+namespace detail
+{
+
+// 策略是否要求并行执行
+template <typename Policy>
+struct is_parallel_policy
+    : public std::integral_constant<bool,
+        !std::is_same<typename std::decay<Policy>::type, execution::sequenced_policy>::value> {};
+
+// 用于重载决议: 只有第一个参数是执行策略时才匹配
+template <typename Policy, typename R>
+using enable_if_policy_t =
+    typename std::enable_if<is_execution_policy<typename std::decay<Policy>::type>::value, R>::type;
+
+// 所有迭代器都是随机访问迭代器
+template <typename... Iters>
+struct all_random_access;
+
+template <>
+struct all_random_access<> : public std::true_type {};
+
+template <typename Iter, typename... Iters>
+struct all_random_access<Iter, Iters...>
+    : public std::integral_constant<bool,
+        std::is_pointer<Iter>::value ? all_random_access<Iters...>::value :
+        (is_random_access_iterator<Iter>::value && all_random_access<Iters...>::value)> {};
+
+template <typename Policy, typename... Iters>
+struct use_parallel
+    : public std::integral_constant<bool,
+        is_parallel_policy<Policy>::value && all_random_access<Iters...>::value> {};
+
+// 策略对应的线程池
+inline thread_pool& pool_of(const execution::parallel_policy& policy){
+    return policy.pool != nullptr ? *policy.pool : default_thread_pool();
+}
+inline thread_pool& pool_of(const execution::parallel_unsequenced_policy& policy){
+    return policy.pool != nullptr ? *policy.pool : default_thread_pool();
+}
+
+// n 个元素分成的块数, 为 1 时调用方应当直接串行执行
+inline size_t chunk_count(size_t n, thread_pool& pool){
+    const size_t grain = DHSSTL_PARALLEL_GRAIN;
+    if(pool.size() <= 1 || n < 2 * grain)
+        return 1;
+    return dhsstl::min(n / grain, pool.size() * 4);
+}
+
+// 把 [0, n) 均匀地分成 chunks 块, 对第 i 块 [lo, hi) 调用 f(i, lo, hi)
+template <typename F>
+void for_each_chunk(thread_pool& pool, size_t n, size_t chunks, F&& f){
+    pool.parallel_for(size_t(0), chunks, size_t(1), [&](size_t cfirst, size_t clast){
+        for(size_t i = cfirst; i < clast; ++i)
+            f(i, n * i / chunks, n * (i + 1) / chunks);
+    });
+}
+
+} // namespace detail
+
+// ---------------------------------------------------
+// copy / move
+// ---------------------------------------------------
+template <typename Policy, typename RandomIter, typename OutputIter>
+OutputIter copy_par(const Policy& policy, RandomIter first, RandomIter last, OutputIter result, std::true_type){
+    thread_pool& pool = detail::pool_of(policy);
+    const size_t n = static_cast<size_t>(last - first);
+    const size_t chunks = detail::chunk_count(n, pool);
+    if(chunks == 1)
+        return dhsstl::copy(first, last, result);
+    detail::for_each_chunk(pool, n, chunks, [&](size_t, size_t lo, size_t hi){
+        dhsstl::copy(first + lo, first + hi, result + lo);
+    });
+    return result + n;
+}
+
+template <typename Policy, typename InputIter, typename OutputIter>
+OutputIter copy_par(const Policy&, InputIter first, InputIter last, OutputIter result, std::false_type){
+    return dhsstl::copy(first, last, result);
+}
+
+template <typename Policy, typename InputIter, typename OutputIter>
+detail::enable_if_policy_t<Policy, OutputIter>
+copy(Policy&& policy, InputIter first, InputIter last, OutputIter result){
+    return dhsstl::copy_par(policy, first, last, result,
+                            detail::use_parallel<Policy, InputIter, OutputIter>{});
+}
+
+template <typename Policy, typename RandomIter, typename OutputIter>
+OutputIter move_par(const Policy& policy, RandomIter first, RandomIter last, OutputIter result, std::true_type){
+    thread_pool& pool = detail::pool_of(policy);
+    const size_t n = static_cast<size_t>(last - first);
+    const size_t chunks = detail::chunk_count(n, pool);
+    if(chunks == 1)
+        return dhsstl::move(first, last, result);
+    detail::for_each_chunk(pool, n, chunks, [&](size_t, size_t lo, size_t hi){
+        dhsstl::move(first + lo, first + hi, result + lo);
+    });
+    return result + n;
+}
+
+template <typename Policy, typename InputIter, typename OutputIter>
+OutputIter move_par(const Policy&, InputIter first, InputIter last, OutputIter result, std::false_type){
+    return dhsstl::move(first, last, result);
+}
+
+template <typename Policy, typename InputIter, typename OutputIter>
+detail::enable_if_policy_t<Policy, OutputIter>
+move(Policy&& policy, InputIter first, InputIter last, OutputIter result){
+    return dhsstl::move_par(policy, first, last, result,
+                            detail::use_parallel<Policy, InputIter, OutputIter>{});
+}
+
+// ---------------------------------------------------
+// fill
+// ---------------------------------------------------
+template <typename Policy, typename RandomIter, typename T>
+void fill_par(const Policy& policy, RandomIter first, RandomIter last, const T& value, std::true_type){
+    thread_pool& pool = detail::pool_of(policy);
+    const size_t n = static_cast<size_t>(last - first);
+    const size_t chunks = detail::chunk_count(n, pool);
+    if(chunks == 1)
+        return dhsstl::fill(first, last, value);
+    detail::for_each_chunk(pool, n, chunks, [&](size_t, size_t lo, size_t hi){
+        dhsstl::fill(first + lo, first + hi, value);
+    });
+}
+
+template <typename Policy, typename ForwardIter, typename T>
+void fill_par(const Policy&, ForwardIter first, ForwardIter last, const T& value, std::false_type){
+    dhsstl::fill(first, last, value);
+}
+
+template <typename Policy, typename ForwardIter, typename T>
+detail::enable_if_policy_t<Policy, void>
+fill(Policy&& policy, ForwardIter first, ForwardIter last, const T& value){
+    dhsstl::fill_par(policy, first, last, value, detail::use_parallel<Policy, ForwardIter>{});
+}
+
+// ---------------------------------------------------
+// mismatch / equal
+// mismatch 记录已经找到的最小失配位置, 位于它之后的块不再比较
+// ---------------------------------------------------
+template <typename Policy, typename RandomIter1, typename RandomIter2, typename Compared>
+dhsstl::pair<RandomIter1, RandomIter2>
+mismatch_par(const Policy& policy, RandomIter1 first1, RandomIter1 last1, RandomIter2 first2, Compared comp,
+             std::true_type){
+    thread_pool& pool = detail::pool_of(policy);
+    const size_t n = static_cast<size_t>(last1 - first1);
+    const size_t chunks = detail::chunk_count(n, pool);
+    if(chunks == 1)
+        return dhsstl::mismatch(first1, last1, first2, comp);
+    std::atomic<size_t> found(n);
+    detail::for_each_chunk(pool, n, chunks, [&](size_t, size_t lo, size_t hi){
+        if(lo >= found.load(std::memory_order_relaxed))
+            return;
+        const auto r = dhsstl::mismatch(first1 + lo, first1 + hi, first2 + lo, comp);
+        if(r.first == first1 + hi)
+            return;
+        const size_t pos = static_cast<size_t>(r.first - first1);
+        size_t cur = found.load(std::memory_order_relaxed);
+        while(pos < cur && !found.compare_exchange_weak(cur, pos, std::memory_order_relaxed)){}
+    });
+    const size_t pos = found.load(std::memory_order_relaxed);
+    return dhsstl::pair<RandomIter1, RandomIter2>(first1 + pos, first2 + pos);
+}
+
+template <typename Policy, typename InputIter1, typename InputIter2, typename Compared>
+dhsstl::pair<InputIter1, InputIter2>
+mismatch_par(const Policy&, InputIter1 first1, InputIter1 last1, InputIter2 first2, Compared comp,
+             std::false_type){
+    return dhsstl::mismatch(first1, last1, first2, comp);
+}
+
+template <typename Policy, typename InputIter1, typename InputIter2, typename Compared>
+detail::enable_if_policy_t<Policy, dhsstl::pair<InputIter1, InputIter2>>
+mismatch(Policy&& policy, InputIter1 first1, InputIter1 last1, InputIter2 first2, Compared comp){
+    return dhsstl::mismatch_par(policy, first1, last1, first2, comp,
+                                detail::use_parallel<Policy, InputIter1, InputIter2>{});
+}
+
+template <typename Policy, typename InputIter1, typename InputIter2>
+detail::enable_if_policy_t<Policy, dhsstl::pair<InputIter1, InputIter2>>
+mismatch(Policy&& policy, InputIter1 first1, InputIter1 last1, InputIter2 first2){
+    return dhsstl::mismatch(dhsstl::forward<Policy>(policy), first1, last1, first2,
+                            dhsstl::equal_to<typename iterator_traits<InputIter1>::value_type>());
+}
+
+// equal 任意一块不相等时, 其他的块直接返回
+template <typename Policy, typename RandomIter1, typename RandomIter2>
+bool equal_par(const Policy& policy, RandomIter1 first1, RandomIter1 last1, RandomIter2 first2, std::true_type){
+    thread_pool& pool = detail::pool_of(policy);
+    const size_t n = static_cast<size_t>(last1 - first1);
+    const size_t chunks = detail::chunk_count(n, pool);
+    if(chunks == 1)
+        return dhsstl::equal(first1, last1, first2);
+    std::atomic<bool> differ(false);
+    detail::for_each_chunk(pool, n, chunks, [&](size_t, size_t lo, size_t hi){
+        if(differ.load(std::memory_order_relaxed))
+            return;
+        if(!dhsstl::equal(first1 + lo, first1 + hi, first2 + lo))
+            differ.store(true, std::memory_order_relaxed);
+    });
+    return !differ.load(std::memory_order_relaxed);
+}
+
+template <typename Policy, typename InputIter1, typename InputIter2>
+bool equal_par(const Policy&, InputIter1 first1, InputIter1 last1, InputIter2 first2, std::false_type){
+    return dhsstl::equal(first1, last1, first2);
+}
+
+template <typename Policy, typename InputIter1, typename InputIter2>
+detail::enable_if_policy_t<Policy, bool>
+equal(Policy&& policy, InputIter1 first1, InputIter1 last1, InputIter2 first2){
+    return dhsstl::equal_par(policy, first1, last1, first2,
+                             detail::use_parallel<Policy, InputIter1, InputIter2>{});
+}
+
+// ---------------------------------------------------
+// reverse
+// 把前一半 [0, n / 2) 分块, 每块与对称位置的元素交换
+// ---------------------------------------------------
+template <typename Policy, typename RandomIter>
+void reverse_par(const Policy& policy, RandomIter first, RandomIter last, std::true_type){
+    thread_pool& pool = detail::pool_of(policy);
+    const size_t half = static_cast<size_t>(last - first) / 2;
+    const size_t chunks = detail::chunk_count(half, pool);
+    if(chunks == 1)
+        return dhsstl::reverse(first, last);
+    detail::for_each_chunk(pool, half, chunks, [&](size_t, size_t lo, size_t hi){
+        RandomIter l = first + lo;
+        RandomIter r = last - lo;
+        for(size_t i = lo; i < hi; ++i)
+            dhsstl::iter_swap(l++, --r);
+    });
+}
+
+template <typename Policy, typename BidirectionalIter>
+void reverse_par(const Policy&, BidirectionalIter first, BidirectionalIter last, std::false_type){
+    dhsstl::reverse(first, last);
+}
+
+template <typename Policy, typename BidirectionalIter>
+detail::enable_if_policy_t<Policy, void>
+reverse(Policy&& policy, BidirectionalIter first, BidirectionalIter last){
+    dhsstl::reverse_par(policy, first, last, detail::use_parallel<Policy, BidirectionalIter>{});
+}
+
+// ---------------------------------------------------
+// transform
+// ---------------------------------------------------
+template <typename Policy, typename RandomIter, typename OutputIter, typename UnaryOperation>
+OutputIter transform_par(const Policy& policy, RandomIter first, RandomIter last, OutputIter result,
+                         UnaryOperation unary_op, std::true_type){
+    thread_pool& pool = detail::pool_of(policy);
+    const size_t n = static_cast<size_t>(last - first);
+    const size_t chunks = detail::chunk_count(n, pool);
+    if(chunks == 1)
+        return dhsstl::transform(first, last, result, unary_op);
+    detail::for_each_chunk(pool, n, chunks, [&](size_t, size_t lo, size_t hi){
+        dhsstl::transform(first + lo, first + hi, result + lo, unary_op);
+    });
+    return result + n;
+}
+
+template <typename Policy, typename InputIter, typename OutputIter, typename UnaryOperation>
+OutputIter transform_par(const Policy&, InputIter first, InputIter last, OutputIter result,
+                         UnaryOperation unary_op, std::false_type){
+    return dhsstl::transform(first, last, result, unary_op);
+}
+
+template <typename Policy, typename InputIter, typename OutputIter, typename UnaryOperation>
+detail::enable_if_policy_t<Policy, OutputIter>
+transform(Policy&& policy, InputIter first, InputIter last, OutputIter result, UnaryOperation unary_op){
+    return dhsstl::transform_par(policy, first, last, result, unary_op,
+                                 detail::use_parallel<Policy, InputIter, OutputIter>{});
+}
+
+template <typename Policy, typename RandomIter1, typename RandomIter2, typename OutputIter,
+          typename BinaryOperation>
+OutputIter transform_par(const Policy& policy, RandomIter1 first1, RandomIter1 last1, RandomIter2 first2,
+                         OutputIter result, BinaryOperation binary_op, std::true_type){
+    thread_pool& pool = detail::pool_of(policy);
+    const size_t n = static_cast<size_t>(last1 - first1);
+    const size_t chunks = detail::chunk_count(n, pool);
+    if(chunks == 1)
+        return dhsstl::transform(first1, last1, first2, result, binary_op);
+    detail::for_each_chunk(pool, n, chunks, [&](size_t, size_t lo, size_t hi){
+        dhsstl::transform(first1 + lo, first1 + hi, first2 + lo, result + lo, binary_op);
+    });
+    return result + n;
+}
+
+template <typename Policy, typename InputIter1, typename InputIter2, typename OutputIter,
+          typename BinaryOperation>
+OutputIter transform_par(const Policy&, InputIter1 first1, InputIter1 last1, InputIter2 first2,
+                         OutputIter result, BinaryOperation binary_op, std::false_type){
+    return dhsstl::transform(first1, last1, first2, result, binary_op);
+}
+
+template <typename Policy, typename InputIter1, typename InputIter2, typename OutputIter,
+          typename BinaryOperation>
+detail::enable_if_policy_t<Policy, OutputIter>
+transform(Policy&& policy, InputIter1 first1, InputIter1 last1, InputIter2 first2, OutputIter result,
+          BinaryOperation binary_op){
+    return dhsstl::transform_par(policy, first1, last1, first2, result, binary_op,
+                                 detail::use_parallel<Policy, InputIter1, InputIter2, OutputIter>{});
+}
+
+// ---------------------------------------------------
+// reduce
+// 每块得到一个局部结果, 再按块的顺序依次合并
+// ---------------------------------------------------
+template <typename Policy, typename RandomIter, typename T, typename BinaryOp>
+T reduce_par(const Policy& policy, RandomIter first, RandomIter last, T init, BinaryOp binary_op, std::true_type){
+    thread_pool& pool = detail::pool_of(policy);
+    const size_t n = static_cast<size_t>(last - first);
+    const size_t chunks = detail::chunk_count(n, pool);
+    if(chunks == 1)
+        return dhsstl::reduce(first, last, dhsstl::move(init), binary_op);
+    // 每块至少有 DHSSTL_PARALLEL_GRAIN 个元素, 用第一个元素作为局部结果的初值
+    dhsstl::vector<T> partial(chunks, init);
+    detail::for_each_chunk(pool, n, chunks, [&](size_t i, size_t lo, size_t hi){
+        partial[i] = dhsstl::reduce(first + lo + 1, first + hi, T(first[lo]), binary_op);
+    });
+    for(size_t i = 0; i < chunks; ++i)
+        init = binary_op(dhsstl::move(init), dhsstl::move(partial[i]));
+    return init;
+}
+
+template <typename Policy, typename InputIter, typename T, typename BinaryOp>
+T reduce_par(const Policy&, InputIter first, InputIter last, T init, BinaryOp binary_op, std::false_type){
+    return dhsstl::reduce(first, last, dhsstl::move(init), binary_op);
+}
+
+template <typename Policy, typename InputIter, typename T, typename BinaryOp>
+detail::enable_if_policy_t<Policy, T>
+reduce(Policy&& policy, InputIter first, InputIter last, T init, BinaryOp binary_op){
+    return dhsstl::reduce_par(policy, first, last, dhsstl::move(init), binary_op,
+                              detail::use_parallel<Policy, InputIter>{});
+}
+
+template <typename Policy, typename InputIter, typename T>
+detail::enable_if_policy_t<Policy, T>
+reduce(Policy&& policy, InputIter first, InputIter last, T init){
+    return dhsstl::reduce(dhsstl::forward<Policy>(policy), first, last, dhsstl::move(init),
+                          dhsstl::plus<T>());
+}
+
+template <typename Policy, typename InputIter>
+detail::enable_if_policy_t<Policy, typename iterator_traits<InputIter>::value_type>
+reduce(Policy&& policy, InputIter first, InputIter last){
+    typedef typename iterator_traits<InputIter>::value_type value_type;
+    return dhsstl::reduce(dhsstl::forward<Policy>(policy), first, last, value_type());
+}
+
+// ---------------------------------------------------
+// sort
+// 并行的 pdqsort: 顶层的划分与串行版本相同, 每次划分后左边作为任务提交, 当前线程继续处理右边,
+// 区间小于 cutoff 时调用串行的 pdqsort_loop
+// 划分严重不均衡的次数与串行版本共用同一个上限, 用完之后该区间改用堆排序
+// ---------------------------------------------------
+namespace detail
+{
+
+template <typename RandomIter, typename Compared, typename Branchless>
+void parallel_pdqsort_loop(task_group& group, RandomIter first, RandomIter last, Compared comp,
+                           ptrdiff_t cutoff, int bad_allowed, bool leftmost, Branchless branchless){
+    while(last - first > cutoff){
+        const auto size = last - first;
+        detail::choose_pivot(first, last, comp);
+        if(!leftmost && !comp(*(first - 1), *first)){
+            first = detail::partition_left(first, last, comp) + 1;
+            continue;
+        }
+        const auto part = detail::partition_right_dispatch(first, last, comp, branchless);
+        const RandomIter pivot_pos = part.first;
+        const auto l_size = pivot_pos - first;
+        const auto r_size = last - (pivot_pos + 1);
+        if(l_size < size / 8 || r_size < size / 8){
+            if(--bad_allowed == 0){
+                dhsstl::make_heap(first, last, comp);
+                dhsstl::sort_heap(first, last, comp);
+                return;
+            }
+            detail::break_patterns(first, pivot_pos, last);
+        }
+        group.spawn([&group, first, pivot_pos, comp, cutoff, bad_allowed, leftmost, branchless]{
+            detail::parallel_pdqsort_loop(group, first, pivot_pos, comp, cutoff, bad_allowed, leftmost,
+                                          branchless);
+        });
+        first = pivot_pos + 1;
+        leftmost = false;
+    }
+    detail::pdqsort_loop(first, last, comp, bad_allowed, leftmost, branchless);
+}
+
+} // namespace detail
+
+template <typename Policy, typename RandomIter, typename Compared>
+void sort_par(const Policy& policy, RandomIter first, RandomIter last, Compared comp, std::true_type){
+    thread_pool& pool = detail::pool_of(policy);
+    const size_t n = static_cast<size_t>(last - first);
+    const size_t chunks = detail::chunk_count(n, pool);
+    if(chunks == 1)
+        return dhsstl::sort(first, last, comp);
+    // 任务数约为块数的 2 倍, 给划分不均衡留出余地
+    const ptrdiff_t cutoff = dhsstl::max<ptrdiff_t>(static_cast<ptrdiff_t>(n / (2 * chunks)),
+                                                    DHSSTL_PARALLEL_GRAIN);
+    task_group group(pool);
+    detail::parallel_pdqsort_loop(group, first, last, comp, cutoff, detail::log2_floor(n), true,
+                                  detail::use_branchless_partition<RandomIter, Compared>{});
+    group.sync();
+}
+
+template <typename Policy, typename RandomIter, typename Compared>
+void sort_par(const Policy&, RandomIter first, RandomIter last, Compared comp, std::false_type){
+    dhsstl::sort(first, last, comp);
+}
+
+template <typename Policy, typename RandomIter, typename Compared>
+detail::enable_if_policy_t<Policy, void>
+sort(Policy&& policy, RandomIter first, RandomIter last, Compared comp){
+    dhsstl::sort_par(policy, first, last, comp, detail::use_parallel<Policy, RandomIter>{});
+}
+
+template <typename Policy, typename RandomIter>
+detail::enable_if_policy_t<Policy, void>
+sort(Policy&& policy, RandomIter first, RandomIter last){
+    dhsstl::sort(dhsstl::forward<Policy>(policy), first, last,
+                 dhsstl::less<typename iterator_traits<RandomIter>::value_type>());
+}
+
+// ---------------------------------------------------
+// radix_sort
+// 并行的 MSD 基数排序:
+//  1. 各块并行统计最高 8 位的直方图, 所有元素都落在同一个桶时改用下一个 8 位
+//  2. 按 (桶, 块) 的顺序算出每块在每个桶中的起始位置, 各块并行地把元素分配到缓冲区, 保持稳定
+//  3. 每个桶之间互不相关, 并行地对剩下的低位做 LSD 基数排序, 结果写回原区间
+// 只对可以平凡复制的类型并行, key 函数会被多个线程同时调用
+// ---------------------------------------------------
+template <typename Policy, typename RandomIter, typename KeyFn>
+void radix_sort_par(const Policy& policy, RandomIter first, RandomIter last, KeyFn key, std::true_type){
+    typedef typename iterator_traits<RandomIter>::value_type                      value_type;
+    typedef typename detail::radix_key_type<KeyFn, value_type>::type             key_type;
+    typedef typename detail::radix_key_traits<key_type>::unsigned_type           unsigned_type;
+    constexpr size_t radix = 256;
+    thread_pool& pool = detail::pool_of(policy);
+    const size_t n = static_cast<size_t>(last - first);
+    const size_t chunks = detail::chunk_count(n, pool);
+    if(chunks == 1 || !std::is_trivially_copyable<value_type>::value)
+        return dhsstl::radix_sort(first, last, key);
+    auto buf = dhsstl::get_temporary_buffer<value_type>(static_cast<ptrdiff_t>(n));
+    if(static_cast<size_t>(buf.second) < n){
+        dhsstl::release_temporary_buffer(buf.first);
+        return dhsstl::radix_sort(first, last, key);
+    }
+    value_type* scratch = buf.first;
+
+    // counts[i * radix + b]: 第 i 块中落在桶 b 的元素个数
+    dhsstl::vector<size_t> counts(chunks * radix);
+    dhsstl::vector<size_t> bucket_begin(radix + 1);
+    unsigned shift = sizeof(unsigned_type) * 8;
+    bool trivial = true;
+    while(trivial && shift > 0){
+        shift -= 8;
+        dhsstl::fill(counts.begin(), counts.end(), size_t(0));
+        detail::for_each_chunk(pool, n, chunks, [&](size_t i, size_t lo, size_t hi){
+            size_t* c = counts.data() + i * radix;
+            for(size_t j = lo; j < hi; ++j)
+                ++c[static_cast<size_t>(detail::radix_key(key, first[j]) >> shift) & (radix - 1)];
+        });
+        size_t sum = 0;
+        for(size_t b = 0; b < radix; ++b){
+            bucket_begin[b] = sum;
+            for(size_t i = 0; i < chunks; ++i){
+                const size_t t = counts[i * radix + b];
+                counts[i * radix + b] = sum;
+                sum += t;
+            }
+            trivial = trivial && (sum - bucket_begin[b] == 0 || sum - bucket_begin[b] == n);
+        }
+        bucket_begin[radix] = n;
+    }
+    // 所有 key 都相同, 已经有序
+    if(trivial){
+        dhsstl::release_temporary_buffer(buf.first);
+        return;
+    }
+
+    detail::for_each_chunk(pool, n, chunks, [&](size_t i, size_t lo, size_t hi){
+        detail::radix_scatter<8>(first + lo, first + hi, scratch, counts.data() + i * radix, shift, key);
+    });
+
+    pool.parallel_for(size_t(0), radix, size_t(1), [&](size_t bfirst, size_t blast){
+        for(size_t b = bfirst; b < blast; ++b){
+            const size_t lo = bucket_begin[b];
+            const size_t m = bucket_begin[b + 1] - lo;
+            if(m == 0)
+                continue;
+            if(shift > 0 && m >= detail::radix_insertion_threshold){
+                if(detail::radix_lsd_dispatch(scratch + lo, first + lo, m, shift, key))
+                    continue;
+            }
+            else if(shift > 0 && m > 1){
+                detail::insertion_sort(scratch + lo, scratch + lo + m, detail::make_radix_key_less(key));
+            }
+            dhsstl::move(scratch + lo, scratch + lo + m, first + lo);
+        }
+    });
+    dhsstl::release_temporary_buffer(buf.first);
+}
+
+template <typename Policy, typename RandomIter, typename KeyFn>
+void radix_sort_par(const Policy&, RandomIter first, RandomIter last, KeyFn key, std::false_type){
+    dhsstl::radix_sort(first, last, key);
+}
+
+template <typename Policy, typename RandomIter, typename KeyFn>
+detail::enable_if_policy_t<Policy, void>
+radix_sort(Policy&& policy, RandomIter first, RandomIter last, KeyFn key){
+    dhsstl::radix_sort_par(policy, first, last, key, detail::use_parallel<Policy, RandomIter>{});
+}
+
+template <typename Policy, typename RandomIter>
+detail::enable_if_policy_t<Policy, void>
+radix_sort(Policy&& policy, RandomIter first, RandomIter last){
+    dhsstl::radix_sort(dhsstl::forward<Policy>(policy), first, last, detail::radix_identity());
+}
+
+} // namespace dhsstl
+
+#endif // !DHSTINYSTL_EXECUTION_H_
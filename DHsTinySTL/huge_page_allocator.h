@@ -0,0 +1,271 @@
+#ifndef DHSTINYSTL_HUGE_PAGE_ALLOCATOR_H_
+#define DHSTINYSTL_HUGE_PAGE_ALLOCATOR_H_
+
+// 这个头文件包含一个模板类 huge_page_allocator, 大块内存直接用 mmap 映射并建议内核使用透明大页
+// 接口和 dhsstl::allocator 相同, 可以作为 vector / deque 的 Alloc 参数, 例如:
+//      dhsstl::vector<uint64_t, dhsstl::huge_page_allocator<uint64_t>> v;
+//
+// 注: 不小于 Threshold 字节的请求按 2MB 向上取整, 用 mmap 映射一块按 2MB 对齐的匿名内存,
+//     再调用 madvise(MADV_HUGEPAGE), 这样一个 TLB 表项可以覆盖 2MB 而不是 4KB;
+//     更小的请求仍然交给 malloc / free, 对齐要求超过 max_align_t 的类型使用带 align_val_t 的 operator new / delete
+//     需要内核开启透明大页(/sys/kernel/mm/transparent_hugepage/enabled 为 always 或 madvise)
+//     在没有 mmap 的平台上退化为 malloc / free
+//     trivially copyable 的类型可以 reallocate, 两端都是 mmap 的内存块时在 Linux 上走 mremap, 不复制数据;
+//     不能原地扩展时用 MREMAP_FIXED 把页移到新映射的按 2MB 对齐的区域, 保证移动后仍然可以使用大页
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#define DHSSTL_HAS_MMAP 1
+#endif
+
+#include "algobase.h"
+#include "construct.h"
+#include "util.h"
+
+namespace dhsstl
+{
+
+// 透明大页的大小
+constexpr size_t huge_page_size = static_cast<size_t>(2) << 20;
+
+// 模板类: huge_page_allocator
+// 模板参数 T 代表数据类型, Threshold 代表使用 mmap 的最小字节数
+template <class T, size_t Threshold = huge_page_size>
+class huge_page_allocator
+{
+public:
+    typedef T               value_type;
+    typedef T*              pointer;
+    typedef const T*        const_pointer;
+    typedef T&              reference;
+    typedef const T&        const_reference;
+    typedef size_t          size_type;
+    typedef ptrdiff_t       difference_type;
+
+    static T*   allocate();
+    static T*   allocate(size_type n);
+
+    // 必须传入 allocate 时的 n, 用于区分内存块是否由 mmap 映射
+    static void deallocate(T* ptr);
+    static void deallocate(T* ptr, size_type n);
+
+    // 把 ptr 处的 old_n 个元素的空间调整为 new_n 个元素, 原有元素按字节保留, 失败时抛出 std::bad_alloc 且 ptr 保持不变
+    // 只能用于 trivially copyable 的类型
+    static T*   reallocate(T* ptr, size_type old_n, size_type new_n);
+
+    static void construct(T* ptr);
+    static void construct(T* ptr, const T& value);
+    static void construct(T* ptr, T&& value);
+
+    template <class... Args>
+    static void construct(T* ptr, Args&& ...args);
+
+    static void destroy(T* ptr);
+    static void destroy(T* first, T* last);
+
+    template <typename U = T>
+    static constexpr bool can_reallocate(){
+        return std::is_trivially_copyable<U>::value && alignof(U) <= alignof(std::max_align_t);
+    }
+
+private:
+    static bool   is_mapped(size_type bytes) { return bytes >= Threshold; }
+    static size_t round_to_huge_page(size_type bytes){
+        return (bytes + huge_page_size - 1) & ~(huge_page_size - 1);
+    }
+
+    // 对齐要求超过 max_align_t 的类型不能用 malloc, 改用带 align_val_t 的 operator new
+    static void*  small_allocate(size_type bytes);
+    static void   small_deallocate(void* ptr);
+    static void*  map_pages(size_t len);
+    static void   unmap_pages(void* ptr, size_t len);
+    static void*  raw_allocate(size_type bytes);
+    static void   raw_deallocate(void* ptr, size_type bytes);
+};
+
+// 定义
+template <class T, size_t Threshold>
+T* huge_page_allocator<T, Threshold>::allocate(){
+    return allocate(1);
+}
+
+template <class T, size_t Threshold>
+T* huge_page_allocator<T, Threshold>::allocate(size_type n){
+    if(n == 0)
+        return nullptr;
+    return static_cast<T*>(raw_allocate(n * sizeof(T)));
+}
+
+template <class T, size_t Threshold>
+void huge_page_allocator<T, Threshold>::deallocate(T* ptr){
+    deallocate(ptr, 1);
+}
+
+template <class T, size_t Threshold>
+void huge_page_allocator<T, Threshold>::deallocate(T* ptr, size_type n){
+    if(ptr == nullptr)
+        return;
+    raw_deallocate(ptr, n * sizeof(T));
+}
+
+template <class T, size_t Threshold>
+T* huge_page_allocator<T, Threshold>::reallocate(T* ptr, size_type old_n, size_type new_n){
+    static_assert(can_reallocate(), "huge_page_allocator<T>::reallocate requires a trivially copyable T");
+    if(ptr == nullptr)
+        return allocate(new_n);
+    if(new_n == 0){
+        deallocate(ptr, old_n);
+        return nullptr;
+    }
+    const size_type old_bytes = old_n * sizeof(T);
+    const size_type new_bytes = new_n * sizeof(T);
+    if(!is_mapped(old_bytes) && !is_mapped(new_bytes)){
+        void* p = std::realloc(ptr, new_bytes);
+        if(p == nullptr)
+            throw std::bad_alloc();
+        return static_cast<T*>(p);
+    }
+#if defined(DHSSTL_HAS_MMAP) && defined(__linux__) && defined(MREMAP_MAYMOVE)
+    if(is_mapped(old_bytes) && is_mapped(new_bytes)){
+        const size_t old_len = round_to_huge_page(old_bytes);
+        const size_t new_len = round_to_huge_page(new_bytes);
+        if(old_len == new_len)
+            return ptr;
+        // 先尝试原地扩展/收缩, 地址不变, 仍然按 2MB 对齐
+        void* p = ::mremap(ptr, old_len, new_len, 0);
+        if(p == MAP_FAILED){
+            // MREMAP_MAYMOVE 只保证新地址按 4KB 对齐, 无法再使用大页
+            // 因此先映射一块按 2MB 对齐的区域作为目标, 再把原来的页移过去
+            void* target = map_pages(new_len);
+#ifdef MREMAP_FIXED
+            p = ::mremap(ptr, old_len, new_len, MREMAP_MAYMOVE | MREMAP_FIXED, target);
+            if(p == MAP_FAILED){
+                unmap_pages(target, new_len);
+                throw std::bad_alloc();
+            }
+#else
+            std::memcpy(target, static_cast<const void*>(ptr), old_bytes);
+            unmap_pages(ptr, old_len);
+            p = target;
+#endif
+        }
+#ifdef MADV_HUGEPAGE
+        ::madvise(p, new_len, MADV_HUGEPAGE);
+#endif
+        return static_cast<T*>(p);
+    }
+#endif
+    // 跨越阈值时只能重新分配并复制
+    T* p = allocate(new_n);
+    std::memcpy(static_cast<void*>(p), static_cast<const void*>(ptr), dhsstl::min(old_bytes, new_bytes));
+    deallocate(ptr, old_n);
+    return p;
+}
+
+template <class T, size_t Threshold>
+void* huge_page_allocator<T, Threshold>::map_pages(size_t len){
+#ifdef DHSSTL_HAS_MMAP
+    // 多映射一个大页, 再把首尾多余的部分解除映射, 得到按 2MB 对齐的内存块
+    const size_t map_len = len + huge_page_size;
+    void* raw = ::mmap(nullptr, map_len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(raw == MAP_FAILED)
+        throw std::bad_alloc();
+    const auto addr = reinterpret_cast<uintptr_t>(raw);
+    const auto aligned = (addr + huge_page_size - 1) & ~static_cast<uintptr_t>(huge_page_size - 1);
+    const size_t head = aligned - addr;
+    if(head != 0)
+        ::munmap(raw, head);
+    if(huge_page_size - head != 0)
+        ::munmap(reinterpret_cast<void*>(aligned + len), huge_page_size - head);
+    void* p = reinterpret_cast<void*>(aligned);
+#ifdef MADV_HUGEPAGE
+    ::madvise(p, len, MADV_HUGEPAGE);
+#endif
+    return p;
+#else
+    return small_allocate(len);
+#endif
+}
+
+template <class T, size_t Threshold>
+void huge_page_allocator<T, Threshold>::unmap_pages(void* ptr, size_t len){
+#ifdef DHSSTL_HAS_MMAP
+    ::munmap(ptr, len);
+#else
+    (void)len;
+    small_deallocate(ptr);
+#endif
+}
+
+template <class T, size_t Threshold>
+void* huge_page_allocator<T, Threshold>::small_allocate(size_type bytes){
+    if(alignof(T) > alignof(std::max_align_t))
+        return ::operator new(bytes, std::align_val_t(alignof(T)));
+    void* p = std::malloc(bytes);
+    if(p == nullptr)
+        throw std::bad_alloc();
+    return p;
+}
+
+template <class T, size_t Threshold>
+void huge_page_allocator<T, Threshold>::small_deallocate(void* ptr){
+    if(alignof(T) > alignof(std::max_align_t))
+        ::operator delete(ptr, std::align_val_t(alignof(T)));
+    else
+        std::free(ptr);
+}
+
+template <class T, size_t Threshold>
+void* huge_page_allocator<T, Threshold>::raw_allocate(size_type bytes){
+    if(is_mapped(bytes))
+        return map_pages(round_to_huge_page(bytes));
+    return small_allocate(bytes);
+}
+
+template <class T, size_t Threshold>
+void huge_page_allocator<T, Threshold>::raw_deallocate(void* ptr, size_type bytes){
+    if(is_mapped(bytes))
+        unmap_pages(ptr, round_to_huge_page(bytes));
+    else
+        small_deallocate(ptr);
+}
+
+template <class T, size_t Threshold>
+void huge_page_allocator<T, Threshold>::construct(T* ptr){
+    dhsstl::construct(ptr);
+}
+
+template <class T, size_t Threshold>
+void huge_page_allocator<T, Threshold>::construct(T* ptr, const T& value){
+    dhsstl::construct(ptr, value);
+}
+
+template <class T, size_t Threshold>
+void huge_page_allocator<T, Threshold>::construct(T* ptr, T&& value){
+    dhsstl::construct(ptr, dhsstl::move(value));
+}
+
+template <class T, size_t Threshold>
+template <class ...Args>
+void huge_page_allocator<T, Threshold>::construct(T* ptr, Args&& ...args){
+    dhsstl::construct(ptr, dhsstl::forward<Args>(args)...);
+}
+
+template <class T, size_t Threshold>
+void huge_page_allocator<T, Threshold>::destroy(T* ptr){
+    dhsstl::destroy(ptr);
+}
+
+template <class T, size_t Threshold>
+void huge_page_allocator<T, Threshold>::destroy(T* first, T* last){
+    dhsstl::destroy(first, last);
+}
+
+} // namespace dhsstl
+
+#endif // DHSTINYSTL_HUGE_PAGE_ALLOCATOR_H_
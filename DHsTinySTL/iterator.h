@@ -214,6 +214,24 @@ struct is_iterator :
 {
 };
 
+// 分段迭代器(segmented iterator)的萃取
+// 像 deque 这样由若干段连续内存组成的容器, 其迭代器每次 ++ 都要检查是否跨段
+// 这类迭代器可以特化 segmented_iterator_traits, 提供以下接口, 算法就可以逐段按原生指针区间处理:
+//      segment_iterator / local_iterator : 段的标识以及段内的迭代器(一般为原生指针)
+//      segment(it) / local(it)           : 迭代器所在的段以及段内的位置
+//      segment_begin(s) / segment_end(s) : 段 s 的首尾
+// 注: 对输出区间逐段写入时, 段与段之间靠迭代器本身的 operator+= 前进
+template <typename Iterator>
+struct segmented_iterator_traits{
+    static constexpr bool is_segmented = false;
+};
+
+template <typename Iterator>
+struct is_segmented_iterator
+    : public m_bool_constant<segmented_iterator_traits<Iterator>::is_segmented>
+{
+};
+
 // 这个函数可以很方便的决定某个迭代器的类型
 template <typename Iterator>
 inline typename iterator_traits<Iterator>::iterator_category
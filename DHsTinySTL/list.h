@@ -15,6 +15,10 @@ list: 双向链表
 //  * push_front
 //  * push_bcak
 //  * insert
+//
+// 节点存储:
+// 模板参数 ChunkSize 为 0 时(默认)每个节点单独分配, ChunkSize > 0 时节点从 list 自己的 chunk 中分配,
+// 哨兵节点内嵌在 list 对象中, 详见 list_node_pool
 
 https://en.cppreference.com/w/cpp/container/list 中显示
 template<
@@ -37,6 +41,13 @@ SGI list 不仅是一个双向链表, 而且还是一个环状的双向链表, 
 #include <functional>
 #include "util.h"
 #include "exceptdef.h"
+#include "algo.h"
+#include "vector.h"
+
+// list<T, ChunkSize> 在个数已知时一次申请的 chunk 的最大字节数, 与 rb_tree 共用
+#ifndef DHSSTL_NODE_BATCH_BYTES
+#define DHSSTL_NODE_BATCH_BYTES (static_cast<size_t>(1) << 20)
+#endif
 
 namespace dhsstl{
 
@@ -190,10 +201,172 @@ struct list_const_iterator : public iterator<bidirectional_iterator_tag, T>{
     bool operator!=(const self& rhs) const{ return node_ != rhs.node_; }
 };
 
-// 模板类: list
-// 模板参数 T 代表数据类型
+// ----------------------------------------------------------------------------------
+// list 的节点存储
+// list<T, ChunkSize> 私有继承 list_node_pool<T, ChunkSize>, 由它分配节点和哨兵节点
+//
+// ChunkSize > 0: 节点从本 list 自己的 chunk 中分配, 每个 chunk 连续存放 ChunkSize 个节点
+//  * 新节点优先从空闲链表中取, 其次从最新的 chunk 中顺序切出, 都没有时才申请新的 chunk
+//  * 个数已知的构造(n 个值, 区间, 复制)先用 reserve_nodes 申请一个能放下所有节点的大 chunk,
+//    大 chunk 最多 DHSSTL_NODE_BATCH_BYTES 字节, 用完后继续申请同样大小的 chunk
+//  * 释放的节点放入空闲链表, 留给之后插入的元素复用
+//  * 哨兵节点内嵌在 list 对象中, 空的 list 不申请内存
+//  * clear 和析构时整块释放 chunk, T 可以平凡析构时不需要遍历节点, 复杂度为 O(chunk 数)
+// 节点的内存属于某个 list, 因此:
+//  * 移动构造, 移动赋值, swap, 整个链表的 splice 以及 merge 会连同 chunk 一起转移
+//  * 从另一个 list 中 splice 一部分节点时, 退化为逐个移动元素, 指向这些元素的迭代器失效
+template <typename T, size_t ChunkSize>
+class list_node_pool
+{
+public:
+    typedef typename node_traits<T>::base_ptr   base_ptr;
+    typedef typename node_traits<T>::node_ptr   node_ptr;
+
+    static constexpr bool pooled = true;
+
+private:
+    // chunk 的头部, 占用 chunk 开头的 header_slots 个节点的空间, 之后是 capacity 个节点
+    struct chunk
+    {
+        chunk*          next;
+        size_t          capacity;
+    };
+    typedef dhsstl::allocator<list_node<T>>     chunk_allocator;
+    static constexpr size_t header_slots = (sizeof(chunk) + sizeof(list_node<T>) - 1) / sizeof(list_node<T>);
+    static constexpr size_t max_nodes    = DHSSTL_NODE_BATCH_BYTES / sizeof(list_node<T>) > ChunkSize
+                                         ? DHSSTL_NODE_BATCH_BYTES / sizeof(list_node<T>) : ChunkSize;
+
+    list_node_base<T>   sentinel_;                  // 内嵌的哨兵节点
+    chunk*              chunks_    = nullptr;       // 所有的 chunk, 最新的在最前面
+    size_t              used_      = 0;             // 最新的 chunk 中已经切出的节点数
+    base_ptr            free_      = nullptr;       // 空闲节点链表, 通过 next 链接
+    base_ptr            free_tail_ = nullptr;       // 空闲链表的尾节点, free_ 不为空时有效
+
+    static node_ptr nodes(chunk* c) noexcept { return reinterpret_cast<node_ptr>(c) + header_slots; }
+
+    // 申请一个容纳 n 个节点(最多 max_nodes 个)的 chunk 作为最新的 chunk, 之前最新的 chunk 中还没有切出的节点放入空闲链表
+    void new_chunk(size_t n){
+        n = dhsstl::min(n, max_nodes);
+        chunk* c = reinterpret_cast<chunk*>(chunk_allocator::allocate(n + header_slots));
+        c->next = chunks_;
+        c->capacity = n;
+        if(chunks_ != nullptr){
+            while(used_ < chunks_->capacity)
+                deallocate_node(nodes(chunks_) + used_++);
+        }
+        chunks_ = c;
+        used_ = 0;
+    }
+
+public:
+    list_node_pool() = default;
+    list_node_pool(const list_node_pool&) = delete;
+    list_node_pool& operator=(const list_node_pool&) = delete;
+    ~list_node_pool(){ release_pool(); }
+
+    node_ptr allocate_node(){
+        if(free_ != nullptr){
+            base_ptr p = free_;
+            free_ = p->next;
+            return p->as_node();
+        }
+        if(chunks_ == nullptr)
+            new_chunk(ChunkSize);
+        else if(used_ == chunks_->capacity)
+            new_chunk(chunks_->capacity);
+        return nodes(chunks_) + used_++;
+    }
+
+    // 之后还要插入 n 个节点, 空闲链表和最新的 chunk 中放不下时一次申请一个能放下的 chunk
+    void reserve_nodes(size_t n){
+        const size_t avail = chunks_ == nullptr ? 0 : chunks_->capacity - used_;
+        if(free_ == nullptr && n > avail && n > ChunkSize)
+            new_chunk(n);
+    }
+
+    void deallocate_node(node_ptr p) noexcept{
+        base_ptr b = p->as_base();
+        b->next = free_;
+        if(free_ == nullptr)
+            free_tail_ = b;
+        free_ = b;
+    }
+
+    base_ptr allocate_sentinel() noexcept { return &sentinel_; }
+    void     deallocate_sentinel(base_ptr) noexcept {}
+
+    // 释放所有的 chunk, 调用前所有的元素都已经析构
+    void release_pool() noexcept{
+        while(chunks_ != nullptr){
+            chunk* next = chunks_->next;
+            chunk_allocator::deallocate(reinterpret_cast<node_ptr>(chunks_), chunks_->capacity + header_slots);
+            chunks_ = next;
+        }
+        used_ = 0;
+        free_ = free_tail_ = nullptr;
+    }
+
+    // 接收 x 的所有 chunk 和空闲节点, x 中的节点从此属于 *this
+    void adopt_pool(list_node_pool& x) noexcept{
+        if(x.chunks_ == nullptr)
+            return;
+        if(chunks_ == nullptr){
+            swap_pool(x);
+            return;
+        }
+        // x 最新的 chunk 中还没有切出的节点放入空闲链表, *this 继续从自己最新的 chunk 中切出节点
+        while(x.used_ < x.chunks_->capacity)
+            x.deallocate_node(nodes(x.chunks_) + x.used_++);
+        chunk* last = x.chunks_;
+        while(last->next != nullptr)
+            last = last->next;
+        last->next = chunks_->next;
+        chunks_->next = x.chunks_;
+        if(x.free_ != nullptr){
+            x.free_tail_->next = free_;
+            if(free_ == nullptr)
+                free_tail_ = x.free_tail_;
+            free_ = x.free_;
+        }
+        x.chunks_ = nullptr;
+        x.free_ = x.free_tail_ = nullptr;
+    }
+
+    // 交换 chunk 和空闲节点, 不交换哨兵节点
+    void swap_pool(list_node_pool& x) noexcept{
+        dhsstl::swap(chunks_, x.chunks_);
+        dhsstl::swap(used_, x.used_);
+        dhsstl::swap(free_, x.free_);
+        dhsstl::swap(free_tail_, x.free_tail_);
+    }
+};
+
+// ChunkSize == 0: 每个节点以及哨兵节点都单独向 allocator 申请, 没有额外的成员
 template <typename T>
-class list{
+class list_node_pool<T, 0>
+{
+public:
+    typedef typename node_traits<T>::base_ptr   base_ptr;
+    typedef typename node_traits<T>::node_ptr   node_ptr;
+    typedef dhsstl::allocator<list_node_base<T>>        base_allocator;
+    typedef dhsstl::allocator<list_node<T>>             node_allocator;
+
+    static constexpr bool pooled = false;
+
+    static node_ptr allocate_node()                         { return node_allocator::allocate(1); }
+    static void     deallocate_node(node_ptr p) noexcept    { node_allocator::deallocate(p); }
+    static base_ptr allocate_sentinel()                     { return base_allocator::allocate(1); }
+    static void     deallocate_sentinel(base_ptr p) noexcept{ base_allocator::deallocate(p); }
+    static void     reserve_nodes(size_t) noexcept {}
+    static void     release_pool() noexcept {}
+    static void     adopt_pool(list_node_pool&) noexcept {}
+    static void     swap_pool(list_node_pool&) noexcept {}
+};
+
+// 模板类: list
+// 模板参数 T 代表数据类型, ChunkSize 代表每个 chunk 中的节点数, 为 0 时每个节点单独分配
+template <typename T, size_t ChunkSize = 0>
+class list : private list_node_pool<T, ChunkSize>{
 
 public:
     // list 的嵌套型别定义
@@ -218,6 +391,11 @@ public:
     typedef typename node_traits<T>::base_ptr           base_ptr;
     typedef typename node_traits<T>::node_ptr           node_ptr;
 
+private:
+    typedef list_node_pool<T, ChunkSize>                pool_type;
+    typedef std::integral_constant<bool, pool_type::pooled> pooled_tag;
+
+public:
     // get_allocator: returns the associated allocator
     allocator_type get_allocator(){ return node_allocator(); }
 
@@ -246,11 +424,7 @@ public:
     list(std::initializer_list<T> ilist)                { copy_init(ilist.begin(), ilist.end()); }
     list(const list& rhs)                               { copy_init(rhs.cbegin(), rhs.cend()); }
 
-    list(list&& rhs) noexcept 
-    : node_(rhs.node_), size_(rhs.size_){
-        rhs.node_ = nullptr;
-        rhs.size_ = 0;
-    }
+    list(list&& rhs) noexcept                           { move_init(rhs, pooled_tag{}); }
 
     // 复制
     list& operator=(const list& rhs){
@@ -276,7 +450,7 @@ public:
     ~list(){
         if(node_){
             clear();
-            base_allocator::deallocate(node_);
+            this->deallocate_sentinel(node_);
             node_ = nullptr;
             size_ = 0;
         }
@@ -483,7 +657,7 @@ public:
     void     resize(size_type new_size, const value_type& value);
 
     void     swap(list& rhs) noexcept{
-        dhsstl::swap(node_, rhs.node_);
+        swap_nodes(rhs, pooled_tag{});
         dhsstl::swap(size_, rhs.size_);
     }
     // Operators
@@ -508,11 +682,20 @@ public:
     template<typename BinaryPredicate>
     void     unique(BinaryPredicate pred);
     // sort
+    // 自底向上的归并排序, 稳定, 只修改节点的链接, 不需要走到中点去切分区间
     void     sort()
-    { list_sort(begin(), end(), size(), dhsstl::less<T>()); }
+    { list_sort(dhsstl::less<T>()); }
     template <typename Compare>
     void     sort(Compare comp)
-    { list_sort(begin(), end(), size(), comp);}
+    { list_sort(comp); }
+    // pointer_sort
+    // 把节点指针复制到数组中用 stable_sort 排序, 再按顺序重新链接, 稳定
+    // 排序时只在连续的指针数组上移动, 不改动链表; comp 抛出异常时链表保持原样
+    // 需要 size() 个指针的额外空间
+    void     pointer_sort()
+    { pointer_sort(dhsstl::less<T>()); }
+    template <typename Compare>
+    void     pointer_sort(Compare comp);
 
     void reverse();
 
@@ -528,6 +711,20 @@ private:
     void    fill_init(size_type n, const value_type& value);
     template<typename Iter>
     void    copy_init(Iter first, Iter last);
+    void    move_init(list& rhs, std::false_type) noexcept;
+    void    move_init(list& rhs, std::true_type) noexcept;
+
+    // clear / swap
+    void    clear_nodes(std::false_type) noexcept;
+    void    clear_nodes(std::true_type) noexcept;
+    void    clear_values(std::true_type) noexcept {}
+    void    clear_values(std::false_type) noexcept;
+    void    swap_nodes(list& rhs, std::false_type) noexcept;
+    void    swap_nodes(list& rhs, std::true_type) noexcept;
+
+    // splice [first, last) of x, n = distance(first, last)
+    void    splice_range(base_ptr pos, list& x, base_ptr first, base_ptr last, size_type n, std::false_type);
+    void    splice_range(base_ptr pos, list& x, base_ptr first, base_ptr last, size_type n, std::true_type);
 
     // link / unlink
     iterator    link_iter_node(const_iterator pos, base_ptr node);
@@ -548,7 +745,10 @@ private:
 
     // sort
     template <typename Compared>
-    iterator    list_sort(iterator first, iterator last, size_type n, Compared comp);
+    void        list_sort(Compared comp);
+    template <typename Compared>
+    static void merge_chain(base_ptr& a, base_ptr b, Compared& comp);
+    void        relink_chain(base_ptr first);
 
 };
 
@@ -556,9 +756,9 @@ private:
 // Non-member functions
 
 // 删除pos处的元素
-template <typename T>
-typename list<T>::iterator
-list<T>::erase(const_iterator pos){
+template <typename T, size_t ChunkSize>
+typename list<T, ChunkSize>::iterator
+list<T, ChunkSize>::erase(const_iterator pos){
     DHSSTL_DEBUG(pos != cend());
     auto n = pos.node_;
     auto next = n->next;
@@ -569,9 +769,9 @@ list<T>::erase(const_iterator pos){
 }
 
 // 删除[first, last) 内的元素
-template <typename T>
-typename list<T>::iterator
-list<T>::erase(const_iterator first, const_iterator last){
+template <typename T, size_t ChunkSize>
+typename list<T, ChunkSize>::iterator
+list<T, ChunkSize>::erase(const_iterator first, const_iterator last){
     if(first != last){
         unlink_nodes(first.node_, last.node_->prev);
         while(first != last){
@@ -585,22 +785,19 @@ list<T>::erase(const_iterator first, const_iterator last){
 }
 
 // 清空list
-template <typename T>
-void list<T>::clear(){
+template <typename T, size_t ChunkSize>
+void list<T, ChunkSize>::clear(){
     if(size_ != 0){
-        auto cur = node_->next;
-        // 因为删除了 cur, 所以这里首先记录一下 cur->next;
-        for(base_ptr next = cur->next; cur != node_; cur = next, next = cur->next){
-            destroy_node(cur->as_node());
-        }
+        clear_nodes(pooled_tag{});
         node_->unlink();
         size_ = 0;
     }
+    this->release_pool();
 }
 
 // 重置容器大小
-template <typename T>
-void list<T>::resize(size_type new_size, const value_type& value){
+template <typename T, size_t ChunkSize>
+void list<T, ChunkSize>::resize(size_type new_size, const value_type& value){
     auto i = begin();
     size_type len = 0;
     while(i != end() && len < new_size){
@@ -614,8 +811,8 @@ void list<T>::resize(size_type new_size, const value_type& value){
 }
 
 // 将list x 接合于 pos 之前
-template <typename T>
-void list<T>::splice(const_iterator pos, list& x){
+template <typename T, size_t ChunkSize>
+void list<T, ChunkSize>::splice(const_iterator pos, list& x){
     DHSSTL_DEBUG(this != &x);
     if(!x.empty()){
         THROW_LENGTH_ERROR_IF(size_ > max_size() - x.size_, "list<T>'s size too big");
@@ -625,6 +822,8 @@ void list<T>::splice(const_iterator pos, list& x){
 
         x.unlink_nodes(f, l);
         link_nodes(pos.node_, f, l);
+        // x 的节点连同所在的 chunk 一起转移过来
+        this->adopt_pool(x);
 
         size_ += x.size_;
         x.size_ = 0;
@@ -632,44 +831,30 @@ void list<T>::splice(const_iterator pos, list& x){
 }
 
 // 将 it 所指的节点结合与 pos 之前
-template <typename T>
-void list<T>::splice(const_iterator pos, list& x, const_iterator it){
+template <typename T, size_t ChunkSize>
+void list<T, ChunkSize>::splice(const_iterator pos, list& x, const_iterator it){
     // 这里排除两种情况: 第一中 it所指的节点本来就是pos节点, 或者it所指的节点本来就在pos节点前面
     if(pos.node_ != it.node_ && pos.node_ != it.node_->next){
         THROW_LENGTH_ERROR_IF(size_ > max_size() - 1, "list<T>'s size too big");
-
-        auto f = it.node_;
-
-        x.unlink_nodes(f, f);
-        link_nodes(pos.node_, f, f);
-
-        ++size_;
-        --x.size_;
+        splice_range(pos.node_, x, it.node_, it.node_->next, 1, pooled_tag{});
     }
 }
 
 // 将 list x 的 [first, last) 内的节点结合于 pos 之前
-template <typename T>
-void list<T>::splice(const_iterator pos, list& x, const_iterator first, const_iterator last){
+template <typename T, size_t ChunkSize>
+void list<T, ChunkSize>::splice(const_iterator pos, list& x, const_iterator first, const_iterator last){
     if(first != last && this != &x){
         size_type n =dhsstl::distance(first, last);
         THROW_OUT_OF_RANGE_IF(size_ > max_size() - n, "list<T>'s size too big");
-        auto f = first.node_;
-        auto l = last.node_->prev;
-
-        x.unlink_nodes(f, l);
-        link_nodes(pos.node_, f, l);
-
-        size_ += n;
-        x.size_ -= n;
+        splice_range(pos.node_, x, first.node_, last.node_, n, pooled_tag{});
     }
 }
 
 // 将另一元操作 pred 为 true 的所有元素移除
 // Unary predicate 一元谓词
-template <typename T>
+template <typename T, size_t ChunkSize>
 template <typename UnaryPredicate>
-void list<T>::remove_if(UnaryPredicate pred){
+void list<T, ChunkSize>::remove_if(UnaryPredicate pred){
     auto f = begin();
     auto l = end();
     for(auto next = f; f != l; f = next){
@@ -682,9 +867,9 @@ void list<T>::remove_if(UnaryPredicate pred){
 
 // 移除 list 中满足 pred 为 true 重复元素
 // 删除容器中相邻的重复元素, 只保留一个
-template <typename T>
+template <typename T, size_t ChunkSize>
 template <typename BinaryPredicate>
-void list<T>::unique(BinaryPredicate pred){
+void list<T, ChunkSize>::unique(BinaryPredicate pred){
     auto i = begin();
     auto e = end();
     auto j = i;
@@ -701,50 +886,59 @@ void list<T>::unique(BinaryPredicate pred){
 }
 
 // 与另一个 list 合并, 按照 comp 为 true 的顺序
-template <typename T>
+template <typename T, size_t ChunkSize>
 template <typename Compare>
-void list<T>::merge(list &x, Compare comp){
+void list<T, ChunkSize>::merge(list &x, Compare comp){
     if(this != &x){
         THROW_LENGTH_ERROR_IF(size_ > max_size() - x.size_, "list<T>'s size too big");
+        // x 的所有节点最终都会转移过来, 先接收 x 的 chunk
+        this->adopt_pool(x);
 
         auto f1 = begin();
         auto l1 = end();
         auto f2 = x.begin();
         auto l2 = x.end();
-
-        while(f1 != l1 && f2 != l2){
-            if(comp(*f2, *f1)){
-                // 使 comp 为 true 的一段区间
-                auto next = f2;
-                ++next;
-                for(; next != l2 && comp(*next, *f1); ++next);
+        // x 中剩余的节点接在尾部
+        auto splice_rest = [&]{
+            if(f2 != l2){
                 auto f = f2.node_;
-                auto l = next.node_->prev;
-
-                // link node
+                auto l = l2.node_->prev;
                 x.unlink_nodes(f, l);
-                link_nodes(f1.node_, f, l);
-                ++f1;
-            }else{
+                link_nodes(l1.node_, f, l);
+            }
+            size_ += x.size_;
+            x.size_ = 0;
+        };
+
+        try{
+            while(f1 != l1 && f2 != l2){
+                if(comp(*f2, *f1)){
+                    // 使 comp 为 true 的一段区间
+                    auto next = f2;
+                    ++next;
+                    for(; next != l2 && comp(*next, *f1); ++next);
+                    auto f = f2.node_;
+                    auto l = next.node_->prev;
+
+                    // link node
+                    x.unlink_nodes(f, l);
+                    link_nodes(f1.node_, f, l);
+                    f2 = next;
+                }
                 ++f1;
             }
+        }catch(...){
+            // comp 抛出异常时, 节点不会丢失, x 仍然变为空
+            splice_rest();
+            throw;
         }
-        // 剩余部分
-        if(f2 != l2){
-            auto f = f2.node_;
-            auto l = l2.node_->prev;
-            x.unlink_nodes(f, l);
-            link_nodes(l1.node_, f, l);
-        }
-
-        size_ += x.size_;
-        x.size_ = 0;
+        splice_rest();
     }
 }
 
 // 将 list 反转
-template <typename T>
-void list<T>::reverse(){
+template <typename T, size_t ChunkSize>
+void list<T, ChunkSize>::reverse(){
     if(size_ <= 1){
         return;
     }
@@ -762,58 +956,60 @@ void list<T>::reverse(){
 // helper function 
 
 // 创建节点
-template<typename T>
+template <typename T, size_t ChunkSize>
 template<typename ...Args>
-typename list<T>::node_ptr
-list<T>::create_node(Args&& ...args){
-    node_ptr p = node_allocator::allocate(1);
+typename list<T, ChunkSize>::node_ptr
+list<T, ChunkSize>::create_node(Args&& ...args){
+    node_ptr p = this->allocate_node();
     try{
         data_allocator::construct(dhsstl::address_of(p->value), dhsstl::forward<Args>(args)...);
         p->prev = nullptr;
         p->next = nullptr;
     }catch(...){
-        node_allocator::deallocate(p);
+        this->deallocate_node(p);
         throw;
     }
     return p;
 }
 
 // 销毁节点
-template <typename T>
-void list<T>::destroy_node(node_ptr p){
+template <typename T, size_t ChunkSize>
+void list<T, ChunkSize>::destroy_node(node_ptr p){
     data_allocator::destroy(dhsstl::address_of(p->value));
-    node_allocator::deallocate(p);
+    this->deallocate_node(p);
 }
 
 // 用 n 个元素初始化容器
-template <typename T>
-void list<T>::fill_init(size_type n, const value_type& value){
-    node_ = base_allocator::allocate(1);
+template <typename T, size_t ChunkSize>
+void list<T, ChunkSize>::fill_init(size_type n, const value_type& value){
+    node_ = this->allocate_sentinel();
     node_->unlink();
     size_ = n;
     try{
+        this->reserve_nodes(n);
         for(; n > 0; --n){
             auto node = create_node(value);
             link_nodes_at_back(node->as_base(), node->as_base());
         }
     }catch(...){
         clear();
-        base_allocator::deallocate(node_);
+        this->deallocate_sentinel(node_);
         node_ = nullptr;
         throw;
     }
 }
 
 // 以[first, last) 初始化容器
-template <typename T>
+template <typename T, size_t ChunkSize>
 template <typename Iter>
-void list<T>::copy_init(Iter first, Iter last){
-    node_ = base_allocator::allocate(1);
+void list<T, ChunkSize>::copy_init(Iter first, Iter last){
+    node_ = this->allocate_sentinel();
     node_->unlink();
     size_type n = dhsstl::distance(first, last);
     size_ = n;
     try
     {
+        this->reserve_nodes(n);
         for(; n > 0; --n, ++first){
             auto node = create_node(*first);
             link_nodes_at_back(node->as_base(), node->as_base());
@@ -822,16 +1018,115 @@ void list<T>::copy_init(Iter first, Iter last){
     catch(...)
     {
         clear();
-        base_allocator::deallocate(node_);
+        this->deallocate_sentinel(node_);
         node_ = nullptr;
         throw;
     }
 }
 
+// 移动构造: 直接接管 rhs 在堆上的哨兵节点
+template <typename T, size_t ChunkSize>
+void list<T, ChunkSize>::move_init(list& rhs, std::false_type) noexcept{
+    node_ = rhs.node_;
+    size_ = rhs.size_;
+    rhs.node_ = nullptr;
+    rhs.size_ = 0;
+}
+
+// 移动构造: 哨兵节点内嵌在对象中, 把 rhs 的节点和 chunk 一起接过来, rhs 成为空的 list
+template <typename T, size_t ChunkSize>
+void list<T, ChunkSize>::move_init(list& rhs, std::true_type) noexcept{
+    node_ = this->allocate_sentinel();
+    node_->unlink();
+    size_ = 0;
+    this->swap_pool(rhs);
+    if(rhs.size_ != 0){
+        link_nodes(node_, rhs.node_->next, rhs.node_->prev);
+        rhs.node_->unlink();
+        size_ = rhs.size_;
+        rhs.size_ = 0;
+    }
+}
+
+// 逐个销毁并释放所有节点
+template <typename T, size_t ChunkSize>
+void list<T, ChunkSize>::clear_nodes(std::false_type) noexcept{
+    auto cur = node_->next;
+    // 因为删除了 cur, 所以这里首先记录一下 cur->next;
+    for(base_ptr next = cur->next; cur != node_; cur = next, next = cur->next){
+        destroy_node(cur->as_node());
+    }
+}
+
+// 节点的内存随后随 chunk 一起释放, 这里只析构元素, T 可以平凡析构时什么也不做
+template <typename T, size_t ChunkSize>
+void list<T, ChunkSize>::clear_nodes(std::true_type) noexcept{
+    clear_values(std::integral_constant<bool, std::is_trivially_destructible<T>::value>{});
+}
+
+template <typename T, size_t ChunkSize>
+void list<T, ChunkSize>::clear_values(std::false_type) noexcept{
+    for(base_ptr cur = node_->next; cur != node_; cur = cur->next)
+        data_allocator::destroy(dhsstl::address_of(cur->as_node()->value));
+}
+
+template <typename T, size_t ChunkSize>
+void list<T, ChunkSize>::swap_nodes(list& rhs, std::false_type) noexcept{
+    dhsstl::swap(node_, rhs.node_);
+}
+
+// 哨兵节点不能交换地址, 交换它们的链接后修正首尾节点的指向
+template <typename T, size_t ChunkSize>
+void list<T, ChunkSize>::swap_nodes(list& rhs, std::true_type) noexcept{
+    this->swap_pool(rhs);
+    dhsstl::swap(node_->prev, rhs.node_->prev);
+    dhsstl::swap(node_->next, rhs.node_->next);
+    auto fix = [](base_ptr sentinel, size_type n){
+        if(n == 0){
+            sentinel->unlink();
+        }else{
+            sentinel->next->prev = sentinel;
+            sentinel->prev->next = sentinel;
+        }
+    };
+    fix(node_, rhs.size_);
+    fix(rhs.node_, size_);
+}
+
+// 将 x 的 [first, last) 中的 n 个节点链接到 pos 之前
+template <typename T, size_t ChunkSize>
+void list<T, ChunkSize>::splice_range(base_ptr pos, list& x, base_ptr first, base_ptr last,
+                                      size_type n, std::false_type){
+    auto l = last->prev;
+    x.unlink_nodes(first, l);
+    link_nodes(pos, first, l);
+    size_ += n;
+    x.size_ -= n;
+}
+
+// 节点属于 x 的 chunk: 同一个 list 内或者转移 x 的所有节点时仍然只修改链接,
+// 否则逐个把元素移动到新节点中, 再删除 x 中的节点
+template <typename T, size_t ChunkSize>
+void list<T, ChunkSize>::splice_range(base_ptr pos, list& x, base_ptr first, base_ptr last,
+                                      size_type n, std::true_type){
+    if(this == &x){
+        splice_range(pos, x, first, last, n, std::false_type{});
+    }else if(n == x.size_){
+        splice(pos, x);
+    }else{
+        while(first != last){
+            auto next = first->next;
+            emplace(pos, dhsstl::move(first->as_node()->value));
+            x.erase(first);
+            first = next;
+        }
+    }
+}
+
 // 在 pos 处链接一个节点
-template <typename T>
-typename list<T>::iterator
-list<T>::link_iter_node(const_iterator pos, base_ptr link_node){
+template <typename T, size_t ChunkSize>
+typename list<T, ChunkSize>::iterator
+list<T, ChunkSize>::link_iter_node(const_iterator pos, base_ptr link_node){
     if(pos == node_->next){
         link_nodes_at_front(link_node, link_node);
     }else if(pos == node_){
@@ -843,8 +1138,8 @@ list<T>::link_iter_node(const_iterator pos, base_ptr link_node){
 }
 
 // 在pos 前链接 [first, last]的节点
-template <typename T>
-void list<T>::link_nodes(base_ptr pos, base_ptr first, base_ptr last){
+template <typename T, size_t ChunkSize>
+void list<T, ChunkSize>::link_nodes(base_ptr pos, base_ptr first, base_ptr last){
     pos->prev->next = first;
     first->prev = pos->prev;
     pos->prev = last;
@@ -852,8 +1147,8 @@ void list<T>::link_nodes(base_ptr pos, base_ptr first, base_ptr last){
 }
 
 // 在头部添加 [first, last]的节点
-template <typename T>
-void list<T>::link_nodes_at_front(base_ptr first, base_ptr last){
+template <typename T, size_t ChunkSize>
+void list<T, ChunkSize>::link_nodes_at_front(base_ptr first, base_ptr last){
     first->prev = node_;
     last->next = node_->next;
     last->next->prev = last;
@@ -861,8 +1156,8 @@ void list<T>::link_nodes_at_front(base_ptr first, base_ptr last){
 }
 
 // 在尾部添加 [first, last]的节点
-template <typename T>
-void list<T>::link_nodes_at_back(base_ptr first, base_ptr last){
+template <typename T, size_t ChunkSize>
+void list<T, ChunkSize>::link_nodes_at_back(base_ptr first, base_ptr last){
     last->next = node_;
     first->prev = node_->prev;
     first->prev->next = first;
@@ -870,15 +1165,15 @@ void list<T>::link_nodes_at_back(base_ptr first, base_ptr last){
 }
 
 // 容器与 [first, last] 节点断开连接
-template <typename T>
-void list<T>::unlink_nodes(base_ptr first, base_ptr last){
+template <typename T, size_t ChunkSize>
+void list<T, ChunkSize>::unlink_nodes(base_ptr first, base_ptr last){
     first->prev->next = last->next;
     last->next->prev = first->prev;
 }
 
 // 用 n 个元素为容器赋值
-template <typename T>
-void list<T>::fill_assign(size_type n, const value_type& value){
+template <typename T, size_t ChunkSize>
+void list<T, ChunkSize>::fill_assign(size_type n, const value_type& value){
     auto i = begin();
     auto e = end();
     for(; n > 0 && i != e; --n, ++i){
@@ -892,9 +1187,9 @@ void list<T>::fill_assign(size_type n, const value_type& value){
 }
 
 // 赋值[f2, l2)为容器赋值
-template <typename T>
+template <typename T, size_t ChunkSize>
 template <typename Iter>
-void list<T>::copy_assign(Iter f2, Iter l2){
+void list<T, ChunkSize>::copy_assign(Iter f2, Iter l2){
     auto f1 = begin();
     auto l1 = end();
     for(; f1 != l1 && f2 != l2; ++f1, ++f2){
@@ -908,9 +1203,9 @@ void list<T>::copy_assign(Iter f2, Iter l2){
 }
 
 // 在 pos 处插入 n 个元素
-template <typename T>
-typename list<T>::iterator
-list<T>::fill_insert(const_iterator pos, size_type n, const value_type& value){
+template <typename T, size_t ChunkSize>
+typename list<T, ChunkSize>::iterator
+list<T, ChunkSize>::fill_insert(const_iterator pos, size_type n, const value_type& value){
     iterator r(pos.node_);    
     if(n != 0){
         const auto add_size = n;
@@ -944,10 +1239,10 @@ list<T>::fill_insert(const_iterator pos, size_type n, const value_type& value){
 }
 
 // 在 pos 处插入[first, last)的元素
-template <typename T>
+template <typename T, size_t ChunkSize>
 template <typename Iter>
-typename list<T>::iterator
-list<T>::copy_insert(const_iterator pos, size_type n, Iter first){
+typename list<T, ChunkSize>::iterator
+list<T, ChunkSize>::copy_insert(const_iterator pos, size_type n, Iter first){
     iterator r(pos.node_);
     if(n != 0){
         const auto add_size = n;
@@ -978,81 +1273,163 @@ list<T>::copy_insert(const_iterator pos, size_type n, Iter first){
     return r;
 }
 
-// 对list 进行归并排序, 返回一个迭代器指向区间最小元素的位置
-template <typename T>
+// list_sort 使用的有序链: 以 nullptr 结尾, 链内的 prev 有效, 首节点的 prev 指向尾节点
+// 合并两条有序链, 结果保存在 a 中, 相等时 a 中的节点在前
+// 合并时顺便维护 prev, 这时节点已经在缓存中, 排序结束后就不需要再按排好的(在内存中是随机的)顺序遍历一次
+// comp 抛出异常时, 把剩下的节点接在已经合并的部分后面(只保证 next), a 中仍然包含两条链的所有节点
+template <typename T, size_t ChunkSize>
 template <typename Compared>
-typename list<T>::iterator
-list<T>::list_sort(iterator f1, iterator l2, size_type n, Compared comp){
-    if(n < 2)
-        return f1;
-    
-    if(n == 2){
-        if(comp(*--l2, *f1)){
-            auto ln = l2.node_;
-            unlink_nodes(ln, ln);
-            link_nodes(f1.node_, ln, ln);
-            return l2;
+void list<T, ChunkSize>::merge_chain(base_ptr& a, base_ptr b, Compared& comp){
+    list_node_base<T> head;
+    base_ptr tail = &head;
+    base_ptr x = a;
+    const base_ptr a_last = a->prev;
+    const base_ptr b_last = b->prev;
+    try{
+        while(x != nullptr && b != nullptr){
+            if(comp(b->as_node()->value, x->as_node()->value)){
+                tail->next = b;
+                b->prev = tail;
+                tail = b;
+                b = b->next;
+            }else{
+                tail->next = x;
+                x->prev = tail;
+                tail = x;
+                x = x->next;
+            }
         }
-        return f1;
+    }catch(...){
+        tail->next = x;
+        while(tail->next != nullptr)
+            tail = tail->next;
+        tail->next = b;
+        a = head.next;
+        throw;
     }
-
-    auto n2 = n / 2;    
-    auto l1 = f1;
-    dhsstl::advance(l1, n2);
-    auto result = f1 = list_sort(f1, l1, n2, comp);
-    auto f2 = l1 = list_sort(l1, l2, n - n2, comp);
-    
-    // 把较小的一段区间移动到前面
-    // 不把这一部分放到循环里的原因是: 
-    //  假如存在这样的情况的话, result得更新
-    //  而后面部分的reuslt不需要更新
-    if(comp(*f2, *f1)){
-        auto m = f2;
-        ++m;
-        for(; m != l2 && comp(*m, *f1); ++m);
-        auto f = f2.node_;
-        auto l = m.node_->prev;
-        result = f2;
-        // 这里l1 需要变的原因是 原来的l1 被移动到链表头部了
-        // 可以和下面对比: 如果
-        // l1 == f2. 那么就会出现这种问题
-        l1 = f2 = m;
-        unlink_nodes(f, l);
-        m = f1;
-        ++m;
-        link_nodes(f1.node_, f, l);
-        f1 = m;
+    if(x != nullptr){
+        tail->next = x;
+        x->prev = tail;
+        a = head.next;
+        a->prev = a_last;
     }else{
-        ++f1;
+        tail->next = b;
+        b->prev = tail;
+        a = head.next;
+        a->prev = b_last;
     }
-    
-    // 合成两端有序区间
-    while(f1 != l1 && f2 != l2){
-        if(comp(*f2, *f1)){
-            auto m = f2;
-            ++m;
-            for(; m != l2 && comp(*m, *f1); ++m) ;
-            auto f = f2.node_;
-            auto l = m.node_->prev;
-            if(l1 == f2) l1 = m;
-            f2 = m;
-            unlink_nodes(f, l);
-            m = f1;
-            // 这里我觉得, 在f1.node_前面添加元素,应该不会改变++f1的值的吧
-            ++m;
-            link_nodes(f1.node_, f, l);
-            f1 = m;
-        }else{
-            ++f1;
+}
+
+// 按单链 first 的顺序重新设置所有节点的 prev / next, 恢复成环状双向链表
+template <typename T, size_t ChunkSize>
+void list<T, ChunkSize>::relink_chain(base_ptr first){
+    base_ptr prev = node_;
+    for(base_ptr p = first; p != nullptr; p = p->next){
+        prev->next = p;
+        p->prev = prev;
+        prev = p;
+    }
+    prev->next = node_;
+    node_->prev = prev;
+}
+
+// 对 list 进行自底向上的归并排序
+// 先把链表断开成以 nullptr 结尾的链, 合并只修改节点的链接
+// bins[i] 为空, 或者是一条长度为 2^i 的有序链. 每次取下一个节点作为 carry, 与 bins[0], bins[1], ...
+// 依次合并, 直到遇到空的 bin, 类似二进制加一. 64 个 bin 足够容纳 2^64 - 1 个节点
+// 合并时较早的链总是作为 a, 保证稳定
+template <typename T, size_t ChunkSize>
+template <typename Compared>
+void list<T, ChunkSize>::list_sort(Compared comp){
+    if(size_ < 2)
+        return;
+    base_ptr bins[64] = {};
+    size_t fill = 0;
+    base_ptr cur = node_->next;
+    base_ptr carry = nullptr;
+    node_->prev->next = nullptr;
+    try{
+        while(cur != nullptr){
+            carry = cur;
+            cur = cur->next;
+            carry->next = nullptr;
+            carry->prev = carry;
+            size_t i = 0;
+            for(; i < fill && bins[i] != nullptr; ++i){
+                base_ptr b = carry;
+                carry = nullptr;
+                merge_chain(bins[i], b, comp);
+                carry = bins[i];
+                bins[i] = nullptr;
+            }
+            bins[i] = carry;
+            carry = nullptr;
+            if(i == fill)
+                ++fill;
         }
+        // 从小到大合并所有的 bin, 较大的 bin 中是较早的节点
+        for(size_t i = 0; i < fill; ++i){
+            if(bins[i] == nullptr)
+                continue;
+            if(carry != nullptr){
+                base_ptr b = carry;
+                carry = nullptr;
+                merge_chain(bins[i], b, comp);
+            }
+            carry = bins[i];
+            bins[i] = nullptr;
+        }
+    }catch(...){
+        // 基本异常保证: 把所有的链首尾相接, 节点不会丢失
+        list_node_base<T> head;
+        base_ptr tail = &head;
+        tail->next = nullptr;
+        auto append = [&](base_ptr chain){
+            tail->next = chain;
+            while(tail->next != nullptr)
+                tail = tail->next;
+        };
+        append(carry);
+        for(size_t i = 0; i < fill; ++i)
+            append(bins[i]);
+        append(cur);
+        relink_chain(head.next);
+        throw;
+    }
+    base_ptr last = carry->prev;
+    node_->next = carry;
+    carry->prev = node_;
+    last->next = node_;
+    node_->prev = last;
+}
+
+// 通过指针数组排序
+template <typename T, size_t ChunkSize>
+template <typename Compare>
+void list<T, ChunkSize>::pointer_sort(Compare comp){
+    if(size_ < 2)
+        return;
+    dhsstl::vector<base_ptr> nodes(size_, dhsstl::default_init);
+    base_ptr p = node_->next;
+    for(size_type i = 0; i < size_; ++i, p = p->next)
+        nodes[i] = p;
+    dhsstl::stable_sort(nodes.begin(), nodes.end(), [&comp](base_ptr a, base_ptr b){
+        return comp(a->as_node()->value, b->as_node()->value);
+    });
+    base_ptr prev = node_;
+    for(size_type i = 0; i < size_; ++i){
+        prev->next = nodes[i];
+        nodes[i]->prev = prev;
+        prev = nodes[i];
     }
-    return result;
+    prev->next = node_;
+    node_->prev = prev;
 }
 
 // 重载比较操作符
 // operator== (removed in C++20)
-template <typename T>
-bool operator==(const list<T>& lhs, const list<T>& rhs){
+template <typename T, size_t ChunkSize>
+bool operator==(const list<T, ChunkSize>& lhs, const list<T, ChunkSize>& rhs){
     auto f1 = lhs.cbegin();
     auto f2 = rhs.cbegin();
     auto l1 = lhs.cend();
@@ -1062,40 +1439,40 @@ bool operator==(const list<T>& lhs, const list<T>& rhs){
 }
 
 // operator!= 同上
-template <typename T>
-bool operator!=(const list<T>& lhs, const list<T>& rhs){
+template <typename T, size_t ChunkSize>
+bool operator!=(const list<T, ChunkSize>& lhs, const list<T, ChunkSize>& rhs){
     return !(lhs == rhs);
 }
 
 // operator< 同上
-template <typename T>
-bool operator<(const list<T>& lhs, const list<T>& rhs){
+template <typename T, size_t ChunkSize>
+bool operator<(const list<T, ChunkSize>& lhs, const list<T, ChunkSize>& rhs){
     return dhsstl::lexicograhical_compare(lhs.cbegin(), lhs.cend(), rhs.cbegin(), rhs.cen());
 }
 
 // operator<=
-template <typename T>
-bool operator<=(const list<T>& lhs, const list<T>& rhs){
+template <typename T, size_t ChunkSize>
+bool operator<=(const list<T, ChunkSize>& lhs, const list<T, ChunkSize>& rhs){
     return !(rhs < lhs);
 }
 
 // operator>
-template <typename T>
-bool operator>(const list<T>& lhs, const list<T>& rhs){
+template <typename T, size_t ChunkSize>
+bool operator>(const list<T, ChunkSize>& lhs, const list<T, ChunkSize>& rhs){
     return rhs < lhs;
 }
 
 // operator>=
-template <typename T>
-bool operator>=(const list<T>& lhs, const list<T>& rhs){
+template <typename T, size_t ChunkSize>
+bool operator>=(const list<T, ChunkSize>& lhs, const list<T, ChunkSize>& rhs){
     return !(lhs < rhs);
 }
 // operator<=> (C++20)
 //      lexicographically compares the values in the list 
 
 // std::swap(std::list) :: specializes the std::swap algo
-template <typename T>
-void swap(list<T>& lhs, list<T>& rhs) noexcept{
+template <typename T, size_t ChunkSize>
+void swap(list<T, ChunkSize>& lhs, list<T, ChunkSize>& rhs) noexcept{
     lhs.swap(rhs);
 }
 // erase(std::list) erase_if :: erases all elements satisfying specific criteria
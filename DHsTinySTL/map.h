@@ -20,8 +20,10 @@ namespace dhsstl{
  * @tparam Key 键值类型
  * @tparam T   value类型
  * @tparam Compare 键值的比较方式, 缺省使用 dhsstl::lsee
+ * @tparam Alloc 分配器, 见 rb_tree
 */
-template <typename Key, typename T, typename Compare = dhsstl::less<Key>>
+template <typename Key, typename T, typename Compare = dhsstl::less<Key>,
+          typename Alloc = dhsstl::allocator<dhsstl::pair<const Key, T>>>
 class map{
 public:
     // map 的嵌套型别定义    
@@ -32,7 +34,7 @@ public:
 
     // 定义一个 functor, 用来进行元素比较
     class value_compare : public binary_function<value_type, value_type, bool>{
-        friend class map<Key, T, Compare>;
+        friend class map<Key, T, Compare, Alloc>;
     private:
         Compare comp;
         value_compare(Compare c): comp(c) {}
@@ -44,7 +46,7 @@ public:
 
 private:
     // 以 dhsstl::rb_tree 作为底层机制
-    typedef dhsstl::rb_tree<value_type, key_compare> base_type;
+    typedef dhsstl::rb_tree<value_type, key_compare, Alloc> base_type;
     base_type tree_;
 
 public:
@@ -233,39 +235,39 @@ public:
     friend bool operator< (const map& lhs, const map& rhs){ return lhs.tree_ <  rhs.tree_; }
 };
 // 重载比较操作符
-template <typename Key, typename T, typename Compare>
-bool operator==(const map<Key, T, Compare>& lhs, const map<Key, T, Compare>& rhs){
+template <typename Key, typename T, typename Compare, typename Alloc>
+bool operator==(const map<Key, T, Compare, Alloc>& lhs, const map<Key, T, Compare, Alloc>& rhs){
     return lhs == rhs;
 }
 
-template <typename Key, typename T, typename Compare>
-bool operator<(const map<Key, T, Compare>& lhs, const map<Key, T, Compare>& rhs){
+template <typename Key, typename T, typename Compare, typename Alloc>
+bool operator<(const map<Key, T, Compare, Alloc>& lhs, const map<Key, T, Compare, Alloc>& rhs){
     return lhs < rhs;
 }
 
-template <typename Key, typename T, typename Compare>
-bool operator!=(const map<Key, T, Compare>& lhs, const map<Key, T, Compare>& rhs){
+template <typename Key, typename T, typename Compare, typename Alloc>
+bool operator!=(const map<Key, T, Compare, Alloc>& lhs, const map<Key, T, Compare, Alloc>& rhs){
     return !(lhs == rhs);
 }
 
-template <typename Key, typename T, typename Compare>
-bool operator>(const map<Key, T, Compare>& lhs, const map<Key, T, Compare>& rhs){
+template <typename Key, typename T, typename Compare, typename Alloc>
+bool operator>(const map<Key, T, Compare, Alloc>& lhs, const map<Key, T, Compare, Alloc>& rhs){
     return rhs < lhs;
 }
 
-template <typename Key, typename T, typename Compare>
-bool operator<=(const map<Key, T, Compare>& lhs, const map<Key, T, Compare>& rhs){
+template <typename Key, typename T, typename Compare, typename Alloc>
+bool operator<=(const map<Key, T, Compare, Alloc>& lhs, const map<Key, T, Compare, Alloc>& rhs){
     return !(rhs < lhs);
 }
 
-template <typename Key, typename T, typename Compare>
-bool operator>=(const map<Key, T, Compare>& lhs, const map<Key, T, Compare>& rhs){
+template <typename Key, typename T, typename Compare, typename Alloc>
+bool operator>=(const map<Key, T, Compare, Alloc>& lhs, const map<Key, T, Compare, Alloc>& rhs){
     return !(lhs < rhs);
 }
 
 // 重载 dhsstl 的 swap
-template<typename Key, typename T, typename Compare>
-void swap(map<Key, T, Compare>& lhs, map<Key, T, Compare>& rhs) noexcept{
+template<typename Key, typename T, typename Compare, typename Alloc>
+void swap(map<Key, T, Compare, Alloc>& lhs, map<Key, T, Compare, Alloc>& rhs) noexcept{
     lhs.swap(rhs);
 }
 
@@ -274,8 +276,10 @@ void swap(map<Key, T, Compare>& lhs, map<Key, T, Compare>& rhs) noexcept{
  * @tparam Key 键值类型
  * @tparam T   value类型
  * @tparam Compare 键值的比较方式, 缺省使用 dhsstl::lsee
+ * @tparam Alloc 分配器, 见 rb_tree
 */
-template <typename Key, typename T, typename Compare = dhsstl::less<Key>>
+template <typename Key, typename T, typename Compare = dhsstl::less<Key>,
+          typename Alloc = dhsstl::allocator<dhsstl::pair<const Key, T>>>
 class multimap{
 public:
     // multimap 的嵌套型别定义    
@@ -288,7 +292,7 @@ public:
 
     // 定义一个 functor, 用来进行元素比较
     class value_compare : public binary_function<value_type, value_type, bool>{
-        friend class multimap<Key, T, Compare>;
+        friend class multimap<Key, T, Compare, Alloc>;
     private:
         Compare comp;
         value_compare(Compare c): comp(c) {}
@@ -300,7 +304,7 @@ public:
 
 private:
     // 以 dhsstl::rb_tree 作为底层机制
-    typedef dhsstl::rb_tree<value_type, key_compare> base_type;
+    typedef dhsstl::rb_tree<value_type, key_compare, Alloc> base_type;
     base_type tree_;
 
 public:
@@ -458,39 +462,39 @@ public:
     friend bool operator< (const multimap& lhs, const multimap& rhs){ return lhs.tree_ <  rhs.tree_; }
 };
 // 重载比较操作符
-template <typename Key, typename T, typename Compare>
-bool operator==(const multimap<Key, T, Compare>& lhs, const multimap<Key, T, Compare>& rhs){
+template <typename Key, typename T, typename Compare, typename Alloc>
+bool operator==(const multimap<Key, T, Compare, Alloc>& lhs, const multimap<Key, T, Compare, Alloc>& rhs){
     return lhs == rhs;
 }
 
-template <typename Key, typename T, typename Compare>
-bool operator<(const multimap<Key, T, Compare>& lhs, const multimap<Key, T, Compare>& rhs){
+template <typename Key, typename T, typename Compare, typename Alloc>
+bool operator<(const multimap<Key, T, Compare, Alloc>& lhs, const multimap<Key, T, Compare, Alloc>& rhs){
     return lhs < rhs;
 }
 
-template <typename Key, typename T, typename Compare>
-bool operator!=(const multimap<Key, T, Compare>& lhs, const multimap<Key, T, Compare>& rhs){
+template <typename Key, typename T, typename Compare, typename Alloc>
+bool operator!=(const multimap<Key, T, Compare, Alloc>& lhs, const multimap<Key, T, Compare, Alloc>& rhs){
     return !(lhs == rhs);
 }
 
-template <typename Key, typename T, typename Compare>
-bool operator>(const multimap<Key, T, Compare>& lhs, const multimap<Key, T, Compare>& rhs){
+template <typename Key, typename T, typename Compare, typename Alloc>
+bool operator>(const multimap<Key, T, Compare, Alloc>& lhs, const multimap<Key, T, Compare, Alloc>& rhs){
     return rhs < lhs;
 }
 
-template <typename Key, typename T, typename Compare>
-bool operator<=(const multimap<Key, T, Compare>& lhs, const multimap<Key, T, Compare>& rhs){
+template <typename Key, typename T, typename Compare, typename Alloc>
+bool operator<=(const multimap<Key, T, Compare, Alloc>& lhs, const multimap<Key, T, Compare, Alloc>& rhs){
     return !(rhs < lhs);
 }
 
-template <typename Key, typename T, typename Compare>
-bool operator>=(const multimap<Key, T, Compare>& lhs, const multimap<Key, T, Compare>& rhs){
+template <typename Key, typename T, typename Compare, typename Alloc>
+bool operator>=(const multimap<Key, T, Compare, Alloc>& lhs, const multimap<Key, T, Compare, Alloc>& rhs){
     return !(lhs < rhs);
 }
 
 // 重载 dhsstl 的 swap
-template<typename Key, typename T, typename Compare>
-void swap(multimap<Key, T, Compare>& lhs, multimap<Key, T, Compare>& rhs) noexcept{
+template<typename Key, typename T, typename Compare, typename Alloc>
+void swap(multimap<Key, T, Compare, Alloc>& lhs, multimap<Key, T, Compare, Alloc>& rhs) noexcept{
     lhs.swap(rhs);
 }
 
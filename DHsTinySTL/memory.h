@@ -7,14 +7,19 @@
 #include <cstddef>
 #include <cstdlib>
 #include <climits>
+#include <cstdint>
+#include <cassert>
 #include <atomic>
+#include <memory>
+#include <new>
+#include <type_traits>
 
 #include "algobase.h"
 #include "allocator.h"
 #include "construct.h"
 #include "uninitialized.h"
 #include "util.h"
-//#include "Detail/ref.h"
+#include "Detail/ref.h"
 
 namespace dhsstl{
 
@@ -25,16 +30,121 @@ constexpr Tp* address_of(Tp& value) noexcept{
 }
 
 // 获取 / 释放 临时缓冲区
-// 这里 确定了一个缓冲区的 最大大小: INT_MAX 也就是说这个缓冲区不能占用
-// INT_MAX的内存? 这是为什么?
-// 估计是 malloc 的问题 !!! Q:
-// 申请一个缓冲区
+// 缓冲区的字节数不超过 PTRDIFF_MAX, 这样元素个数和指针之差都可以用 ptrdiff_t 表示
+// (早期的实现限制为 INT_MAX 字节, 对 radix_sort 之类需要与输入一样大的缓冲区的算法, 2GB 不够用)
+//
+// 每个线程保留一块 scratch arena, 归还之后下一次申请直接复用, 容量不够时按 2 倍增长,
+// stable_sort 之类反复申请缓冲区的算法不再每次调用 malloc / free
+// arena 同一时间只借出一块, 嵌套申请以及超过 DHSSTL_SCRATCH_ARENA_LIMIT 的申请仍然调用 malloc
+
+// 每个线程的 arena 保留的最大字节数
+#ifndef DHSSTL_SCRATCH_ARENA_LIMIT
+#define DHSSTL_SCRATCH_ARENA_LIMIT (static_cast<size_t>(16) << 20)
+#endif
+
+namespace detail
+{
+
+inline void* align_up(void* p, size_t align) noexcept{
+    const uintptr_t v = reinterpret_cast<uintptr_t>(p);
+    return reinterpret_cast<void*>((v + align - 1) & ~static_cast<uintptr_t>(align - 1));
+}
+
+// 线程私有的临时缓冲区
+class scratch_arena
+{
+    void*  block_ = nullptr;
+    size_t cap_   = 0;
+    void*  lent_  = nullptr;     // 当前借出的指针
+    size_t limit_ = DHSSTL_SCRATCH_ARENA_LIMIT;
+
+public:
+    scratch_arena() = default;
+    scratch_arena(const scratch_arena&) = delete;
+    scratch_arena& operator=(const scratch_arena&) = delete;
+    ~scratch_arena() { std::free(block_); }
+
+    static scratch_arena& local() noexcept{
+        static thread_local scratch_arena arena;
+        return arena;
+    }
+
+    // 返回按 align 对齐的 bytes 字节, 已经借出或者超过上限时返回 nullptr
+    void* acquire(size_t bytes, size_t align) noexcept{
+        const size_t pad = align > alignof(std::max_align_t) ? align - 1 : 0;
+        if(lent_ != nullptr || bytes > limit_ || bytes + pad > limit_)
+            return nullptr;
+        const size_t need = bytes + pad;
+        if(need > cap_){
+            const size_t new_cap = dhsstl::max(need, dhsstl::min(cap_ * 2, limit_));
+            std::free(block_);
+            block_ = std::malloc(new_cap);
+            cap_ = block_ == nullptr ? 0 : new_cap;
+            if(block_ == nullptr)
+                return nullptr;
+        }
+        lent_ = align_up(block_, align);
+        return lent_;
+    }
+
+    // p 是 arena 借出的缓冲区时返回 true
+    bool release(void* p) noexcept{
+        if(p == nullptr || p != lent_)
+            return false;
+        lent_ = nullptr;
+        return true;
+    }
+
+    // 释放保留的内存, 借出期间不释放
+    void trim() noexcept{
+        if(lent_ != nullptr)
+            return;
+        std::free(block_);
+        block_ = nullptr;
+        cap_ = 0;
+    }
+
+    void set_limit(size_t bytes) noexcept{
+        limit_ = bytes;
+        if(cap_ > bytes)
+            trim();
+    }
+
+    size_t capacity() const noexcept { return cap_; }
+};
+
+// arena 提供不了时用 malloc 申请, 在返回的指针前保存 malloc 得到的地址, 释放时据此调用 free
+inline void* scratch_malloc(size_t bytes, size_t align) noexcept{
+    const size_t offset = align > alignof(std::max_align_t) ? align : alignof(std::max_align_t);
+    if(bytes > SIZE_MAX - offset)
+        return nullptr;
+    void* raw = std::malloc(bytes + offset);
+    if(raw == nullptr)
+        return nullptr;
+    void* p = align_up(static_cast<char*>(raw) + sizeof(void*), align);
+    static_cast<void**>(p)[-1] = raw;
+    return p;
+}
+
+inline void scratch_free(void* p) noexcept{
+    if(p != nullptr)
+        std::free(static_cast<void**>(p)[-1]);
+}
+
+} // namespace detail
+
+// 申请一个缓冲区, 先从本线程的 arena 中获取, 否则 malloc, 失败时减少 len 的大小
 template <typename T>
-pair<T*, ptrdiff_t> get_buffer_helper(ptrdiff_t len, T*){
-    if (len > static_cast<ptrdiff_t>(INT_MAX / sizeof(T)))
-        len = INT_MAX / sizeof(T);
+pair<T*, ptrdiff_t> get_buffer_helper(ptrdiff_t len, T*, size_t align = alignof(T)){
+    if (len > static_cast<ptrdiff_t>(PTRDIFF_MAX / sizeof(T)))
+        len = PTRDIFF_MAX / sizeof(T);
+    if (len <= 0)
+        return pair<T*, ptrdiff_t>(nullptr, 0);
+    void* p = detail::scratch_arena::local().acquire(static_cast<size_t>(len) * sizeof(T), align);
+    if(p)
+        return pair<T*, ptrdiff_t>(static_cast<T*>(p), len);
     while (len > 0){
-        T* tmp = static_cast<T*>(malloc(static_cast<size_t>(len) * sizeof(T)));
+        T* tmp = static_cast<T*>(detail::scratch_malloc(static_cast<size_t>(len) * sizeof(T), align));
         if(tmp)
             return pair<T*, ptrdiff_t>(tmp, len);
         len /= 2; // 申请失败时减少len的大小
@@ -52,9 +162,28 @@ pair<T*, ptrdiff_t> get_temporary_buffer(ptrdiff_t len, T*){
     return get_buffer_helper(len, static_cast<T*>(0));
 }
 
+// 按 align 对齐的缓冲区, align 为 2 的幂且不小于 alignof(T), 例如 64 用于按 cache line 对齐
+template <typename T>
+pair<T*, ptrdiff_t> get_aligned_temporary_buffer(ptrdiff_t len, size_t align){
+    assert(align != 0 && (align & (align - 1)) == 0 && align >= alignof(T));
+    return get_buffer_helper(len, static_cast<T*>(0), align);
+}
+
+// 只能释放 get_temporary_buffer / get_aligned_temporary_buffer 得到的缓冲区, 且必须在同一个线程中释放
 template <typename T>
 void release_temporary_buffer(T* ptr){
-    free(ptr);
+    if(!detail::scratch_arena::local().release(ptr))
+        detail::scratch_free(ptr);
+}
+
+// 释放本线程 arena 保留的内存
+inline void trim_temporary_buffer() noexcept{
+    detail::scratch_arena::local().trim();
+}
+
+// 设置本线程 arena 保留的最大字节数, 0 表示不使用 arena, 每次都调用 malloc
+inline void set_temporary_buffer_limit(size_t bytes) noexcept{
+    detail::scratch_arena::local().set_limit(bytes);
 }
 
 // ---------------------------------------------------------
@@ -72,7 +201,7 @@ public:
     temporary_buffer(ForwardIterator first, ForwardIterator last);
     ~temporary_buffer(){
         dhsstl::destroy(buffer, buffer+len);
-        free(buffer);
+        dhsstl::release_temporary_buffer(buffer);
     }
 
 public:
@@ -97,7 +226,8 @@ private:
 // 构造函数
 template <typename ForwardIterator, typename T>
 temporary_buffer<ForwardIterator, T>::
-temporary_buffer(ForwardIterator first, ForwardIterator last){
+temporary_buffer(ForwardIterator first, ForwardIterator last)
+    : original_len(0), len(0), buffer(nullptr){
     try{
         len = dhsstl::distance(first, last);
         allocate_buffer();
@@ -105,7 +235,7 @@ temporary_buffer(ForwardIterator first, ForwardIterator last){
             initialize_buffer(*first, std::is_trivially_default_constructible<T>());
         }
     }catch(...){
-        free(buffer);
+        dhsstl::release_temporary_buffer(buffer);
         buffer = nullptr;
         len = 0;
     }
@@ -115,14 +245,9 @@ temporary_buffer(ForwardIterator first, ForwardIterator last){
 template <typename ForwardIterator, typename T>
 void temporary_buffer<ForwardIterator, T>::allocate_buffer(){
     original_len = len;
-    if(len > static_cast<ptrdiff_t>(INT_MAX / sizeof(T)))
-        len = INT_MAX / sizeof(T);
-    while(len > 0){
-        buffer = static_cast<T*>(malloc(len * sizeof(T)));
-        if(buffer)
-            break;
-        len /= 2; // 申请失败时减少申请空间
-    }
+    pair<T*, ptrdiff_t> result = dhsstl::get_temporary_buffer<T>(len);
+    buffer = result.first;
+    len = result.second;
 }
 
 // ------------------------------------------------------
@@ -285,38 +410,43 @@ unique_ptr<T> make_unique(Args&&... args){
     return unique_ptr<T>(new T(dhsstl::forward<Args>(args)...));
 }
 
-// 计数类
-struct prt_count{
-    prt_count():ncount_(0), wcount_(0){}
-    std::atomic<size_t> ncount_;
-    std::atomic<size_t> wcount_;
-};
+template<typename T, typename Counter> class shared_ptr;
 
+namespace detail
+{
 
-template<typename T> class shared_ptr;
+// shared_ptr 内部使用的构造函数的标签
+struct sp_block_tag {};
+
+template<class T, class Counter, class Alloc, class... Args>
+dhsstl::shared_ptr<T, Counter> allocate_shared_impl(Args&&... args);
+
+} // namespace detail
+
+template<typename T, typename Counter = thread_safe_counter> class shared_ptr;
 /**
  * @brief weak_ptr
  * 弱共享指针, 由shared_ptr初始化
  * 不增加管理资源的指针计数, 当管理资源的shared_ptr计数清零后将组织访问资源
  * @tparam T
+ * @tparam Counter 引用计数策略, 与对应的 shared_ptr 相同
  */
-template<typename T>
+template<typename T, typename Counter = thread_safe_counter>
 class weak_ptr{
-    template <typename U> friend class shared_ptr;
+    template <typename U, typename C> friend class shared_ptr;
 
 public:
     weak_ptr() = default;
     weak_ptr(const weak_ptr& rhs): _data(rhs._data), _ptr_count(rhs._ptr_count){
-        if(_ptr_count) ++_ptr_count->wcount_;
+        if(_ptr_count) _ptr_count->add_weak_ref();
     }
 
-    weak_ptr(const shared_ptr<T>& rhs): _data(rhs._data), _ptr_count(rhs._ptr_count){
-        if(_ptr_count) ++_ptr_count->wcount_;
+    weak_ptr(const shared_ptr<T, Counter>& rhs): _data(rhs._data), _ptr_count(rhs._ptr_count){
+        if(_ptr_count) _ptr_count->add_weak_ref();
     }
 
     weak_ptr(weak_ptr&& rhs) noexcept{
         swap(rhs);
-        rhs.reset();
     }
 
     weak_ptr& operator=(const weak_ptr& rhs) noexcept{
@@ -326,7 +456,7 @@ public:
     }
 
     weak_ptr& operator=(weak_ptr&& rhs) noexcept{
-        weak_ptr tmp(dhsstl::move(this));
+        weak_ptr tmp(dhsstl::move(rhs));
         swap(tmp);
         return *this;
     }
@@ -342,48 +472,53 @@ public:
     }
 
     int use_count() const noexcept{
-        return _data == nullptr ? 0 : _ptr_count->ncount_.load();
+        return _ptr_count == nullptr ? 0 : static_cast<int>(_ptr_count->use_count());
     }
 
     bool expired() const noexcept{ return use_count() == 0; }
 
-    shared_ptr<T> lock(){
-        return expired() ? shared_ptr<T>() : shared_ptr<T>(*this);
+    shared_ptr<T, Counter> lock() const noexcept{
+        return shared_ptr<T, Counter>(*this);
     }
-private:
+
     void swap(weak_ptr& rhs) noexcept{
         dhsstl::swap(_data, rhs._data);
         dhsstl::swap(_ptr_count, rhs._ptr_count);
     }
 
-    void release(){
-        if(_ptr_count){
-            if(_ptr_count->ncount_ == 0 && --_ptr_count->wcount_ == 0){
-                delete _ptr_count;
-                _ptr_count = nullptr;
-            }
-        }
+private:
+    void release() noexcept{
+        if(_ptr_count)
+            _ptr_count->weak_release();
     }
 private:
     T* _data = nullptr;
-    prt_count* _ptr_count = nullptr;
+    prt_count<Counter>* _ptr_count = nullptr;
 };
 /*!
  * @brief shared_ptr
  * 允许多个智能指针同时指向一个底部资源
+ * shared_ptr(p) 分别分配对象和控制块, make_shared / allocate_shared 把对象放在控制块中, 只分配一次
+ * shared_ptr(p, d[, alloc]) 的对象可以来自对象池或者 arena, 由 d 归还
  * @tparam T 只能指针所指的类型
+ * @tparam Counter 引用计数策略, 默认为原子计数, 见 thread_safe_counter / local_shared_ptr
  */
-template<typename T>
+template<typename T, typename Counter>
 class shared_ptr{
-    template<typename U> friend class weak_ptr;
+    template<typename U, typename C> friend class weak_ptr;
+    template<typename U, typename C, typename Alloc, typename... Args>
+    friend shared_ptr<U, C> detail::allocate_shared_impl(Args&&...);
 public:
     typedef T              element_type;
 
 public:
-    explicit shared_ptr(T* p = nullptr) : _data(p){
+    shared_ptr() noexcept = default;
+    shared_ptr(std::nullptr_t) noexcept {}
+
+    explicit shared_ptr(T* p) : _data(p){
         if(p){
             try{
-                _ptr_count = new prt_count();
+                _ptr_count = new prt_count_ptr<T, Counter>(p);
             }
             catch(...){
                 delete p;
@@ -392,27 +527,56 @@ public:
         }
     }
 
-    // template<class D>
-    // shared_ptr(T *p, D del) : ref_t(new ref_t<T>(p, del)){}
+    // 由 d(p) 释放对象, 控制块 Detail::ref_t 由 Alloc 分配, 除控制块外不再有其他的分配
+    // 分配或构造控制块失败时调用 d(p) 后抛出异常
+    template<class D>
+    shared_ptr(T* p, D d) : shared_ptr(p, dhsstl::move(d), dhsstl::allocator<T>()){}
 
-    shared_ptr(const shared_ptr& sp) : _data(sp._data), _ptr_count(sp._ptr_count){
-        if(_ptr_count) ++_ptr_count->ncount_;
+    template<class D, class Alloc>
+    shared_ptr(T* p, D d, const Alloc&) : _data(p){
+        typedef Detail::ref_t<T, D, Alloc, Counter>     block_type;
+        typedef typename block_type::block_allocator    block_allocator;
+        block_type* block = nullptr;
+        try{
+            block = block_allocator::allocate(1);
+        }
+        catch(...){
+            d(p);
+            throw;
+        }
+        // 构造控制块时移动 d 也可能抛出异常, 同样归还内存并调用 d(p)
+        try{
+            ::new (static_cast<void*>(block)) block_type(p, dhsstl::move(d));
+        }
+        catch(...){
+            block_allocator::deallocate(block);
+            d(p);
+            throw;
+        }
+        _ptr_count = block;
+    }
+
+    shared_ptr(const shared_ptr& sp) noexcept : _data(sp._data), _ptr_count(sp._ptr_count){
+        if(_ptr_count) _ptr_count->add_ref();
     }
     shared_ptr(shared_ptr&& sp) noexcept{
-        swap(this);
-        sp.reset();
+        swap(sp);
     }
-    explicit shared_ptr(const weak_ptr<T>& wp) : _data(wp._data), _ptr_count(wp._ptr_count){
-        if(_ptr_count) ++_ptr_count->ncount_;
+    // wp 已经失效时得到空的 shared_ptr
+    explicit shared_ptr(const weak_ptr<T, Counter>& wp) noexcept{
+        if(wp._ptr_count && wp._ptr_count->add_ref_lock()){
+            _data = wp._data;
+            _ptr_count = wp._ptr_count;
+        }
     }
 
-    shared_ptr& operator=( const shared_ptr& sp){
+    shared_ptr& operator=(const shared_ptr& sp) noexcept{
         shared_ptr tmp(sp);
         swap(tmp);
         return *this;
     }
     shared_ptr& operator=(shared_ptr&& sp) noexcept{
-        shared_ptr tmp(sp);
+        shared_ptr tmp(dhsstl::move(sp));
         swap(tmp);
         return *this;
     }
@@ -420,10 +584,10 @@ public:
     ~shared_ptr() { release(); }
 
     bool unique() const noexcept{
-        return _data != nullptr && _ptr_count->ncount_.load() == 1;
+        return use_count() == 1;
     }
-    int use_count() const {
-        return _data == nullptr ? 0 : _ptr_count->ncount_.load();
+    int use_count() const noexcept{
+        return _ptr_count == nullptr ? 0 : static_cast<int>(_ptr_count->use_count());
     }
 
     element_type&       operator*()             { assert(*this); return *(get()); }
@@ -434,74 +598,300 @@ public:
     element_type*       get()       { return _data; }
     const element_type* get() const { return  _data; }
 
-    void reset(){
+    void reset() noexcept{
         release();
         _data = nullptr;
         _ptr_count = nullptr;
     }
 
     void reset(T* data){
-        reset();
         shared_ptr tmp(data);
         swap(tmp);
     }
 
     operator bool() const { return get() != nullptr;}
-private:
-    void swap(shared_ptr& rhs){
+
+    void swap(shared_ptr& rhs) noexcept{
         dhsstl::swap(_data, rhs._data);
         dhsstl::swap(_ptr_count, rhs._ptr_count);
     }
 
-    void release(){
-        if(_ptr_count){
-            if(--_ptr_count->ncount_ == 0){
-                delete _data;
-                _data = nullptr;
-                if(_ptr_count->wcount_.load() == 0){
-                    delete _ptr_count;
-                    _ptr_count = nullptr;
-                }
-            }
-        }
+private:
+    // 接管已经构造好对象的控制块, 计数已经为 1
+    shared_ptr(detail::sp_block_tag, T* p, prt_count<Counter>* count) noexcept
+        : _data(p), _ptr_count(count){}
+
+    void release() noexcept{
+        if(_ptr_count)
+            _ptr_count->release();
     }
 
 private:
-    // ref_t<T> *ref_;
     T* _data = nullptr;
-    prt_count* _ptr_count = nullptr;
+    prt_count<Counter>* _ptr_count = nullptr;
 };
 
-template<class T1, class T2>
-bool operator==(const shared_ptr<T1>& lhs, const shared_ptr<T2>& rhs){
+// 只在一个线程中使用的 shared_ptr, 引用计数是普通整数, 复制和销毁不需要原子操作
+// 不能与 shared_ptr<T> 相互转换, 也不能跨线程共享同一个对象
+template<typename T>
+using local_shared_ptr = shared_ptr<T, thread_unsafe_counter>;
+template<typename T>
+using local_weak_ptr = weak_ptr<T, thread_unsafe_counter>;
+
+template<class T1, class C1, class T2, class C2>
+bool operator==(const shared_ptr<T1, C1>& lhs, const shared_ptr<T2, C2>& rhs){
     return lhs.get() == rhs.get();
 }
-template<class T1, class T2>
-bool operator!=(const shared_ptr<T1>& lhs, const shared_ptr<T2>& rhs){
+template<class T1, class C1, class T2, class C2>
+bool operator!=(const shared_ptr<T1, C1>& lhs, const shared_ptr<T2, C2>& rhs){
     return !(lhs == rhs);
 }
-template<class T>
-bool operator==(const shared_ptr<T>& sh, std::nullptr_t p){
+template<class T, class C>
+bool operator==(const shared_ptr<T, C>& sh, std::nullptr_t p){
     return sh.get() == p;
 }
-template<class T>
-bool operator==(std::nullptr_t p, const shared_ptr<T>& sh){
+template<class T, class C>
+bool operator==(std::nullptr_t p, const shared_ptr<T, C>& sh){
     return sh.get() == p;
 }
-template<class T>
-bool operator!=(const shared_ptr<T>& sh, std::nullptr_t p){
+template<class T, class C>
+bool operator!=(const shared_ptr<T, C>& sh, std::nullptr_t p){
     return sh.get() != p;
 }
-template<class T>
-bool operator!=(std::nullptr_t p, const shared_ptr<T>& sh){
+template<class T, class C>
+bool operator!=(std::nullptr_t p, const shared_ptr<T, C>& sh){
     return sh.get() != p;
 }
 
+template<class T, class C>
+void swap(shared_ptr<T, C>& lhs, shared_ptr<T, C>& rhs) noexcept{
+    lhs.swap(rhs);
+}
+template<class T, class C>
+void swap(weak_ptr<T, C>& lhs, weak_ptr<T, C>& rhs) noexcept{
+    lhs.swap(rhs);
+}
+
+namespace detail
+{
+
+// 用 Alloc 分配一个同时容纳控制块和对象的内存块, 在其中构造 T(args...)
+template<class T, class Counter, class Alloc, class... Args>
+shared_ptr<T, Counter> allocate_shared_impl(Args&&... args){
+    typedef prt_count_inplace<T, Alloc, Counter>    block_type;
+    typedef typename block_type::block_allocator    block_allocator;
+    block_type* block = block_allocator::allocate(1);
+    ::new (static_cast<void*>(block)) block_type();
+    try{
+        dhsstl::construct(block->ptr(), dhsstl::forward<Args>(args)...);
+    }
+    catch(...){
+        block->~block_type();
+        block_allocator::deallocate(block);
+        throw;
+    }
+    return shared_ptr<T, Counter>(detail::sp_block_tag(), block->ptr(), block);
+}
+
+} // namespace detail
+
+// Alloc 为静态接口的分配器(如 dhsstl::allocator<T>), 参数 alloc 只用来推导类型
+template<class T, class Alloc, class... Args>
+shared_ptr<T> allocate_shared(const Alloc&, Args&&... args){
+    return detail::allocate_shared_impl<T, thread_safe_counter, Alloc>(dhsstl::forward<Args>(args)...);
+}
+
+template<class T, class... Args>
+shared_ptr<T> make_shared(Args&&... args){
+    return detail::allocate_shared_impl<T, thread_safe_counter, dhsstl::allocator<T>>(dhsstl::forward<Args>(args)...);
+}
+
+template<class T, class Alloc, class... Args>
+local_shared_ptr<T> allocate_local_shared(const Alloc&, Args&&... args){
+    return detail::allocate_shared_impl<T, thread_unsafe_counter, Alloc>(dhsstl::forward<Args>(args)...);
+}
+
 template<class T, class... Args>
-shared_ptr<T> make_shared(Args... args){
-    return shared_ptr<T>(new T(std::forward<Args>(args)...));
+local_shared_ptr<T> make_local_shared(Args&&... args){
+    return detail::allocate_shared_impl<T, thread_unsafe_counter, dhsstl::allocator<T>>(dhsstl::forward<Args>(args)...);
 }
 
+// ------------------------------------------------------
+// 模板类: intrusive_ptr
+// 引用计数保存在对象内部的智能指针, 大小与裸指针相同, 计数和数据在同一块内存中
+// 通过 ADL 查找的两个函数管理计数:
+//   intrusive_ptr_add_ref(T* p)   引用计数加一
+//   intrusive_ptr_release(T* p)   引用计数减一, 减到 0 时释放对象
+// 类型可以自己提供这两个函数, 也可以继承 intrusive_ref_counter
+template<typename T>
+class intrusive_ptr{
+    template<typename U> friend class intrusive_ptr;
+public:
+    typedef T              element_type;
+
+public:
+    intrusive_ptr() noexcept = default;
+    intrusive_ptr(std::nullptr_t) noexcept {}
+
+    // add_ref 为 false 时接管 p 已有的一个引用, 例如 detach() 得到的指针
+    intrusive_ptr(T* p, bool add_ref = true) : _data(p){
+        if(_data && add_ref) intrusive_ptr_add_ref(_data);
+    }
+
+    intrusive_ptr(const intrusive_ptr& rhs) : _data(rhs._data){
+        if(_data) intrusive_ptr_add_ref(_data);
+    }
+    template<typename U, typename = typename std::enable_if<std::is_convertible<U*, T*>::value>::type>
+    intrusive_ptr(const intrusive_ptr<U>& rhs) : _data(rhs._data){
+        if(_data) intrusive_ptr_add_ref(_data);
+    }
+
+    intrusive_ptr(intrusive_ptr&& rhs) noexcept : _data(rhs._data){
+        rhs._data = nullptr;
+    }
+    template<typename U, typename = typename std::enable_if<std::is_convertible<U*, T*>::value>::type>
+    intrusive_ptr(intrusive_ptr<U>&& rhs) noexcept : _data(rhs._data){
+        rhs._data = nullptr;
+    }
+
+    intrusive_ptr& operator=(const intrusive_ptr& rhs){
+        intrusive_ptr tmp(rhs);
+        swap(tmp);
+        return *this;
+    }
+    intrusive_ptr& operator=(intrusive_ptr&& rhs) noexcept{
+        intrusive_ptr tmp(dhsstl::move(rhs));
+        swap(tmp);
+        return *this;
+    }
+    intrusive_ptr& operator=(T* p){
+        intrusive_ptr tmp(p);
+        swap(tmp);
+        return *this;
+    }
+
+    ~intrusive_ptr(){
+        if(_data) intrusive_ptr_release(_data);
+    }
+
+    void reset() noexcept{
+        intrusive_ptr tmp;
+        swap(tmp);
+    }
+    void reset(T* p, bool add_ref = true){
+        intrusive_ptr tmp(p, add_ref);
+        swap(tmp);
+    }
+
+    // 放弃所有权但不减少计数, 由调用者负责之后的 intrusive_ptr_release
+    T* detach() noexcept{
+        T* p = _data;
+        _data = nullptr;
+        return p;
+    }
+
+    T& operator*()  const { assert(_data); return *_data; }
+    T* operator->() const { return _data; }
+    T* get()        const noexcept { return _data; }
+
+    explicit operator bool() const noexcept { return _data != nullptr; }
+
+    void swap(intrusive_ptr& rhs) noexcept{
+        dhsstl::swap(_data, rhs._data);
+    }
+
+private:
+    T* _data = nullptr;
+};
+
+template<class T, class U>
+bool operator==(const intrusive_ptr<T>& lhs, const intrusive_ptr<U>& rhs){
+    return lhs.get() == rhs.get();
+}
+template<class T, class U>
+bool operator!=(const intrusive_ptr<T>& lhs, const intrusive_ptr<U>& rhs){
+    return lhs.get() != rhs.get();
+}
+template<class T>
+bool operator<(const intrusive_ptr<T>& lhs, const intrusive_ptr<T>& rhs){
+    return lhs.get() < rhs.get();
+}
+template<class T>
+bool operator==(const intrusive_ptr<T>& p, std::nullptr_t){
+    return p.get() == nullptr;
+}
+template<class T>
+bool operator==(std::nullptr_t, const intrusive_ptr<T>& p){
+    return p.get() == nullptr;
+}
+template<class T>
+bool operator!=(const intrusive_ptr<T>& p, std::nullptr_t){
+    return p.get() != nullptr;
+}
+template<class T>
+bool operator!=(std::nullptr_t, const intrusive_ptr<T>& p){
+    return p.get() != nullptr;
+}
+
+template<class T>
+void swap(intrusive_ptr<T>& lhs, intrusive_ptr<T>& rhs) noexcept{
+    lhs.swap(rhs);
+}
+
+template<class T, class... Args>
+intrusive_ptr<T> make_intrusive(Args&&... args){
+    return intrusive_ptr<T>(new T(dhsstl::forward<Args>(args)...));
+}
+
+/**
+ * @brief intrusive_ref_counter
+ * 为派生类 T 提供引用计数以及 intrusive_ptr_add_ref / intrusive_ptr_release, 用法:
+ *     struct node : dhsstl::intrusive_ref_counter<node> { ... };
+ * 计数为 0 时通过 delete static_cast<const T*>(p) 释放对象, 不需要虚析构函数
+ * 复制对象时不复制计数, 新对象的计数从 0 开始
+ * @tparam T 派生类
+ * @tparam Counter 引用计数策略, thread_safe_counter 或 thread_unsafe_counter(只在一个线程中使用)
+ */
+template<typename T, typename Counter = thread_safe_counter>
+class intrusive_ref_counter{
+public:
+    intrusive_ref_counter() noexcept : _ref_count(0) {}
+    intrusive_ref_counter(const intrusive_ref_counter&) noexcept : _ref_count(0) {}
+    intrusive_ref_counter& operator=(const intrusive_ref_counter&) noexcept { return *this; }
+
+    size_t use_count() const noexcept { return Counter::load(_ref_count); }
+
+    friend void intrusive_ptr_add_ref(const intrusive_ref_counter* p) noexcept{
+        Counter::increment(p->_ref_count);
+    }
+    friend void intrusive_ptr_release(const intrusive_ref_counter* p) noexcept{
+        if(Counter::decrement(p->_ref_count))
+            delete static_cast<const T*>(p);
+    }
+
+protected:
+    ~intrusive_ref_counter() = default;
+
+private:
+    mutable typename Counter::type _ref_count;
+};
+
+// 智能指针只持有指向堆上对象的指针, 可以按字节搬移
+template<typename T>
+struct is_trivially_relocatable<dhsstl::unique_ptr<T>> : dhsstl::m_true_type {};
+template<typename T, typename C>
+struct is_trivially_relocatable<dhsstl::shared_ptr<T, C>> : dhsstl::m_true_type {};
+template<typename T, typename C>
+struct is_trivially_relocatable<dhsstl::weak_ptr<T, C>> : dhsstl::m_true_type {};
+template<typename T>
+struct is_trivially_relocatable<dhsstl::intrusive_ptr<T>> : dhsstl::m_true_type {};
+template<typename T>
+struct is_trivially_relocatable<std::unique_ptr<T, std::default_delete<T>>> : dhsstl::m_true_type {};
+template<typename T>
+struct is_trivially_relocatable<std::shared_ptr<T>> : dhsstl::m_true_type {};
+template<typename T>
+struct is_trivially_relocatable<std::weak_ptr<T>> : dhsstl::m_true_type {};
+
 
 }//namespace dhsstl
 #endif //!DHSTINYSTL_MEMORY_H_
\ No newline at end of file
@@ -0,0 +1,80 @@
+#ifndef DHSTINYSTL_NUMERIC_H_
+#define DHSTINYSTL_NUMERIC_H_
+
+// 这个头文件包含了 tinystl 的数值算法
+
+#include "iterator.h"
+#include "functional.h"
+#include "util.h"
+
+namespace dhsstl
+{
+
+// ---------------------------------------------------
+// accumulate
+// 以 init 为初值, 从左到右依次对[first, last)区间内的元素进行累加(或 binary_op)
+// ---------------------------------------------------
+template <typename InputIter, typename T>
+T accumulate(InputIter first, InputIter last, T init){
+    for(; first != last; ++first)
+        init = dhsstl::move(init) + *first;
+    return init;
+}
+
+template <typename InputIter, typename T, typename BinaryOp>
+T accumulate(InputIter first, InputIter last, T init, BinaryOp binary_op){
+    for(; first != last; ++first)
+        init = binary_op(dhsstl::move(init), *first);
+    return init;
+}
+
+// ---------------------------------------------------
+// reduce
+// 与 accumulate 相同, 但不保证运算的顺序, 要求 binary_op 满足结合律和交换律
+// 这样带执行策略的版本(见 execution.h)可以分块并行计算, 串行版本可以打破循环依赖, 用多个累加器
+// ---------------------------------------------------
+template <typename InputIter, typename T, typename BinaryOp>
+T reduce_cat(InputIter first, InputIter last, T init, BinaryOp binary_op, dhsstl::input_iterator_tag){
+    return dhsstl::accumulate(first, last, dhsstl::move(init), binary_op);
+}
+
+// 随机访问迭代器版本: 两个互相独立的累加器, 让流水线不用等待上一次运算的结果
+template <typename RandomIter, typename T, typename BinaryOp>
+T reduce_cat(RandomIter first, RandomIter last, T init, BinaryOp binary_op, dhsstl::random_access_iterator_tag){
+    auto n = last - first;
+    if(n < 8)
+        return dhsstl::accumulate(first, last, dhsstl::move(init), binary_op);
+    T s0 = binary_op(first[0], first[1]);
+    T s1 = binary_op(first[2], first[3]);
+    first += 4;
+    n -= 4;
+    for(; n >= 4; n -= 4, first += 4){
+        s0 = binary_op(binary_op(dhsstl::move(s0), first[0]), first[1]);
+        s1 = binary_op(binary_op(dhsstl::move(s1), first[2]), first[3]);
+    }
+    for(; n > 0; --n, ++first)
+        s0 = binary_op(dhsstl::move(s0), *first);
+    return binary_op(dhsstl::move(init), binary_op(dhsstl::move(s0), dhsstl::move(s1)));
+}
+
+template <typename InputIter, typename T, typename BinaryOp>
+T reduce(InputIter first, InputIter last, T init, BinaryOp binary_op){
+    return dhsstl::reduce_cat(first, last, dhsstl::move(init), binary_op, iterator_category(first));
+}
+
+template <typename InputIter, typename T>
+T reduce(InputIter first, InputIter last, T init){
+    return dhsstl::reduce(first, last, dhsstl::move(init), dhsstl::plus<T>());
+}
+
+// 初值为值初始化的 value_type
+template <typename InputIter>
+typename iterator_traits<InputIter>::value_type
+reduce(InputIter first, InputIter last){
+    typedef typename iterator_traits<InputIter>::value_type value_type;
+    return dhsstl::reduce(first, last, value_type());
+}
+
+} // namespace dhsstl
+
+#endif // !DHSTINYSTL_NUMERIC_H_
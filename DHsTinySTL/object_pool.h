@@ -0,0 +1,266 @@
+#ifndef DHSTINYSTL_OBJECT_POOL_H_
+#define DHSTINYSTL_OBJECT_POOL_H_
+
+// 这个头文件包含固定大小对象的内存池 object_pool, 以及基于它的分配器 pool_allocator
+//
+// object_pool<T> : 同一种 T 的所有对象共用一个池, 接口是静态的, 与 dhsstl::allocator 相同
+//  * 每个线程有一个本地的空闲链表, 分配和释放只访问本线程的链表, 不需要同步
+//  * 本地链表达到 2 * Batch 个节点时, 把其中 Batch 个作为一个 magazine 交给全局的 depot;
+//    本地链表为空时先从 depot 取回一个 magazine, depot 也为空时一次申请 Batch 个节点的 chunk
+//  * depot 用互斥量保护, 每次加锁移动一整个 magazine, 锁的开销摊到 Batch 个节点上
+//  * 可以在一个线程中释放另一个线程分配的对象, 节点经由 depot 回到其他线程
+//  * chunk 不归还给系统, 由进程退出回收, 池保留的内存是使用量的峰值
+//  * depot 不会析构, 静态析构期间退出的线程(例如 default_thread_pool 的工作线程)仍然可以交还节点
+//
+// pool_allocator<T> : 单个对象从 object_pool<T> 分配, 多个对象的数组交给 dhsstl::allocator<T>
+//                     用于 rb_tree / set / map 等节点容器, 例如
+//     dhsstl::map<int, int, dhsstl::less<int>, dhsstl::pool_allocator<dhsstl::pair<const int, int>>> m;
+
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <type_traits>
+
+#include "allocator.h"
+#include "construct.h"
+#include "util.h"
+#include "vector.h"
+
+namespace dhsstl
+{
+
+namespace detail
+{
+
+// 空闲的节点复用对象的内存保存链表指针
+template <class T>
+union pool_slot
+{
+    pool_slot* next;
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+};
+
+} // namespace detail
+
+/*****************************************************************************************/
+// object_pool
+/*****************************************************************************************/
+template <class T, size_t Batch = 64>
+class object_pool
+{
+    static_assert(Batch > 0, "object_pool: Batch must be positive");
+
+    typedef detail::pool_slot<T> slot;
+
+    // Batch 个节点组成的链表
+    struct magazine
+    {
+        slot*  head;
+        size_t count;
+    };
+
+    // 全局的 depot, 持有所有的 chunk
+    struct depot
+    {
+        std::mutex               mtx;
+        dhsstl::vector<magazine> full;
+        dhsstl::vector<slot*>    chunks;
+
+        bool take(magazine& m){
+            std::lock_guard<std::mutex> lk(mtx);
+            if(full.empty())
+                return false;
+            m = full.back();
+            full.pop_back();
+            return true;
+        }
+
+        void give(const magazine& m){
+            std::lock_guard<std::mutex> lk(mtx);
+            full.push_back(m);
+        }
+
+        // 申请一个 chunk, 返回其中串好的 Batch 个节点
+        slot* new_chunk(){
+            slot* c = static_cast<slot*>(::operator new(Batch * sizeof(slot), std::align_val_t(alignof(slot))));
+            try{
+                std::lock_guard<std::mutex> lk(mtx);
+                chunks.push_back(c);
+            }
+            catch(...){
+                ::operator delete(c, std::align_val_t(alignof(slot)));
+                throw;
+            }
+            for(size_t i = 0; i + 1 < Batch; ++i)
+                c[i].next = c + i + 1;
+            c[Batch - 1].next = nullptr;
+            return c;
+        }
+
+        size_t chunk_count(){
+            std::lock_guard<std::mutex> lk(mtx);
+            return chunks.size();
+        }
+    };
+
+    // 线程退出时把本地的节点全部交还给 depot
+    struct local_cache
+    {
+        depot& shared;
+        slot*  head = nullptr;
+        size_t count = 0;
+
+        explicit local_cache(depot& d) noexcept :shared(d) {}
+        ~local_cache(){
+            while(head != nullptr)
+                give(count < Batch ? count : Batch);
+        }
+
+        // 把链表头部的 n 个节点交给 depot
+        // depot 记录 magazine 失败时这些节点不再复用, 内存仍由 chunk 持有
+        void give(size_t n) noexcept{
+            slot* first = head;
+            slot* last = head;
+            for(size_t i = 1; i < n; ++i)
+                last = last->next;
+            head = last->next;
+            last->next = nullptr;
+            count -= n;
+            try{
+                shared.give(magazine{ first, n });
+            }
+            catch(...){
+            }
+        }
+    };
+
+    // depot 有意不析构: 线程的 local_cache 在线程退出时析构, 可能晚于静态对象的析构,
+    // 例如 default_thread_pool 的工作线程在静态析构期间才被 join
+    static depot& shared_depot(){
+        static depot* d = new depot();
+        return *d;
+    }
+    static local_cache& local(){
+        static thread_local local_cache c(shared_depot());
+        return c;
+    }
+
+    static void refill(local_cache& c){
+        magazine m;
+        if(c.shared.take(m)){
+            c.head = m.head;
+            c.count = m.count;
+        }
+        else{
+            c.head = c.shared.new_chunk();
+            c.count = Batch;
+        }
+    }
+
+public:
+    typedef T       value_type;
+    typedef size_t  size_type;
+
+    // 返回未构造的对象内存
+    static T* allocate(){
+        local_cache& c = local();
+        if(c.head == nullptr)
+            refill(c);
+        slot* s = c.head;
+        c.head = s->next;
+        --c.count;
+        return reinterpret_cast<T*>(&s->storage);
+    }
+
+    // p 上的对象必须已经析构
+    static void deallocate(T* p) noexcept{
+        if(p == nullptr)
+            return;
+        local_cache& c = local();
+        slot* s = reinterpret_cast<slot*>(p);
+        s->next = c.head;
+        c.head = s;
+        if(++c.count >= 2 * Batch)
+            c.give(Batch);
+    }
+
+    template <class... Args>
+    static T* construct(Args&&... args){
+        T* p = allocate();
+        try{
+            dhsstl::construct(p, dhsstl::forward<Args>(args)...);
+        }
+        catch(...){
+            deallocate(p);
+            throw;
+        }
+        return p;
+    }
+
+    static void destroy(T* p){
+        if(p == nullptr)
+            return;
+        dhsstl::destroy(p);
+        deallocate(p);
+    }
+
+    // 本线程缓存的空闲节点个数
+    static size_t cached() { return local().count; }
+
+    // 已经申请的 chunk 个数, 池保留的内存为 chunk_count() * Batch 个对象
+    static size_t chunk_count() { return shared_depot().chunk_count(); }
+};
+
+/*****************************************************************************************/
+// pool_allocator
+// 接口与 dhsstl::allocator 相同, 不提供 reallocate
+// deallocate(p) 只能用于单个对象, 数组需要调用 deallocate(p, n)
+/*****************************************************************************************/
+template <class T>
+class pool_allocator
+{
+public:
+    typedef T               value_type;
+    typedef T*              pointer;
+    typedef const T*        const_pointer;
+    typedef T&              reference;
+    typedef const T&        const_reference;
+    typedef size_t          size_type;
+    typedef ptrdiff_t       difference_type;
+
+    typedef object_pool<T>  pool_type;
+
+    static T* allocate() { return pool_type::allocate(); }
+
+    static T* allocate(size_type n){
+        if(n == 0)
+            return nullptr;
+        return n == 1 ? pool_type::allocate() : dhsstl::allocator<T>::allocate(n);
+    }
+
+    static void deallocate(T* ptr) { pool_type::deallocate(ptr); }
+
+    static void deallocate(T* ptr, size_type n){
+        if(n == 1)
+            pool_type::deallocate(ptr);
+        else
+            dhsstl::allocator<T>::deallocate(ptr, n);
+    }
+
+    static void construct(T* ptr)                { dhsstl::construct(ptr); }
+    static void construct(T* ptr, const T& value) { dhsstl::construct(ptr, value); }
+    static void construct(T* ptr, T&& value)      { dhsstl::construct(ptr, dhsstl::move(value)); }
+
+    template <class... Args>
+    static void construct(T* ptr, Args&& ...args) { dhsstl::construct(ptr, dhsstl::forward<Args>(args)...); }
+
+    static void destroy(T* ptr)          { dhsstl::destroy(ptr); }
+    static void destroy(T* first, T* last) { dhsstl::destroy(first, last); }
+
+    template <typename U = T>
+    static constexpr bool can_reallocate() { return false; }
+};
+
+} // namespace dhsstl
+
+#endif // !DHSTINYSTL_OBJECT_POOL_H_
@@ -0,0 +1,234 @@
+#ifndef DHSTINYSTL_RADIX_SORT_H_
+#define DHSTINYSTL_RADIX_SORT_H_
+
+// 这个头文件包含基数排序 radix_sort
+//
+// LSD(低位优先)基数排序, 稳定, 每一趟按 key 的一个数位做计数排序, 在原区间和临时缓冲区之间来回分配
+//  1. key 可以是无符号 / 有符号整数或者 IEEE 浮点数(float, double), 先映射成保持顺序的无符号整数:
+//     有符号整数翻转符号位; 浮点数为正时翻转符号位, 为负时翻转所有位(-0.0 排在 +0.0 之前, NaN 排在两端)
+//  2. 数位宽度按 key 的位数和元素个数选择 8 / 11 / 16 位:
+//     元素少或者 key 不超过 16 位时用 8 位, 直方图只有 256 项;
+//     一般情况用 11 位, 2048 项的直方图可以放进 L1, 32 位 key 只需要 3 趟;
+//     64 位 key 且元素很多时用 16 位, 趟数从 6 减少到 4, 直方图的开销可以被摊薄
+//  3. 一次遍历算出所有趟的直方图, 所有元素在某一趟落在同一个桶时跳过这一趟
+//  4. 缓冲区由 get_temporary_buffer 申请, 申请不到足够的大小时退化为 stable_sort
+//
+// 带 key 函数的版本按 key(x) 排序, 例如 vector<pair<uint32_t, T>> 可以用 [](const auto& p){ return p.first; }
+// 并行的 MSD 版本见 execution.h
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "algo.h"
+#include "iterator.h"
+#include "memory.h"
+#include "vector.h"
+
+namespace dhsstl
+{
+
+namespace detail
+{
+
+// 元素个数少于这个值时用插入排序
+constexpr size_t radix_insertion_threshold = 64;
+
+// 把 key 映射成无符号整数, 映射前后的大小顺序相同
+template <typename K, typename = void>
+struct radix_key_traits
+{
+    static_assert(std::is_arithmetic<K>::value, "radix_sort key must be an integer or a floating point number");
+};
+
+template <typename K>
+struct radix_key_traits<K, typename std::enable_if<std::is_integral<K>::value &&
+                                                   std::is_unsigned<K>::value>::type>
+{
+    typedef K unsigned_type;
+    static unsigned_type to_unsigned(K k) noexcept { return k; }
+};
+
+template <typename K>
+struct radix_key_traits<K, typename std::enable_if<std::is_integral<K>::value &&
+                                                   std::is_signed<K>::value>::type>
+{
+    typedef typename std::make_unsigned<K>::type unsigned_type;
+    static unsigned_type to_unsigned(K k) noexcept{
+        return static_cast<unsigned_type>(static_cast<unsigned_type>(k) ^
+                                          (unsigned_type(1) << (sizeof(K) * 8 - 1)));
+    }
+};
+
+template <>
+struct radix_key_traits<float>
+{
+    typedef uint32_t unsigned_type;
+    static unsigned_type to_unsigned(float k) noexcept{
+        uint32_t u;
+        std::memcpy(&u, &k, sizeof(u));
+        return (u & 0x80000000u) ? ~u : (u | 0x80000000u);
+    }
+};
+
+template <>
+struct radix_key_traits<double>
+{
+    typedef uint64_t unsigned_type;
+    static unsigned_type to_unsigned(double k) noexcept{
+        uint64_t u;
+        std::memcpy(&u, &k, sizeof(u));
+        return (u & 0x8000000000000000ull) ? ~u : (u | 0x8000000000000000ull);
+    }
+};
+
+// 默认的 key 函数: 元素本身
+struct radix_identity
+{
+    template <typename T>
+    const T& operator()(const T& x) const noexcept { return x; }
+};
+
+template <typename KeyFn, typename T>
+struct radix_key_type
+{
+    typedef typename std::decay<decltype(std::declval<KeyFn&>()(std::declval<const T&>()))>::type type;
+};
+
+template <typename KeyFn, typename T>
+typename radix_key_traits<typename radix_key_type<KeyFn, T>::type>::unsigned_type
+radix_key(KeyFn& key, const T& x){
+    typedef typename radix_key_type<KeyFn, T>::type key_type;
+    return radix_key_traits<key_type>::to_unsigned(key(x));
+}
+
+// 与基数排序结果一致的比较器, 用于插入排序和退化时的 stable_sort
+template <typename KeyFn>
+struct radix_key_less
+{
+    KeyFn key;
+
+    template <typename T>
+    bool operator()(const T& a, const T& b) { return radix_key(key, a) < radix_key(key, b); }
+};
+
+template <typename KeyFn>
+radix_key_less<KeyFn> make_radix_key_less(KeyFn key){
+    return radix_key_less<KeyFn>{ key };
+}
+
+inline unsigned radix_digit_bits(size_t n, unsigned key_bits){
+    if(key_bits <= 16 || n < (size_t(1) << 16))
+        return 8;
+    if(key_bits > 32 && n >= (size_t(1) << 24))
+        return 16;
+    return 11;
+}
+
+// 按 key 从 shift 开始的 Bits 位把 [first, last) 分配到 result 中, offsets 为每个桶的起始位置
+template <unsigned Bits, typename SrcIter, typename DstIter, typename KeyFn>
+void radix_scatter(SrcIter first, SrcIter last, DstIter result, size_t* offsets, unsigned shift, KeyFn& key){
+    constexpr size_t mask = (size_t(1) << Bits) - 1;
+    for(; first != last; ++first){
+        const size_t d = static_cast<size_t>(detail::radix_key(key, *first) >> shift) & mask;
+        result[offsets[d]++] = dhsstl::move(*first);
+    }
+}
+
+// 对 [first, first + n) 按 key 的低 low_bits 位排序, scratch 是同样大小的缓冲区
+// 返回 true 表示结果在 scratch 中, 否则在 first 中
+template <unsigned Bits, typename Iter1, typename Iter2, typename KeyFn>
+bool radix_lsd(Iter1 first, Iter2 scratch, size_t n, unsigned low_bits, KeyFn& key){
+    constexpr size_t radix = size_t(1) << Bits;
+    const unsigned passes = (low_bits + Bits - 1) / Bits;
+    dhsstl::vector<size_t> counts(passes * radix, size_t(0));
+    for(size_t i = 0; i < n; ++i){
+        const auto u = detail::radix_key(key, first[i]);
+        for(unsigned p = 0; p < passes; ++p)
+            ++counts[p * radix + (static_cast<size_t>(u >> (p * Bits)) & (radix - 1))];
+    }
+
+    const auto u0 = detail::radix_key(key, first[0]);
+    bool in_scratch = false;
+    for(unsigned p = 0; p < passes; ++p){
+        size_t* c = counts.data() + p * radix;
+        // 所有元素落在同一个桶里, 这一趟不改变顺序
+        if(c[static_cast<size_t>(u0 >> (p * Bits)) & (radix - 1)] == n)
+            continue;
+        size_t sum = 0;
+        for(size_t b = 0; b < radix; ++b){
+            const size_t t = c[b];
+            c[b] = sum;
+            sum += t;
+        }
+        if(in_scratch)
+            detail::radix_scatter<Bits>(scratch, scratch + n, first, c, p * Bits, key);
+        else
+            detail::radix_scatter<Bits>(first, first + n, scratch, c, p * Bits, key);
+        in_scratch = !in_scratch;
+    }
+    return in_scratch;
+}
+
+template <typename Iter1, typename Iter2, typename KeyFn>
+bool radix_lsd_dispatch(Iter1 first, Iter2 scratch, size_t n, unsigned low_bits, KeyFn& key){
+    switch(detail::radix_digit_bits(n, low_bits)){
+    case 8:  return detail::radix_lsd<8>(first, scratch, n, low_bits, key);
+    case 11: return detail::radix_lsd<11>(first, scratch, n, low_bits, key);
+    default: return detail::radix_lsd<16>(first, scratch, n, low_bits, key);
+    }
+}
+
+// 可以平凡复制的类型: 缓冲区不需要构造, 直接在原区间和缓冲区之间来回分配
+template <typename RandomIter, typename T, typename KeyFn>
+void radix_sort_buffer(RandomIter first, T* buf, size_t n, unsigned key_bits, KeyFn& key, std::true_type){
+    if(detail::radix_lsd_dispatch(first, buf, n, key_bits, key))
+        dhsstl::move(buf, buf + n, first);
+}
+
+// 其他类型: 先把元素移动构造到缓冲区, 这样两边都是已经构造的对象, 之后只有移动赋值
+template <typename RandomIter, typename T, typename KeyFn>
+void radix_sort_buffer(RandomIter first, T* buf, size_t n, unsigned key_bits, KeyFn& key, std::false_type){
+    dhsstl::uninitialized_move(first, first + n, buf);
+    if(!detail::radix_lsd_dispatch(buf, first, n, key_bits, key))
+        dhsstl::move(buf, buf + n, first);
+    dhsstl::destroy(buf, buf + n);
+}
+
+} // namespace detail
+
+/*!
+ * @brief 按 key(x) 对 [first, last) 做稳定的基数排序, key 返回整数或浮点数
+ */
+template <typename RandomIter, typename KeyFn>
+void radix_sort(RandomIter first, RandomIter last, KeyFn key){
+    typedef typename iterator_traits<RandomIter>::value_type              value_type;
+    typedef typename detail::radix_key_type<KeyFn, value_type>::type     key_type;
+    typedef typename detail::radix_key_traits<key_type>::unsigned_type   unsigned_type;
+    static_assert(std::is_nothrow_move_constructible<value_type>::value &&
+                  std::is_nothrow_move_assignable<value_type>::value,
+                  "radix_sort requires nothrow move construction and assignment");
+    const size_t n = static_cast<size_t>(last - first);
+    if(n < detail::radix_insertion_threshold){
+        detail::insertion_sort(first, last, detail::make_radix_key_less(key));
+        return;
+    }
+    auto buf = dhsstl::get_temporary_buffer<value_type>(static_cast<ptrdiff_t>(n));
+    if(static_cast<size_t>(buf.second) < n){
+        dhsstl::release_temporary_buffer(buf.first);
+        dhsstl::stable_sort(first, last, detail::make_radix_key_less(key));
+        return;
+    }
+    detail::radix_sort_buffer(first, buf.first, n, sizeof(unsigned_type) * 8, key,
+                              std::integral_constant<bool, std::is_trivially_copyable<value_type>::value>{});
+    dhsstl::release_temporary_buffer(buf.first);
+}
+
+template <typename RandomIter>
+void radix_sort(RandomIter first, RandomIter last){
+    dhsstl::radix_sort(first, last, detail::radix_identity());
+}
+
+} // namespace dhsstl
+
+#endif // !DHSTINYSTL_RADIX_SORT_H_
@@ -12,6 +12,11 @@
 #include "type_traits.h"
 #include "exceptdef.h"
 
+// 批量分配节点时每块的最大字节数
+#ifndef DHSSTL_NODE_BATCH_BYTES
+#define DHSSTL_NODE_BATCH_BYTES (static_cast<size_t>(1) << 20)
+#endif
+
 namespace dhsstl{
 
 // enum _Rb_tree_color_type { _S_red = false, _S_black = true };
@@ -669,12 +674,98 @@ BasePtr _rb_tree_erase_rebalance(BasePtr z, BasePtr& root, BasePtr& leftmost, Ba
     return y;
 }
 
+/**
+ * @brief rb_tree 的批量节点
+ * 向空树中插入一段长度已知的区间(insert_unique / insert_multi(first, last), 复制构造, 复制赋值)时,
+ * 一次申请一整块连续的节点, 之后这棵树的所有节点都从块中分配:
+ *  * 新节点优先从空闲链表中取, 其次从最新的块中顺序切出, 都没有时再申请一个两倍大的块
+ *  * 每块最多 DHSSTL_NODE_BATCH_BYTES 字节, 更大的区间分成几块: 过大的块会由 malloc 直接 mmap,
+ *    每次释放都归还给系统, 下次申请时重新缺页
+ *  * 删除的节点放入空闲链表, 留给之后插入的元素复用, 内存在 clear 或析构时才整块释放
+ *  * clear 和析构时 T 可以平凡析构则不需要遍历节点, 复杂度为 O(块数)
+ *  * 树中的节点不会转移到其他树, 移动和 swap 时连同块一起交换
+ * clear 之后回到逐个向 NodeAlloc 申请节点
+*/
+template <typename Node, typename NodeAlloc>
+class _Rb_tree_node_batch{
+    // 块的头部, 占用块开头的 header_slots 个节点的空间
+    struct block{
+        block*  next;
+        size_t  capacity;
+    };
+    static constexpr size_t header_slots = (sizeof(block) + sizeof(Node) - 1) / sizeof(Node);
+    static constexpr size_t max_nodes    = DHSSTL_NODE_BATCH_BYTES / sizeof(Node) > 16
+                                         ? DHSSTL_NODE_BATCH_BYTES / sizeof(Node) : 16;
+
+    block*  blocks_ = nullptr;      // 所有的块, 最新的在最前面
+    size_t  used_   = 0;            // 最新的块中已经切出的节点数
+    Node*   free_   = nullptr;      // 空闲节点链表, 通过 left 链接
+
+    static Node* nodes(block* b) noexcept { return reinterpret_cast<Node*>(b) + header_slots; }
+
+public:
+    _Rb_tree_node_batch() = default;
+    _Rb_tree_node_batch(const _Rb_tree_node_batch&) = delete;
+    _Rb_tree_node_batch& operator=(const _Rb_tree_node_batch&) = delete;
+    ~_Rb_tree_node_batch() { release(); }
+
+    bool active() const noexcept { return blocks_ != nullptr; }
+
+    // 申请一个容纳 n 个节点(最多 max_nodes 个)的块, 之前最新的块中还没有切出的节点放入空闲链表
+    void reserve(size_t n){
+        n = dhsstl::min(n, max_nodes);
+        block* b = reinterpret_cast<block*>(NodeAlloc::allocate(n + header_slots));
+        b->next = blocks_;
+        b->capacity = n;
+        if(blocks_ != nullptr){
+            while(used_ < blocks_->capacity)
+                deallocate(nodes(blocks_) + used_++);
+        }
+        blocks_ = b;
+        used_ = 0;
+    }
+
+    Node* allocate(){
+        if(free_ != nullptr){
+            Node* p = free_;
+            free_ = static_cast<Node*>(p->left);
+            return p;
+        }
+        if(used_ == blocks_->capacity)
+            reserve(dhsstl::max<size_t>(blocks_->capacity * 2, 16));
+        return nodes(blocks_) + used_++;
+    }
+
+    void deallocate(Node* p) noexcept{
+        p->left = free_;
+        free_ = p;
+    }
+
+    // 释放所有的块, 调用前块中的元素都已经析构
+    void release() noexcept{
+        while(blocks_ != nullptr){
+            block* next = blocks_->next;
+            NodeAlloc::deallocate(reinterpret_cast<Node*>(blocks_), blocks_->capacity + header_slots);
+            blocks_ = next;
+        }
+        used_ = 0;
+        free_ = nullptr;
+    }
+
+    void swap(_Rb_tree_node_batch& rhs) noexcept{
+        dhsstl::swap(blocks_, rhs.blocks_);
+        dhsstl::swap(used_, rhs.used_);
+        dhsstl::swap(free_, rhs.free_);
+    }
+};
+
 /**
  * @brief 模板类 rb_tree
  * @tparam T Value类型
  * @tparam Compare 键值比较类型
+ * @tparam Alloc 静态接口的分配器, 节点和头节点的分配器由它 rebind 得到, 例如 pool_allocator<T>
 */
-template <typename T, typename Compare>
+template <typename T, typename Compare, typename Alloc = dhsstl::allocator<T>>
 class rb_tree{
     
 public:
@@ -690,10 +781,11 @@ public:
     typedef typename tree_traits::value_type            value_type;
     typedef Compare                                     key_compare;
 
-    typedef dhsstl::allocator<T>                        allocator_type;
-    typedef dhsstl::allocator<T>                        data_allocator;
-    typedef dhsstl::allocator<base_type>                base_allocator;
-    typedef dhsstl::allocator<node_type>                node_allocator;
+    typedef Alloc                                                        allocator_type;
+    typedef Alloc                                                        data_allocator;
+    typedef typename detail::allocator_rebind<Alloc, base_type>::type   base_allocator;
+    typedef typename detail::allocator_rebind<Alloc, node_type>::type   node_allocator;
+    typedef _Rb_tree_node_batch<node_type, node_allocator>              node_batch;
 
     typedef typename allocator_type::pointer             pointer;
     typedef typename allocator_type::const_pointer       const_pointer;
@@ -707,7 +799,7 @@ public:
     typedef dhsstl::reverse_iterator<iterator>          reverse_iterator;
     typedef dhsstl::reverse_iterator<const_iterator>    const_reverse_iterator;
 
-    allocator_type  get_allocator()  const { return node_allocator(); }
+    allocator_type  get_allocator()  const { return allocator_type(); }
     key_compare     key_comp()       const { return key_comp_; }
 
 private:
@@ -715,6 +807,7 @@ private:
     base_ptr        header_;        // 特殊节点, 与根节点互为对方的父节点
     size_type       node_count_;    // 节点数
     key_compare     key_comp_;      // 节点键值比较的准则
+    node_batch      batch_;         // 批量分配的节点, 没有时节点逐个分配
 
 private:
     /**
@@ -736,7 +829,7 @@ public:
     rb_tree& operator=(const rb_tree& rhs);
     rb_tree& operator=(rb_tree&& rhs);
 
-    ~rb_tree() { clear(); }
+    ~rb_tree() { clear(); base_allocator::deallocate(header_); }
 
 public:
     // 迭代器相关操作
@@ -810,6 +903,7 @@ public:
     void insert_multi(InputIterator first, InputIterator last){
         size_type n = dhsstl::distance(first, last);
         THROW_LENGTH_ERROR_IF(node_count_ > max_size() - n, "rb_tree<T, Comp>'s size too big");
+        reserve_nodes(n);
         for(; n > 0; --n, ++first)
             insert_multi(end(), *first);
     }
@@ -830,6 +924,7 @@ public:
     void      insert_unique(InputIterator first, InputIterator last){
         size_type n = dhsstl::distance(first, last);
         THROW_LENGTH_ERROR_IF(node_count_ > max_size() - n, "rb_tree<T, Comp>'s size too big");
+        reserve_nodes(n);
         for(; n > 0; --n, ++first)
             insert_unique(end(), *first);
     }
@@ -902,6 +997,12 @@ private:
     node_ptr clone_node(base_ptr x);
     void     destroy_node(node_ptr p);
 
+    node_ptr allocate_node()
+    { return batch_.active() ? batch_.allocate() : node_allocator::allocate(1); }
+    void     deallocate_node(node_ptr p) noexcept
+    { batch_.active() ? batch_.deallocate(p) : node_allocator::deallocate(p); }
+    void     reserve_nodes(size_type n);
+
     // init / reset
     void     rb_tree_init();
     void     reset();
@@ -931,11 +1032,12 @@ private:
 /**
  * @brief 复制构造函数
 */
-template <typename T, typename Compare>
-rb_tree<T, Compare>::
+template <typename T, typename Compare, typename Alloc>
+rb_tree<T, Compare, Alloc>::
 rb_tree(const rb_tree& rhs){
     rb_tree_init();
     if(rhs.node_count_ != 0){
+        reserve_nodes(rhs.node_count_);
         root() = copy_from(rhs.root(), header_);
         leftmost() = _Rb_tree_node_base::minimun(root());
         rightmost() = _Rb_tree_node_base::maximum(root());
@@ -947,27 +1049,29 @@ rb_tree(const rb_tree& rhs){
 /**
  * @brief 移动构造函数
 */
-template <typename T, typename Compare>
-rb_tree<T, Compare>::
+template <typename T, typename Compare, typename Alloc>
+rb_tree<T, Compare, Alloc>::
 rb_tree(rb_tree&& rhs) noexcept
  : header_(dhsstl::move(rhs.header_)),
    node_count_(rhs.node_count_),
    key_comp_(rhs.key_comp_)
 {
+    batch_.swap(rhs.batch_);
     rhs.reset();
 }
 
 /**
  * @brief 复制赋值操作符
 */
-template <typename T, typename Compare>
-rb_tree<T, Compare>&
-rb_tree<T, Compare>::
+template <typename T, typename Compare, typename Alloc>
+rb_tree<T, Compare, Alloc>&
+rb_tree<T, Compare, Alloc>::
 operator=(const rb_tree& rhs){
     if(this != &rhs){
         clear();
         
         if(rhs.node_count_ != 0){
+            reserve_nodes(rhs.node_count_);
             root() = copy_from(rhs.root(), header_);
             leftmost() = _Rb_tree_node_base::minimun(root());
             rightmost() = _Rb_tree_node_base::maximum(root());
@@ -982,14 +1086,16 @@ operator=(const rb_tree& rhs){
 /**
  * @brief 移动赋值操作符
 */
-template <typename T, typename Compare>
-rb_tree<T, Compare>&
-rb_tree<T, Compare>::
+template <typename T, typename Compare, typename Alloc>
+rb_tree<T, Compare, Alloc>&
+rb_tree<T, Compare, Alloc>::
 operator=(rb_tree&& rhs){
     clear();
+    base_allocator::deallocate(header_);
     header_ = dhsstl::move(rhs.header_);
     node_count_ = rhs.node_count_;
     key_comp_ = rhs.key_comp_;
+    batch_.swap(rhs.batch_);
     rhs.reset();
     return *this;
 }
@@ -997,10 +1103,10 @@ operator=(rb_tree&& rhs){
 /**
  * @brief 就地插入元素, 并且允许键值的重复
 */
-template <typename T, typename Compare>
+template <typename T, typename Compare, typename Alloc>
 template <typename ...Args>
-typename rb_tree<T, Compare>::iterator
-rb_tree<T, Compare>::
+typename rb_tree<T, Compare, Alloc>::iterator
+rb_tree<T, Compare, Alloc>::
 emplace_multi(Args&& ...args){
     THROW_LENGTH_ERROR_IF(node_count_ > max_size() - 1, "rb_tree<T, Comp>'s size too big");
     node_ptr np = create_node(dhsstl::forward<Args>(args)...);
@@ -1011,10 +1117,10 @@ emplace_multi(Args&& ...args){
 /**
  * @brief 就地插入元素, 键值不允许重复
 */
-template <typename T, typename Compare>
+template <typename T, typename Compare, typename Alloc>
 template <typename ...Args>
-dhsstl::pair<typename rb_tree<T, Compare>::iterator, bool>
-rb_tree<T, Compare>::
+dhsstl::pair<typename rb_tree<T, Compare, Alloc>::iterator, bool>
+rb_tree<T, Compare, Alloc>::
 emplace_unique(Args&& ...args){
     THROW_LENGTH_ERROR_IF(node_count_ > max_size() - 1, "rb_tree<T, Comp>'s size too big");
     node_ptr np = create_node(dhsstl::forward<Args>(args)...);
@@ -1030,10 +1136,10 @@ emplace_unique(Args&& ...args){
 /**
  * @brief 就地插入元素, 键值允许重复, 当 hint 位置与插入位置接近时, 插入操作的时间复杂度可以降低
 */
-template <typename T, typename Compare>
+template <typename T, typename Compare, typename Alloc>
 template <typename ...Args>
-typename rb_tree<T, Compare>::iterator
-rb_tree<T, Compare>::
+typename rb_tree<T, Compare, Alloc>::iterator
+rb_tree<T, Compare, Alloc>::
 emplace_multi_use_hint(iterator hint, Args&& ...args){
     THROW_LENGTH_ERROR_IF(node_count_ > max_size() - 1, "rb_tree<T, Comp>'s size too big");
     node_ptr np = create_node(dhsstl::forward<Args>(args)...);
@@ -1064,10 +1170,10 @@ emplace_multi_use_hint(iterator hint, Args&& ...args){
 /**
  * @brief 就地插入元素, 键值不允许重复, 当 hint 位置与插入位置接近时, 插入操作的时间复杂度可以降低
 */
-template <typename T, typename Compare>
+template <typename T, typename Compare, typename Alloc>
 template <typename ...Args>
-typename rb_tree<T, Compare>::iterator
-rb_tree<T, Compare>::
+typename rb_tree<T, Compare, Alloc>::iterator
+rb_tree<T, Compare, Alloc>::
 emplace_unique_use_hint(iterator hint, Args&& ...args){
     THROW_LENGTH_ERROR_IF(node_count_ > max_size() - 1, "rb_tree<T, Comp>'s size too big");
     node_ptr np = create_node(dhsstl::forward<Args>(args)...);
@@ -1106,9 +1212,9 @@ emplace_unique_use_hint(iterator hint, Args&& ...args){
 /**
  * @brief 插入元素, 节点键值允许重复
 */
-template <typename T, typename Compare>
-typename rb_tree<T, Compare>::iterator
-rb_tree<T, Compare>::
+template <typename T, typename Compare, typename Alloc>
+typename rb_tree<T, Compare, Alloc>::iterator
+rb_tree<T, Compare, Alloc>::
 insert_multi(const value_type& value){
     THROW_LENGTH_ERROR_IF(node_count_ > max_size() - 1, "rb_tree<T, Comp>'s size too big");
     auto res = get_insert_multi_pos(value_traits::get_key(value));
@@ -1119,9 +1225,9 @@ insert_multi(const value_type& value){
  * @brief 插入新值, 节点键值不允许重复,
  * @return pair: 若插入成功, pair.second 为 true, 反之为 false
 */
-template <typename T, typename Compare>
-dhsstl::pair<typename rb_tree<T, Compare>::iterator, bool>
-rb_tree<T, Compare>::
+template <typename T, typename Compare, typename Alloc>
+dhsstl::pair<typename rb_tree<T, Compare, Alloc>::iterator, bool>
+rb_tree<T, Compare, Alloc>::
 insert_unique(const value_type& value){
     THROW_LENGTH_ERROR_IF(node_count_ > max_size() - 1, "rb_tree<T, Comp>'s size too big");    
     auto res = get_insert_unique_pos(value_traits::get_key(value));
@@ -1136,9 +1242,9 @@ insert_unique(const value_type& value){
  * @brief 删除 hint 位置的节点
  * @param hint iterator 需要删除节点的迭代器
 */
-template <typename T, typename Compare>
-typename rb_tree<T, Compare>::iterator
-rb_tree<T, Compare>::
+template <typename T, typename Compare, typename Alloc>
+typename rb_tree<T, Compare, Alloc>::iterator
+rb_tree<T, Compare, Alloc>::
 erase(iterator hint){
     auto node = static_cast<node_ptr>(hint.node);
     iterator next(node);
@@ -1155,9 +1261,9 @@ erase(iterator hint){
  * @param key 要被删除的键值
  * @return 删除的个数
 */
-template <typename T, typename Compare>
-typename rb_tree<T, Compare>::size_type
-rb_tree<T, Compare>::
+template <typename T, typename Compare, typename Alloc>
+typename rb_tree<T, Compare, Alloc>::size_type
+rb_tree<T, Compare, Alloc>::
 erase_multi(const key_type& key){
     auto p = equal_range_multi(key);
     size_type n = dhsstl::distance(p.first, p.second);
@@ -1170,9 +1276,9 @@ erase_multi(const key_type& key){
  * @param key 要被删除的键值
  * @return 删除的个数
 */
-template <typename T, typename Compare>
-typename rb_tree<T, Compare>::size_type
-rb_tree<T, Compare>::
+template <typename T, typename Compare, typename Alloc>
+typename rb_tree<T, Compare, Alloc>::size_type
+rb_tree<T, Compare, Alloc>::
 erase_unique(const key_type& key){
     auto it = find(key);
     if(it != end()){
@@ -1187,8 +1293,8 @@ erase_unique(const key_type& key){
  * @param first first 迭代器
  * @param last last 迭代器
 */
-template <typename T, typename Compare>
-void rb_tree<T, Compare>::
+template <typename T, typename Compare, typename Alloc>
+void rb_tree<T, Compare, Alloc>::
 erase(iterator first, iterator last){
     if(first == begin() && last == end()){
         clear();
@@ -1201,16 +1307,19 @@ erase(iterator first, iterator last){
 /**
  * @brief 清空 rb_tree
 */
-template <typename T, typename Compare>
-void rb_tree<T, Compare>::
+template <typename T, typename Compare, typename Alloc>
+void rb_tree<T, Compare, Alloc>::
 clear(){
     if(node_count_ != 0){
-        erase_since(root());
+        // 节点都在块中且元素可以平凡析构时, 不需要遍历, 随块一起释放
+        if(!batch_.active() || !std::is_trivially_destructible<T>::value)
+            erase_since(root());
         leftmost() = header_;
         root() = nullptr;
         rightmost() = header_;
         node_count_ = 0;
     }
+    batch_.release();
 }
 
 /**
@@ -1218,9 +1327,9 @@ clear(){
  * @param key 要查找的键值
  * @return 指向key的iterator
 */
-template <typename T, typename Compare>
-typename rb_tree<T, Compare>::iterator
-rb_tree<T, Compare>::
+template <typename T, typename Compare, typename Alloc>
+typename rb_tree<T, Compare, Alloc>::iterator
+rb_tree<T, Compare, Alloc>::
 find(const key_type& key){
     auto y = header_;
     auto x = root();
@@ -1237,9 +1346,9 @@ find(const key_type& key){
     return (j == end() || key_comp_(key, value_traits::get_key(*j))) ? end() : j;
 }
 
-template <typename T, typename Compare>
-typename rb_tree<T, Compare>::const_iterator
-rb_tree<T, Compare>::
+template <typename T, typename Compare, typename Alloc>
+typename rb_tree<T, Compare, Alloc>::const_iterator
+rb_tree<T, Compare, Alloc>::
 find(const key_type& key) const{
     auto y = header_;
     auto x = root();
@@ -1260,9 +1369,9 @@ find(const key_type& key) const{
  * @brief 键值不小于 key 的第一个位置
  * @param key 键值
 */
-template <typename T, typename Compare>
-typename rb_tree<T, Compare>::iterator
-rb_tree<T, Compare>::
+template <typename T, typename Compare, typename Alloc>
+typename rb_tree<T, Compare, Alloc>::iterator
+rb_tree<T, Compare, Alloc>::
 lower_bound(const key_type& key){
     auto y = header_;
     auto x = root();
@@ -1277,9 +1386,9 @@ lower_bound(const key_type& key){
     return iterator(y);
 }
 
-template <typename T, typename Compare>
-typename rb_tree<T, Compare>::const_iterator
-rb_tree<T, Compare>::
+template <typename T, typename Compare, typename Alloc>
+typename rb_tree<T, Compare, Alloc>::const_iterator
+rb_tree<T, Compare, Alloc>::
 lower_bound(const key_type& key) const{
     auto y = header_;
     auto x = root();
@@ -1298,9 +1407,9 @@ lower_bound(const key_type& key) const{
  * @brief 键值不小于 key 的最后一个位置
  * @param key 键值
 */
-template <typename T, typename Compare>
-typename rb_tree<T, Compare>::iterator
-rb_tree<T, Compare>::
+template <typename T, typename Compare, typename Alloc>
+typename rb_tree<T, Compare, Alloc>::iterator
+rb_tree<T, Compare, Alloc>::
 upper_bound(const key_type& key){
     auto y = header_;
     auto x = root();
@@ -1315,9 +1424,9 @@ upper_bound(const key_type& key){
     return iterator(y);
 }
 
-template <typename T, typename Compare>
-typename rb_tree<T, Compare>::const_iterator
-rb_tree<T, Compare>::
+template <typename T, typename Compare, typename Alloc>
+typename rb_tree<T, Compare, Alloc>::const_iterator
+rb_tree<T, Compare, Alloc>::
 upper_bound(const key_type& key) const{
     auto y = header_;
     auto x = root();
@@ -1335,13 +1444,14 @@ upper_bound(const key_type& key) const{
 /**
  * @brief 交换 rb tree
 */
-template <typename T, typename Compare>
-void rb_tree<T, Compare>::
+template <typename T, typename Compare, typename Alloc>
+void rb_tree<T, Compare, Alloc>::
 swap(rb_tree& rhs) noexcept{
     if(this != & rhs){
         dhsstl::swap(header_, rhs.header_);
         dhsstl::swap(node_count_, rhs.node_count_);
         dhsstl::swap(key_comp_, rhs.key_comp_);
+        batch_.swap(rhs.batch_);
     }
 }
 
@@ -1351,19 +1461,19 @@ swap(rb_tree& rhs) noexcept{
 /**
  * @brief 创建一个节点
 */
-template<typename T, typename Compare>
+template<typename T, typename Compare, typename Alloc>
 template<typename ...Args>
-typename rb_tree<T, Compare>::node_ptr
-rb_tree<T, Compare>::
+typename rb_tree<T, Compare, Alloc>::node_ptr
+rb_tree<T, Compare, Alloc>::
 create_node(Args&& ...args){
-    auto tmp = node_allocator::allocate(1);
+    auto tmp = allocate_node();
     try{
         data_allocator::construct(dhsstl::address_of(tmp->value_field), dhsstl::forward<Args>(args)...);
         tmp->left = nullptr;
         tmp->right = nullptr;
         tmp->parent = nullptr;
     }catch(...){
-        node_allocator::deallocate(tmp);
+        deallocate_node(tmp);
         throw;
     }
     return tmp;
@@ -1372,9 +1482,9 @@ create_node(Args&& ...args){
 /**
  * @brief 复制一个节点
 */
-template <typename T, typename Compare>
-typename rb_tree<T, Compare>::node_ptr
-rb_tree<T, Compare>::
+template <typename T, typename Compare, typename Alloc>
+typename rb_tree<T, Compare, Alloc>::node_ptr
+rb_tree<T, Compare, Alloc>::
 clone_node(base_ptr x){
     node_ptr tmp = create_node(static_cast<node_ptr>(x)->value_field);
     tmp->color = x -> color;
@@ -1386,18 +1496,30 @@ clone_node(base_ptr x){
 /**
  * @brief 销毁一个节点
 */
-template <typename T, typename Compare>
-void rb_tree<T, Compare>::
+template <typename T, typename Compare, typename Alloc>
+void rb_tree<T, Compare, Alloc>::
 destroy_node(node_ptr p){
     data_allocator::destroy(&p->value_field);
-    node_allocator::deallocate(p);
+    deallocate_node(p);
+}
+
+/**
+ * @brief 空树插入 n 个节点之前, 一次申请 n 个节点的块, 树为空时原有的块中没有存活的节点, 可以先释放
+*/
+template <typename T, typename Compare, typename Alloc>
+void rb_tree<T, Compare, Alloc>::
+reserve_nodes(size_type n){
+    if(node_count_ == 0 && n > 1){
+        batch_.release();
+        batch_.reserve(n);
+    }
 }
 
 /**
  * @brief 初始化容器
 */
-template <typename T, typename Compare>
-void rb_tree<T, Compare>::
+template <typename T, typename Compare, typename Alloc>
+void rb_tree<T, Compare, Alloc>::
 rb_tree_init(){
     header_ = base_allocator::allocate(1);
     header_->color = _Rb_tree_red; // header_ 节点颜色为红, 与root区分
@@ -1407,15 +1529,15 @@ rb_tree_init(){
     node_count_ = 0;
 }
 
-template <typename T, typename Compare>
-void rb_tree<T, Compare>::reset(){
+template <typename T, typename Compare, typename Alloc>
+void rb_tree<T, Compare, Alloc>::reset(){
     header_ = nullptr;
     node_count_ = 0;
 }
 
-template<typename T, typename Compare>
-dhsstl::pair<typename rb_tree<T, Compare>::base_ptr, bool>
-rb_tree<T, Compare>::get_insert_multi_pos(const key_type& key){
+template<typename T, typename Compare, typename Alloc>
+dhsstl::pair<typename rb_tree<T, Compare, Alloc>::base_ptr, bool>
+rb_tree<T, Compare, Alloc>::get_insert_multi_pos(const key_type& key){
     auto x = root();
     auto y = header_;
     bool add_to_left = true;
@@ -1433,9 +1555,9 @@ rb_tree<T, Compare>::get_insert_multi_pos(const key_type& key){
  * @return 返回一个pair类型, 第一个值为一个pair, 表示插入点的父节点和一个 bool 表示是否在左边插入
  *         第二个值为一个bool, 表示是否插入成功
 */
-template <typename T, typename Compare>
-dhsstl::pair<dhsstl::pair<typename rb_tree<T, Compare>::base_ptr, bool>, bool>
-rb_tree<T, Compare>::get_insert_unique_pos(const key_type& key){
+template <typename T, typename Compare, typename Alloc>
+dhsstl::pair<dhsstl::pair<typename rb_tree<T, Compare, Alloc>::base_ptr, bool>, bool>
+rb_tree<T, Compare, Alloc>::get_insert_unique_pos(const key_type& key){
     auto x = root(); 
     auto y = header_;
     bool add_to_left = true; // 树为空时也在 header_ 左边插入
@@ -1467,9 +1589,9 @@ rb_tree<T, Compare>::get_insert_unique_pos(const key_type& key){
  * @param value 要插入的值
  * @param add_to_left 表示是否在左边插入
 */
-template <typename T, typename Compare>
-typename rb_tree<T, Compare>::iterator
-rb_tree<T, Compare>::
+template <typename T, typename Compare, typename Alloc>
+typename rb_tree<T, Compare, Alloc>::iterator
+rb_tree<T, Compare, Alloc>::
 insert_value_at(base_ptr x, const value_type& value, bool add_to_left){
     node_ptr node = create_node(value);
     node->parent = x;
@@ -1498,9 +1620,9 @@ insert_value_at(base_ptr x, const value_type& value, bool add_to_left){
  * @param node 要插入的节点
  * @param add_to_left 表示是否要在左边插入
 */
-template <typename T, typename Compare>
-typename rb_tree<T, Compare>::iterator
-rb_tree<T, Compare>::
+template <typename T, typename Compare, typename Alloc>
+typename rb_tree<T, Compare, Alloc>::iterator
+rb_tree<T, Compare, Alloc>::
 insert_node_at(base_ptr x, node_ptr node, bool add_to_left){
     node->parent = x;
     auto base_node = static_cast<base_ptr>(node);
@@ -1528,9 +1650,9 @@ insert_node_at(base_ptr x, node_ptr node, bool add_to_left){
  * @param key  键值
  * @param node node_ptr
 */
-template <typename T, typename Compare>
-typename rb_tree<T, Compare>::iterator
-rb_tree<T, Compare>::
+template <typename T, typename Compare, typename Alloc>
+typename rb_tree<T, Compare, Alloc>::iterator
+rb_tree<T, Compare, Alloc>::
 insert_multi_use_hint(iterator hint, key_type key, node_ptr node){
     // 在 hint 附近寻找可以插入的位置
     auto np = hint.node;
@@ -1556,9 +1678,9 @@ insert_multi_use_hint(iterator hint, key_type key, node_ptr node){
  * @param key  键值
  * @param node node_ptr
 */
-template <typename T, typename Compare>
-typename rb_tree<T, Compare>::iterator
-rb_tree<T, Compare>::
+template <typename T, typename Compare, typename Alloc>
+typename rb_tree<T, Compare, Alloc>::iterator
+rb_tree<T, Compare, Alloc>::
 insert_unique_use_hint(iterator hint, key_type key, node_ptr node){
     // 在 hint 附近云找可以插入的元素
     auto np = hint.node;
@@ -1585,9 +1707,9 @@ insert_unique_use_hint(iterator hint, key_type key, node_ptr node){
 /**
  * @brief copy_from 函数: 递归复制一棵树, 节点从 x 开始, p 为 x 的父节点
 */
-template <typename T, typename Compare>
-typename rb_tree<T, Compare>::base_ptr
-rb_tree<T, Compare>::copy_from(base_ptr x, base_ptr p){
+template <typename T, typename Compare, typename Alloc>
+typename rb_tree<T, Compare, Alloc>::base_ptr
+rb_tree<T, Compare, Alloc>::copy_from(base_ptr x, base_ptr p){
     auto top = clone_node(x);
     top->parent = p;
     try
@@ -1617,8 +1739,8 @@ rb_tree<T, Compare>::copy_from(base_ptr x, base_ptr p){
 /**
  * @brief erase_since 函数 从 x 节点开始删除该节点及其子树
 */
-template <typename T, typename Compare>
-void rb_tree<T, Compare>::
+template <typename T, typename Compare, typename Alloc>
+void rb_tree<T, Compare, Alloc>::
 erase_since(base_ptr x){
     while(x != nullptr){
         erase_since(x->right);
@@ -1629,39 +1751,39 @@ erase_since(base_ptr x){
 }
 
 // 重载比较操作符
-template <typename T, typename Compare>
-bool operator==(const rb_tree<T, Compare>& lhs, const rb_tree<T, Compare>& rhs){
+template <typename T, typename Compare, typename Alloc>
+bool operator==(const rb_tree<T, Compare, Alloc>& lhs, const rb_tree<T, Compare, Alloc>& rhs){
     return lhs.size() == rhs.size() && dhsstl::equal(lhs.begin(), lhs.end(), rhs.begin());
 }
 
-template <typename T, typename Compare>
-bool operator<(const rb_tree<T, Compare>& lhs, const rb_tree<T, Compare>& rhs){
+template <typename T, typename Compare, typename Alloc>
+bool operator<(const rb_tree<T, Compare, Alloc>& lhs, const rb_tree<T, Compare, Alloc>& rhs){
     return dhsstl::lexicograhical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
 }
 
-template <typename T, typename Compare>
-bool operator!=(const rb_tree<T, Compare>& lhs, const rb_tree<T, Compare>& rhs){
+template <typename T, typename Compare, typename Alloc>
+bool operator!=(const rb_tree<T, Compare, Alloc>& lhs, const rb_tree<T, Compare, Alloc>& rhs){
     return !(lhs == rhs);
 }
 
-template <typename T, typename Compare>
-bool operator>(const rb_tree<T, Compare>& lhs, const rb_tree<T, Compare>& rhs){
+template <typename T, typename Compare, typename Alloc>
+bool operator>(const rb_tree<T, Compare, Alloc>& lhs, const rb_tree<T, Compare, Alloc>& rhs){
     return rhs > lhs;
 }
 
-template <typename T, typename Compare>
-bool operator<=(const rb_tree<T, Compare>& lhs, const rb_tree<T, Compare>& rhs){
+template <typename T, typename Compare, typename Alloc>
+bool operator<=(const rb_tree<T, Compare, Alloc>& lhs, const rb_tree<T, Compare, Alloc>& rhs){
     return !(rhs < lhs);
 }
 
-template <typename T, typename Compare>
-bool operator>=(const rb_tree<T, Compare>& lhs, const rb_tree<T, Compare>& rhs){
+template <typename T, typename Compare, typename Alloc>
+bool operator>=(const rb_tree<T, Compare, Alloc>& lhs, const rb_tree<T, Compare, Alloc>& rhs){
     return !(lhs < rhs);
 }
 
 // 重载 dhsstl 的 swap
-template <typename T, typename Compare>
-void swap(rb_tree<T, Compare>& lhs, rb_tree<T, Compare>& rhs) noexcept{
+template <typename T, typename Compare, typename Alloc>
+void swap(rb_tree<T, Compare, Alloc>& lhs, rb_tree<T, Compare, Alloc>& rhs) noexcept{
     lhs.swap(rhs);
 }
 
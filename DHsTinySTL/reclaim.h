@@ -0,0 +1,481 @@
+#ifndef DHSTINYSTL_RECLAIM_H_
+#define DHSTINYSTL_RECLAIM_H_
+
+// 这个头文件包含无锁数据结构使用的安全内存回收(safe memory reclamation)
+// 无锁结构把节点摘下之后, 其他线程可能还在读这个节点, 不能马上释放:
+// 先 retire, 确认没有读者之后再释放
+//
+// hazard pointer : 读者在访问节点之前把它的地址写进自己的 hazard 槽位, 再确认节点仍然可达
+//                  退休的节点攒够一批之后扫描所有线程的槽位, 释放没有被保护的节点
+//                  读者停住只会挡住它保护的几个节点, 未释放的节点个数有上界
+// epoch          : 读者进入临界区时记录当前的全局 epoch(epoch_guard), 不逐个保护节点, 读的开销更低
+//                  所有在临界区中的线程都进入当前 epoch 之后全局 epoch 才能前进,
+//                  在 epoch e 退休的节点到 e + 2 时释放. 一个线程停在临界区中会让所有节点都无法释放
+//
+// 两者都是进程内唯一的 domain, 线程第一次使用时登记一条记录, 线程退出时记录留给之后的线程复用,
+// 还没有释放的节点交给 domain, 由其他线程的扫描或者程序结束时释放
+// 退休的节点只保存地址和释放函数, 同一个 domain 可以同时回收不同类型的节点
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+#include "algo.h"
+#include "concurrent_queue.h"
+#include "exceptdef.h"
+#include "util.h"
+#include "vector.h"
+
+namespace dhsstl
+{
+
+// 每个线程可以同时持有的 hazard pointer 个数
+#ifndef DHSSTL_HAZARD_SLOTS
+#define DHSSTL_HAZARD_SLOTS 4
+#endif
+
+// 每个线程攒够这么多退休的节点之后才尝试回收
+#ifndef DHSSTL_RECLAIM_BATCH
+#define DHSSTL_RECLAIM_BATCH 64
+#endif
+
+namespace detail
+{
+
+// 一个已经退休, 等待释放的节点
+struct retired_ptr
+{
+    void*    ptr;
+    void   (*reclaim)(void*);
+    uint64_t epoch;   // 只有 epoch_domain 使用
+};
+
+template <class T>
+void reclaim_delete(void* p){
+    delete static_cast<T*>(p);
+}
+
+// 线程退出时还没有释放的节点, 只在线程退出和扫描时加锁访问
+class orphan_list
+{
+    std::mutex                     mtx_;
+    dhsstl::vector<retired_ptr>    nodes_;
+    std::atomic<bool>              nonempty_{false};
+
+public:
+    void give(dhsstl::vector<retired_ptr>& v){
+        if(v.empty())
+            return;
+        std::lock_guard<std::mutex> lk(mtx_);
+        for(auto& r : v)
+            nodes_.push_back(r);
+        nonempty_.store(true, std::memory_order_relaxed);
+        v.clear();
+    }
+
+    void take(dhsstl::vector<retired_ptr>& v){
+        if(!nonempty_.load(std::memory_order_relaxed))
+            return;
+        std::lock_guard<std::mutex> lk(mtx_);
+        for(auto& r : nodes_)
+            v.push_back(r);
+        nodes_.clear();
+        nonempty_.store(false, std::memory_order_relaxed);
+    }
+
+    // 程序结束时已经没有读者
+    ~orphan_list(){
+        for(auto& r : nodes_)
+            r.reclaim(r.ptr);
+    }
+};
+
+// 登记在 domain 中的线程记录组成的链表, 记录只增加不删除, 线程退出后由其他线程复用
+template <class Record>
+class record_list
+{
+    std::atomic<Record*> head_{nullptr};
+    std::atomic<size_t>  size_{0};
+
+public:
+    Record* acquire(){
+        for(Record* r = head_.load(std::memory_order_acquire); r != nullptr; r = r->next){
+            bool expected = false;
+            if(!r->in_use.load(std::memory_order_relaxed) &&
+               r->in_use.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+                return r;
+        }
+        Record* r = new Record();
+        r->in_use.store(true, std::memory_order_relaxed);
+        Record* old = head_.load(std::memory_order_relaxed);
+        do{
+            r->next = old;
+        }while(!head_.compare_exchange_weak(old, r, std::memory_order_release, std::memory_order_relaxed));
+        size_.fetch_add(1, std::memory_order_relaxed);
+        return r;
+    }
+
+    void release(Record* r) noexcept{
+        r->in_use.store(false, std::memory_order_release);
+    }
+
+    Record* head() const noexcept { return head_.load(std::memory_order_acquire); }
+    size_t  size() const noexcept { return size_.load(std::memory_order_relaxed); }
+
+    ~record_list(){
+        for(Record* r = head_.load(std::memory_order_relaxed); r != nullptr; ){
+            Record* next = r->next;
+            delete r;
+            r = next;
+        }
+    }
+};
+
+} // namespace detail
+
+/*****************************************************************************************/
+// hazard_domain
+// 进程内唯一, 由 hazard_pointer / hazard_retire / hazard_scan 使用
+/*****************************************************************************************/
+class hazard_domain
+{
+public:
+    static constexpr size_t slots = DHSSTL_HAZARD_SLOTS;
+
+    struct alignas(cache_line_size) record
+    {
+        std::atomic<const void*> hazard[slots];
+        std::atomic<bool>        in_use{false};
+        record*                  next = nullptr;
+
+        record() noexcept{
+            for(size_t i = 0; i < slots; ++i)
+                hazard[i].store(nullptr, std::memory_order_relaxed);
+        }
+    };
+
+private:
+    // 每个线程的状态: 记录, 已经占用的槽位, 退休的节点
+    struct local_state
+    {
+        hazard_domain&                      domain;
+        record*                             rec;
+        unsigned                            used = 0;
+        dhsstl::vector<detail::retired_ptr> retired;
+
+        explicit local_state(hazard_domain& d) :domain(d), rec(d.records_.acquire()) {}
+        ~local_state(){
+            domain.scan(retired);
+            domain.orphans_.give(retired);
+            domain.records_.release(rec);
+        }
+    };
+
+    detail::record_list<record> records_;
+    detail::orphan_list         orphans_;
+
+public:
+    static hazard_domain& instance(){
+        static hazard_domain d;
+        return d;
+    }
+
+    // 返回本线程的一个空闲槽位
+    static std::atomic<const void*>* acquire_slot(){
+        local_state& s = local();
+        for(unsigned i = 0; i < slots; ++i){
+            if((s.used & (1u << i)) == 0){
+                s.used |= 1u << i;
+                return &s.rec->hazard[i];
+            }
+        }
+        THROW_RUNTIME_ERROR_IF(true, "hazard_pointer: too many hazard pointers in one thread");
+        return nullptr;
+    }
+
+    static void release_slot(std::atomic<const void*>* slot) noexcept{
+        local_state& s = local();
+        slot->store(nullptr, std::memory_order_release);
+        s.used &= ~(1u << static_cast<unsigned>(slot - s.rec->hazard));
+    }
+
+    // p 必须已经从数据结构中摘下, 之后不会再有新的读者拿到它
+    static void retire(void* p, void (*reclaim)(void*)){
+        local_state& s = local();
+        s.retired.push_back(detail::retired_ptr{ p, reclaim, 0 });
+        if(s.retired.size() >= s.domain.threshold())
+            s.domain.scan(s.retired);
+    }
+
+    // 立即回收本线程和已退出线程留下的节点中没有被保护的那些
+    static void scan(){
+        local_state& s = local();
+        s.domain.scan(s.retired);
+    }
+
+    // 本线程中还没有释放的节点个数
+    static size_t pending(){
+        return local().retired.size();
+    }
+
+private:
+    hazard_domain() = default;
+
+    // domain 先于 local_state 构造, 因而在它之后析构
+    static local_state& local(){
+        static thread_local local_state s(instance());
+        return s;
+    }
+
+    size_t threshold() const noexcept{
+        return dhsstl::max<size_t>(DHSSTL_RECLAIM_BATCH, 2 * slots * records_.size());
+    }
+
+    void scan(dhsstl::vector<detail::retired_ptr>& retired);
+};
+
+// 先收集所有线程的 hazard pointer 并排序, 再逐个检查退休的节点
+// 释放函数中可能再 retire 其他节点, 所以先把待检查的节点换到 work 中
+inline void hazard_domain::scan(dhsstl::vector<detail::retired_ptr>& retired){
+    orphans_.take(retired);
+    if(retired.empty())
+        return;
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    dhsstl::vector<const void*> protect;
+    protect.reserve(records_.size() * slots);
+    for(record* r = records_.head(); r != nullptr; r = r->next){
+        for(size_t i = 0; i < slots; ++i){
+            const void* p = r->hazard[i].load(std::memory_order_acquire);
+            if(p != nullptr)
+                protect.push_back(p);
+        }
+    }
+    dhsstl::sort(protect.begin(), protect.end());
+
+    dhsstl::vector<detail::retired_ptr> work;
+    work.swap(retired);
+    for(auto& r : work){
+        auto it = dhsstl::lower_bound(protect.begin(), protect.end(), static_cast<const void*>(r.ptr));
+        if(it != protect.end() && *it == r.ptr)
+            retired.push_back(r);
+        else
+            r.reclaim(r.ptr);
+    }
+}
+
+/*****************************************************************************************/
+// hazard_pointer
+// 占用本线程的一个 hazard 槽位, 析构时归还
+// 用法:
+//     hazard_pointer hp;
+//     node* p = hp.protect(head);   // 在 hp 重置或析构之前, p 不会被释放
+/*****************************************************************************************/
+class hazard_pointer
+{
+    std::atomic<const void*>* slot_;
+
+public:
+    hazard_pointer() :slot_(hazard_domain::acquire_slot()) {}
+
+    hazard_pointer(hazard_pointer&& rhs) noexcept :slot_(rhs.slot_){
+        rhs.slot_ = nullptr;
+    }
+
+    hazard_pointer(const hazard_pointer&) = delete;
+    hazard_pointer& operator=(const hazard_pointer&) = delete;
+
+    ~hazard_pointer(){
+        if(slot_ != nullptr)
+            hazard_domain::release_slot(slot_);
+    }
+
+    // 读出 src 并保护, 写入槽位之后 src 没有改变, 说明写入时节点还没有退休
+    template <class T>
+    T* protect(const std::atomic<T*>& src) noexcept{
+        T* p = src.load(std::memory_order_relaxed);
+        for(;;){
+            slot_->store(p, std::memory_order_seq_cst);
+            T* q = src.load(std::memory_order_seq_cst);
+            if(q == p)
+                return p;
+            p = q;
+        }
+    }
+
+    // 直接保护 p, 调用者需要自己确认 p 还没有退休
+    void reset(const void* p) noexcept{
+        slot_->store(p, std::memory_order_seq_cst);
+    }
+
+    void reset() noexcept{
+        slot_->store(nullptr, std::memory_order_release);
+    }
+};
+
+template <class T>
+void hazard_retire(T* p){
+    hazard_domain::retire(p, &detail::reclaim_delete<T>);
+}
+
+inline void hazard_retire(void* p, void (*reclaim)(void*)){
+    hazard_domain::retire(p, reclaim);
+}
+
+inline void hazard_scan(){
+    hazard_domain::scan();
+}
+
+/*****************************************************************************************/
+// epoch_domain
+// 进程内唯一, 由 epoch_guard / epoch_retire / epoch_collect 使用
+// 记录的 state 为 (epoch << 1) | active
+/*****************************************************************************************/
+class epoch_domain
+{
+public:
+    struct alignas(cache_line_size) record
+    {
+        std::atomic<uint64_t> state{0};
+        std::atomic<bool>     in_use{false};
+        record*               next = nullptr;
+    };
+
+private:
+    struct local_state
+    {
+        epoch_domain&                       domain;
+        record*                             rec;
+        unsigned                            depth = 0;
+        size_t                              next_collect = DHSSTL_RECLAIM_BATCH;
+        dhsstl::vector<detail::retired_ptr> retired;
+
+        explicit local_state(epoch_domain& d) :domain(d), rec(d.records_.acquire()) {}
+        ~local_state(){
+            rec->state.store(0, std::memory_order_release);
+            domain.collect(retired);
+            domain.orphans_.give(retired);
+            domain.records_.release(rec);
+        }
+    };
+
+    alignas(cache_line_size) std::atomic<uint64_t> epoch_{0};
+    alignas(cache_line_size) detail::record_list<record> records_;
+    detail::orphan_list                                  orphans_;
+
+public:
+    static epoch_domain& instance(){
+        static epoch_domain d;
+        return d;
+    }
+
+    // 可以嵌套, 只有最外层的 pin 记录 epoch
+    // 线程第一次调用时要登记一条记录, 可能抛出 std::bad_alloc, 所以不是 noexcept
+    static void pin(){
+        local_state& s = local();
+        if(s.depth++ == 0){
+            const uint64_t e = s.domain.epoch_.load(std::memory_order_relaxed);
+            s.rec->state.store((e << 1) | 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+    }
+
+    static void unpin() noexcept{
+        local_state& s = local();
+        if(--s.depth == 0)
+            s.rec->state.store(0, std::memory_order_release);
+    }
+
+    static void retire(void* p, void (*reclaim)(void*)){
+        local_state& s = local();
+        const uint64_t e = s.domain.epoch_.load(std::memory_order_seq_cst);
+        s.retired.push_back(detail::retired_ptr{ p, reclaim, e });
+        if(s.retired.size() >= s.next_collect){
+            s.domain.collect(s.retired);
+            s.next_collect = s.retired.size() + DHSSTL_RECLAIM_BATCH;
+        }
+    }
+
+    // 尝试推进全局 epoch, 并释放本线程中已经安全的节点
+    static void collect(){
+        local_state& s = local();
+        s.domain.collect(s.retired);
+    }
+
+    static size_t pending(){
+        return local().retired.size();
+    }
+
+    static uint64_t epoch() noexcept{
+        return instance().epoch_.load(std::memory_order_relaxed);
+    }
+
+private:
+    epoch_domain() = default;
+
+    static local_state& local(){
+        static thread_local local_state s(instance());
+        return s;
+    }
+
+    // 所有在临界区中的线程都已经进入当前 epoch 时, 全局 epoch 加一
+    void try_advance() noexcept{
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        uint64_t e = epoch_.load(std::memory_order_seq_cst);
+        for(record* r = records_.head(); r != nullptr; r = r->next){
+            const uint64_t s = r->state.load(std::memory_order_seq_cst);
+            if((s & 1) != 0 && (s >> 1) != e)
+                return;
+        }
+        epoch_.compare_exchange_strong(e, e + 1, std::memory_order_seq_cst);
+    }
+
+    void collect(dhsstl::vector<detail::retired_ptr>& retired);
+};
+
+// 读者最多落后全局 epoch 一代, 所以在 e 退休的节点在全局 epoch 达到 e + 2 时已经没有读者
+inline void epoch_domain::collect(dhsstl::vector<detail::retired_ptr>& retired){
+    orphans_.take(retired);
+    if(retired.empty())
+        return;
+    try_advance();
+    const uint64_t e = epoch_.load(std::memory_order_acquire);
+    dhsstl::vector<detail::retired_ptr> work;
+    work.swap(retired);
+    for(auto& r : work){
+        if(r.epoch + 2 <= e)
+            r.reclaim(r.ptr);
+        else
+            retired.push_back(r);
+    }
+}
+
+/*****************************************************************************************/
+// epoch_guard
+// 在作用域内把本线程标记为读者, 此期间读到的节点不会被释放
+/*****************************************************************************************/
+class epoch_guard
+{
+public:
+    epoch_guard()   { epoch_domain::pin(); }
+    ~epoch_guard()  { epoch_domain::unpin(); }
+
+    epoch_guard(const epoch_guard&) = delete;
+    epoch_guard& operator=(const epoch_guard&) = delete;
+};
+
+template <class T>
+void epoch_retire(T* p){
+    epoch_domain::retire(p, &detail::reclaim_delete<T>);
+}
+
+inline void epoch_retire(void* p, void (*reclaim)(void*)){
+    epoch_domain::retire(p, reclaim);
+}
+
+inline void epoch_collect(){
+    epoch_domain::collect();
+}
+
+} // namespace dhsstl
+
+#endif // !DHSTINYSTL_RECLAIM_H_
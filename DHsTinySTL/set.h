@@ -21,8 +21,9 @@ namespace dhsstl
  * @brief 模板类set, 键值不允许重复
  * @tparam Key 键值类型
  * @tparam Compare 键值比较方式, 缺省使用dhstl::less
+ * @tparam Alloc 分配器, 见 rb_tree
 */
-template <typename Key, typename Compare = dhsstl::less<Key>>
+template <typename Key, typename Compare = dhsstl::less<Key>, typename Alloc = dhsstl::allocator<Key>>
 class set{
 public:
     typedef Key         key_type;
@@ -32,7 +33,7 @@ public:
 
 private:
     // 以 dhsstl::rb_tree 作为底层机制
-    typedef dhsstl::rb_tree<value_type, key_compare> base_type;
+    typedef dhsstl::rb_tree<value_type, key_compare, Alloc> base_type;
     base_type tree_;
 
 public:
@@ -197,39 +198,39 @@ public:
 };
 
 // 重载比较操作符
-template <typename Key, typename Compare>
-bool operator==(const set<Key, Compare>& lhs, const set<Key, Compare>& rhs){
+template <typename Key, typename Compare, typename Alloc>
+bool operator==(const set<Key, Compare, Alloc>& lhs, const set<Key, Compare, Alloc>& rhs){
     return lhs == rhs;
 }
 
-template <typename Key, typename Compare>
-bool operator<(const set<Key, Compare>& lhs, const set<Key, Compare>& rhs){
+template <typename Key, typename Compare, typename Alloc>
+bool operator<(const set<Key, Compare, Alloc>& lhs, const set<Key, Compare, Alloc>& rhs){
     return lhs < rhs;
 }
 
-template <typename Key, typename Compare>
-bool operator!=(const set<Key, Compare>& lhs, const set<Key, Compare>& rhs){
+template <typename Key, typename Compare, typename Alloc>
+bool operator!=(const set<Key, Compare, Alloc>& lhs, const set<Key, Compare, Alloc>& rhs){
     return !(lhs == rhs);
 }
 
-template <typename Key, typename Compare>
-bool operator>(const set<Key, Compare>& lhs, const set<Key, Compare>& rhs){
+template <typename Key, typename Compare, typename Alloc>
+bool operator>(const set<Key, Compare, Alloc>& lhs, const set<Key, Compare, Alloc>& rhs){
     return rhs < lhs;
 }
 
-template <typename Key, typename Compare>
-bool operator<=(const set<Key, Compare>& lhs, const set<Key, Compare>& rhs){
+template <typename Key, typename Compare, typename Alloc>
+bool operator<=(const set<Key, Compare, Alloc>& lhs, const set<Key, Compare, Alloc>& rhs){
     return !(rhs < lhs);
 }
 
-template <typename Key, typename Compare>
-bool operator>=(const set<Key, Compare>& lhs, const set<Key, Compare>& rhs){
+template <typename Key, typename Compare, typename Alloc>
+bool operator>=(const set<Key, Compare, Alloc>& lhs, const set<Key, Compare, Alloc>& rhs){
     return !(lhs < rhs);
 }
 
 // 重载 dhsstl 的 swap
-template <typename Key, typename Compare>
-void swap(set<Key, Compare>& lhs, set<Key, Compare>& rhs) noexcept{
+template <typename Key, typename Compare, typename Alloc>
+void swap(set<Key, Compare, Alloc>& lhs, set<Key, Compare, Alloc>& rhs) noexcept{
     lhs.swap(rhs);
 }
 
@@ -237,8 +238,9 @@ void swap(set<Key, Compare>& lhs, set<Key, Compare>& rhs) noexcept{
  * @brief 模板类multiset, 允许键值重复
  * @tparam Key 键值类型
  * @tparam Compare 键值比较方式, 缺省使用 dhsstl::less
+ * @tparam Alloc 分配器, 见 rb_tree
 */
-template <typename Key, typename Compare = dhsstl::less<Key>>
+template <typename Key, typename Compare = dhsstl::less<Key>, typename Alloc = dhsstl::allocator<Key>>
 class multiset{
 public:
     typedef Key         key_type;
@@ -248,7 +250,7 @@ public:
 
 private:
     // 以 dhsstl::rb_tree 作为底层机制
-    typedef dhsstl::rb_tree<value_type, key_compare> base_type;
+    typedef dhsstl::rb_tree<value_type, key_compare, Alloc> base_type;
     base_type tree_;
 
 public:
@@ -409,39 +411,39 @@ public:
 };
 
 // 重载比较操作符
-template <typename Key, typename Compare>
-bool operator==(const multiset<Key, Compare>& lhs, const multiset<Key, Compare>& rhs){
+template <typename Key, typename Compare, typename Alloc>
+bool operator==(const multiset<Key, Compare, Alloc>& lhs, const multiset<Key, Compare, Alloc>& rhs){
     return lhs == rhs;
 }
 
-template <typename Key, typename Compare>
-bool operator<(const multiset<Key, Compare>& lhs, const multiset<Key, Compare>& rhs){
+template <typename Key, typename Compare, typename Alloc>
+bool operator<(const multiset<Key, Compare, Alloc>& lhs, const multiset<Key, Compare, Alloc>& rhs){
     return lhs < rhs;
 }
 
-template <typename Key, typename Compare>
-bool operator!=(const multiset<Key, Compare>& lhs, const multiset<Key, Compare>& rhs){
+template <typename Key, typename Compare, typename Alloc>
+bool operator!=(const multiset<Key, Compare, Alloc>& lhs, const multiset<Key, Compare, Alloc>& rhs){
     return !(lhs == rhs);
 }
 
-template <typename Key, typename Compare>
-bool operator>(const multiset<Key, Compare>& lhs, const multiset<Key, Compare>& rhs){
+template <typename Key, typename Compare, typename Alloc>
+bool operator>(const multiset<Key, Compare, Alloc>& lhs, const multiset<Key, Compare, Alloc>& rhs){
     return rhs < lhs;
 }
 
-template <typename Key, typename Compare>
-bool operator<=(const multiset<Key, Compare>& lhs, const multiset<Key, Compare>& rhs){
+template <typename Key, typename Compare, typename Alloc>
+bool operator<=(const multiset<Key, Compare, Alloc>& lhs, const multiset<Key, Compare, Alloc>& rhs){
     return !(rhs < lhs);
 }
 
-template <typename Key, typename Compare>
-bool operator>=(const multiset<Key, Compare>& lhs, const multiset<Key, Compare>& rhs){
+template <typename Key, typename Compare, typename Alloc>
+bool operator>=(const multiset<Key, Compare, Alloc>& lhs, const multiset<Key, Compare, Alloc>& rhs){
     return !(lhs < rhs);
 }
 
 // 重载 dhsstl 的 swap
-template <typename Key, typename Compare>
-void swap(multiset<Key, Compare>& lhs, multiset<Key, Compare>& rhs) noexcept{
+template <typename Key, typename Compare, typename Alloc>
+void swap(multiset<Key, Compare, Alloc>& lhs, multiset<Key, Compare, Alloc>& rhs) noexcept{
     lhs.swap(rhs);
 }
 } // namespace dhsstl
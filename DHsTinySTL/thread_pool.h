@@ -0,0 +1,541 @@
+#ifndef DHSTINYSTL_THREAD_POOL_H_
+#define DHSTINYSTL_THREAD_POOL_H_
+
+// 这个头文件包含一个工作窃取(work stealing)的线程池 thread_pool, 以及它用到的:
+//
+// work_stealing_deque : Chase-Lev 双端队列, 所有者在底部 push / pop, 其他线程从顶部 steal
+//                       使用可以增长的环形数组, 内存序参考 Lê, Pop, Cohen, Nardelli 2013 的 C11 版本
+// task_group          : fork-join 原语, spawn 提交一个任务, sync 等待这一组任务全部完成
+//                       等待期间当前线程会执行(或窃取)其他任务, 而不是阻塞
+// thread_pool         : 每个工作线程有一个 work_stealing_deque, 自己的任务后进先出, 空闲时随机选择其他线程窃取
+//                       非工作线程提交的任务进入一个加锁的注入队列
+//                       parallel_for 把区间递归二分成任务, 每个任务处理不超过 grain 个元素
+//
+// 注: 任务中抛出的异常会被捕获, 在 sync 时重新抛出(只保留第一个)
+//     线程池析构时工作线程不再取新任务, 队列中剩下的任务直接释放, 不会执行
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+
+#include "allocator.h"
+#include "concurrent_queue.h"
+#include "deque.h"
+#include "util.h"
+#include "vector.h"
+
+namespace dhsstl
+{
+
+/*****************************************************************************************/
+// work_stealing_deque
+// T 必须是 trivially copyable 的类型, 通常是任务指针
+// push / pop 只能由所有者线程调用, steal 可以由任意线程调用
+/*****************************************************************************************/
+template <class T>
+class work_stealing_deque
+{
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "work_stealing_deque<T> requires a trivially copyable T");
+
+public:
+    typedef T           value_type;
+    typedef ptrdiff_t   index_type;
+
+private:
+    // 环形数组, 下标对容量取模
+    struct ring
+    {
+        index_type          capacity;
+        index_type          mask;
+        std::atomic<T>*     slots;
+
+        typedef dhsstl::allocator<std::atomic<T>> slot_allocator;
+
+        // allocate 只分配内存, 每个 atomic 需要再构造一次
+        explicit ring(index_type cap)
+            :capacity(cap), mask(cap - 1),
+             slots(slot_allocator::allocate(static_cast<size_t>(cap))){
+            for(index_type i = 0; i != cap; ++i)
+                slot_allocator::construct(slots + i, T());
+        }
+        ~ring(){
+            slot_allocator::destroy(slots, slots + capacity);
+            slot_allocator::deallocate(slots, static_cast<size_t>(capacity));
+        }
+
+        T    get(index_type i) const noexcept  { return slots[i & mask].load(std::memory_order_relaxed); }
+        void put(index_type i, T x) noexcept   { slots[i & mask].store(x, std::memory_order_relaxed); }
+
+        // 容量加倍, 复制 [top, bottom) 中的元素
+        ring* grow(index_type top, index_type bottom) const{
+            ring* r = new ring(capacity * 2);
+            for(index_type i = top; i != bottom; ++i)
+                r->put(i, get(i));
+            return r;
+        }
+    };
+
+    alignas(cache_line_size) std::atomic<index_type> top_;      // 窃取者竞争
+    alignas(cache_line_size) std::atomic<index_type> bottom_;   // 所有者写
+    std::atomic<ring*>                               array_;
+    // 旧的数组可能还在被窃取者读取, 保留到析构时再释放
+    dhsstl::vector<ring*>                            retired_;
+
+public:
+    explicit work_stealing_deque(size_t capacity = 256)
+        :top_(0), bottom_(0),
+         array_(new ring(static_cast<index_type>(detail::ring_capacity(capacity, 2)))) {}
+
+    work_stealing_deque(const work_stealing_deque&) = delete;
+    work_stealing_deque& operator=(const work_stealing_deque&) = delete;
+
+    ~work_stealing_deque(){
+        delete array_.load(std::memory_order_relaxed);
+        for(auto r : retired_)
+            delete r;
+    }
+
+public:
+    // 其他线程同时操作时只是一个近似值
+    size_t size_approx() const noexcept{
+        const index_type b = bottom_.load(std::memory_order_relaxed);
+        const index_type t = top_.load(std::memory_order_relaxed);
+        return b > t ? static_cast<size_t>(b - t) : 0;
+    }
+    bool empty() const noexcept { return size_approx() == 0; }
+
+    // 所有者接口
+    void push(T x);
+    bool pop(T& x) noexcept;
+
+    // 窃取者接口, 队列为空或者和其他线程竞争失败时返回 false
+    bool steal(T& x) noexcept;
+};
+
+template <class T>
+void work_stealing_deque<T>::push(T x){
+    const index_type b = bottom_.load(std::memory_order_relaxed);
+    const index_type t = top_.load(std::memory_order_acquire);
+    ring* a = array_.load(std::memory_order_relaxed);
+    if(b - t > a->capacity - 1){
+        // 先为 retired_ 预留位置, 分配新数组之后的步骤都不会抛出异常
+        retired_.reserve(retired_.size() + 1);
+        ring* bigger = a->grow(t, b);
+        retired_.push_back(a);
+        array_.store(bigger, std::memory_order_release);
+        a = bigger;
+    }
+    a->put(b, x);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom_.store(b + 1, std::memory_order_relaxed);
+}
+
+template <class T>
+bool work_stealing_deque<T>::pop(T& x) noexcept{
+    const index_type b = bottom_.load(std::memory_order_relaxed) - 1;
+    ring* a = array_.load(std::memory_order_relaxed);
+    bottom_.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    index_type t = top_.load(std::memory_order_relaxed);
+    if(t > b){
+        // 队列为空
+        bottom_.store(b + 1, std::memory_order_relaxed);
+        return false;
+    }
+    x = a->get(b);
+    if(t == b){
+        // 最后一个元素, 和窃取者竞争
+        const bool won = top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                                      std::memory_order_relaxed);
+        bottom_.store(b + 1, std::memory_order_relaxed);
+        return won;
+    }
+    return true;
+}
+
+template <class T>
+bool work_stealing_deque<T>::steal(T& x) noexcept{
+    index_type t = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const index_type b = bottom_.load(std::memory_order_acquire);
+    if(t >= b)
+        return false;
+    ring* a = array_.load(std::memory_order_acquire);
+    x = a->get(t);
+    return top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                        std::memory_order_relaxed);
+}
+
+/*****************************************************************************************/
+// task_base / task_impl
+// 任务对象由 spawn 分配, 执行完毕后自己释放
+// 线程池析构时还没有执行的任务通过 discard 释放, 不执行
+/*****************************************************************************************/
+class task_group;
+
+struct task_base
+{
+    void      (*invoke)(task_base*);
+    void      (*discard)(task_base*);
+    task_group* group;
+};
+
+class thread_pool;
+
+/*****************************************************************************************/
+// task_group
+// 一组 fork-join 任务, 析构前会等待所有任务完成
+/*****************************************************************************************/
+class task_group
+{
+    thread_pool&                pool_;
+    std::atomic<size_t>         pending_;
+    std::atomic<bool>           failed_;
+    std::exception_ptr          error_;
+
+    template <class F>
+    struct task_impl : public task_base
+    {
+        F f;
+
+        template <class G>
+        task_impl(task_group* g, G&& fn) :f(dhsstl::forward<G>(fn)){
+            invoke = &task_impl::run;
+            discard = &task_impl::drop;
+            group = g;
+        }
+
+        static void run(task_base* t){
+            task_impl* self = static_cast<task_impl*>(t);
+            task_group* g = self->group;
+            try{
+                self->f();
+            }
+            catch(...){
+                g->set_error(std::current_exception());
+            }
+            // 先释放任务(以及 f 捕获的对象), 再通知 sync
+            delete self;
+            g->pending_.fetch_sub(1, std::memory_order_release);
+        }
+
+        // 同样减少计数, 使 task_group 的析构不再等待这个任务
+        static void drop(task_base* t){
+            task_impl* self = static_cast<task_impl*>(t);
+            task_group* g = self->group;
+            delete self;
+            g->pending_.fetch_sub(1, std::memory_order_release);
+        }
+    };
+
+public:
+    explicit task_group(thread_pool& pool) noexcept
+        :pool_(pool), pending_(0), failed_(false) {}
+
+    task_group(const task_group&) = delete;
+    task_group& operator=(const task_group&) = delete;
+
+    ~task_group(){
+        wait();
+    }
+
+    // 提交一个任务, f 以无参数的形式调用
+    template <class F>
+    void spawn(F&& f);
+
+    // 等待所有任务完成, 重新抛出任务中的第一个异常
+    void sync(){
+        wait();
+        if(failed_.load(std::memory_order_relaxed)){
+            failed_.store(false, std::memory_order_relaxed);
+            std::exception_ptr e = error_;
+            error_ = nullptr;
+            std::rethrow_exception(e);
+        }
+    }
+
+private:
+    void wait() noexcept;
+
+    void set_error(std::exception_ptr e) noexcept{
+        bool expected = false;
+        if(failed_.compare_exchange_strong(expected, true, std::memory_order_relaxed))
+            error_ = e;
+    }
+};
+
+/*****************************************************************************************/
+// thread_pool
+/*****************************************************************************************/
+class thread_pool
+{
+    friend class task_group;
+
+    struct alignas(cache_line_size) worker
+    {
+        work_stealing_deque<task_base*> tasks;
+        std::thread                     thread;
+        unsigned                        seed;
+    };
+
+    // 当前线程属于哪个线程池的哪个工作线程
+    struct thread_info
+    {
+        thread_pool* pool = nullptr;
+        size_t       index = 0;
+    };
+    static thread_info& this_thread_info() noexcept{
+        static thread_local thread_info info;
+        return info;
+    }
+
+    dhsstl::vector<worker*>     workers_;
+
+    // 外部线程提交的任务
+    std::mutex                  inject_mtx_;
+    dhsstl::deque<task_base*>   inject_;
+    std::atomic<size_t>         inject_size_;
+
+    // 空闲的工作线程在条件变量上睡眠, 提交任务时 epoch_ 加一
+    std::atomic<bool>           stop_;
+    std::atomic<size_t>         epoch_;
+    std::atomic<size_t>         sleepers_;
+    std::mutex                  sleep_mtx_;
+    std::condition_variable     sleep_cv_;
+
+public:
+    // n 为 0 时使用硬件线程数
+    explicit thread_pool(size_t n = 0);
+
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    ~thread_pool();
+
+public:
+    size_t size() const noexcept { return workers_.size(); }
+
+    // 把 [first, last) 递归二分, 对每个不超过 grain 个元素的子区间调用 f(lo, hi)
+    // grain 为 0 时让每个工作线程大约分到 8 块
+    template <class Index, class F>
+    void parallel_for(Index first, Index last, Index grain, F&& f);
+
+    // 执行一个其他任务, 没有可以执行的任务时返回 false, task_group::sync 用它在等待时帮忙
+    bool run_one();
+
+private:
+    // 入队时分配内存失败会抛出异常, 此时 t 没有进入任何队列
+    void submit(task_base* t);
+    task_base* find_task(size_t self);
+    bool steal_from(size_t self, unsigned& seed, task_base*& t);
+    void worker_loop(size_t index);
+    void notify();
+
+    template <class Index, class F>
+    void parallel_for_aux(task_group& g, Index first, Index last, Index grain, F& f);
+};
+
+/*****************************************************************************************/
+
+inline thread_pool::thread_pool(size_t n)
+    :inject_size_(0), stop_(false), epoch_(0), sleepers_(0)
+{
+    if(n == 0)
+        n = dhsstl::max<size_t>(std::thread::hardware_concurrency(), 1);
+    workers_.reserve(n);
+    for(size_t i = 0; i < n; ++i){
+        worker* w = new worker();
+        w->seed = static_cast<unsigned>(i * 2654435761u + 1);
+        workers_.push_back(w);
+    }
+    for(size_t i = 0; i < n; ++i)
+        workers_[i]->thread = std::thread([this, i]{ worker_loop(i); });
+}
+
+inline thread_pool::~thread_pool(){
+    {
+        std::lock_guard<std::mutex> lk(sleep_mtx_);
+        stop_.store(true, std::memory_order_seq_cst);
+    }
+    sleep_cv_.notify_all();
+    for(auto w : workers_)
+        w->thread.join();
+    // 工作线程退出时队列中可能还有任务, 释放它们
+    task_base* t = nullptr;
+    for(auto w : workers_){
+        while(w->tasks.pop(t))
+            t->discard(t);
+        delete w;
+    }
+    while(!inject_.empty()){
+        t = inject_.front();
+        inject_.pop_front();
+        t->discard(t);
+    }
+}
+
+// 提交任务后唤醒一个睡眠的工作线程
+// 工作线程先增加 sleepers_ 再检查 epoch_, 这里先增加 epoch_ 再检查 sleepers_, 两者至少有一方能看到对方
+inline void thread_pool::notify(){
+    epoch_.fetch_add(1, std::memory_order_seq_cst);
+    if(sleepers_.load(std::memory_order_seq_cst) != 0){
+        std::lock_guard<std::mutex> lk(sleep_mtx_);
+        sleep_cv_.notify_one();
+    }
+}
+
+inline void thread_pool::submit(task_base* t){
+    thread_info& info = this_thread_info();
+    if(info.pool == this){
+        workers_[info.index]->tasks.push(t);
+    }
+    else{
+        std::lock_guard<std::mutex> lk(inject_mtx_);
+        inject_.push_back(t);
+        inject_size_.fetch_add(1, std::memory_order_release);
+    }
+    notify();
+}
+
+inline bool thread_pool::steal_from(size_t self, unsigned& seed, task_base*& t){
+    const size_t n = workers_.size();
+    // 从随机的位置开始, 依次尝试每个其他的工作线程
+    seed = seed * 1103515245u + 12345u;
+    const size_t start = (seed >> 16) % n;
+    for(size_t k = 0; k < n; ++k){
+        const size_t victim = (start + k) % n;
+        if(victim != self && workers_[victim]->tasks.steal(t))
+            return true;
+    }
+    return false;
+}
+
+// self 为 size() 时表示不是工作线程
+inline task_base* thread_pool::find_task(size_t self){
+    task_base* t = nullptr;
+    if(self < workers_.size() && workers_[self]->tasks.pop(t))
+        return t;
+    if(inject_size_.load(std::memory_order_acquire) != 0){
+        std::lock_guard<std::mutex> lk(inject_mtx_);
+        if(!inject_.empty()){
+            t = inject_.front();
+            inject_.pop_front();
+            inject_size_.fetch_sub(1, std::memory_order_relaxed);
+            return t;
+        }
+    }
+    static thread_local unsigned seed = 0x9e3779b9u;
+    unsigned& s = self < workers_.size() ? workers_[self]->seed : seed;
+    if(steal_from(self, s, t))
+        return t;
+    return nullptr;
+}
+
+inline bool thread_pool::run_one(){
+    thread_info& info = this_thread_info();
+    task_base* t = find_task(info.pool == this ? info.index : workers_.size());
+    if(t == nullptr)
+        return false;
+    t->invoke(t);
+    return true;
+}
+
+inline void thread_pool::worker_loop(size_t index){
+    thread_info& info = this_thread_info();
+    info.pool = this;
+    info.index = index;
+    backoff b;
+    size_t idle = 0;
+    while(!stop_.load(std::memory_order_relaxed)){
+        const size_t epoch = epoch_.load(std::memory_order_seq_cst);
+        if(task_base* t = find_task(index)){
+            t->invoke(t);
+            b.reset();
+            idle = 0;
+            continue;
+        }
+        if(++idle < 32){
+            b.pause();
+            continue;
+        }
+        // 连续多次找不到任务, 睡眠到有新任务提交
+        std::unique_lock<std::mutex> lk(sleep_mtx_);
+        sleepers_.fetch_add(1, std::memory_order_seq_cst);
+        sleep_cv_.wait(lk, [&]{
+            return stop_.load(std::memory_order_relaxed) ||
+                   epoch_.load(std::memory_order_seq_cst) != epoch;
+        });
+        sleepers_.fetch_sub(1, std::memory_order_relaxed);
+        idle = 0;
+        b.reset();
+    }
+}
+
+template <class Index, class F>
+void thread_pool::parallel_for(Index first, Index last, Index grain, F&& f){
+    if(!(first < last))
+        return;
+    if(grain == Index(0)){
+        grain = static_cast<Index>((last - first) / static_cast<Index>(size() * 8));
+        if(grain == Index(0))
+            grain = Index(1);
+    }
+    task_group g(*this);
+    parallel_for_aux(g, first, last, grain, f);
+    g.sync();
+}
+
+// 右半部分作为任务提交, 当前线程继续处理左半部分
+template <class Index, class F>
+void thread_pool::parallel_for_aux(task_group& g, Index first, Index last, Index grain, F& f){
+    while(last - first > grain){
+        const Index mid = first + (last - first) / 2;
+        g.spawn([this, &g, mid, last, grain, &f]{ parallel_for_aux(g, mid, last, grain, f); });
+        last = mid;
+    }
+    f(first, last);
+}
+
+/*****************************************************************************************/
+
+template <class F>
+void task_group::spawn(F&& f){
+    typedef task_impl<typename std::decay<F>::type> impl;
+    impl* t = new impl(this, dhsstl::forward<F>(f));
+    // 先计数再入队, 否则任务可能在计数之前执行完并减一
+    // 入队失败(例如队列扩容时 bad_alloc)时任务不会执行, 撤销计数, 否则 wait 永远等不到 0
+    pending_.fetch_add(1, std::memory_order_relaxed);
+    try{
+        pool_.submit(t);
+    }
+    catch(...){
+        pending_.fetch_sub(1, std::memory_order_relaxed);
+        delete t;
+        throw;
+    }
+}
+
+inline void task_group::wait() noexcept{
+    backoff b;
+    while(pending_.load(std::memory_order_acquire) != 0){
+        if(pool_.run_one())
+            b.reset();
+        else
+            b.pause();
+    }
+}
+
+// 默认的线程池, 线程数等于硬件线程数, 第一次使用时创建
+inline thread_pool& default_thread_pool(){
+    static thread_pool pool;
+    return pool;
+}
+
+} // namespace dhsstl
+
+#endif // !DHSTINYSTL_THREAD_POOL_H_
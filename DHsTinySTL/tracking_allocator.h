@@ -0,0 +1,374 @@
+#ifndef DHSTINYSTL_TRACKING_ALLOCATOR_H_
+#define DHSTINYSTL_TRACKING_ALLOCATOR_H_
+
+// 这个头文件包含一个模板类 tracking_allocator, 统计容器持有的内存
+// 接口和 dhsstl::allocator 相同, 把请求转交给 Alloc, 同时按 Tag 记录:
+//   当前持有的字节数, 峰值字节数, 分配 / 释放 / reallocate 的次数, 以及按 2 的幂分组的请求大小直方图
+// 同一个 Tag 的所有分配器共用一份统计, rebind 时保留 Tag, 所以容器的节点, 头结点等都计入同一个 Tag, 例如:
+//      struct index_tag { static const char* name() { return "index"; } };
+//      dhsstl::map<int, int, dhsstl::less<int>,
+//                  dhsstl::tracking_allocator<dhsstl::pair<const int, int>, index_tag>> m;
+//      dhsstl::alloc_stats<index_tag>::snapshot().live_bytes;
+//      dhsstl::dump_alloc_stats_json(std::cout);
+//
+// 注: 计数使用 relaxed 原子操作, 只保证每个计数本身准确, 同一份 snapshot 中的各项不是同一时刻的值
+//     deallocate(p) 不带大小时按一个对象计算, 与 allocate() 配对使用
+//     定义 DHSSTL_ALLOC_TRACKING 为 0 时不做任何记录, tracking_allocator 与 Alloc 相同, snapshot 全为 0
+//     set_alloc_hook 可以设置一个全局的回调, 在每次分配和释放时调用, 用于接入外部的堆分析工具
+
+#include <atomic>
+#include <cstddef>
+#include <ostream>
+#include <type_traits>
+#include <typeinfo>
+
+#include "allocator.h"
+#include "construct.h"
+#include "util.h"
+#include "vector.h"
+#include "Detail/ref.h"
+
+#ifndef DHSSTL_ALLOC_TRACKING
+#define DHSSTL_ALLOC_TRACKING 1
+#endif
+
+// 直方图的组数, 第 k 组记录 [2^k, 2^(k+1)) 字节的请求, 最后一组包含所有更大的请求
+#ifndef DHSSTL_ALLOC_HISTOGRAM_BUCKETS
+#define DHSSTL_ALLOC_HISTOGRAM_BUCKETS 32
+#endif
+
+namespace dhsstl
+{
+
+// 某个 Tag 在某一时刻的统计
+struct alloc_snapshot
+{
+    const char* name;
+    size_t      live_bytes;
+    size_t      peak_bytes;
+    size_t      total_bytes;
+    size_t      allocations;
+    size_t      deallocations;
+    size_t      reallocations;
+    size_t      histogram[DHSSTL_ALLOC_HISTOGRAM_BUCKETS];
+
+    size_t live_blocks() const noexcept { return allocations - deallocations; }
+};
+
+// 分配与释放的回调, allocate 为 false 时表示释放
+typedef void (*alloc_hook)(const char* name, void* ptr, size_t bytes, bool allocate);
+
+namespace detail
+{
+
+// Tag 提供静态函数 name() 时用它作为名字, 否则使用 typeid(Tag).name()
+template <class Tag, class = void>
+struct alloc_tag_name
+{
+    static const char* get() { return typeid(Tag).name(); }
+};
+
+template <class Tag>
+struct alloc_tag_name<Tag, decltype(void(Tag::name()))>
+{
+    static const char* get() { return Tag::name(); }
+};
+
+template <>
+struct alloc_tag_name<void, void>
+{
+    static const char* get() { return "default"; }
+};
+
+inline size_t alloc_bucket(size_t bytes) noexcept{
+    size_t k = 0;
+    while(bytes >>= 1)
+        ++k;
+    return k < DHSSTL_ALLOC_HISTOGRAM_BUCKETS ? k : DHSSTL_ALLOC_HISTOGRAM_BUCKETS - 1;
+}
+
+// 一个 Tag 的计数, 构造时挂到全局链表上, 用于 dump 所有的统计
+struct alloc_counters
+{
+    const char*          name;
+    std::atomic<size_t>  live_bytes;
+    std::atomic<size_t>  peak_bytes;
+    std::atomic<size_t>  total_bytes;
+    std::atomic<size_t>  allocations;
+    std::atomic<size_t>  deallocations;
+    std::atomic<size_t>  reallocations;
+    std::atomic<size_t>  histogram[DHSSTL_ALLOC_HISTOGRAM_BUCKETS];
+    alloc_counters*      next;
+
+    explicit alloc_counters(const char* n) noexcept
+        :name(n), live_bytes(0), peak_bytes(0), total_bytes(0),
+         allocations(0), deallocations(0), reallocations(0), next(nullptr){
+        for(auto& h : histogram)
+            h.store(0, std::memory_order_relaxed);
+        auto& head = registry();
+        next = head.load(std::memory_order_relaxed);
+        while(!head.compare_exchange_weak(next, this, std::memory_order_release, std::memory_order_relaxed))
+            ;
+    }
+
+    static std::atomic<alloc_counters*>& registry() noexcept{
+        static std::atomic<alloc_counters*> head(nullptr);
+        return head;
+    }
+
+    static std::atomic<alloc_hook>& hook() noexcept{
+        static std::atomic<alloc_hook> h(nullptr);
+        return h;
+    }
+
+    void add_live(size_t bytes) noexcept{
+        const size_t live = live_bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        size_t peak = peak_bytes.load(std::memory_order_relaxed);
+        while(live > peak && !peak_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+            ;
+    }
+
+    void on_allocate(void* p, size_t bytes) noexcept{
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        total_bytes.fetch_add(bytes, std::memory_order_relaxed);
+        histogram[alloc_bucket(bytes)].fetch_add(1, std::memory_order_relaxed);
+        add_live(bytes);
+        if(alloc_hook h = hook().load(std::memory_order_relaxed))
+            h(name, p, bytes, true);
+    }
+
+    void on_deallocate(void* p, size_t bytes) noexcept{
+        deallocations.fetch_add(1, std::memory_order_relaxed);
+        live_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+        if(alloc_hook h = hook().load(std::memory_order_relaxed))
+            h(name, p, bytes, false);
+    }
+
+    // 内存块从 old_bytes 调整为 new_bytes, 计为一次 reallocate, 不计入分配次数和直方图
+    void on_reallocate(void* old_p, size_t old_bytes, void* new_p, size_t new_bytes) noexcept{
+        reallocations.fetch_add(1, std::memory_order_relaxed);
+        if(new_bytes > old_bytes){
+            total_bytes.fetch_add(new_bytes - old_bytes, std::memory_order_relaxed);
+            add_live(new_bytes - old_bytes);
+        }
+        else{
+            live_bytes.fetch_sub(old_bytes - new_bytes, std::memory_order_relaxed);
+        }
+        if(alloc_hook h = hook().load(std::memory_order_relaxed)){
+            h(name, old_p, old_bytes, false);
+            h(name, new_p, new_bytes, true);
+        }
+    }
+
+    alloc_snapshot snapshot() const noexcept{
+        alloc_snapshot s;
+        s.name = name;
+        s.live_bytes = live_bytes.load(std::memory_order_relaxed);
+        s.peak_bytes = peak_bytes.load(std::memory_order_relaxed);
+        s.total_bytes = total_bytes.load(std::memory_order_relaxed);
+        s.allocations = allocations.load(std::memory_order_relaxed);
+        s.deallocations = deallocations.load(std::memory_order_relaxed);
+        s.reallocations = reallocations.load(std::memory_order_relaxed);
+        for(size_t i = 0; i < DHSSTL_ALLOC_HISTOGRAM_BUCKETS; ++i)
+            s.histogram[i] = histogram[i].load(std::memory_order_relaxed);
+        return s;
+    }
+
+    // 清空计数, 峰值从当前持有的字节数重新开始
+    void reset() noexcept{
+        total_bytes.store(0, std::memory_order_relaxed);
+        allocations.store(0, std::memory_order_relaxed);
+        deallocations.store(0, std::memory_order_relaxed);
+        reallocations.store(0, std::memory_order_relaxed);
+        for(auto& h : histogram)
+            h.store(0, std::memory_order_relaxed);
+        peak_bytes.store(live_bytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+};
+
+} // namespace detail
+
+/*****************************************************************************************/
+// alloc_stats
+// 按 Tag 访问统计, 第一次使用某个 Tag 时登记到全局链表
+/*****************************************************************************************/
+template <class Tag = void>
+class alloc_stats
+{
+public:
+    static detail::alloc_counters& counters() noexcept{
+        static detail::alloc_counters c(detail::alloc_tag_name<Tag>::get());
+        return c;
+    }
+
+    static alloc_snapshot snapshot() noexcept { return counters().snapshot(); }
+
+    // 清空次数和直方图, live_bytes 保持不变
+    static void reset() noexcept { counters().reset(); }
+
+    static void on_allocate(void* p, size_t bytes) noexcept{
+#if DHSSTL_ALLOC_TRACKING
+        counters().on_allocate(p, bytes);
+#else
+        (void)p; (void)bytes;
+#endif
+    }
+
+    static void on_deallocate(void* p, size_t bytes) noexcept{
+#if DHSSTL_ALLOC_TRACKING
+        counters().on_deallocate(p, bytes);
+#else
+        (void)p; (void)bytes;
+#endif
+    }
+
+    static void on_reallocate(void* old_p, size_t old_bytes, void* new_p, size_t new_bytes) noexcept{
+#if DHSSTL_ALLOC_TRACKING
+        counters().on_reallocate(old_p, old_bytes, new_p, new_bytes);
+#else
+        (void)old_p; (void)old_bytes; (void)new_p; (void)new_bytes;
+#endif
+    }
+};
+
+// 设置全局的分配回调, 返回原来的回调, 传入 nullptr 取消
+inline alloc_hook set_alloc_hook(alloc_hook h) noexcept{
+    return detail::alloc_counters::hook().exchange(h, std::memory_order_acq_rel);
+}
+
+// 所有已经使用过的 Tag 的统计, 按登记的逆序排列
+inline dhsstl::vector<alloc_snapshot> alloc_stats_snapshot(){
+    dhsstl::vector<alloc_snapshot> result;
+    for(auto c = detail::alloc_counters::registry().load(std::memory_order_acquire); c != nullptr; c = c->next)
+        result.push_back(c->snapshot());
+    return result;
+}
+
+// 输出为 JSON 数组, 直方图只输出非空的组, 键为组的下界字节数
+inline void dump_alloc_stats_json(std::ostream& os){
+    auto all = alloc_stats_snapshot();
+    os << "[";
+    for(size_t i = 0; i < all.size(); ++i){
+        const alloc_snapshot& s = all[i];
+        os << (i == 0 ? "\n" : ",\n")
+           << "  {\"name\": \"" << s.name << "\""
+           << ", \"live_bytes\": " << s.live_bytes
+           << ", \"peak_bytes\": " << s.peak_bytes
+           << ", \"total_bytes\": " << s.total_bytes
+           << ", \"allocations\": " << s.allocations
+           << ", \"deallocations\": " << s.deallocations
+           << ", \"reallocations\": " << s.reallocations
+           << ", \"histogram\": {";
+        bool first = true;
+        for(size_t k = 0; k < DHSSTL_ALLOC_HISTOGRAM_BUCKETS; ++k){
+            if(s.histogram[k] == 0)
+                continue;
+            os << (first ? "" : ", ") << "\"" << (static_cast<size_t>(1) << k) << "\": " << s.histogram[k];
+            first = false;
+        }
+        os << "}}";
+    }
+    os << (all.empty() ? "]\n" : "\n]\n");
+}
+
+// 输出为 CSV, 每个 Tag 一行, 直方图每组一列
+inline void dump_alloc_stats_csv(std::ostream& os){
+    os << "name,live_bytes,peak_bytes,total_bytes,allocations,deallocations,reallocations";
+    for(size_t k = 0; k < DHSSTL_ALLOC_HISTOGRAM_BUCKETS; ++k)
+        os << ",hist_" << (static_cast<size_t>(1) << k);
+    os << "\n";
+    for(const alloc_snapshot& s : alloc_stats_snapshot()){
+        os << s.name << "," << s.live_bytes << "," << s.peak_bytes << "," << s.total_bytes << ","
+           << s.allocations << "," << s.deallocations << "," << s.reallocations;
+        for(size_t k = 0; k < DHSSTL_ALLOC_HISTOGRAM_BUCKETS; ++k)
+            os << "," << s.histogram[k];
+        os << "\n";
+    }
+}
+
+/*****************************************************************************************/
+// tracking_allocator
+// 模板参数 T 代表数据类型, Tag 区分统计, Alloc 是实际分配内存的分配器
+/*****************************************************************************************/
+template <class T, class Tag = void, class Alloc = dhsstl::allocator<T>>
+class tracking_allocator
+{
+public:
+    typedef T               value_type;
+    typedef T*              pointer;
+    typedef const T*        const_pointer;
+    typedef T&              reference;
+    typedef const T&        const_reference;
+    typedef size_t          size_type;
+    typedef ptrdiff_t       difference_type;
+
+    typedef Alloc           base_allocator;
+    typedef alloc_stats<Tag> stats_type;
+
+    static T* allocate(){
+        T* p = Alloc::allocate();
+        stats_type::on_allocate(p, sizeof(T));
+        return p;
+    }
+
+    static T* allocate(size_type n){
+        T* p = Alloc::allocate(n);
+        if(p != nullptr)
+            stats_type::on_allocate(p, n * sizeof(T));
+        return p;
+    }
+
+    static void deallocate(T* ptr){
+        if(ptr == nullptr)
+            return;
+        stats_type::on_deallocate(ptr, sizeof(T));
+        Alloc::deallocate(ptr);
+    }
+
+    static void deallocate(T* ptr, size_type n){
+        if(ptr == nullptr)
+            return;
+        stats_type::on_deallocate(ptr, n * sizeof(T));
+        Alloc::deallocate(ptr, n);
+    }
+
+    static T* reallocate(T* ptr, size_type old_n, size_type new_n){
+        T* p = Alloc::reallocate(ptr, old_n, new_n);
+        if(ptr == nullptr)
+            stats_type::on_allocate(p, new_n * sizeof(T));
+        else if(p == nullptr)
+            stats_type::on_deallocate(ptr, old_n * sizeof(T));
+        else
+            stats_type::on_reallocate(ptr, old_n * sizeof(T), p, new_n * sizeof(T));
+        return p;
+    }
+
+    static void construct(T* ptr)                 { Alloc::construct(ptr); }
+    static void construct(T* ptr, const T& value) { Alloc::construct(ptr, value); }
+    static void construct(T* ptr, T&& value)      { Alloc::construct(ptr, dhsstl::move(value)); }
+
+    template <class... Args>
+    static void construct(T* ptr, Args&& ...args) { Alloc::construct(ptr, dhsstl::forward<Args>(args)...); }
+
+    static void destroy(T* ptr)            { Alloc::destroy(ptr); }
+    static void destroy(T* first, T* last) { Alloc::destroy(first, last); }
+
+    template <typename U = T>
+    static constexpr bool can_reallocate() { return Alloc::template can_reallocate<U>(); }
+};
+
+namespace detail
+{
+
+// rebind 时保留 Tag, 同时 rebind 底层的 Alloc
+template <class T, class Tag, class Alloc, typename U>
+struct allocator_rebind<tracking_allocator<T, Tag, Alloc>, U>
+{
+    typedef tracking_allocator<U, Tag, typename allocator_rebind<Alloc, U>::type> type;
+};
+
+} // namespace detail
+
+} // namespace dhsstl
+
+#endif // !DHSTINYSTL_TRACKING_ALLOCATOR_H_
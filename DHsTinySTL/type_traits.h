@@ -36,6 +36,20 @@ struct is_pair : dhsstl::m_false_type {};
 template<class T1, class T2>
 struct is_pair<dhsstl::pair<T1, T2>> : dhsstl::m_true_type{};
 
+// is_trivially_relocatable
+// 若把一个对象按字节复制到新地址后, 原地址上的对象可以直接视为已析构(不再调用析构函数),
+// 则称这个类型是 trivially relocatable 的, 容器扩容/插入/删除时就可以用一次 memcpy/memmove 搬移元素
+// 默认只对 trivially copyable 的类型成立, 用户类型(例如只持有指针的句柄)可以通过特化本模板选择加入:
+//     namespace dhsstl { template<> struct is_trivially_relocatable<my_handle> : m_true_type {}; }
+// 注: 含有指向自身的指针的类型(例如 libstdc++ 的 std::string)绝对不能特化为 true
+template<class T>
+struct is_trivially_relocatable : dhsstl::m_bool_constant<std::is_trivially_copyable<T>::value> {};
+
+template<class T1, class T2>
+struct is_trivially_relocatable<dhsstl::pair<T1, T2>>
+    : dhsstl::m_bool_constant<is_trivially_relocatable<T1>::value &&
+                              is_trivially_relocatable<T2>::value> {};
+
 } // namespace mystl
 
 #endif
\ No newline at end of file
@@ -2,6 +2,9 @@
 #define DHSTINYSTL_UNINITIALIZED_H_
 
 // 这个头文件用于对未初始化空间构造元素
+#include <cstring>
+#include <type_traits>
+
 #include "algobase.h"
 #include "construct.h"
 #include "iterator.h"
@@ -10,6 +13,22 @@
 
 namespace dhsstl{
 
+// ------------------------------------------------
+// 构造方式的选择
+// 以 uninitialized_copy 为例, 按以下顺序选择:
+//  1. 构造和赋值都是平凡的: 构造等价于赋值, 交给 dhsstl::copy, 原生指针区间走 memmove
+//  2. 构造不会抛出异常(noexcept): 逐个构造, 不需要 try / catch 和回滚
+//  3. 其他: 逐个构造, 失败时析构已经构造的元素, 再把异常抛给调用者, 目标区间保持未初始化
+// uninitialized_fill 在 1 的基础上, 填充原生指针区间且 value 的每个字节都是 0 时直接 memset
+// ------------------------------------------------
+template <typename T>
+struct uninit_trivial_copy : std::integral_constant<bool,
+    std::is_trivially_copy_constructible<T>::value && std::is_trivially_copy_assignable<T>::value> {};
+
+template <typename T>
+struct uninit_trivial_move : std::integral_constant<bool,
+    std::is_trivially_move_constructible<T>::value && std::is_trivially_move_assignable<T>::value> {};
+
 // ------------------------------------------------
 // uninitialized_copy
 // 把 [first, last) 上的内容复制到以 result 为起始处的空间, 返回复制结束位置
@@ -20,13 +39,15 @@ namespace dhsstl{
 // 而 普通的 copy, 所有元素都是初始化过的.
 template <typename InputIter, typename ForwardIter>
 ForwardIter
-unchecked_uninit_copy(InputIter first, InputIter last, ForwardIter result, std::true_type){
-    return dhsstl::copy(first, last, result);
+uninit_copy_construct(InputIter first, InputIter last, ForwardIter result, std::true_type){
+    for(; first != last; ++first, ++result)
+        dhsstl::construct(&*result, *first);
+    return result;
 }
 
 template <typename InputIter, typename ForwardIter>
 ForwardIter
-unchecked_uninit_copy(InputIter first, InputIter last, ForwardIter result, std::false_type){
+uninit_copy_construct(InputIter first, InputIter last, ForwardIter result, std::false_type){
     // 如果失败了, 就一个也不能够被construct
     auto cur = result;
     try{
@@ -34,16 +55,30 @@ unchecked_uninit_copy(InputIter first, InputIter last, ForwardIter result, std::
             dhsstl::construct(&*cur, *first);
         }
     }catch (...){
-        for(; result != cur; --cur)
-            dhsstl::destroy(&*cur);
+        dhsstl::destroy(result, cur);
+        throw;
     }
     return cur;
 }
 
+template <typename InputIter, typename ForwardIter>
+ForwardIter
+unchecked_uninit_copy(InputIter first, InputIter last, ForwardIter result, std::true_type){
+    return dhsstl::copy(first, last, result);
+}
+
+template <typename InputIter, typename ForwardIter>
+ForwardIter
+unchecked_uninit_copy(InputIter first, InputIter last, ForwardIter result, std::false_type){
+    typedef typename iterator_traits<ForwardIter>::value_type value_type;
+    return dhsstl::uninit_copy_construct(first, last, result,
+                                         std::is_nothrow_constructible<value_type, decltype(*first)>{});
+}
+
 template <typename InputIter, typename ForwardIter>
 ForwardIter uninitialized_copy(InputIter first, InputIter last, ForwardIter result){
     return dhsstl::unchecked_uninit_copy(first, last, result,
-                                         std::is_trivially_copy_assignable<
+                                         uninit_trivial_copy<
                                          typename iterator_traits<ForwardIter>::
                                          value_type 
                                          >{});
@@ -54,32 +89,46 @@ ForwardIter uninitialized_copy(InputIter first, InputIter last, ForwardIter resu
 // ------------------------------------------------
 template <typename InputIter, typename Size, typename ForwardIter>
 ForwardIter
-unchecked_uninit_copy_n(InputIter first, Size n ,ForwardIter result, std::true_type){
-    return dhsstl::copy_n(first, n, result).second;
+uninit_copy_n_construct(InputIter first, Size n, ForwardIter result, std::true_type){
+    for(; n > 0; --n, ++first, ++result)
+        dhsstl::construct(&*result, *first);
+    return result;
 }
 
 template <typename InputIter, typename Size, typename ForwardIter>
 ForwardIter
-unchecked_uninit_copy_n(InputIter first, Size n, ForwardIter result, std::false_type){
+uninit_copy_n_construct(InputIter first, Size n, ForwardIter result, std::false_type){
     auto cur = result;
     try{
-        for(; n > 0; ++first, ++cur){
-            // 传得是一个 右值 first
+        for(; n > 0; --n, ++first, ++cur){
             dhsstl::construct(&*cur, *first);
         }
     }catch (...){
-        for(; result != cur; --cur){
-            dhsstl::destroy(&*cur);
-        }
+        dhsstl::destroy(result, cur);
+        throw;
     }
     return cur;
 }
 
+template <typename InputIter, typename Size, typename ForwardIter>
+ForwardIter
+unchecked_uninit_copy_n(InputIter first, Size n ,ForwardIter result, std::true_type){
+    return dhsstl::copy_n(first, n, result).second;
+}
+
+template <typename InputIter, typename Size, typename ForwardIter>
+ForwardIter
+unchecked_uninit_copy_n(InputIter first, Size n, ForwardIter result, std::false_type){
+    typedef typename iterator_traits<ForwardIter>::value_type value_type;
+    return dhsstl::uninit_copy_n_construct(first, n, result,
+                                           std::is_nothrow_constructible<value_type, decltype(*first)>{});
+}
+
 template <typename InputIter, typename Size, typename ForwardIter>
 ForwardIter uninitialized_copy_n(InputIter first, Size n, ForwardIter result){
     return dhsstl::unchecked_uninit_copy_n(first, n, result,
-                                           std::is_trivially_copy_assignable<
-                                           typename iterator_traits<InputIter>::
+                                           uninit_trivial_copy<
+                                           typename iterator_traits<ForwardIter>::
                                            value_type 
                                            >{});
 }
@@ -87,84 +136,177 @@ ForwardIter uninitialized_copy_n(InputIter first, Size n, ForwardIter result){
 // uninitialized_fill
 // 在 [first, last) 区间内填充元素值
 // ------------------------------------------------
+// value 的对象表示是否全为 0 字节, 是则可以用 memset 填充
+template <typename T>
+bool uninit_is_zero_bytes(const T& value) noexcept{
+    const unsigned char* p = &reinterpret_cast<const unsigned char&>(value);
+    for(size_t i = 0; i < sizeof(T); ++i){
+        if(p[i] != 0)
+            return false;
+    }
+    return true;
+}
+
+template <typename ForwardIter, typename Size, typename T>
+ForwardIter
+uninit_fill_n_construct(ForwardIter first, Size n, const T& value, std::true_type){
+    for(; n > 0; --n, ++first)
+        dhsstl::construct(&*first, value);
+    return first;
+}
+
+template <typename ForwardIter, typename Size, typename T>
+ForwardIter
+uninit_fill_n_construct(ForwardIter first, Size n, const T& value, std::false_type){
+    auto cur = first;
+    try{
+        for(; n > 0; --n, ++cur){
+            dhsstl::construct(&*cur, value);
+        }
+    } catch(...){
+        dhsstl::destroy(first, cur);
+        throw;
+    }
+    return cur;
+}
+
+template <typename ForwardIter, typename Size, typename T>
+ForwardIter
+unchecked_uninit_fill_n(ForwardIter first, Size n, const T& value, std::true_type){
+    return dhsstl::fill_n(first, n, value);
+}
+
+// 平凡类型的原生指针区间, 填充的值与元素类型相同且全为 0 字节时用 memset
+template <typename Tp, typename Size>
+Tp*
+unchecked_uninit_fill_n(Tp* first, Size n, const Tp& value, std::true_type){
+    if(n > 0 && uninit_is_zero_bytes(value)){
+        std::memset(static_cast<void*>(first), 0, static_cast<size_t>(n) * sizeof(Tp));
+        return first + n;
+    }
+    return dhsstl::fill_n(first, n, value);
+}
+
+template <typename ForwardIter, typename Size, typename T>
+ForwardIter
+unchecked_uninit_fill_n(ForwardIter first, Size n, const T& value, std::false_type){
+    typedef typename iterator_traits<ForwardIter>::value_type value_type;
+    return dhsstl::uninit_fill_n_construct(first, n, value,
+                                           std::is_nothrow_constructible<value_type, const T&>{});
+}
+
+template <typename ForwardIter, typename Size, typename T>
+ForwardIter
+uninitialized_fill_n(ForwardIter first, Size n, const T& value){
+    return unchecked_uninit_fill_n(first, n, value,
+                                   uninit_trivial_copy<
+                                   typename iterator_traits<ForwardIter>::
+                                   value_type 
+                                   >{});
+}
+
 template <typename ForwardIter, typename T>
 void
 unchecked_uninit_fill(ForwardIter first, ForwardIter last, const T& value, std::true_type){
     dhsstl::fill(first, last, value);
 }
 
+template <typename Tp>
+void
+unchecked_uninit_fill(Tp* first, Tp* last, const Tp& value, std::true_type){
+    dhsstl::unchecked_uninit_fill_n(first, last - first, value, std::true_type{});
+}
+
 template <typename ForwardIter, typename T>
 void
-unchecked_uninit_fill(ForwardIter first, ForwardIter last, const T& value, std::false_type){
+uninit_fill_construct(ForwardIter first, ForwardIter last, const T& value, std::true_type){
+    for(; first != last; ++first)
+        dhsstl::construct(&*first, value);
+}
+
+template <typename ForwardIter, typename T>
+void
+uninit_fill_construct(ForwardIter first, ForwardIter last, const T& value, std::false_type){
     auto cur = first;
     try{
         for(; cur != last; ++cur){
             dhsstl::construct(&*cur, value);
         }
     }catch(...){
-        for(; first != cur; ++first){
-            dhsstl::destroy(&*first);
-        }
+        dhsstl::destroy(first, cur);
+        throw;
     }
 }
 
+template <typename ForwardIter, typename T>
+void
+unchecked_uninit_fill(ForwardIter first, ForwardIter last, const T& value, std::false_type){
+    typedef typename iterator_traits<ForwardIter>::value_type value_type;
+    dhsstl::uninit_fill_construct(first, last, value,
+                                  std::is_nothrow_constructible<value_type, const T&>{});
+}
+
 template <typename ForwardIter, typename T>
 void
 uninitialized_fill(ForwardIter first, ForwardIter last, const T& value){
     return dhsstl::unchecked_uninit_fill(first, last, value,
-                                          std::is_trivially_copy_assignable<
+                                          uninit_trivial_copy<
                                           typename iterator_traits<ForwardIter>::
                                           value_type 
                                           >{});
 }
 // ------------------------------------------------
-// uninitialized_fill_n
-// 从 first 位置开始, 填充元素值
+// uninitialized_default_construct_n
+// 从 first 位置开始默认初始化 n 个元素(不做值初始化), 返回构造结束的位置
+// trivially default constructible 的类型不需要任何操作, 内存内容保持不变
 // ------------------------------------------------
-template <typename ForwardIter, typename Size, typename T>
+template <typename ForwardIter, typename Size>
 ForwardIter
-unchecked_uninit_fill_n(ForwardIter first, Size n, const T& value, std::true_type){
-    return dhsstl::fill_n(first, n, value);
+unchecked_uninit_default_construct_n(ForwardIter first, Size n, std::true_type){
+    dhsstl::advance(first, n);
+    return first;
 }
 
-template <typename ForwardIter, typename Size, typename T>
+template <typename ForwardIter, typename Size>
 ForwardIter
-unchecked_uninit_fill_n(ForwardIter first, Size n, const T& value, std::false_type){
+unchecked_uninit_default_construct_n(ForwardIter first, Size n, std::false_type){
+    typedef typename iterator_traits<ForwardIter>::value_type value_type;
     auto cur = first;
     try{
         for(; n > 0; --n, ++cur){
-            dhsstl::construct(&*cur, value);
-        }
-    } catch(...){
-        for(; first != cur; ++first){
-            dhsstl::destroy(&*first);
+            ::new (static_cast<void*>(&*cur)) value_type;
         }
+    }catch(...){
+        dhsstl::destroy(first, cur);
+        throw;
     }
     return cur;
 }
 
-template <typename ForwardIter, typename Size, typename T>
-ForwardIter
-uninitialized_fill_n(ForwardIter first, Size n, const T& value){
-    return unchecked_uninit_fill_n(first, n, value,
-                                   std::is_trivially_copy_assignable<
-                                   typename iterator_traits<ForwardIter>::
-                                   value_type 
-                                   >{});
+template <typename ForwardIter, typename Size>
+ForwardIter uninitialized_default_construct_n(ForwardIter first, Size n){
+    return dhsstl::unchecked_uninit_default_construct_n(first, n,
+                                                        std::is_trivially_default_constructible<
+                                                        typename iterator_traits<ForwardIter>::
+                                                        value_type
+                                                        >{});
 }
+
 // ------------------------------------------------
 // uninitialized_move
 // 把[first, last)上的内容移动到以result为起始处的空间, 返回移动结束的位置
 // ------------------------------------------------
 template <typename InputIter, typename ForwardIter>
 ForwardIter
-unchecked_uninit_move(InputIter first, InputIter last, ForwardIter result, std::true_type){
-    return dhsstl::move(first, last, result);
+uninit_move_construct(InputIter first, InputIter last, ForwardIter result, std::true_type){
+    for(; first != last; ++first, ++result)
+        dhsstl::construct(&*result, dhsstl::move(*first));
+    return result;
 }
 
 template <typename InputIter, typename ForwardIter>
 ForwardIter
-unchecked_uninit_move(InputIter first, InputIter last, ForwardIter result, std::false_type){
+uninit_move_construct(InputIter first, InputIter last, ForwardIter result, std::false_type){
     ForwardIter cur = result;
     try{
         for(; first != last; ++first, ++cur){
@@ -172,16 +314,32 @@ unchecked_uninit_move(InputIter first, InputIter last, ForwardIter result, std::
         }
     }catch(...){
         dhsstl::destroy(result, cur);
+        throw;
     }
-    // 这里不用throw吗
     return cur;
 }
 
+// 平凡类型交给 dhsstl::move, 原生指针区间走 memmove, 允许区间重叠
+template <typename InputIter, typename ForwardIter>
+ForwardIter
+unchecked_uninit_move(InputIter first, InputIter last, ForwardIter result, std::true_type){
+    return dhsstl::move(first, last, result);
+}
+
+template <typename InputIter, typename ForwardIter>
+ForwardIter
+unchecked_uninit_move(InputIter first, InputIter last, ForwardIter result, std::false_type){
+    typedef typename iterator_traits<ForwardIter>::value_type value_type;
+    return dhsstl::uninit_move_construct(first, last, result,
+                                         std::is_nothrow_constructible<value_type,
+                                         decltype(dhsstl::move(*first))>{});
+}
+
 template <typename InputIter, typename ForwardIter>
 ForwardIter uninitialized_move(InputIter first, InputIter last, ForwardIter result){
     return dhsstl::unchecked_uninit_move(first, last, result,
-                                         std::is_trivially_move_assignable<
-                                         typename iterator_traits<InputIter>:: 
+                                         uninit_trivial_move<
+                                         typename iterator_traits<ForwardIter>:: 
                                          value_type>{}
                                         );
 }
@@ -192,36 +350,158 @@ ForwardIter uninitialized_move(InputIter first, InputIter last, ForwardIter resu
 // ------------------------------------------------
 template <typename InputIter, typename Size, typename ForwardIter>
 ForwardIter
-unchecked_uninit_move_n(InputIter first, Size n, ForwardIter result, std::true_type){
-    return dhsstl::move(first, first+n, result);
+uninit_move_n_construct(InputIter first, Size n, ForwardIter result, std::true_type){
+    for(; n > 0; --n, ++first, ++result)
+        dhsstl::construct(&*result, dhsstl::move(*first));
+    return result;
 }
 
 template <typename InputIter, typename Size, typename ForwardIter>
 ForwardIter
-unchecked_uninit_move_n(InputIter first, Size n, ForwardIter result, std::false_type){
+uninit_move_n_construct(InputIter first, Size n, ForwardIter result, std::false_type){
     auto cur = result;
     try{
         for(; n > 0; --n, ++first, ++cur){
             dhsstl::construct(&*cur, dhsstl::move(*first));
         }
     }catch(...){
-        for(; result != cur; ++result){
-            dhsstl::destroy(&*result);
-        }
+        dhsstl::destroy(result, cur);
         throw;
     }
     return cur;
 }
 
+template <typename InputIter, typename Size, typename ForwardIter>
+ForwardIter
+unchecked_uninit_move_n(InputIter first, Size n, ForwardIter result, std::true_type){
+    return dhsstl::move(first, first+n, result);
+}
+
+template <typename InputIter, typename Size, typename ForwardIter>
+ForwardIter
+unchecked_uninit_move_n(InputIter first, Size n, ForwardIter result, std::false_type){
+    typedef typename iterator_traits<ForwardIter>::value_type value_type;
+    return dhsstl::uninit_move_n_construct(first, n, result,
+                                           std::is_nothrow_constructible<value_type,
+                                           decltype(dhsstl::move(*first))>{});
+}
+
 template <typename InputIter, typename Size, typename ForwardIter>
 ForwardIter uninitialized_move_n(InputIter first, Size n, ForwardIter result){
     return dhsstl::unchecked_uninit_move_n(first, n, result,
-                                           std::is_trivially_move_assignable<
-                                           typename iterator_traits<InputIter>::
+                                           uninit_trivial_move<
+                                           typename iterator_traits<ForwardIter>::
                                            value_type
                                            >{}
     );
 }
 
+// ------------------------------------------------
+// uninitialized_relocate
+// 把[first, last)上的对象搬移到以result为起始处的未初始化空间, 并析构原对象, 返回搬移结束的位置
+// 调用之后[first, last)变为未初始化空间
+// 注: 只有 trivially relocatable 的类型允许区间重叠, 且要求 result 位于 first 之前;
+//     其他类型先全部构造再析构原区间, 两个区间不能重叠
+// ------------------------------------------------
+// trivially relocatable 的原生指针版本: 一次 memmove, 不需要调用析构函数
+template <typename T>
+T* unchecked_uninit_relocate(T* first, T* last, T* result, std::true_type){
+    const auto n = static_cast<size_t>(last - first);
+    if(n != 0)
+        std::memmove(static_cast<void*>(result), static_cast<const void*>(first), n * sizeof(T));
+    return result + n;
+}
+
+// trivially relocatable 的一般迭代器版本: 逐个元素按字节复制
+template <typename InputIter, typename ForwardIter>
+ForwardIter
+unchecked_uninit_relocate(InputIter first, InputIter last, ForwardIter result, std::true_type){
+    typedef typename iterator_traits<ForwardIter>::value_type value_type;
+    for(; first != last; ++first, ++result){
+        std::memcpy(static_cast<void*>(&*result), static_cast<const void*>(&*first), sizeof(value_type));
+    }
+    return result;
+}
+
+// 一般版本: 先全部移动构造, 成功之后再析构原对象, 失败时原区间保持不变
+// 区间重叠时 destroy(first, last) 会析构刚搬移过去的对象, 因此不允许重叠
+template <typename InputIter, typename ForwardIter>
+ForwardIter
+unchecked_uninit_relocate(InputIter first, InputIter last, ForwardIter result, std::false_type){
+    auto cur = result;
+    try{
+        for(auto it = first; it != last; ++it, ++cur){
+            dhsstl::construct(&*cur, dhsstl::move(*it));
+        }
+    }catch(...){
+        dhsstl::destroy(result, cur);
+        throw;
+    }
+    dhsstl::destroy(first, last);
+    return cur;
+}
+
+template <typename InputIter, typename ForwardIter>
+ForwardIter uninitialized_relocate(InputIter first, InputIter last, ForwardIter result){
+    return dhsstl::unchecked_uninit_relocate(first, last, result,
+                                             std::integral_constant<bool,
+                                             dhsstl::is_trivially_relocatable<
+                                             typename iterator_traits<InputIter>::
+                                             value_type>::value>{});
+}
+
+// ------------------------------------------------
+// uninitialized_relocate_backward
+// 把[first, last)上的对象从后往前搬移到以result为结束处的未初始化空间, 返回搬移后区间的起始位置
+// 注: 允许区间重叠, 但要求 result 位于 last 之后(或两者不重叠)
+// ------------------------------------------------
+template <typename T>
+T* unchecked_uninit_relocate_backward(T* first, T* last, T* result, std::true_type){
+    const auto n = static_cast<size_t>(last - first);
+    if(n != 0){
+        result -= n;
+        std::memmove(static_cast<void*>(result), static_cast<const void*>(first), n * sizeof(T));
+    }
+    return result;
+}
+
+template <typename BidirectionalIter1, typename BidirectionalIter2>
+BidirectionalIter2
+unchecked_uninit_relocate_backward(BidirectionalIter1 first, BidirectionalIter1 last,
+                                   BidirectionalIter2 result, std::true_type){
+    typedef typename iterator_traits<BidirectionalIter2>::value_type value_type;
+    while(first != last){
+        --last;
+        --result;
+        std::memcpy(static_cast<void*>(&*result), static_cast<const void*>(&*last), sizeof(value_type));
+    }
+    return result;
+}
+
+// 一般版本: 逐个移动构造并析构原对象, 区间重叠时目标位置总是已经被搬空的
+template <typename BidirectionalIter1, typename BidirectionalIter2>
+BidirectionalIter2
+unchecked_uninit_relocate_backward(BidirectionalIter1 first, BidirectionalIter1 last,
+                                   BidirectionalIter2 result, std::false_type){
+    while(first != last){
+        --last;
+        --result;
+        dhsstl::construct(&*result, dhsstl::move(*last));
+        dhsstl::destroy(&*last);
+    }
+    return result;
+}
+
+template <typename BidirectionalIter1, typename BidirectionalIter2>
+BidirectionalIter2
+uninitialized_relocate_backward(BidirectionalIter1 first, BidirectionalIter1 last,
+                                BidirectionalIter2 result){
+    return dhsstl::unchecked_uninit_relocate_backward(first, last, result,
+                                                      std::integral_constant<bool,
+                                                      dhsstl::is_trivially_relocatable<
+                                                      typename iterator_traits<BidirectionalIter1>::
+                                                      value_type>::value>{});
+}
+
 } // namespace dhsstl
 #endif // !DHSTINYSTL_UNINITIALIZED_H_
\ No newline at end of file
@@ -15,6 +15,14 @@
 //      * reserver
 //      * resize
 //      * insert
+//
+// 当 dhsstl::is_trivially_relocatable<T>::value == true 时, 扩容, insert, erase 以及 shrink_to_fit
+// 都会直接用 memmove 搬移元素, 而不会逐个调用移动构造函数和析构函数
+// 当 T 为 trivially copyable 时, reserve, shrink_to_fit 以及在尾部插入引起的扩容会调用
+// data_allocator::reallocate(realloc), 由分配器尽量原地扩展内存块, 避免整块复制
+// 扩容时的新容量由模板参数 GrowthPolicy 决定, 见下方的 growth_1_5x 等策略
+// vector(n, default_init), resize_default_init 以及 append_uninitialized 只做默认初始化,
+// T 为 trivially default constructible 时新元素的值是未定义的, 适合马上会被覆盖的缓冲区
 
 #include <initializer_list>
 
@@ -37,16 +45,75 @@ namespace dhsstl{
 #undef min
 #endif
 
+// ------------------------------------------------------------------------------
+// default_init_t
+// 用于选择只做默认初始化(而不是值初始化)的构造函数
+struct default_init_t{
+    explicit default_init_t() = default;
+};
+constexpr default_init_t default_init{};
+
+// ------------------------------------------------------------------------------
+// vector 的扩容策略
+// 每个策略提供 static size_t grow(size_t old_cap, size_t min_cap, size_t elem_size),
+// 返回扩容后的容量(元素个数), 结果至少为 min_cap
+// 注: 返回值溢出或者超过 max_size() 时, vector 会退回到刚好够用的 min_cap
+
+// 默认策略: 按 1.5 倍扩容, 第一次分配至少 16 个元素
+struct growth_1_5x{
+    static size_t grow(size_t old_cap, size_t min_cap, size_t /*elem_size*/){
+        if(old_cap == 0)
+            return dhsstl::max(min_cap, static_cast<size_t>(16));
+        return dhsstl::max(old_cap + old_cap / 2, min_cap);
+    }
+};
+
+// 按 2 倍扩容, 扩容次数更少, 但平均浪费的空间更多
+struct growth_2x{
+    static size_t grow(size_t old_cap, size_t min_cap, size_t /*elem_size*/){
+        if(old_cap == 0)
+            return dhsstl::max(min_cap, static_cast<size_t>(16));
+        return dhsstl::max(old_cap * 2, min_cap);
+    }
+};
+
+// 按 1.5 倍扩容后, 把字节数向上取整到页大小(4096), 适合大块缓冲区
+struct growth_page{
+    static size_t grow(size_t old_cap, size_t min_cap, size_t elem_size){
+        const size_t bytes = growth_1_5x::grow(old_cap, min_cap, elem_size) * elem_size;
+        return ((bytes + 4095) & ~static_cast<size_t>(4095)) / elem_size;
+    }
+};
+
+// 按 1.5 倍扩容后, 把字节数向上取整到分配器的尺寸分级(jemalloc / tcmalloc 的做法):
+// 不超过 128 字节时按 16 字节对齐, 之后每个 2 的幂区间再均分为 4 级,
+// 这样申请到的空间不会被分配器内部的取整浪费掉
+struct growth_size_class{
+    static size_t round(size_t bytes){
+        if(bytes <= 128)
+            return (bytes + 15) & ~static_cast<size_t>(15);
+        size_t lg = 0;
+        for(size_t x = bytes - 1; x > 1; x >>= 1)
+            ++lg;
+        const size_t spacing = static_cast<size_t>(1) << (lg - 2);
+        return (bytes + spacing - 1) & ~(spacing - 1);
+    }
+    static size_t grow(size_t old_cap, size_t min_cap, size_t elem_size){
+        return round(growth_1_5x::grow(old_cap, min_cap, elem_size) * elem_size) / elem_size;
+    }
+};
+
 // 模板类: vector
-// 模板参数 T 代表类型
-template <typename T>
+// 模板参数 T 代表类型, Alloc 代表分配器, GrowthPolicy 代表扩容策略
+// 注: Alloc 需要提供和 dhsstl::allocator 相同的静态接口, 包括 can_reallocate / reallocate
+template <typename T, typename Alloc = dhsstl::allocator<T>, typename GrowthPolicy = dhsstl::growth_1_5x>
 class vector{
 
     static_assert(!std::is_same<bool, T>::value, "vector<bool> is abandoned in dhsstl");
 public:
     // vector 的嵌套型别定义
-    typedef dhsstl::allocator<T>                     allocator_type;
-    typedef dhsstl::allocator<T>                     data_allocator;
+    typedef Alloc                                    allocator_type;
+    typedef Alloc                                    data_allocator;
 
     typedef typename allocator_type::value_type      value_type;
     typedef typename allocator_type::pointer         pointer;
@@ -64,6 +131,15 @@ public:
     allocator_type get_allocator() { return data_allocator(); }
 
 private:
+    // 元素能否按字节搬移, 用于选择扩容/插入/删除时的搬移方式
+    // 注: 写成模板是为了推迟到使用时才求值, 使 vector 的声明仍然允许 T 为不完整类型
+    template <typename U = T>
+    using is_relocatable = std::integral_constant<bool, dhsstl::is_trivially_relocatable<U>::value>;
+
+    // 能否直接用 data_allocator::reallocate 原地扩展内存块
+    template <typename U = T>
+    using can_reallocate = std::integral_constant<bool, data_allocator::template can_reallocate<U>()>;
+
     iterator begin_;        // 表示目前使用空间的头部
     iterator end_;          // 表示目前使用空间的尾部
     iterator cap_;          // 表示目前存储空间的尾部
@@ -82,6 +158,10 @@ public:
         fill_init(n, value);
     }
 
+    vector(size_type n, default_init_t){
+        default_construct_init(n);
+    }
+
     template <typename Iter, typename std::enable_if<
         dhsstl::is_input_iterator<Iter>::value, int>::type = 0
     >
@@ -269,6 +349,15 @@ public:
         copy_insert(const_cast<iterator>(pos), first, last);
     }
 
+    // append_range
+    // 在尾部追加 [first, last), 前向迭代器只计算一次长度, 最多扩容一次
+    template <typename Iter, typename std::enable_if<
+        dhsstl::is_input_iterator<Iter>::value, int 
+    >::type = 0>
+    void append_range(Iter first, Iter last){
+        append_range_aux(first, last, iterator_category(first));
+    }
+
     // erase / clear
     iterator erase(const_iterator pos);
     iterator erase(const_iterator first, const_iterator last);
@@ -277,10 +366,14 @@ public:
     // resieze / reverse
     void     resize(size_type new_size){ return resize(new_size, value_type());}
     void     resize(size_type new_size, const value_type& value);
+    void     resize_default_init(size_type new_size);
+
+    // 在尾部追加 n 个只做默认初始化的元素, 返回指向第一个新元素的指针
+    pointer  append_uninitialized(size_type n);
     
     void     reverse(){ dhsstl::reverse(begin(), end()); }
 
-    void     swap(vector<T>& rhs)   noexcept;
+    void     swap(vector& rhs)      noexcept;
 private:    
     // helper functions
 
@@ -288,6 +381,7 @@ private:
     void        try_init() noexcept;
     void        init_space(size_type size, size_type cap);
     void        fill_init(size_type n, const value_type& value);
+    void        default_construct_init(size_type n);
 
     template <typename Iter>
     void        range_init(Iter first, Iter last);
@@ -312,22 +406,49 @@ private:
 
     void        reallocate_insert(iterator pos, const value_type& value);
 
+    // relocate
+    void        relocate_with_gap(iterator pos, size_type n, iterator new_begin, std::true_type) noexcept;
+    void        relocate_with_gap(iterator pos, size_type n, iterator new_begin, std::false_type);
+    void        relocate_to_new_storage(iterator pos, size_type n, iterator new_begin, size_type new_cap);
+
     // insert
+    template <typename... Args>
+    void        emplace_aux(iterator pos, std::true_type, Args&& ...args);
+    template <typename... Args>
+    void        emplace_aux(iterator pos, std::false_type, Args&& ...args);
+
     iterator    fill_insert(iterator pos, size_type n, const value_type& value);
+    void        fill_insert_aux(iterator pos, size_type n, const value_type& value, std::true_type);
+    void        fill_insert_aux(iterator pos, size_type n, const value_type& value, std::false_type);
     
     template <typename IIter>
     void        copy_insert(iterator pos, IIter frist, IIter last);
+    template <typename FIter>
+    void        copy_insert_aux(iterator pos, FIter first, FIter last, size_type n, std::true_type);
+    template <typename FIter>
+    void        copy_insert_aux(iterator pos, FIter first, FIter last, size_type n, std::false_type);
+
+    // append_range
+    template <typename IIter>
+    void        append_range_aux(IIter first, IIter last, input_iterator_tag);
+    template <typename FIter>
+    void        append_range_aux(FIter first, FIter last, forward_iterator_tag);
+
+    // erase
+    iterator    erase_aux(iterator first, iterator last, std::true_type);
+    iterator    erase_aux(iterator first, iterator last, std::false_type);
 
-    // shrink_to_fit
-    void        reinsert(size_type size);
+    // reserve / shrink_to_fit
+    void        reallocate_storage(size_type new_cap, std::true_type);
+    void        reallocate_storage(size_type new_cap, std::false_type);
 };
 
 
 // ------------------------------------------------------------------------------
 
 // 复制赋值操作符 
-template <typename T>
-vector<T>& vector<T>::operator=(const vector& rhs){
+template <typename T, typename Alloc, typename GrowthPolicy>
+vector<T, Alloc, GrowthPolicy>& vector<T, Alloc, GrowthPolicy>::operator=(const vector& rhs){
     if(this != &rhs){
         const auto len = rhs.size();
         if(len > capacity()){
@@ -340,15 +461,15 @@ vector<T>& vector<T>::operator=(const vector& rhs){
         }else{
             dhsstl::copy(rhs.begin(), rhs.begin() + size(), begin_);
             dhsstl::uninitialized_copy(rhs.begin() + size(), rhs.end(), end_);
-            cap_ = end_ = begin_ + len;
+            end_ = begin_ + len;
         }
     }
     return *this;
 }
 
 // 移动赋值操作符
-template <typename T>
-vector<T>& vector<T>::operator=(vector&& rhs) noexcept{
+template <typename T, typename Alloc, typename GrowthPolicy>
+vector<T, Alloc, GrowthPolicy>& vector<T, Alloc, GrowthPolicy>::operator=(vector&& rhs) noexcept{
     destory_and_recorver(begin_, end_, cap_ - begin_);
     begin_ = rhs.begin_;
     end_ = rhs.end_;
@@ -360,36 +481,30 @@ vector<T>& vector<T>::operator=(vector&& rhs) noexcept{
 }
 
 // 预留空间大小, 当原容量小于要求大小时, 才会重新分配
-template<typename T>
-void vector<T>::reserve(size_type n){
+template <typename T, typename Alloc, typename GrowthPolicy>
+void vector<T, Alloc, GrowthPolicy>::reserve(size_type n){
     if(capacity() < n){
         THROW_LENGTH_ERROR_IF(n > max_size(),
             "n can not larger than max_size() in vector<T>::reserve(n)" 
         );
-        const auto old_size = size();
-        auto tmp = data_allocator::allocate(n);
-        dhsstl::uninitialized_move(begin_, end_, tmp);
-        data_allocator::deallocate(begin_, cap_ - begin_);
-        begin_ = tmp;
-        end_ = tmp + old_size;
-        cap_ = begin_ + n;
+        reallocate_storage(n, can_reallocate<>());
     }
 }
 
 // 放弃多余的容量
-template <typename T>
-void vector<T>::shrink_to_fit(){
+template <typename T, typename Alloc, typename GrowthPolicy>
+void vector<T, Alloc, GrowthPolicy>::shrink_to_fit(){
     if(end_ < cap_){
-        reinsert(size());
+        reallocate_storage(size(), can_reallocate<>());
     }
 }
 
 // 在pos位置就地构造元素, 避免额外的赋值或者移动开销
 // !!!
-template <typename T>
+template <typename T, typename Alloc, typename GrowthPolicy>
 template <typename ...Args>
-typename vector<T>::iterator
-vector<T>::emplace(const_iterator pos, Args&& ...args){
+typename vector<T, Alloc, GrowthPolicy>::iterator
+vector<T, Alloc, GrowthPolicy>::emplace(const_iterator pos, Args&& ...args){
     DHSSTL_DEBUG(pos >= begin() && pos <= end());
     iterator xpos = const_cast<iterator>(pos);
     const size_type n = xpos - begin_;
@@ -397,14 +512,7 @@ vector<T>::emplace(const_iterator pos, Args&& ...args){
         data_allocator::construct(dhsstl::address_of(*end_), dhsstl::forward<Args>(args)...);
         ++end_;
     }else if(end_ != cap_){
-        auto new_end = end_;
-        data_allocator::construct(dhsstl::address_of(*end_), *(end_ - 1));
-        ++new_end;
-        // 这里为什么不用move_backward
-        // dhsstl::move_backward(xpos, end_ - 1, end_);
-        dhsstl::copy_backward(xpos, end_ - 1, end_);
-        *xpos = value_type(dhsstl::forward<Args>(args)...);
-        end_ = new_end;
+        emplace_aux(xpos, is_relocatable<>(), dhsstl::forward<Args>(args)...);
     }else{
         reallocate_emplace(xpos, dhsstl::forward<Args>(args)...);
     }
@@ -412,9 +520,9 @@ vector<T>::emplace(const_iterator pos, Args&& ...args){
 }
 
 // 在尾部就地构造元素, 避免额外的复制或者移动开销
-template <typename T>
+template <typename T, typename Alloc, typename GrowthPolicy>
 template <typename ...Args>
-void vector<T>::emplace_back(Args&& ...args){
+void vector<T, Alloc, GrowthPolicy>::emplace_back(Args&& ...args){
     if(end_ < cap_){
         data_allocator::construct(dhsstl::address_of(*end_), dhsstl::forward<Args>(args)...);
         ++end_;
@@ -424,8 +532,8 @@ void vector<T>::emplace_back(Args&& ...args){
 }
 
 // 在尾部插入元素
-template <typename T>
-void vector<T>::push_back(const value_type& value){
+template <typename T, typename Alloc, typename GrowthPolicy>
+void vector<T, Alloc, GrowthPolicy>::push_back(const value_type& value){
     if(end_ != cap_){
         data_allocator::construct(dhsstl::address_of(*end_), value);
         ++end_;
@@ -435,17 +543,17 @@ void vector<T>::push_back(const value_type& value){
 }
 
 // 弹出尾部元素
-template<typename T>
-void vector<T>::pop_back(){
+template <typename T, typename Alloc, typename GrowthPolicy>
+void vector<T, Alloc, GrowthPolicy>::pop_back(){
     DHSSTL_DEBUG(!empty());
     data_allocator::destroy(end_ - 1);
     --end_;
 }
 
 // 在 pos 处插入元素
-template <typename T>
-typename vector<T>::iterator
-vector<T>::insert(const_iterator pos, const value_type& value){
+template <typename T, typename Alloc, typename GrowthPolicy>
+typename vector<T, Alloc, GrowthPolicy>::iterator
+vector<T, Alloc, GrowthPolicy>::insert(const_iterator pos, const value_type& value){
     DHSSTL_DEBUG(pos >= begin() && pos <= end());
     iterator xpos = const_cast<iterator>(pos);
     const size_type n = pos - begin_;
@@ -453,13 +561,7 @@ vector<T>::insert(const_iterator pos, const value_type& value){
         data_allocator::construct(dhsstl::address_of(*end_), value);
         ++end_;
     }else if(end_ != cap_){
-        auto new_end = end_;
-        data_allocator::construct(dhsstl::address_of(*end_), *(end_ - 1));
-        ++new_end;
-        auto value_copy = value; // 避免元素因为以下复制操作而被改变
-        dhsstl::copy_backward(xpos, end_ - 1, end_);
-        *xpos = dhsstl::move(value_copy);
-        end_ = new_end;
+        emplace_aux(xpos, is_relocatable<>(), value);
     }else{
         reallocate_insert(xpos, value);
     }
@@ -467,32 +569,26 @@ vector<T>::insert(const_iterator pos, const value_type& value){
 }
 
 // 删除pos位置上的元素
-template <typename T>
-typename vector<T>::iterator
-vector<T>::erase(const_iterator pos){
+template <typename T, typename Alloc, typename GrowthPolicy>
+typename vector<T, Alloc, GrowthPolicy>::iterator
+vector<T, Alloc, GrowthPolicy>::erase(const_iterator pos){
     DHSSTL_DEBUG(pos >= begin() && pos <= end());
     iterator xpos = begin_ + (pos - begin());
-    dhsstl::move(xpos + 1, end_, xpos);
-    data_allocator::destroy(end_ - 1);
-    --end_;
-    return xpos;
+    return erase_aux(xpos, xpos + 1, is_relocatable<>());
 }
 
 // 删除[first, last)上的元素
-template <typename T>
-typename vector<T>::iterator
-vector<T>::erase(const_iterator first, const_iterator last){
+template <typename T, typename Alloc, typename GrowthPolicy>
+typename vector<T, Alloc, GrowthPolicy>::iterator
+vector<T, Alloc, GrowthPolicy>::erase(const_iterator first, const_iterator last){
     DHSSTL_DEBUG(first >= begin() && last <= end() && !(last < first));
-    const auto n = first - begin();
     iterator r = begin_ + (first - begin());
-    data_allocator::destroy(dhsstl::move(r + (last - first), end_, r), end_);
-    end_ = end_ - (last - first);
-    return begin_ + n;
+    return erase_aux(r, r + (last - first), is_relocatable<>());
 }
 
 // 重置容器大小
-template <typename T>
-void vector<T>::resize(size_type new_size, const value_type& value){
+template <typename T, typename Alloc, typename GrowthPolicy>
+void vector<T, Alloc, GrowthPolicy>::resize(size_type new_size, const value_type& value){
     if(new_size < size()){
         erase(begin() + new_size, end());
     }else{
@@ -500,9 +596,30 @@ void vector<T>::resize(size_type new_size, const value_type& value){
     }
 }
 
+// 重置容器大小, 新增的元素只做默认初始化
+template <typename T, typename Alloc, typename GrowthPolicy>
+void vector<T, Alloc, GrowthPolicy>::resize_default_init(size_type new_size){
+    if(new_size < size()){
+        erase(begin() + new_size, end());
+    }else{
+        append_uninitialized(new_size - size());
+    }
+}
+
+// 在尾部追加 n 个只做默认初始化的元素
+template <typename T, typename Alloc, typename GrowthPolicy>
+typename vector<T, Alloc, GrowthPolicy>::pointer
+vector<T, Alloc, GrowthPolicy>::append_uninitialized(size_type n){
+    if(static_cast<size_type>(cap_ - end_) < n)
+        reallocate_storage(get_new_cap(n), can_reallocate<>());
+    auto old_end = end_;
+    end_ = dhsstl::uninitialized_default_construct_n(end_, n);
+    return old_end;
+}
+
 // 与另一个 vector 交换
-template <typename T>
-void vector<T>::swap(vector<T>& rhs) noexcept{
+template <typename T, typename Alloc, typename GrowthPolicy>
+void vector<T, Alloc, GrowthPolicy>::swap(vector<T, Alloc, GrowthPolicy>& rhs) noexcept{
     if(this != &rhs){
         dhsstl::swap(begin_, rhs.begin_);
         dhsstl::swap(end_, rhs.end_);
@@ -513,8 +630,8 @@ void vector<T>::swap(vector<T>& rhs) noexcept{
 // helper function
 
 // try_init(), 若分配失败则忽略, 不抛出异常 
-template <typename T>
-void vector<T>::try_init() noexcept{
+template <typename T, typename Alloc, typename GrowthPolicy>
+void vector<T, Alloc, GrowthPolicy>::try_init() noexcept{
     try
     {
         begin_ = data_allocator::allocate(16);
@@ -530,8 +647,8 @@ void vector<T>::try_init() noexcept{
 }
 
 // init_space 函数
-template <typename T>
-void vector<T>::init_space(size_type size, size_type cap){
+template <typename T, typename Alloc, typename GrowthPolicy>
+void vector<T, Alloc, GrowthPolicy>::init_space(size_type size, size_type cap){
     try
     {
         begin_ = data_allocator::allocate(cap);
@@ -548,17 +665,25 @@ void vector<T>::init_space(size_type size, size_type cap){
 }
 
 // fill_init 函数
-template <typename T>
-void vector<T>::fill_init(size_type n, const value_type& value){
+template <typename T, typename Alloc, typename GrowthPolicy>
+void vector<T, Alloc, GrowthPolicy>::fill_init(size_type n, const value_type& value){
     const size_type init_size = dhsstl::max(static_cast<size_type>(16), n);
     init_space(n, init_size);
     dhsstl::uninitialized_fill_n(begin_, n, value);
 }
 
+// default_construct_init 函数
+template <typename T, typename Alloc, typename GrowthPolicy>
+void vector<T, Alloc, GrowthPolicy>::default_construct_init(size_type n){
+    const size_type init_size = dhsstl::max(static_cast<size_type>(16), n);
+    init_space(n, init_size);
+    dhsstl::uninitialized_default_construct_n(begin_, n);
+}
+
 // range_init 函数
-template <typename T>
+template <typename T, typename Alloc, typename GrowthPolicy>
 template <typename Iter>
-void vector<T>::range_init(Iter first, Iter last){
+void vector<T, Alloc, GrowthPolicy>::range_init(Iter first, Iter last){
     const size_type len = dhsstl::distance(first, last);
     const size_type init_size = dhsstl::max(len, static_cast<size_type>(16));
     init_space(len, init_size);
@@ -566,37 +691,30 @@ void vector<T>::range_init(Iter first, Iter last){
 }
 
 // destory_and_recover()
-template <typename T>
-void vector<T>::destory_and_recorver(iterator first, iterator last, size_type n){
+template <typename T, typename Alloc, typename GrowthPolicy>
+void vector<T, Alloc, GrowthPolicy>::destory_and_recorver(iterator first, iterator last, size_type n){
     data_allocator::destroy(first, last);
     data_allocator::deallocate(first, n);
 }
 
 // get_new_cap()
-template <typename T>
-typename vector<T>::size_type
-vector<T>::get_new_cap(size_type add_size){
-    // 这个函数要分三种情况:
+template <typename T, typename Alloc, typename GrowthPolicy>
+typename vector<T, Alloc, GrowthPolicy>::size_type
+vector<T, Alloc, GrowthPolicy>::get_new_cap(size_type add_size){
+    // 这个函数要分两种情况:
     //  1. add_size 装不下: 也就是 old_size > max_size() - add_size
-    //  2. add_size 可以装的下
-    //      因为 c++ 默认一次可以装 old_size / 2 这样扩
-    //      但加入 已经装不下, 那就只能按照 old_size / 2 这样了
-    //      若可以装的下, 就判断一下
+    //  2. add_size 可以装的下, 由 GrowthPolicy 决定新容量
+    //      若策略给出的容量溢出或者超过了 max_size(), 就只扩到刚好够用
     const auto old_size = capacity();
     THROW_LENGTH_ERROR_IF(old_size > max_size() - add_size, "vector<T>'s size too big");
-    if(old_size > max_size() - old_size / 2){
-        return old_size + add_size > max_size() - 16
-            ? old_size + add_size : old_size + add_size + 16;
-    }
-    const size_type new_size = old_size == 0 ?
-        dhsstl::max(add_size, static_cast<size_type>(16)) :
-        dhsstl::max(old_size + old_size / 2, old_size + add_size);
-    return new_size;
+    const size_type min_size = old_size + add_size;
+    const size_type new_size = GrowthPolicy::grow(old_size, min_size, sizeof(T));
+    return (new_size < min_size || new_size > max_size()) ? min_size : new_size;
 }
 
 // fill_assign()
-template <typename T>
-void vector<T>::fill_assign(size_type n, const value_type& value){
+template <typename T, typename Alloc, typename GrowthPolicy>
+void vector<T, Alloc, GrowthPolicy>::fill_assign(size_type n, const value_type& value){
     if (n > capacity()){
         vector tmp(n, value);
         swap(tmp);
@@ -609,9 +727,9 @@ void vector<T>::fill_assign(size_type n, const value_type& value){
 }
 
 // copy_assign()
-template<typename T>
+template <typename T, typename Alloc, typename GrowthPolicy>
 template<typename IIter>
-void vector<T>::copy_assign(IIter first, IIter last, input_iterator_tag){
+void vector<T, Alloc, GrowthPolicy>::copy_assign(IIter first, IIter last, input_iterator_tag){
     auto cur = begin_; 
     for(; first != last && cur != end_; ++first, ++cur){
         *cur = *first;
@@ -624,9 +742,9 @@ void vector<T>::copy_assign(IIter first, IIter last, input_iterator_tag){
 }
 
 // 用[first, last) 为容器赋值
-template<typename T>
+template <typename T, typename Alloc, typename GrowthPolicy>
 template<typename FIter>
-void vector<T>::copy_assign(FIter first, FIter last, forward_iterator_tag){
+void vector<T, Alloc, GrowthPolicy>::copy_assign(FIter first, FIter last, forward_iterator_tag){
     const size_type len = dhsstl::distance(first, last);
     if(len > capacity()){
         vector tmp(first, last);
@@ -645,54 +763,128 @@ void vector<T>::copy_assign(FIter first, FIter last, forward_iterator_tag){
 }
 
 // 重新分配空间并在 pos 出就地构造元素
-template <typename T>
+template <typename T, typename Alloc, typename GrowthPolicy>
 template <typename... Args>
-void vector<T>::reallocate_emplace(iterator pos, Args&& ...args){
+void vector<T, Alloc, GrowthPolicy>::reallocate_emplace(iterator pos, Args&& ...args){
+    if(can_reallocate<>::value && pos == end_){
+        // 在尾部扩容时直接 realloc, 新元素先构造在栈上, 因为 realloc 之后 args 引用的容器内元素可能已经失效
+        value_type value(dhsstl::forward<Args>(args)...);
+        reallocate_storage(get_new_cap(1), can_reallocate<>());
+        data_allocator::construct(dhsstl::address_of(*end_), dhsstl::move(value));
+        ++end_;
+        return;
+    }
     // 注: 这个get_new_cap的参数是加的个数
     const auto new_size = get_new_cap(1);
     auto new_begin = data_allocator::allocate(new_size);
-    auto new_end = new_begin;
+    // 先构造新元素, 再搬移旧元素, 这样 args 引用容器内的元素时也不会读到被搬走的值
     try{
-        new_end = dhsstl::uninitialized_move(begin_, pos, new_begin);
-        data_allocator::construct(dhsstl::address_of(*new_end), dhsstl::forward<Args>(args)...);
-        ++new_end;
-        new_end = dhsstl::uninitialized_move(pos, end_, new_end);
+        data_allocator::construct(dhsstl::address_of(*(new_begin + (pos - begin_))),
+                                  dhsstl::forward<Args>(args)...);
     }catch(...){
         data_allocator::deallocate(new_begin, new_size);
         throw;
     }
-    destory_and_recorver(begin_, end_, cap_ - begin_);
-    begin_ = new_begin;
-    end_ = new_end;
-    cap_ = new_begin + new_size;
+    relocate_to_new_storage(pos, 1, new_begin, new_size);
 }
 
 // 重新分配空间并在 pos 处插入元素
-template<typename T>
-void vector<T>::reallocate_insert(iterator pos, const value_type& value){
-    const auto new_size = get_new_cap(1);
-    auto new_begin = data_allocator::allocate(new_size); 
+template <typename T, typename Alloc, typename GrowthPolicy>
+void vector<T, Alloc, GrowthPolicy>::reallocate_insert(iterator pos, const value_type& value){
+    reallocate_emplace(pos, value);
+}
+
+// relocate_with_gap 函数
+// 把 [begin_, pos) 与 [pos, end_) 搬移到以 new_begin 起始的新空间, 两段之间空出 n 个位置
+// trivially relocatable 版本: 两次 memmove, 旧元素不再析构
+template <typename T, typename Alloc, typename GrowthPolicy>
+void vector<T, Alloc, GrowthPolicy>::
+relocate_with_gap(iterator pos, size_type n, iterator new_begin, std::true_type) noexcept{
+    auto new_end = dhsstl::uninitialized_relocate(begin_, pos, new_begin);
+    dhsstl::uninitialized_relocate(pos, end_, new_end + n);
+}
+
+// 一般版本: 先移动构造全部元素, 成功之后再析构旧元素
+template <typename T, typename Alloc, typename GrowthPolicy>
+void vector<T, Alloc, GrowthPolicy>::
+relocate_with_gap(iterator pos, size_type n, iterator new_begin, std::false_type){
     auto new_end = new_begin;
-    const value_type& value_copy = value;
     try{
         new_end = dhsstl::uninitialized_move(begin_, pos, new_begin);
-        data_allocator::construct(dhsstl::address_of(*new_end), value_copy);
-        ++new_end;
-        new_end = dhsstl::uninitialized_move(end_, new_end);
+        dhsstl::uninitialized_move(pos, end_, new_end + n);
     }catch(...){
-        data_allocator::deallocate(new_begin, new_size);
+        data_allocator::destroy(new_begin, new_end);
         throw;
     }
-    destory_and_recorver(begin_, end_, cap_ - begin_);
+    data_allocator::destroy(begin_, end_);
+}
+
+// relocate_to_new_storage 函数
+// 新空间中 [pos - begin_, pos - begin_ + n) 上的元素已经构造好, 把旧元素搬过去并释放旧空间
+template <typename T, typename Alloc, typename GrowthPolicy>
+void vector<T, Alloc, GrowthPolicy>::
+relocate_to_new_storage(iterator pos, size_type n, iterator new_begin, size_type new_cap){
+    const size_type old_size = size();
+    try{
+        relocate_with_gap(pos, n, new_begin, is_relocatable<>());
+    }catch(...){
+        const auto gap = new_begin + (pos - begin_);
+        data_allocator::destroy(gap, gap + n);
+        data_allocator::deallocate(new_begin, new_cap);
+        throw;
+    }
+    data_allocator::deallocate(begin_, cap_ - begin_);
     begin_ = new_begin;
+    end_ = new_begin + old_size + n;
+    cap_ = new_begin + new_cap;
+}
+
+// emplace_aux 函数, 备用空间足够时在 pos 处构造元素
+// trivially relocatable 版本: 先在临时空间构造新元素, 把 [pos, end_) 整体后移一位, 再把新元素搬进来
+template <typename T, typename Alloc, typename GrowthPolicy>
+template <typename... Args>
+void vector<T, Alloc, GrowthPolicy>::emplace_aux(iterator pos, std::true_type, Args&& ...args){
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type buf;
+    auto tmp = reinterpret_cast<pointer>(&buf);
+    data_allocator::construct(tmp, dhsstl::forward<Args>(args)...);
+    dhsstl::uninitialized_relocate_backward(pos, end_, end_ + 1);
+    dhsstl::uninitialized_relocate(tmp, tmp + 1, pos);
+    ++end_;
+}
+
+template <typename T, typename Alloc, typename GrowthPolicy>
+template <typename... Args>
+void vector<T, Alloc, GrowthPolicy>::emplace_aux(iterator pos, std::false_type, Args&& ...args){
+    auto value_copy = value_type(dhsstl::forward<Args>(args)...); // 避免元素因为以下复制操作而被改变
+    data_allocator::construct(dhsstl::address_of(*end_), dhsstl::move(*(end_ - 1)));
+    ++end_;
+    dhsstl::move_backward(pos, end_ - 2, end_ - 1);
+    *pos = dhsstl::move(value_copy);
+}
+
+// erase_aux 函数
+// trivially relocatable 版本: 析构被删除的元素, 再把后面的元素整体前移
+template <typename T, typename Alloc, typename GrowthPolicy>
+typename vector<T, Alloc, GrowthPolicy>::iterator
+vector<T, Alloc, GrowthPolicy>::erase_aux(iterator first, iterator last, std::true_type){
+    data_allocator::destroy(first, last);
+    end_ = dhsstl::uninitialized_relocate(last, end_, first);
+    return first;
+}
+
+template <typename T, typename Alloc, typename GrowthPolicy>
+typename vector<T, Alloc, GrowthPolicy>::iterator
+vector<T, Alloc, GrowthPolicy>::erase_aux(iterator first, iterator last, std::false_type){
+    auto new_end = dhsstl::move(last, end_, first);
+    data_allocator::destroy(new_end, end_);
     end_ = new_end;
-    cap_ = new_begin + new_size;
+    return first;
 }
 
 // fill_insert()
-template <typename T>
-typename vector<T>::iterator
-vector<T>::
+template <typename T, typename Alloc, typename GrowthPolicy>
+typename vector<T, Alloc, GrowthPolicy>::iterator
+vector<T, Alloc, GrowthPolicy>::
 fill_insert(iterator pos, size_type n, const value_type& value){
     if(n == 0)
         return pos;
@@ -700,121 +892,209 @@ fill_insert(iterator pos, size_type n, const value_type& value){
     const value_type value_copy = value; // 避免被覆盖 
     if(static_cast<size_type>(cap_ - end_) >= n){
         // 如果备用空间大于等于增加的空间
+        fill_insert_aux(pos, n, value_copy, is_relocatable<>());
+    }else if(can_reallocate<>::value && pos == end_){
+        // 在尾部填充时直接 realloc, 再就地填充
+        reallocate_storage(get_new_cap(n), can_reallocate<>());
+        fill_insert_aux(end_, n, value_copy, is_relocatable<>());
+    }else{
+        // 如果备用空间不足
         const auto new_size = get_new_cap(n);
         auto new_begin = data_allocator::allocate(new_size);
-        auto new_end = new_begin;
         try{
-            new_end = dhsstl::uninitialized_move(begin_, pos, new_begin);
-            new_end = dhsstl::uninitialized_fill_n(new_end, n, value);
-            new_end = dhsstl::uninitialized_move(pos, end_, new_end);
+            dhsstl::uninitialized_fill_n(new_begin + xpos, n, value_copy);
         }catch(...){
-            destory_and_recorver(new_begin, new_end, new_size);
+            data_allocator::deallocate(new_begin, new_size);
             throw;
         }
-        data_allocator::deallocate(begin_, cap_ - begin_);
-        begin_ = new_begin;
-        end_ = new_end;
-        cap_ = begin_ + new_size;
+        relocate_to_new_storage(pos, n, new_begin, new_size);
     }
     return begin_ + xpos;
 }
 
+// fill_insert_aux 函数, 备用空间足够时在 pos 处填充 n 个元素
+template <typename T, typename Alloc, typename GrowthPolicy>
+void vector<T, Alloc, GrowthPolicy>::
+fill_insert_aux(iterator pos, size_type n, const value_type& value, std::true_type){
+    dhsstl::uninitialized_relocate_backward(pos, end_, end_ + n);
+    try{
+        dhsstl::uninitialized_fill_n(pos, n, value);
+    }catch(...){
+        dhsstl::uninitialized_relocate(pos + n, end_ + n, pos);
+        throw;
+    }
+    end_ += n;
+}
+
+template <typename T, typename Alloc, typename GrowthPolicy>
+void vector<T, Alloc, GrowthPolicy>::
+fill_insert_aux(iterator pos, size_type n, const value_type& value, std::false_type){
+    const size_type after_elems = end_ - pos;
+    auto old_end = end_;
+    if(after_elems > n){
+        end_ = dhsstl::uninitialized_move(end_ - n, end_, end_);
+        dhsstl::move_backward(pos, old_end - n, old_end);
+        dhsstl::fill_n(pos, n, value);
+    }else{
+        end_ = dhsstl::uninitialized_fill_n(end_, n - after_elems, value);
+        end_ = dhsstl::uninitialized_move(pos, old_end, end_);
+        dhsstl::fill_n(pos, after_elems, value);
+    }
+}
+
 // copy_insert 函数
-template <typename T>
+template <typename T, typename Alloc, typename GrowthPolicy>
 template <typename IIter>
-void vector<T>::
+void vector<T, Alloc, GrowthPolicy>::
 copy_insert(iterator pos, IIter first, IIter last){
     if(first == last)
         return;
-    const auto n = dhsstl::distance(first, last);
-    if((cap_ - end_) > n){
+    const size_type n = dhsstl::distance(first, last);
+    if(static_cast<size_type>(cap_ - end_) >= n){
         // 如果备用空间大小足够
-        const auto after_elems = end_ - pos;
-        auto old_end = end_;
-        if(after_elems > n){
-            end_ = dhsstl::uninitialized_copy(end_ - n, end_, end_);
-            dhsstl::move_backward(pos, old_end - n, old_end);
-            dhsstl::uninitialized_copy(first, last, pos);
-        }else{
-            auto mid = first;
-            dhsstl::advance(mid, after_elems);
-            end_ = dhsstl::uninitialized_copy(mid, last, end_);
-            end_ = dhsstl::uninitialized_move(pos, old_end, end_);
-            dhsstl::uninitialized_copy(first, mid, pos);
-        }
+        copy_insert_aux(pos, first, last, n, is_relocatable<>());
     }else{
         // 如果备用空间不足
         const auto new_size = get_new_cap(n);
         auto new_begin = data_allocator::allocate(new_size);
-        auto new_end = new_begin;
         try{
-            new_end = dhsstl::uninitialized_move(begin_, pos, new_begin);
-            new_end = dhsstl::uninitialized_copy(first, last, new_end);
-            new_end = dhsstl::uninitialized_move(pos, end_, new_end);
+            dhsstl::uninitialized_copy(first, last, new_begin + (pos - begin_));
         }catch(...){
-            destory_and_recorver(new_begin, new_end, new_size);
+            data_allocator::deallocate(new_begin, new_size);
             throw;
         }
-        data_allocator::deallocate(begin_, cap_ - begin_);
-        begin_ = new_begin;
-        end_ = new_end;
-        cap_ = begin_ + new_size;
+        relocate_to_new_storage(pos, n, new_begin, new_size);
+    }
+}
+
+// copy_insert_aux 函数, 备用空间足够时在 pos 处插入 [first, last)
+template <typename T, typename Alloc, typename GrowthPolicy>
+template <typename FIter>
+void vector<T, Alloc, GrowthPolicy>::
+copy_insert_aux(iterator pos, FIter first, FIter last, size_type n, std::true_type){
+    dhsstl::uninitialized_relocate_backward(pos, end_, end_ + n);
+    try{
+        dhsstl::uninitialized_copy(first, last, pos);
+    }catch(...){
+        dhsstl::uninitialized_relocate(pos + n, end_ + n, pos);
+        throw;
+    }
+    end_ += n;
+}
+
+template <typename T, typename Alloc, typename GrowthPolicy>
+template <typename FIter>
+void vector<T, Alloc, GrowthPolicy>::
+copy_insert_aux(iterator pos, FIter first, FIter last, size_type n, std::false_type){
+    const size_type after_elems = end_ - pos;
+    auto old_end = end_;
+    if(after_elems > n){
+        end_ = dhsstl::uninitialized_move(end_ - n, end_, end_);
+        dhsstl::move_backward(pos, old_end - n, old_end);
+        dhsstl::copy(first, last, pos);
+    }else{
+        auto mid = first;
+        dhsstl::advance(mid, after_elems);
+        end_ = dhsstl::uninitialized_copy(mid, last, end_);
+        end_ = dhsstl::uninitialized_move(pos, old_end, end_);
+        dhsstl::copy(first, mid, pos);
+    }
+}
+
+// append_range_aux 函数
+// input_iterator_tag 版本: 长度未知, 只能逐个追加
+template <typename T, typename Alloc, typename GrowthPolicy>
+template <typename IIter>
+void vector<T, Alloc, GrowthPolicy>::
+append_range_aux(IIter first, IIter last, input_iterator_tag){
+    for(; first != last; ++first)
+        emplace_back(*first);
+}
+
+// forward_iterator_tag 版本: 先按 n 扩容一次, 再整段复制到尾部
+// trivially copyable 且来源不是自身的元素时, 交给 realloc 原地扩展, 之后的复制对原生指针就是一次 memmove
+template <typename T, typename Alloc, typename GrowthPolicy>
+template <typename FIter>
+void vector<T, Alloc, GrowthPolicy>::
+append_range_aux(FIter first, FIter last, forward_iterator_tag){
+    if(first == last)
+        return;
+    const size_type n = dhsstl::distance(first, last);
+    if(static_cast<size_type>(cap_ - end_) < n && can_reallocate<>::value){
+        const auto src = static_cast<const void*>(&*first);
+        if(src < static_cast<const void*>(begin_) || src >= static_cast<const void*>(cap_))
+            reallocate_storage(get_new_cap(n), can_reallocate<>());
+    }
+    if(static_cast<size_type>(cap_ - end_) >= n){
+        end_ = dhsstl::uninitialized_copy(first, last, end_);
+    }else{
+        copy_insert(end_, first, last);
     }
 }
 
-// reinsert 函数
-template <typename T>
-void vector<T>::reinsert(size_type size){
-    auto new_begin = data_allocator::allocate(size);
+// reallocate_storage 函数, 把存储空间调整为 new_cap, 元素保持不变
+// trivially copyable 版本: 交给 realloc, 能原地扩展/收缩时不需要复制任何元素
+template <typename T, typename Alloc, typename GrowthPolicy>
+void vector<T, Alloc, GrowthPolicy>::reallocate_storage(size_type new_cap, std::true_type){
+    const size_type old_size = size();
+    begin_ = data_allocator::reallocate(begin_, capacity(), new_cap);
+    end_ = begin_ + old_size;
+    cap_ = begin_ + new_cap;
+}
+
+template <typename T, typename Alloc, typename GrowthPolicy>
+void vector<T, Alloc, GrowthPolicy>::reallocate_storage(size_type new_cap, std::false_type){
+    const size_type old_size = size();
+    auto new_begin = data_allocator::allocate(new_cap);
     try{
-        dhsstl::uninitialized_move(begin_, end_, new_begin);
+        dhsstl::uninitialized_relocate(begin_, end_, new_begin);
     }catch(...){
-        data_allocator::deallocate(new_begin, size);
+        data_allocator::deallocate(new_begin, new_cap);
         throw;
     }
     data_allocator::deallocate(begin_, cap_ - begin_);
     begin_ = new_begin;
-    end_ = begin_ + size;
-    cap_ = begin_ + size;
+    end_ = new_begin + old_size;
+    cap_ = new_begin + new_cap;
 }
 
 // --------------------------------------------------------------
 // 重载比较操作符
 
-template <typename T>
-bool operator==(const vector<T>& lhs, const vector<T>& rhs){
+template <typename T, typename Alloc, typename GrowthPolicy>
+bool operator==(const vector<T, Alloc, GrowthPolicy>& lhs, const vector<T, Alloc, GrowthPolicy>& rhs){
     return lhs.size() == rhs.size() &&
         dhsstl::equal(lhs.begin(), lhs.end(), rhs.begin());
 }
 
-template <typename T>
-bool operator<(const vector<T>& lhs, const vector<T>& rhs){
+template <typename T, typename Alloc, typename GrowthPolicy>
+bool operator<(const vector<T, Alloc, GrowthPolicy>& lhs, const vector<T, Alloc, GrowthPolicy>& rhs){
     return dhsstl::lexicograhical_compare(lhs.begin(), lhs.end(), rhs.begin());
 }
 
-template <typename T>
-bool operator!=(const vector<T>& lhs, const vector<T>& rhs){
+template <typename T, typename Alloc, typename GrowthPolicy>
+bool operator!=(const vector<T, Alloc, GrowthPolicy>& lhs, const vector<T, Alloc, GrowthPolicy>& rhs){
     return !(lhs == rhs);
 }
 
-template <typename T>
-bool operator>(const vector<T>& lhs, const vector<T>& rhs){
+template <typename T, typename Alloc, typename GrowthPolicy>
+bool operator>(const vector<T, Alloc, GrowthPolicy>& lhs, const vector<T, Alloc, GrowthPolicy>& rhs){
     return rhs < lhs;
 } 
 
-template <typename T>
-bool operator<=(const vector<T>& lhs, const vector<T>& rhs){
+template <typename T, typename Alloc, typename GrowthPolicy>
+bool operator<=(const vector<T, Alloc, GrowthPolicy>& lhs, const vector<T, Alloc, GrowthPolicy>& rhs){
     return !(rhs > lhs);
 }
 
-template <typename T>
-bool operator>=(const vector<T>& lhs, const vector<T>& rhs){
+template <typename T, typename Alloc, typename GrowthPolicy>
+bool operator>=(const vector<T, Alloc, GrowthPolicy>& lhs, const vector<T, Alloc, GrowthPolicy>& rhs){
     return !(lhs < rhs);
 }
 
 // 重载 dhsstl 的 swap
-template <typename T>
-void swap(vector<T>& lhs, vector<T>& rhs){
+template <typename T, typename Alloc, typename GrowthPolicy>
+void swap(vector<T, Alloc, GrowthPolicy>& lhs, vector<T, Alloc, GrowthPolicy>& rhs){
     lhs.swap(rhs);
 }
 
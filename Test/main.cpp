@@ -1,26 +1,56 @@
 #include "test_alloc.h"
+#include "test_memory.h"
 #include "test_vector.h"
 #include "test_list.h"
 #include "test_deque.h"
 #include "test_stack.h"
 #include "test_queue.h"
+#include "test_concurrent_queue.h"
+#include "test_reclaim.h"
+#include "test_thread_pool.h"
+#include "test_execution.h"
+#include "test_algo.h"
 #include "test_set.h"
 #include "test_map.h"
 
 int main(){
 //! -------  Test Alloc  ---------
 //    dhsstl::test::test_alloc();
+//    dhsstl::test::huge_page_vector_test();
+//    dhsstl::test::huge_page_scan_perf();
+//    dhsstl::test::object_pool_test();
+//    dhsstl::test::object_pool_perf();
+//    dhsstl::test::tracking_allocator_test();
+
+//! -------  Test Memory  ---------
+//    dhsstl::test::shared_ptr_test();
+//    dhsstl::test::shared_ptr_perf();
+//    dhsstl::test::shared_ptr_copy_perf();
+//    dhsstl::test::intrusive_ptr_test();
+//    dhsstl::test::intrusive_ptr_perf();
+//    dhsstl::test::uninitialized_test();
+//    dhsstl::test::uninitialized_perf();
 
 //! ------   Test Vector  --------
 //    dhsstl::test::vector_test();
+//    dhsstl::test::vector_relocate_perf();
+//    dhsstl::test::vector_realloc_perf();
+//    dhsstl::test::vector_growth_perf();
+//    dhsstl::test::vector_default_init_perf();
 
 //! -------   Test List  ---------
 //    dhsstl::test::list_test();
 //    dhsstl::test::list_stl();
+//    dhsstl::test::list_sort_test();
+//    dhsstl::test::list_sort_perf();
+//    dhsstl::test::list_pool_test();
+//    dhsstl::test::list_pool_perf();
+//    dhsstl::test::list_build_perf();
 
 //! -------  Test Deque  ---------
 //    dhsstl::test::deque_test();
 //    dhsstl::test::deque_std();
+//    dhsstl::test::deque_algo_perf();
 
 //! -------  Test Stack  ---------
 //    dhsstl::test::stack_test();
@@ -28,10 +58,36 @@ int main(){
 //! -------  Test Queue  ---------
 //    dhsstl::test::queue_test();
 //    dhsstl::test::priority_queue_test();
+//    dhsstl::test::queue_churn_perf();
+
+//! -------  Test Concurrent Queue  ---------
+//    dhsstl::test::concurrent_queue_test();
+//    dhsstl::test::concurrent_queue_perf();
+//    dhsstl::test::mpsc_queue_perf();
+
+//! -------  Test Reclaim  ---------
+//    dhsstl::test::reclaim_test();
+//    dhsstl::test::snapshot_publish_perf();
+
+//! -------  Test Thread Pool  ---------
+//    dhsstl::test::thread_pool_test();
+//    dhsstl::test::thread_pool_perf();
+
+//! -------  Test Execution Policy  ---------
+//    dhsstl::test::execution_test();
+//    dhsstl::test::execution_perf();
+
+//! -------  Test Algorithm  ---------
+//    dhsstl::test::algo_test();
+//    dhsstl::test::sort_perf();
+//    dhsstl::test::radix_sort_perf();
+//    dhsstl::test::stable_merge_perf();
 
 //! -------  Test   Set  ---------
 //    dhsstl::test::set_test();
 //    dhsstl::test::multiset_test();
+//    dhsstl::test::set_batch_test();
+//    dhsstl::test::set_build_perf();
 
 //! -------  Test   Map  ---------
 //    dhsstl::test::map_test();
@@ -0,0 +1,473 @@
+#ifndef DHSTINYSTL_TEST_ALGO_H_
+#define DHSTINYSTL_TEST_ALGO_H_
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include "algo.h"
+#include "execution.h"
+#include "radix_sort.h"
+#include "vector.h"
+#include "test.h"
+
+namespace dhsstl {
+namespace test {
+
+typedef std::chrono::steady_clock algo_clock;
+
+// 测试用的输入分布
+enum class sort_input { random, sorted, reversed, few_unique, organ_pipe };
+
+inline const char* sort_input_name(sort_input k){
+    switch(k){
+    case sort_input::random:     return "random";
+    case sort_input::sorted:     return "sorted";
+    case sort_input::reversed:   return "reversed";
+    case sort_input::few_unique: return "few_unique";
+    default:                     return "organ_pipe";
+    }
+}
+
+template <typename T>
+void make_sort_input(dhsstl::vector<T>& v, size_t n, sort_input k, uint32_t seed = 2024){
+    std::mt19937_64 gen(seed);
+    v.resize(n);
+    for(size_t i = 0; i < n; ++i){
+        switch(k){
+        case sort_input::random:     v[i] = static_cast<T>(gen()); break;
+        case sort_input::sorted:     v[i] = static_cast<T>(i); break;
+        case sort_input::reversed:   v[i] = static_cast<T>(n - i); break;
+        case sort_input::few_unique: v[i] = static_cast<T>(gen() % 16); break;
+        default:                     v[i] = static_cast<T>(i < n / 2 ? i : n - i); break;
+        }
+    }
+}
+
+// 带原始下标的元素, 只按 key 比较, 用来检查 stable_sort 的稳定性
+struct keyed
+{
+    int    key;
+    size_t index;
+};
+
+struct keyed_less
+{
+    bool operator()(const keyed& a, const keyed& b) const { return a.key < b.key; }
+};
+
+// 记录复制次数和存活个数的元素, 移动不计入复制
+struct algo_counted
+{
+    static int copies;
+    static int alive;
+    int        key;
+
+    explicit algo_counted(int k = 0) : key(k) { ++alive; }
+    algo_counted(const algo_counted& rhs) : key(rhs.key) { ++copies; ++alive; }
+    algo_counted(algo_counted&& rhs) noexcept : key(rhs.key) { ++alive; }
+    algo_counted& operator=(const algo_counted& rhs) { key = rhs.key; ++copies; return *this; }
+    algo_counted& operator=(algo_counted&& rhs) noexcept { key = rhs.key; return *this; }
+    ~algo_counted() { --alive; }
+
+    bool operator<(const algo_counted& rhs) const { return key < rhs.key; }
+};
+int algo_counted::copies = 0;
+int algo_counted::alive = 0;
+
+//! @brief 功能测试: 各种输入下 sort / stable_sort / partial_sort / nth_element 的结果与 std::sort 一致
+void algo_test(){
+    std::cout << "[=================================================================================]" << std::endl;
+    std::cout << "[------------------------- Run API test : sort algorithms ------------------------]" << std::endl;
+    const sort_input kinds[] = { sort_input::random, sort_input::sorted, sort_input::reversed,
+                                 sort_input::few_unique, sort_input::organ_pipe };
+    const size_t sizes[] = { 0, 1, 2, 23, 24, 100, 1000, 100000 };
+    dhsstl::thread_pool pool(4);
+    bool sort_ok = true, par_ok = true, greater_ok = true, stable_ok = true, partial_ok = true, nth_ok = true;
+    dhsstl::vector<int> v, w, expect;
+    for(auto k : kinds){
+        for(auto n : sizes){
+            make_sort_input(expect, n, k);
+            std::sort(expect.data(), expect.data() + n);
+
+            make_sort_input(v, n, k);
+            dhsstl::sort(v.begin(), v.end());
+            sort_ok = sort_ok && dhsstl::equal(v.begin(), v.end(), expect.begin());
+
+            make_sort_input(v, n, k);
+            dhsstl::sort(dhsstl::execution::par.on(pool), v.begin(), v.end());
+            par_ok = par_ok && dhsstl::equal(v.begin(), v.end(), expect.begin());
+
+            make_sort_input(v, n, k);
+            dhsstl::sort(v.begin(), v.end(), dhsstl::greater<int>());
+            greater_ok = greater_ok && dhsstl::is_sorted(v.begin(), v.end(), dhsstl::greater<int>());
+
+            make_sort_input(v, n, k);
+            dhsstl::stable_sort(v.begin(), v.end());
+            stable_ok = stable_ok && dhsstl::equal(v.begin(), v.end(), expect.begin());
+
+            if(n > 0){
+                const size_t m = n / 3;
+                make_sort_input(v, n, k);
+                dhsstl::partial_sort(v.begin(), v.begin() + m, v.end());
+                partial_ok = partial_ok && dhsstl::equal(v.begin(), v.begin() + m, expect.begin());
+
+                make_sort_input(v, n, k);
+                dhsstl::nth_element(v.begin(), v.begin() + m, v.end());
+                bool ok = v[m] == expect[m];
+                for(size_t i = 0; i < m; ++i)
+                    ok = ok && !(v[m] < v[i]);
+                for(size_t i = m + 1; i < n; ++i)
+                    ok = ok && !(v[i] < v[m]);
+                nth_ok = nth_ok && ok;
+            }
+        }
+    }
+    // 并行版本的阈值较大, 单独用一个较大的区间覆盖任务划分
+    make_sort_input(v, 1 << 20, sort_input::random);
+    w = v;
+    std::sort(w.data(), w.data() + w.size());
+    dhsstl::sort(dhsstl::execution::par.on(pool), v.begin(), v.end());
+    par_ok = par_ok && dhsstl::equal(v.begin(), v.end(), w.begin());
+
+    std::cout << " sort\t\t: " << (sort_ok ? "true" : "false") << std::endl;
+    std::cout << " sort(par)\t: " << (par_ok ? "true" : "false") << std::endl;
+    std::cout << " sort(greater)\t: " << (greater_ok ? "true" : "false") << std::endl;
+    std::cout << " stable_sort\t: " << (stable_ok ? "true" : "false") << std::endl;
+    std::cout << " partial_sort\t: " << (partial_ok ? "true" : "false") << std::endl;
+    std::cout << " nth_element\t: " << (nth_ok ? "true" : "false") << std::endl;
+
+    // 稳定性: 相等的 key 保持原来的下标顺序
+    dhsstl::vector<keyed> s(100000);
+    std::mt19937 gen(7);
+    for(size_t i = 0; i < s.size(); ++i)
+        s[i] = keyed{ static_cast<int>(gen() % 100), i };
+    dhsstl::stable_sort(s.begin(), s.end(), keyed_less());
+    bool stable = true;
+    for(size_t i = 1; i < s.size(); ++i)
+        stable = stable && (s[i - 1].key < s[i].key || (s[i - 1].key == s[i].key && s[i - 1].index < s[i].index));
+    std::cout << " stable_sort keeps order of equal keys : " << (stable ? "true" : "false") << std::endl;
+
+    // inplace_merge: 两段有序区间合并, 相等的 key 前一段在前
+    bool merge_ok = true;
+    for(size_t len1 : { size_t(0), size_t(1), size_t(37), size_t(5000), size_t(60000) }){
+        for(size_t i = 0; i < s.size(); ++i)
+            s[i] = keyed{ static_cast<int>(gen() % 100), i };
+        dhsstl::stable_sort(s.begin(), s.begin() + len1, keyed_less());
+        dhsstl::stable_sort(s.begin() + len1, s.end(), keyed_less());
+        dhsstl::inplace_merge(s.begin(), s.begin() + len1, s.end(), keyed_less());
+        for(size_t i = 1; i < s.size(); ++i)
+            merge_ok = merge_ok && (s[i - 1].key < s[i].key || (s[i - 1].key == s[i].key && s[i - 1].index < s[i].index));
+    }
+    std::cout << " inplace_merge is stable : " << (merge_ok ? "true" : "false") << std::endl;
+
+    // 缓冲区是未初始化空间, 较短的一段移动构造进去: 只能移动的类型也可以排序, 且不会复制元素
+    {
+        auto deref_less = [](const std::unique_ptr<int>& a, const std::unique_ptr<int>& b){ return *a < *b; };
+        dhsstl::vector<std::unique_ptr<int>> u;
+        for(size_t i = 0; i < 10000; ++i)
+            u.push_back(std::unique_ptr<int>(new int(static_cast<int>(gen() % 1000))));
+        dhsstl::stable_sort(u.begin(), u.end(), deref_less);
+        bool ok = u.front() != nullptr;
+        for(size_t i = 1; i < u.size(); ++i)
+            ok = ok && u[i] != nullptr && !(*u[i] < *u[i - 1]);
+        FUN_VALUE(ok);
+        for(size_t i = 0; i < u.size(); ++i)
+            *u[i] = static_cast<int>(gen() % 1000);
+        dhsstl::stable_sort(u.begin(), u.begin() + 3000, deref_less);
+        dhsstl::stable_sort(u.begin() + 3000, u.end(), deref_less);
+        dhsstl::inplace_merge(u.begin(), u.begin() + 3000, u.end(), deref_less);
+        ok = true;
+        for(size_t i = 1; i < u.size(); ++i)
+            ok = ok && u[i] != nullptr && !(*u[i] < *u[i - 1]);
+        FUN_VALUE(ok);
+    }
+    {
+        dhsstl::vector<algo_counted> c;
+        c.reserve(10000);
+        for(size_t i = 0; i < 10000; ++i)
+            c.emplace_back(static_cast<int>(gen() % 1000));
+        algo_counted::copies = 0;
+        dhsstl::stable_sort(c.begin(), c.end());
+        dhsstl::inplace_merge(c.begin(), c.begin() + 4000, c.end());
+        FUN_VALUE(dhsstl::is_sorted(c.begin(), c.end()));
+        FUN_VALUE(algo_counted::copies);
+        FUN_VALUE(algo_counted::alive);
+    }
+    FUN_VALUE(algo_counted::alive);
+
+    // 临时缓冲区: 归还之后复用同一块内存, 嵌套申请时另外分配, 对齐的缓冲区
+    {
+        auto b1 = dhsstl::get_temporary_buffer<uint64_t>(1000);
+        auto b2 = dhsstl::get_temporary_buffer<uint64_t>(1000);
+        FUN_VALUE((b1.first != b2.first));
+        dhsstl::release_temporary_buffer(b2.first);
+        dhsstl::release_temporary_buffer(b1.first);
+        auto b3 = dhsstl::get_temporary_buffer<uint64_t>(500);
+        FUN_VALUE((b3.first == b1.first));
+        auto b4 = dhsstl::get_aligned_temporary_buffer<uint64_t>(100, 256);
+        FUN_VALUE(reinterpret_cast<uintptr_t>(b4.first) % 256);
+        dhsstl::release_temporary_buffer(b4.first);
+        dhsstl::release_temporary_buffer(b3.first);
+        auto b5 = dhsstl::get_aligned_temporary_buffer<uint64_t>(100, 256);
+        FUN_VALUE(reinterpret_cast<uintptr_t>(b5.first) % 256);
+        dhsstl::release_temporary_buffer(b5.first);
+        FUN_VALUE(dhsstl::get_temporary_buffer<uint64_t>(0).second);
+    }
+
+    // 非算术类型走带分支的划分
+    dhsstl::vector<std::string> str;
+    for(int i = 0; i < 1000; ++i)
+        str.push_back(std::to_string(i * 7919 % 1000));
+    dhsstl::sort(str.begin(), str.end());
+    FUN_VALUE(dhsstl::is_sorted(str.begin(), str.end()));
+    FUN_VALUE(str.front());
+    FUN_VALUE(str.back());
+    int a[] = { 5, 3, 1, 4, 2 };
+    FUN_VALUE(dhsstl::is_sorted_until(a, a + 5) - a);
+
+    // radix_sort: 无符号 / 有符号整数, 浮点数, 以及按 key 排序的记录
+    bool radix_ok = true, radix_par_ok = true;
+    dhsstl::vector<uint64_t> u, ue;
+    for(auto k : kinds){
+        for(auto m : { size_t(10), size_t(1000), size_t(100000), size_t(1) << 20 }){
+            make_sort_input(ue, m, k);
+            std::sort(ue.data(), ue.data() + m);
+            make_sort_input(u, m, k);
+            dhsstl::radix_sort(u.begin(), u.end());
+            radix_ok = radix_ok && dhsstl::equal(u.begin(), u.end(), ue.begin());
+            make_sort_input(u, m, k);
+            dhsstl::radix_sort(dhsstl::execution::par.on(pool), u.begin(), u.end());
+            radix_par_ok = radix_par_ok && dhsstl::equal(u.begin(), u.end(), ue.begin());
+        }
+    }
+    std::cout << " radix_sort(uint64_t)\t: " << (radix_ok ? "true" : "false") << std::endl;
+    std::cout << " radix_sort(par)\t: " << (radix_par_ok ? "true" : "false") << std::endl;
+
+    dhsstl::vector<int> si(200000);
+    for(size_t i = 0; i < si.size(); ++i)
+        si[i] = static_cast<int>(gen());
+    dhsstl::radix_sort(si.begin(), si.end());
+    FUN_VALUE(dhsstl::is_sorted(si.begin(), si.end()));
+
+    dhsstl::vector<double> d(200000);
+    for(size_t i = 0; i < d.size(); ++i)
+        d[i] = (static_cast<double>(gen()) - 2147483648.0) / 1024.0;
+    d[0] = -0.0;
+    d[1] = 0.0;
+    dhsstl::radix_sort(dhsstl::execution::par.on(pool), d.begin(), d.end());
+    FUN_VALUE(dhsstl::is_sorted(d.begin(), d.end()));
+
+    // 按 key 排序是稳定的
+    dhsstl::vector<std::pair<uint32_t, uint32_t>> rec(300000);
+    for(size_t i = 0; i < rec.size(); ++i)
+        rec[i] = std::make_pair(static_cast<uint32_t>(gen() % 1000), static_cast<uint32_t>(i));
+    dhsstl::radix_sort(rec.begin(), rec.end(), [](const std::pair<uint32_t, uint32_t>& p){ return p.first; });
+    bool rec_stable = true;
+    for(size_t i = 1; i < rec.size(); ++i)
+        rec_stable = rec_stable && (rec[i - 1].first < rec[i].first ||
+                                    (rec[i - 1].first == rec[i].first && rec[i - 1].second < rec[i].second));
+    std::cout << " radix_sort by key is stable : " << (rec_stable ? "true" : "false") << std::endl;
+
+    // 不能平凡复制的元素
+    dhsstl::vector<std::pair<int, std::string>> named;
+    for(int i = 0; i < 1000; ++i)
+        named.push_back(std::make_pair(i * 7919 % 1000 - 500, std::to_string(i)));
+    dhsstl::radix_sort(named.begin(), named.end(), [](const std::pair<int, std::string>& p){ return p.first; });
+    FUN_VALUE(named.front().first);
+    FUN_VALUE(named.back().first);
+    std::cout << "[--------------------------- ------ END API test ------- -------------------------]" << std::endl;
+}
+
+// 对每种输入计时 rounds 次, 每次都重新复制输入
+template <typename F>
+double sort_time_ms(const dhsstl::vector<uint64_t>& input, dhsstl::vector<uint64_t>& work, int rounds, F&& f){
+    double total = 0;
+    for(int i = 0; i < rounds; ++i){
+        work = input;
+        auto start = algo_clock::now();
+        f(work.data(), work.data() + work.size());
+        total += std::chrono::duration<double, std::milli>(algo_clock::now() - start).count();
+    }
+    return total / rounds;
+}
+
+// 对大小为 n 的输入反复调用 f, 一共处理 total 个元素, 返回每个元素的平均耗时(ns)
+template <typename F>
+double stable_merge_time_ns(const dhsstl::vector<uint64_t>& input, size_t total, int rounds, F&& f){
+    dhsstl::vector<uint64_t> work(input.size());
+    const size_t reps = dhsstl::max<size_t>(total / input.size(), 1);
+    double best = 1e300;
+    for(int r = 0; r < rounds; ++r){
+        auto start = algo_clock::now();
+        for(size_t i = 0; i < reps; ++i){
+            dhsstl::copy(input.begin(), input.end(), work.begin());
+            f(work.data(), work.data() + work.size());
+        }
+        best = dhsstl::min(best, std::chrono::duration<double, std::nano>(algo_clock::now() - start).count());
+    }
+    return best / (static_cast<double>(reps) * input.size());
+}
+
+//! @brief 反复对小数组做 inplace_merge / stable_sort, 比较每次调用 malloc 的临时缓冲区与线程的 scratch arena
+//! arena 关闭时(set_temporary_buffer_limit(0)) 每次调用都 malloc / free, 超过 mmap 阈值的缓冲区还要缺页
+void stable_merge_perf(size_t total = 1 << 24, int rounds = 3){
+    std::cout << "[=================================================================================]" << std::endl;
+    std::cout << "[-------------------- Run performance test : stable merge ------------------------]" << std::endl;
+    std::cout << " " << total << " uint64_t in total per size, min of " << rounds << " rounds, ns / element" << std::endl;
+    std::cout << " n		 merge: std	 malloc	 arena		 stable_sort: std	 malloc	 arena" << std::endl;
+    std::mt19937_64 gen(11);
+    for(size_t n : { size_t(256), size_t(4096), size_t(65536), size_t(1) << 20 }){
+        dhsstl::vector<uint64_t> merge_in(n), sort_in(n);
+        for(size_t i = 0; i < n; ++i)
+            merge_in[i] = sort_in[i] = gen() % n;
+        std::sort(merge_in.data(), merge_in.data() + n / 2);
+        std::sort(merge_in.data() + n / 2, merge_in.data() + n);
+
+        auto merge_std = [](uint64_t* f, uint64_t* l){ std::inplace_merge(f, f + (l - f) / 2, l); };
+        auto merge_dhs = [](uint64_t* f, uint64_t* l){ dhsstl::inplace_merge(f, f + (l - f) / 2, l); };
+        auto sort_std  = [](uint64_t* f, uint64_t* l){ std::stable_sort(f, l); };
+        auto sort_dhs  = [](uint64_t* f, uint64_t* l){ dhsstl::stable_sort(f, l); };
+
+        std::cout << " " << n << "\t\t " << stable_merge_time_ns(merge_in, total, rounds, merge_std);
+        dhsstl::set_temporary_buffer_limit(0);
+        std::cout << "\t " << stable_merge_time_ns(merge_in, total, rounds, merge_dhs);
+        dhsstl::set_temporary_buffer_limit(DHSSTL_SCRATCH_ARENA_LIMIT);
+        std::cout << "\t " << stable_merge_time_ns(merge_in, total, rounds, merge_dhs);
+        std::cout << "\t\t " << stable_merge_time_ns(sort_in, total, rounds, sort_std);
+        dhsstl::set_temporary_buffer_limit(0);
+        std::cout << "\t " << stable_merge_time_ns(sort_in, total, rounds, sort_dhs);
+        dhsstl::set_temporary_buffer_limit(DHSSTL_SCRATCH_ARENA_LIMIT);
+        std::cout << "\t " << stable_merge_time_ns(sort_in, total, rounds, sort_dhs) << std::endl;
+    }
+
+    // 只测量申请和释放 n / 2 个元素的缓冲区, 即 inplace_merge 每次调用的额外开销
+    std::cout << " get + release temporary buffer, ns / call :\t malloc\t arena" << std::endl;
+    for(size_t n : { size_t(256), size_t(4096), size_t(65536), size_t(1) << 20 }){
+        auto buffer_ns = [n](size_t calls){
+            auto start = algo_clock::now();
+            for(size_t i = 0; i < calls; ++i){
+                auto buf = dhsstl::get_temporary_buffer<uint64_t>(static_cast<ptrdiff_t>(n / 2));
+                // 写一个元素, 新映射的页至少要缺页一次
+                buf.first[i % buf.second] = i;
+                dhsstl::release_temporary_buffer(buf.first);
+            }
+            return std::chrono::duration<double, std::nano>(algo_clock::now() - start).count() / calls;
+        };
+        const size_t calls = 100000;
+        dhsstl::set_temporary_buffer_limit(0);
+        std::cout << " " << n << "\t\t\t\t\t " << buffer_ns(calls);
+        dhsstl::set_temporary_buffer_limit(DHSSTL_SCRATCH_ARENA_LIMIT);
+        std::cout << "\t " << buffer_ns(calls) << std::endl;
+    }
+    std::cout << "[--------------------------- ------ END perf test ------ -------------------------]" << std::endl;
+}
+
+//! @brief 与 std::sort / std::stable_sort 比较, 输入为 n 个 uint64_t
+void sort_perf(size_t n = 10000000, int rounds = 3){
+    std::cout << "[=================================================================================]" << std::endl;
+    std::cout << "[--------------------- Run performance test : sort algorithms --------------------]" << std::endl;
+    const sort_input kinds[] = { sort_input::random, sort_input::sorted, sort_input::reversed,
+                                 sort_input::few_unique, sort_input::organ_pipe };
+    std::cout << " hardware threads : " << std::thread::hardware_concurrency()
+              << ", elements : " << n << ", time in ms" << std::endl;
+    const auto flags = std::cout.flags();
+    const auto prec = std::cout.precision();
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << " input\t\t std::sort\t sort\t sort(par)\t std::stable\t stable_sort" << std::endl;
+    dhsstl::vector<uint64_t> input, work;
+    for(auto k : kinds){
+        make_sort_input(input, n, k);
+        std::cout << " " << std::left << std::setw(12) << sort_input_name(k) << std::right << "\t "
+            << sort_time_ms(input, work, rounds, [](uint64_t* f, uint64_t* l){ std::sort(f, l); }) << "\t "
+            << sort_time_ms(input, work, rounds, [](uint64_t* f, uint64_t* l){ dhsstl::sort(f, l); }) << "\t "
+            << sort_time_ms(input, work, rounds, [](uint64_t* f, uint64_t* l){
+                   dhsstl::sort(dhsstl::execution::par, f, l); }) << "\t\t "
+            << sort_time_ms(input, work, rounds, [](uint64_t* f, uint64_t* l){ std::stable_sort(f, l); }) << "\t "
+            << sort_time_ms(input, work, rounds, [](uint64_t* f, uint64_t* l){ dhsstl::stable_sort(f, l); })
+            << std::endl;
+    }
+    std::cout.flags(flags);
+    std::cout.precision(prec);
+    std::cout << "[--------------------------- ------ END perf test ------ -------------------------]" << std::endl;
+}
+
+//! @brief radix_sort 与比较排序的比较, 元素个数从 1M 开始每次乘以 10, 直到 max_n
+//! 注: max_n 为 1e9 时 uint64_t 的输入, 副本和缓冲区共需要约 24GB 内存
+void radix_sort_perf(size_t max_n = 100000000, int rounds = 3){
+    std::cout << "[=================================================================================]" << std::endl;
+    std::cout << "[---------------------- Run performance test : radix sort -----------------------]" << std::endl;
+    std::cout << " hardware threads : " << std::thread::hardware_concurrency() << ", time in ms" << std::endl;
+    const auto flags = std::cout.flags();
+    const auto prec = std::cout.precision();
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << " uint64_t\t std::sort\t sort\t\t radix\t\t radix(par)" << std::endl;
+    dhsstl::vector<uint64_t> input, work;
+    for(size_t n = 1000000; n <= max_n; n *= 10){
+        make_sort_input(input, n, sort_input::random);
+        std::cout << " " << n << "\t "
+            << sort_time_ms(input, work, rounds, [](uint64_t* f, uint64_t* l){ std::sort(f, l); }) << "\t "
+            << sort_time_ms(input, work, rounds, [](uint64_t* f, uint64_t* l){ dhsstl::sort(f, l); }) << "\t "
+            << sort_time_ms(input, work, rounds, [](uint64_t* f, uint64_t* l){ dhsstl::radix_sort(f, l); }) << "\t "
+            << sort_time_ms(input, work, rounds, [](uint64_t* f, uint64_t* l){
+                   dhsstl::radix_sort(dhsstl::execution::par, f, l); }) << std::endl;
+    }
+
+    // pair<uint32_t, uint32_t> 按 first 排序: radix_sort 只有 4 趟(32 位 key, 8 位数位时)或 3 趟
+    typedef std::pair<uint32_t, uint32_t> record;
+    const size_t rn = dhsstl::min<size_t>(max_n, 10000000);
+    dhsstl::vector<record> rin(rn), rwork;
+    std::mt19937 gen(11);
+    for(size_t i = 0; i < rn; ++i)
+        rin[i] = record(static_cast<uint32_t>(gen()), static_cast<uint32_t>(i));
+    auto rtime = [&](auto&& f){
+        double total = 0;
+        for(int r = 0; r < rounds; ++r){
+            rwork = rin;
+            auto start = algo_clock::now();
+            f(rwork.data(), rwork.data() + rn);
+            total += std::chrono::duration<double, std::milli>(algo_clock::now() - start).count();
+        }
+        return total / rounds;
+    };
+    auto key = [](const record& p){ return p.first; };
+    auto less = [](const record& a, const record& b){ return a.first < b.first; };
+    std::cout << " pair<uint32_t, uint32_t> x " << rn << " by first" << std::endl;
+    std::cout << "  std::stable_sort\t: " << rtime([&](record* f, record* l){ std::stable_sort(f, l, less); }) << std::endl;
+    std::cout << "  dhsstl::stable_sort\t: " << rtime([&](record* f, record* l){ dhsstl::stable_sort(f, l, less); }) << std::endl;
+    std::cout << "  radix_sort\t\t: " << rtime([&](record* f, record* l){ dhsstl::radix_sort(f, l, key); }) << std::endl;
+    std::cout << "  radix_sort(par)\t: " << rtime([&](record* f, record* l){
+        dhsstl::radix_sort(dhsstl::execution::par, f, l, key); }) << std::endl;
+
+    // double: 符号位的映射不增加趟数
+    dhsstl::vector<double> din(rn), dwork;
+    for(size_t i = 0; i < rn; ++i)
+        din[i] = (static_cast<double>(gen()) - 2147483648.0) * 1e-3;
+    auto dtime = [&](auto&& f){
+        double total = 0;
+        for(int r = 0; r < rounds; ++r){
+            dwork = din;
+            auto start = algo_clock::now();
+            f(dwork.data(), dwork.data() + rn);
+            total += std::chrono::duration<double, std::milli>(algo_clock::now() - start).count();
+        }
+        return total / rounds;
+    };
+    std::cout << " double x " << rn << std::endl;
+    std::cout << "  std::sort\t\t: " << dtime([](double* f, double* l){ std::sort(f, l); }) << std::endl;
+    std::cout << "  radix_sort\t\t: " << dtime([](double* f, double* l){ dhsstl::radix_sort(f, l); }) << std::endl;
+    std::cout.flags(flags);
+    std::cout.precision(prec);
+    std::cout << "[--------------------------- ------ END perf test ------ -------------------------]" << std::endl;
+}
+
+} // namespace test
+} // namespace dhsstl
+#endif
@@ -1,10 +1,23 @@
 #ifndef DHSTINYSTL_TEST_ALLOC_H_
 #define DHSTINYSTL_TEST_ALLOC_H_
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <ctime>
 #include <list>
 #include <iostream>
+#include <thread>
 #include "allocator.h"
+#include "aligned_allocator.h"
+#include "huge_page_allocator.h"
+#include "map.h"
+#include "object_pool.h"
+#include "set.h"
+#include "thread_pool.h"
+#include "tracking_allocator.h"
+#include "vector.h"
+#include "test.h"
 
 namespace dhsstl {
 namespace test {
@@ -34,6 +47,389 @@ void test_alloc(){
               << end - start << std::endl;
 }
 
+// 对 bytes 字节的 vector<uint64_t> 做一次顺序扫描和一次随机访问扫描
+// 注: TLB miss 可以用 perf stat -e dTLB-load-misses,dTLB-loads 观察
+template <typename Alloc>
+void scan_run(const char* name, size_t bytes){
+    const size_t n = bytes / sizeof(uint64_t);
+    clock_t start = clock();
+    dhsstl::vector<uint64_t, Alloc> v(n, dhsstl::default_init);
+    for(size_t i = 0; i < n; ++i)
+        v[i] = i;
+    const clock_t fill = clock() - start;
+
+    start = clock();
+    uint64_t sum = 0;
+    for(size_t i = 0; i < n; ++i)
+        sum += v[i];
+    const clock_t seq = clock() - start;
+
+    // 随机访问 n / 8 次, 每次几乎都落在不同的页上
+    start = clock();
+    uint64_t x = 88172645463325252ull;
+    for(size_t i = 0; i < n / 8; ++i){
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        sum += v[x % n];
+    }
+    const clock_t rnd = clock() - start;
+    std::cout << " " << name << " fill: " << fill << ", sequential scan: " << seq
+              << ", random scan: " << rnd << " (" << sum % 10 << ")" << std::endl;
+}
+
+// 对齐要求为 64 的元素
+struct alignas(64) huge_page_aligned
+{
+    uint64_t value;
+};
+
+//! @brief huge_page_allocator 作为 vector 的分配器: 复制赋值后容量不变, 释放和 reallocate 使用原来的字节数
+void huge_page_vector_test(){
+    std::cout << "[=================================================================================]" << std::endl;
+    std::cout << "[---------------------- Run API test : huge_page_allocator -----------------------]" << std::endl;
+    // Threshold 为 4KB, 512 个 uint64_t 以上的缓冲区用 mmap 映射
+    typedef dhsstl::huge_page_allocator<uint64_t, 4096> alloc_type;
+    {
+        dhsstl::vector<uint64_t, alloc_type> src(100, 7);
+        dhsstl::vector<uint64_t, alloc_type> dst(10, 1);
+        dst.reserve(1024);
+        const uint64_t* data = dst.data();
+        // size() < rhs.size() <= capacity(): 原地复制, 容量保持 1024, 析构时按 mmap 的块释放
+        dst = src;
+        FUN_VALUE(dst.size());
+        FUN_VALUE(dst.capacity());
+        FUN_VALUE((dst.data() == data));
+        FUN_VALUE((dst == src));
+        // 扩容时以完整的旧容量调用 reallocate
+        for(uint64_t i = 0; i < 2000; ++i)
+            dst.push_back(i);
+        FUN_VALUE(dst.size());
+        FUN_VALUE(dst[99]);
+        FUN_VALUE(dst[2099]);
+    }
+    {
+        // 复制赋值后直接析构
+        dhsstl::vector<uint64_t, alloc_type> src(100, 7);
+        dhsstl::vector<uint64_t, alloc_type> dst(10, 1);
+        dst.reserve(1024);
+        dst = src;
+        FUN_VALUE(dst.capacity());
+    }
+    {
+        // 低于 Threshold 的小块内存也要满足 alignof(T)
+        dhsstl::vector<huge_page_aligned, dhsstl::huge_page_allocator<huge_page_aligned>> v(3);
+        for(uint64_t i = 0; i < 40; ++i)
+            v.push_back(huge_page_aligned{ i });
+        FUN_VALUE((reinterpret_cast<uintptr_t>(v.data()) % 64 == 0));
+        FUN_VALUE(v[42].value);
+    }
+#if defined(__linux__) && defined(MAP_FIXED_NOREPLACE)
+    {
+        // 紧跟在内存块之后的地址被占用, mremap 不能原地扩展, 移动之后仍然按 2MB 对齐
+        typedef dhsstl::huge_page_allocator<uint64_t> hp;
+        const size_t n = dhsstl::huge_page_size / sizeof(uint64_t);
+        uint64_t* p = hp::allocate(n);
+        for(size_t i = 0; i < n; ++i)
+            p[i] = i;
+        void* blocker = ::mmap(p + n, 4096, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+        uint64_t* q = hp::reallocate(p, n, 2 * n);
+        FUN_VALUE((q != p));
+        FUN_VALUE((reinterpret_cast<uintptr_t>(q) % dhsstl::huge_page_size == 0));
+        FUN_VALUE((q[0] == 0 && q[n - 1] == n - 1));
+        q[2 * n - 1] = 1;
+        if(blocker != MAP_FAILED)
+            ::munmap(blocker, 4096);
+        // 之后的地址空闲时原地扩展, 地址不变
+        uint64_t* r = hp::reallocate(q, 2 * n, 3 * n);
+        FUN_VALUE((reinterpret_cast<uintptr_t>(r) % dhsstl::huge_page_size == 0));
+        FUN_VALUE((r[n - 1] == n - 1));
+        hp::deallocate(r, 3 * n);
+    }
+#endif
+    std::cout << "[--------------------------- ------ END API test ------- -------------------------]" << std::endl;
+}
+
+//! @brief 比较普通分配器, 按 cache line 对齐的分配器以及大页分配器在大块缓冲区上的扫描速度
+void huge_page_scan_perf(size_t bytes = static_cast<size_t>(4) << 30){
+    std::cout << "[=================================================================================]" << std::endl;
+    std::cout << "[----------------------- Run performance test : huge page scan --------------------]" << std::endl;
+    scan_run<dhsstl::allocator<uint64_t>>("allocator              ", bytes);
+    scan_run<dhsstl::aligned_allocator<uint64_t, 64>>("aligned_allocator<64>  ", bytes);
+    scan_run<dhsstl::huge_page_allocator<uint64_t>>("huge_page_allocator    ", bytes);
+    std::cout << "[--------------------------- ------ END perf test ------ -------------------------]" << std::endl;
+}
+
+// 64 字节的请求对象, 记录存活的个数
+struct pool_request
+{
+    static int alive;
+    uint64_t   id;
+    uint64_t   payload[7];
+
+    explicit pool_request(uint64_t i) : id(i), payload() { ++alive; }
+    ~pool_request() { --alive; }
+};
+int pool_request::alive = 0;
+
+// 只在 default_thread_pool 的任务中使用, depot 晚于线程池构造
+struct pool_worker_item
+{
+    uint64_t value;
+};
+
+//! @brief object_pool 与 pool_allocator 的功能测试
+void object_pool_test(){
+    std::cout << "[=================================================================================]" << std::endl;
+    std::cout << "[------------------------- Run API test : object_pool ----------------------------]" << std::endl;
+    typedef dhsstl::object_pool<pool_request> pool;
+    {
+        dhsstl::vector<pool_request*> v;
+        for(uint64_t i = 0; i < 1000; ++i)
+            v.push_back(pool::construct(i));
+        FUN_VALUE(pool_request::alive);
+        FUN_VALUE(v[999]->id);
+        const size_t chunks = pool::chunk_count();
+        FUN_VALUE(chunks);
+        for(auto p : v)
+            pool::destroy(p);
+        FUN_VALUE(pool_request::alive);
+        // 释放的节点被再次使用, 不再申请新的 chunk
+        v.clear();
+        for(uint64_t i = 0; i < 1000; ++i)
+            v.push_back(pool::construct(i));
+        FUN_VALUE((pool::chunk_count() == chunks));
+        // 另一个线程释放这些对象, 节点经由 depot 回到本线程
+        std::thread t([&v]{
+            for(auto p : v)
+                pool::destroy(p);
+        });
+        t.join();
+        FUN_VALUE(pool_request::alive);
+        for(uint64_t i = 0; i < 1000; ++i)
+            v[i] = pool::construct(i);
+        FUN_VALUE((pool::chunk_count() == chunks));
+        for(auto p : v)
+            pool::destroy(p);
+    }
+    {
+        dhsstl::map<int, int, dhsstl::less<int>, dhsstl::pool_allocator<dhsstl::pair<const int, int>>> m;
+        for(int i = 0; i < 10000; ++i)
+            m[i * 7919 % 10000] = i;
+        FUN_VALUE(m.size());
+        FUN_VALUE(m.begin()->first);
+        FUN_VALUE(m.rbegin()->first);
+        for(int i = 0; i < 10000; i += 2)
+            m.erase(i);
+        FUN_VALUE(m.size());
+        auto copy = m;
+        FUN_VALUE((copy == m));
+        dhsstl::multiset<int, dhsstl::less<int>, dhsstl::pool_allocator<int>> ms;
+        for(int i = 0; i < 100; ++i)
+            ms.insert(i % 10);
+        FUN_VALUE(ms.count(3));
+    }
+    {
+        // default_thread_pool 先于 depot 构造, 它的工作线程在静态析构期间才退出,
+        // 退出时本地缓存的节点仍要交还给 depot, 程序结束时在 ASan 下检查
+        typedef dhsstl::object_pool<pool_worker_item> worker_pool;
+        dhsstl::thread_pool& tp = dhsstl::default_thread_pool();
+        // 每个任务都等到所有任务开始后才结束, 保证每个工作线程(以及调用 sync 的线程)各执行一个
+        const size_t n = tp.size() + 1;
+        std::atomic<size_t> arrived(0);
+        dhsstl::task_group g(tp);
+        for(size_t i = 0; i < n; ++i){
+            g.spawn([i, n, &arrived]{
+                pool_worker_item* p = worker_pool::construct(pool_worker_item{ i });
+                worker_pool::destroy(p);
+                arrived.fetch_add(1);
+                while(arrived.load() != n)
+                    std::this_thread::yield();
+            });
+        }
+        g.sync();
+        FUN_VALUE((worker_pool::chunk_count() > 0));
+    }
+    std::cout << "[--------------------------- ------ END API test ------- -------------------------]" << std::endl;
+}
+
+typedef std::chrono::steady_clock pool_clock;
+
+// threads 个线程各自保持 live 个存活的对象, 每次随机释放一个再分配一个, 共 ops 次, 返回总耗时
+template <typename Make, typename Free>
+double pool_churn_run(size_t threads, size_t ops, size_t live, Make make, Free release){
+    auto work = [=]{
+        dhsstl::vector<pool_request*> v(live);
+        for(size_t i = 0; i < live; ++i)
+            v[i] = make(i);
+        uint64_t x = 88172645463325252ull + threads;
+        for(size_t i = 0; i < ops; ++i){
+            x ^= x << 13;
+            x ^= x >> 7;
+            x ^= x << 17;
+            pool_request*& slot = v[x % live];
+            release(slot);
+            slot = make(i);
+        }
+        for(auto p : v)
+            release(p);
+    };
+    auto start = pool_clock::now();
+    if(threads <= 1){
+        work();
+    }else{
+        dhsstl::vector<std::thread> ts;
+        for(size_t t = 0; t < threads; ++t)
+            ts.push_back(std::thread(work));
+        for(auto& t : ts)
+            t.join();
+    }
+    return std::chrono::duration<double, std::milli>(pool_clock::now() - start).count();
+}
+
+// map 的插入 / 删除交替进行, 每次操作都分配或释放一个节点
+template <typename Map>
+double pool_map_run(size_t ops, size_t live){
+    auto start = pool_clock::now();
+    Map m;
+    uint64_t x = 88172645463325252ull;
+    for(size_t i = 0; i < ops; ++i){
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        const uint64_t k = x % (2 * live);
+        auto it = m.find(k);
+        if(it == m.end())
+            m.insert(dhsstl::make_pair(k, i));
+        else
+            m.erase(it);
+    }
+    return std::chrono::duration<double, std::milli>(pool_clock::now() - start).count();
+}
+
+//! @brief 固定大小对象的分配与释放: new / delete 与 object_pool, 以及使用 pool_allocator 的 map
+void object_pool_perf(size_t ops = 20000000, size_t max_threads = 0, size_t live = 4096){
+    std::cout << "[=================================================================================]" << std::endl;
+    std::cout << "[--------------------- Run performance test : object_pool ------------------------]" << std::endl;
+    if(max_threads == 0)
+        max_threads = dhsstl::max<size_t>(std::thread::hardware_concurrency(), 1);
+    std::cout << " " << ops << " free + allocate per thread, " << live << " live objects of "
+              << sizeof(pool_request) << " bytes, time in ms, threads :";
+    for(size_t t = 1; t <= max_threads; t *= 2)
+        std::cout << "\t " << t;
+    std::cout << std::endl;
+    std::cout << " new / delete        ";
+    for(size_t t = 1; t <= max_threads; t *= 2)
+        std::cout << "\t " << pool_churn_run(t, ops, live,
+            [](size_t i){ return new pool_request(i); }, [](pool_request* p){ delete p; });
+    std::cout << std::endl;
+    std::cout << " object_pool         ";
+    for(size_t t = 1; t <= max_threads; t *= 2)
+        std::cout << "\t " << pool_churn_run(t, ops, live,
+            [](size_t i){ return dhsstl::object_pool<pool_request>::construct(i); },
+            [](pool_request* p){ dhsstl::object_pool<pool_request>::destroy(p); });
+    std::cout << std::endl;
+
+    typedef dhsstl::pair<const uint64_t, uint64_t> value_type;
+    std::cout << " map insert / erase, " << ops / 4 << " ops, " << live << " keys" << std::endl;
+    std::cout << "  allocator         \t "
+              << pool_map_run<dhsstl::map<uint64_t, uint64_t>>(ops / 4, live) << std::endl;
+    std::cout << "  pool_allocator    \t "
+              << pool_map_run<dhsstl::map<uint64_t, uint64_t, dhsstl::less<uint64_t>,
+                                          dhsstl::pool_allocator<value_type>>>(ops / 4, live) << std::endl;
+    std::cout << "[--------------------------- ------ END perf test ------ -------------------------]" << std::endl;
+}
+
+struct track_vector_tag { static const char* name() { return "vector<int>"; } };
+struct track_set_tag    { static const char* name() { return "set<int>"; } };
+struct track_map_tag    { static const char* name() { return "map<int, int>"; } };
+
+//! @brief tracking_allocator 的功能测试, 检查各个容器的分配次数和持有的字节数
+void tracking_allocator_test(){
+    std::cout << "[=================================================================================]" << std::endl;
+    std::cout << "[---------------------- Run API test : tracking_allocator ------------------------]" << std::endl;
+    FUN_VALUE(DHSSTL_ALLOC_TRACKING);
+    {
+        typedef dhsstl::alloc_stats<track_vector_tag> stats;
+        {
+            // 默认构造时预留 16 个元素, trivially copyable 的元素扩容时走 reallocate
+            dhsstl::vector<int, dhsstl::tracking_allocator<int, track_vector_tag>> v;
+            FUN_VALUE((stats::snapshot().allocations == 1));
+            v.reserve(100);
+            FUN_VALUE((stats::snapshot().reallocations == 1));
+            FUN_VALUE((stats::snapshot().live_bytes == 100 * sizeof(int)));
+            for(int i = 0; i < 100; ++i)
+                v.push_back(i);
+            // 容量足够时不再分配
+            FUN_VALUE((stats::snapshot().allocations + stats::snapshot().reallocations == 2));
+            v.push_back(100);
+            FUN_VALUE((stats::snapshot().live_bytes == v.capacity() * sizeof(int)));
+            FUN_VALUE(stats::snapshot().live_blocks());
+        }
+        FUN_VALUE(stats::snapshot().live_bytes);
+        FUN_VALUE(stats::snapshot().live_blocks());
+        FUN_VALUE((stats::snapshot().peak_bytes >= 101 * sizeof(int)));
+        {
+            // 复制赋值到容量足够, 元素较少的 vector, 析构时按完整的容量释放
+            dhsstl::vector<int, dhsstl::tracking_allocator<int, track_vector_tag>> src(30, 1);
+            dhsstl::vector<int, dhsstl::tracking_allocator<int, track_vector_tag>> dst(5, 2);
+            dst.reserve(64);
+            dst = src;
+            FUN_VALUE(dst.capacity());
+            FUN_VALUE((stats::snapshot().live_bytes == (src.capacity() + dst.capacity()) * sizeof(int)));
+        }
+        FUN_VALUE(stats::snapshot().live_bytes);
+        FUN_VALUE(stats::snapshot().live_blocks());
+    }
+    {
+        typedef dhsstl::alloc_stats<track_set_tag> stats;
+        {
+            dhsstl::set<int, dhsstl::less<int>, dhsstl::tracking_allocator<int, track_set_tag>> s;
+            const size_t empty = stats::snapshot().allocations;
+            for(int i = 0; i < 1000; ++i)
+                s.insert(i % 500);
+            // insert 先创建节点再查找位置, 重复的元素也会分配并释放一次节点
+            FUN_VALUE(stats::snapshot().allocations - empty);
+            s.erase(0);
+            FUN_VALUE(stats::snapshot().deallocations);
+            // 除了头结点之外每个元素一个节点, 所有节点大小相同, 落在直方图的同一组
+            const auto snap = stats::snapshot();
+            size_t groups = 0;
+            for(auto h : snap.histogram)
+                groups += h != 0;
+            FUN_VALUE(snap.live_blocks());
+            FUN_VALUE((groups <= 2));
+        }
+        FUN_VALUE(stats::snapshot().live_bytes);
+    }
+    {
+        typedef dhsstl::alloc_stats<track_map_tag> stats;
+        stats::reset();
+        size_t hooked = 0;
+        static size_t* counter = nullptr;
+        counter = &hooked;
+        auto old = dhsstl::set_alloc_hook([](const char*, void*, size_t, bool allocate){
+            if(allocate)
+                ++*counter;
+        });
+        {
+            dhsstl::map<int, int, dhsstl::less<int>,
+                        dhsstl::tracking_allocator<dhsstl::pair<const int, int>, track_map_tag>> m;
+            for(int i = 0; i < 100; ++i)
+                m[i] = i;
+            auto copy = m;
+            FUN_VALUE((copy == m));
+        }
+        dhsstl::set_alloc_hook(old);
+        FUN_VALUE((hooked == stats::snapshot().allocations));
+        FUN_VALUE(stats::snapshot().allocations);
+        FUN_VALUE((stats::snapshot().allocations == stats::snapshot().deallocations));
+    }
+    dhsstl::dump_alloc_stats_json(std::cout);
+    dhsstl::dump_alloc_stats_csv(std::cout);
+    std::cout << "[--------------------------- ------ END API test ------- -------------------------]" << std::endl;
+}
+
 } // namespace test
 } // namespace dhsstl
 #endif
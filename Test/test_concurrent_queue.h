@@ -0,0 +1,355 @@
+#ifndef DHSTINYSTL_TEST_CONCURRENT_QUEUE_H_
+#define DHSTINYSTL_TEST_CONCURRENT_QUEUE_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+#include "concurrent_queue.h"
+#include "queue.h"
+#include "vector.h"
+#include "test.h"
+
+namespace dhsstl {
+namespace test {
+
+// 多线程的测试用墙上时间, clock() 统计的是所有线程的 CPU 时间
+typedef std::chrono::steady_clock cq_clock;
+
+inline double cq_elapsed_ms(cq_clock::time_point start){
+    return std::chrono::duration<double, std::milli>(cq_clock::now() - start).count();
+}
+
+// 用互斥量保护的 dhsstl::queue, 作为对比的基准
+template <typename T>
+class locked_queue {
+    std::mutex mtx_;
+    dhsstl::queue<T> q_;
+public:
+    bool try_push(const T& value){
+        std::lock_guard<std::mutex> lk(mtx_);
+        q_.push(value);
+        return true;
+    }
+    bool try_pop(T& value){
+        std::lock_guard<std::mutex> lk(mtx_);
+        if(q_.empty())
+            return false;
+        value = q_.front();
+        q_.pop();
+        return true;
+    }
+};
+
+//! @brief 功能测试: 单线程的边界情况, 以及多线程下元素不丢失, 不重复
+void concurrent_queue_test(){
+    std::cout << "[=================================================================================]" << std::endl;
+    std::cout << "[------------------------- Run API test : concurrent queue ------------------------]" << std::endl;
+    {
+        dhsstl::spsc_queue<int> q(5);
+        FUN_VALUE(q.capacity());
+        int a[10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+        FUN_VALUE(q.push_n(a, 10));
+        FUN_VALUE(q.try_push(10));
+        FUN_VALUE(*q.front());
+        int b[10] = {0};
+        FUN_VALUE(q.pop_n(b, 3));
+        FUN_VALUE(q.push_n(a + 8, 2));
+        FUN_VALUE(q.pop_n(b + 3, 10));
+        std::cout << " b :";
+        for(int i = 0; i < 7; ++i)
+            std::cout << " " << b[i];
+        std::cout << std::endl;
+        FUN_VALUE(q.empty());
+    }
+    {
+        dhsstl::mpmc_queue<std::string> q(3);
+        FUN_VALUE(q.capacity());
+        std::string s[5] = {"a", "b", "c", "d", "e"};
+        FUN_VALUE(q.push_n(s, 5));
+        FUN_VALUE(q.try_push("x"));
+        std::string out;
+        FUN_VALUE(q.try_pop(out));
+        FUN_VALUE(out);
+        FUN_VALUE(q.try_push(s[4]));
+        std::string r[4];
+        FUN_VALUE(q.pop_n(r, 4));
+        std::cout << " r : " << r[0] << " " << r[1] << " " << r[2] << " " << r[3] << std::endl;
+        FUN_VALUE(q.empty());
+    }
+    {
+        // 一个生产者一个消费者, 消费者检查顺序
+        const uint64_t n = 1000000;
+        dhsstl::spsc_queue<uint64_t> q(1024);
+        bool in_order = true;
+        std::thread consumer([&]{
+            uint64_t expect = 0, buf[32];
+            while(expect < n){
+                const size_t k = q.pop_n(buf, 32);
+                for(size_t i = 0; i < k; ++i)
+                    in_order = in_order && buf[i] == expect++;
+                if(k == 0)
+                    std::this_thread::yield();
+            }
+        });
+        for(uint64_t i = 0; i < n; ++i)
+            q.push(i);
+        consumer.join();
+        std::cout << " spsc_queue in order : " << (in_order ? "true" : "false") << std::endl;
+    }
+    {
+        // 多个生产者多个消费者, 检查总和与个数
+        const int producers = 4, consumers = 4;
+        const uint64_t per = 200000;
+        dhsstl::mpmc_queue<uint64_t> q(256);
+        std::atomic<uint64_t> sum(0), count(0);
+        dhsstl::vector<std::thread> ts;
+        for(int p = 0; p < producers; ++p){
+            ts.emplace_back([&, p]{
+                uint64_t buf[16];
+                for(uint64_t i = 0; i < per; ){
+                    size_t m = 0;
+                    for(; m < 16 && i + m < per; ++m)
+                        buf[m] = p * per + i + m + 1;
+                    const size_t k = q.push_n(buf, m);
+                    i += k;
+                    if(k == 0)
+                        std::this_thread::yield();
+                }
+            });
+        }
+        for(int c = 0; c < consumers; ++c){
+            ts.emplace_back([&]{
+                uint64_t v;
+                while(count.load(std::memory_order_relaxed) < producers * per){
+                    if(q.try_pop(v)){
+                        sum.fetch_add(v, std::memory_order_relaxed);
+                        count.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    else{
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+        for(auto& t : ts)
+            t.join();
+        const uint64_t total = producers * per;
+        std::cout << " mpmc_queue count : " << count.load() << " / " << total
+                  << ", sum ok : " << (sum.load() == total * (total + 1) / 2 ? "true" : "false") << std::endl;
+    }
+    {
+        dhsstl::mpsc_queue<std::string> q;
+        FUN_VALUE(q.empty());
+        q.push("a");
+        q.emplace(3, 'b');
+        FUN_VALUE(q.front());
+        q.pop();
+        std::string out;
+        FUN_VALUE(q.try_pop(out));
+        FUN_VALUE(out);
+        FUN_VALUE(q.try_pop(out));
+        q.push("left in queue");
+    }
+    {
+        // 多个生产者一个消费者, 检查每个生产者的元素按顺序到达
+        const int producers = 8;
+        const uint64_t per = 100000;
+        dhsstl::mpsc_queue<uint64_t> q;
+        dhsstl::vector<std::thread> ts;
+        for(int p = 0; p < producers; ++p){
+            ts.emplace_back([&, p]{
+                for(uint64_t i = 0; i < per; ++i)
+                    q.push(static_cast<uint64_t>(p) << 32 | i);
+            });
+        }
+        dhsstl::vector<uint64_t> next(producers, 0);
+        bool in_order = true;
+        uint64_t v;
+        for(uint64_t got = 0; got < producers * per; ){
+            if(q.try_pop(v)){
+                const size_t p = static_cast<size_t>(v >> 32);
+                in_order = in_order && (v & 0xffffffff) == next[p]++;
+                ++got;
+            }
+            else{
+                std::this_thread::yield();
+            }
+        }
+        for(auto& t : ts)
+            t.join();
+        std::cout << " mpsc_queue per-producer order : " << (in_order ? "true" : "false")
+                  << ", empty : " << (q.empty() ? "true" : "false") << std::endl;
+    }
+    std::cout << "[--------------------------- ------ END API test ------- -------------------------]" << std::endl;
+}
+
+// threads 个生产者和 threads 个消费者, 每个生产者放入 n / threads 个元素, 返回吞吐量(百万元素每秒)
+template <typename Queue>
+double queue_throughput_run(Queue& q, int threads, uint64_t n){
+    const uint64_t per = n / threads;
+    std::atomic<bool> go(false);
+    dhsstl::vector<std::thread> ts;
+    for(int p = 0; p < threads; ++p){
+        ts.emplace_back([&]{
+            while(!go.load(std::memory_order_acquire))
+                std::this_thread::yield();
+            dhsstl::backoff b;
+            for(uint64_t i = 0; i < per; ++i){
+                while(!q.try_push(i))
+                    b.pause();
+                b.reset();
+            }
+        });
+    }
+    for(int c = 0; c < threads; ++c){
+        ts.emplace_back([&]{
+            while(!go.load(std::memory_order_acquire))
+                std::this_thread::yield();
+            dhsstl::backoff b;
+            uint64_t v;
+            for(uint64_t i = 0; i < per; ++i){
+                while(!q.try_pop(v))
+                    b.pause();
+                b.reset();
+            }
+        });
+    }
+    auto start = cq_clock::now();
+    go.store(true, std::memory_order_release);
+    for(auto& t : ts)
+        t.join();
+    return static_cast<double>(per * threads) / cq_elapsed_ms(start) / 1000.0;
+}
+
+// 单生产者单消费者, 每次批量放入 / 取出 batch 个元素
+inline double spsc_batch_run(uint64_t n, size_t batch){
+    dhsstl::spsc_queue<uint64_t> q(4096);
+    auto start = cq_clock::now();
+    std::thread consumer([&]{
+        dhsstl::vector<uint64_t> buf(batch);
+        dhsstl::backoff b;
+        for(uint64_t got = 0; got < n; ){
+            const size_t k = q.pop_n(buf.begin(), batch);
+            got += k;
+            if(k == 0) b.pause(); else b.reset();
+        }
+    });
+    dhsstl::vector<uint64_t> buf(batch);
+    dhsstl::backoff b;
+    for(uint64_t sent = 0; sent < n; ){
+        for(size_t i = 0; i < batch; ++i)
+            buf[i] = sent + i;
+        const size_t k = q.push_n(buf.begin(), dhsstl::min<uint64_t>(batch, n - sent));
+        sent += k;
+        if(k == 0) b.pause(); else b.reset();
+    }
+    consumer.join();
+    return static_cast<double>(n) / cq_elapsed_ms(start) / 1000.0;
+}
+
+// 两个 spsc_queue 之间来回传递一个元素, 返回平均单程延迟(纳秒)
+inline double spsc_latency_run(uint64_t rounds){
+    dhsstl::spsc_queue<uint64_t> ping(64), pong(64);
+    std::thread echo([&]{
+        uint64_t v;
+        for(uint64_t i = 0; i < rounds; ++i){
+            ping.pop(v);
+            pong.push(v);
+        }
+    });
+    uint64_t v;
+    auto start = cq_clock::now();
+    for(uint64_t i = 0; i < rounds; ++i){
+        ping.push(i);
+        pong.pop(v);
+    }
+    const double ms = cq_elapsed_ms(start);
+    echo.join();
+    return ms * 1e6 / static_cast<double>(rounds) / 2.0;
+}
+
+//! @brief spsc_queue / mpmc_queue 在不同线程数下的吞吐量与延迟, 对比互斥量保护的 dhsstl::queue
+void concurrent_queue_perf(uint64_t n = 10000000, int max_threads = 8){
+    std::cout << "[=================================================================================]" << std::endl;
+    std::cout << "[-------------------- Run performance test : concurrent queue --------------------]" << std::endl;
+    std::cout << " hardware threads : " << std::thread::hardware_concurrency() << std::endl;
+    std::cout << " throughput in M elements / s" << std::endl;
+    {
+        dhsstl::spsc_queue<uint64_t> q(4096);
+        std::cout << " 1P1C spsc_queue\t\t: " << queue_throughput_run(q, 1, n) << std::endl;
+    }
+    for(size_t batch = 1; batch <= 256; batch *= 16)
+        std::cout << " 1P1C spsc_queue batch " << batch << "\t: " << spsc_batch_run(n, batch) << std::endl;
+    for(int t = 1; t <= max_threads; t *= 2){
+        dhsstl::mpmc_queue<uint64_t> q(4096);
+        locked_queue<uint64_t> lq;
+        const double a = queue_throughput_run(q, t, n);
+        const double b = queue_throughput_run(lq, t, n);
+        std::cout << " " << t << "P" << t << "C mpmc_queue\t\t: " << a
+                  << "\t mutex + queue : " << b << std::endl;
+    }
+    std::cout << " spsc_queue one-way latency (ns)\t: " << spsc_latency_run(n / 100) << std::endl;
+    std::cout << "[--------------------------- ------ END perf test ------ -------------------------]" << std::endl;
+}
+
+// producers 个生产者共放入 n 个元素, 一个消费者取出, 返回吞吐量(百万元素每秒)
+template <typename Queue>
+double mpsc_throughput_run(int producers, uint64_t n){
+    Queue q;
+    const uint64_t per = n / producers;
+    std::atomic<bool> go(false);
+    dhsstl::vector<std::thread> ts;
+    for(int p = 0; p < producers; ++p){
+        ts.emplace_back([&]{
+            while(!go.load(std::memory_order_acquire))
+                std::this_thread::yield();
+            for(uint64_t i = 0; i < per; ++i)
+                q.try_push(i);
+        });
+    }
+    auto start = cq_clock::now();
+    go.store(true, std::memory_order_release);
+    dhsstl::backoff b;
+    uint64_t v;
+    for(uint64_t got = 0; got < per * producers; ){
+        if(q.try_pop(v)){
+            ++got;
+            b.reset();
+        }
+        else{
+            b.pause();
+        }
+    }
+    const double ms = cq_elapsed_ms(start);
+    for(auto& t : ts)
+        t.join();
+    return static_cast<double>(per * producers) / ms / 1000.0;
+}
+
+// 让 mpsc_queue 和 locked_queue 有相同的接口
+template <typename T>
+struct mpsc_adapter : public dhsstl::mpsc_queue<T> {
+    bool try_push(const T& value){ this->push(value); return true; }
+};
+
+//! @brief mpsc_queue 在 1 ~ max_producers 个生产者下的吞吐量, 对比互斥量保护的 dhsstl::queue
+void mpsc_queue_perf(uint64_t n = 10000000, int max_producers = 64){
+    std::cout << "[=================================================================================]" << std::endl;
+    std::cout << "[---------------------- Run performance test : mpsc queue ------------------------]" << std::endl;
+    std::cout << " hardware threads : " << std::thread::hardware_concurrency() << std::endl;
+    std::cout << " throughput in M elements / s" << std::endl;
+    for(int p = 1; p <= max_producers; p *= 2){
+        const double a = mpsc_throughput_run<mpsc_adapter<uint64_t>>(p, n);
+        const double b = mpsc_throughput_run<locked_queue<uint64_t>>(p, n);
+        std::cout << " " << p << "P1C mpsc_queue\t: " << a << "\t mutex + queue : " << b << std::endl;
+    }
+    std::cout << "[--------------------------- ------ END perf test ------ -------------------------]" << std::endl;
+}
+
+} // namespace test
+} // namespace dhsstl
+#endif
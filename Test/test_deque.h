@@ -1,10 +1,13 @@
 #ifndef DHSTINYSTL_TEST_DEQUE_H_
 #define DHSTINYSTL_TEST_DEQUE_H_
 
+#include <ctime>
 #include <iostream>
 #include <deque>
 
+#include "algo.h"
 #include "deque.h"
+#include "vector.h"
 #include "test.h"
 
 
@@ -125,6 +128,75 @@ void deque_std() {
     std::cout << "[--------------------------- ------ END API test ------- -------------------------]" << std::endl;
 }
 
+// 把 f 执行 rounds 次, 返回耗时
+template <typename F>
+clock_t deque_time_rounds(size_t rounds, F f){
+    clock_t start = clock();
+    for(size_t r = 0; r < rounds; ++r)
+        f(r);
+    return clock() - start;
+}
+
+//! @brief 比较 deque 与 vector 上的 copy / fill / find,
+//! "element loop" 为逐个元素经由 deque 迭代器处理(即分段处理之前的做法)
+void deque_algo_perf(size_t n = static_cast<size_t>(1) << 16, size_t rounds = 5000){
+    std::cout << "[=================================================================================]" << std::endl;
+    std::cout << "[----------------------- Run performance test : deque algorithms ------------------]" << std::endl;
+    dhsstl::deque<int> d(n, 1);
+    dhsstl::vector<int> v(n, 1);
+    dhsstl::vector<int> out(n);
+    long long sink = 0;
+
+    std::cout << " copy  deque  element loop : " << deque_time_rounds(rounds, [&](size_t r){
+        auto result = out.begin();
+        for(auto it = d.begin(); it != d.end(); ++it, ++result)
+            *result = *it;
+        sink += out[r];
+    }) << std::endl;
+    std::cout << " copy  deque  -> vector    : " << deque_time_rounds(rounds, [&](size_t r){
+        dhsstl::copy(d.begin(), d.end(), out.begin());
+        sink += out[r];
+    }) << std::endl;
+    std::cout << " copy  vector -> deque     : " << deque_time_rounds(rounds, [&](size_t r){
+        dhsstl::copy(v.begin(), v.end(), d.begin());
+        sink += d[r];
+    }) << std::endl;
+    std::cout << " copy  vector -> vector    : " << deque_time_rounds(rounds, [&](size_t r){
+        dhsstl::copy(v.begin(), v.end(), out.begin());
+        sink += out[r];
+    }) << std::endl;
+
+    std::cout << " fill  deque  element loop : " << deque_time_rounds(rounds, [&](size_t r){
+        for(auto it = d.begin(); it != d.end(); ++it)
+            *it = static_cast<int>(r);
+        sink += d[r];
+    }) << std::endl;
+    std::cout << " fill  deque               : " << deque_time_rounds(rounds, [&](size_t r){
+        dhsstl::fill(d.begin(), d.end(), static_cast<int>(r));
+        sink += d[r];
+    }) << std::endl;
+    std::cout << " fill  vector              : " << deque_time_rounds(rounds, [&](size_t r){
+        dhsstl::fill(v.begin(), v.end(), static_cast<int>(r));
+        sink += v[r];
+    }) << std::endl;
+
+    // 查找一个不存在的值, 需要扫描整个区间
+    std::cout << " find  deque  element loop : " << deque_time_rounds(rounds, [&](size_t){
+        auto it = d.begin();
+        while(it != d.end() && !(*it == -1))
+            ++it;
+        sink += it - d.begin();
+    }) << std::endl;
+    std::cout << " find  deque               : " << deque_time_rounds(rounds, [&](size_t){
+        sink += dhsstl::find(d.begin(), d.end(), -1) - d.begin();
+    }) << std::endl;
+    std::cout << " find  vector              : " << deque_time_rounds(rounds, [&](size_t){
+        sink += dhsstl::find(v.begin(), v.end(), -1) - v.begin();
+    }) << std::endl;
+    std::cout << " (" << sink % 10 << ")" << std::endl;
+    std::cout << "[--------------------------- ------ END perf test ------ -------------------------]" << std::endl;
+}
+
 } // namespace test
 } // namespace dhsstl
 
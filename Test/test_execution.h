@@ -0,0 +1,129 @@
+#ifndef DHSTINYSTL_TEST_EXECUTION_H_
+#define DHSTINYSTL_TEST_EXECUTION_H_
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+#include "execution.h"
+#include "vector.h"
+#include "list.h"
+#include "test.h"
+
+namespace dhsstl {
+namespace test {
+
+typedef std::chrono::steady_clock ex_clock;
+
+// 重复 rounds 次, 返回平均耗时(毫秒)
+template <typename F>
+double ex_time_ms(int rounds, F&& f){
+    auto start = ex_clock::now();
+    for(int i = 0; i < rounds; ++i)
+        f();
+    return std::chrono::duration<double, std::milli>(ex_clock::now() - start).count() / rounds;
+}
+
+//! @brief 功能测试: 带执行策略的算法与串行版本的结果一致
+void execution_test(){
+    std::cout << "[=================================================================================]" << std::endl;
+    std::cout << "[------------------------ Run API test : execution policy ------------------------]" << std::endl;
+    namespace ex = dhsstl::execution;
+    dhsstl::thread_pool pool(4);
+    const auto par = ex::par.on(pool);
+    const size_t n = 1000003;
+    dhsstl::vector<uint64_t> a(n), b(n), c(n);
+    for(size_t i = 0; i < n; ++i)
+        a[i] = i * 2654435761u % 1000;
+
+    dhsstl::copy(par, a.begin(), a.end(), b.begin());
+    FUN_VALUE(dhsstl::equal(a.begin(), a.end(), b.begin()));
+    FUN_VALUE(dhsstl::equal(par, a.begin(), a.end(), b.begin()));
+    b[n - 7] += 1;
+    b[n / 2] += 1;
+    FUN_VALUE(dhsstl::equal(ex::par_unseq.on(pool), a.begin(), a.end(), b.begin()));
+    FUN_VALUE(dhsstl::mismatch(par, a.begin(), a.end(), b.begin()).first - a.begin());
+    FUN_VALUE(dhsstl::mismatch(ex::seq, a.begin(), a.end(), b.begin()).first - a.begin());
+
+    FUN_VALUE(dhsstl::reduce(a.begin(), a.end()));
+    FUN_VALUE(dhsstl::reduce(par, a.begin(), a.end()));
+    FUN_VALUE(dhsstl::reduce(par, a.begin(), a.end(), uint64_t(1), dhsstl::plus<uint64_t>()));
+
+    dhsstl::transform(par, a.begin(), a.end(), c.begin(), [](uint64_t x){ return x * 3; });
+    dhsstl::transform(par, a.begin(), a.end(), c.begin(), b.begin(),
+                      [](uint64_t x, uint64_t y){ return y - x; });
+    FUN_VALUE((dhsstl::reduce(par, b.begin(), b.end()) == 2 * dhsstl::reduce(a.begin(), a.end())));
+
+    dhsstl::copy(a.begin(), a.end(), b.begin());
+    dhsstl::reverse(par, b.begin(), b.end());
+    dhsstl::reverse(a.begin(), a.end());
+    FUN_VALUE(dhsstl::equal(a.begin(), a.end(), b.begin()));
+
+    dhsstl::fill(par, b.begin(), b.end(), uint64_t(7));
+    dhsstl::move(par, b.begin(), b.end(), c.begin());
+    FUN_VALUE((dhsstl::reduce(par, c.begin(), c.end()) == 7 * n));
+
+    // 非随机访问迭代器时退化为串行版本
+    dhsstl::list<int> l(100000, 1);
+    FUN_VALUE(dhsstl::reduce(par, l.begin(), l.end()));
+    std::cout << "[--------------------------- ------ END API test ------- -------------------------]" << std::endl;
+}
+
+//! @brief 强扩展性: 问题规模固定为 n 个 uint64_t, 线程数从 1 增加到硬件线程数
+void execution_perf(size_t n = 1u << 26, int rounds = 5, size_t max_threads = 0){
+    std::cout << "[=================================================================================]" << std::endl;
+    std::cout << "[-------------------- Run performance test : execution policy --------------------]" << std::endl;
+    namespace ex = dhsstl::execution;
+    const size_t hw = dhsstl::max<size_t>(std::thread::hardware_concurrency(), 1);
+    if(max_threads == 0)
+        max_threads = hw;
+    std::cout << " hardware threads : " << hw << ", elements : " << n << ", time in ms" << std::endl;
+    // equal 比较 a 和它的副本 c, 同一个区间和自己比较时 memcmp 会直接返回
+    dhsstl::vector<uint64_t> a(n), b(n), c(n);
+    for(size_t i = 0; i < n; ++i)
+        a[i] = c[i] = i;
+    volatile uint64_t sink = 0;
+    const auto flags = std::cout.flags();
+    const auto prec = std::cout.precision();
+    std::cout << std::fixed << std::setprecision(2);
+
+    std::cout << " threads\t copy\t fill\t equal\t reverse\t transform\t reduce" << std::endl;
+    auto seq_row = [&]{
+        std::cout << " seq\t "
+            << ex_time_ms(rounds, [&]{ dhsstl::copy(ex::seq, a.begin(), a.end(), b.begin()); }) << "\t "
+            << ex_time_ms(rounds, [&]{ dhsstl::fill(ex::seq, b.begin(), b.end(), uint64_t(1)); }) << "\t "
+            << ex_time_ms(rounds, [&]{ sink = dhsstl::equal(ex::seq, a.begin(), a.end(), c.begin()); }) << "\t "
+            << ex_time_ms(rounds, [&]{ dhsstl::reverse(ex::seq, b.begin(), b.end()); }) << "\t\t "
+            << ex_time_ms(rounds, [&]{ dhsstl::transform(ex::seq, a.begin(), a.end(), b.begin(),
+                                                         [](uint64_t x){ return x * x + 1; }); }) << "\t\t "
+            << ex_time_ms(rounds, [&]{ sink = dhsstl::reduce(ex::seq, a.begin(), a.end()); }) << std::endl;
+    };
+    seq_row();
+    auto par_row = [&](size_t t){
+        dhsstl::thread_pool pool(t);
+        const auto par = ex::par.on(pool);
+        std::cout << " " << t << "\t "
+            << ex_time_ms(rounds, [&]{ dhsstl::copy(par, a.begin(), a.end(), b.begin()); }) << "\t "
+            << ex_time_ms(rounds, [&]{ dhsstl::fill(par, b.begin(), b.end(), uint64_t(1)); }) << "\t "
+            << ex_time_ms(rounds, [&]{ sink = dhsstl::equal(par, a.begin(), a.end(), c.begin()); }) << "\t "
+            << ex_time_ms(rounds, [&]{ dhsstl::reverse(par, b.begin(), b.end()); }) << "\t\t "
+            << ex_time_ms(rounds, [&]{ dhsstl::transform(par, a.begin(), a.end(), b.begin(),
+                                                         [](uint64_t x){ return x * x + 1; }); }) << "\t\t "
+            << ex_time_ms(rounds, [&]{ sink = dhsstl::reduce(par, a.begin(), a.end()); }) << std::endl;
+    };
+    size_t t = 1;
+    for(; t <= max_threads; t *= 2)
+        par_row(t);
+    if(t / 2 != max_threads)
+        par_row(max_threads);
+    (void)sink;
+    std::cout.flags(flags);
+    std::cout.precision(prec);
+    std::cout << "[--------------------------- ------ END perf test ------ -------------------------]" << std::endl;
+}
+
+} // namespace test
+} // namespace dhsstl
+#endif
@@ -1,11 +1,17 @@
 #ifndef DHSTINYSTL_TEST_LIST_H_
 #define DHSTINYSTL_TEST_LIST_H_
 
+#include <chrono>
 #include <iostream>
 #include <list>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
 
 #include "test.h"
 #include "list.h"
+#include "vector.h"
 
 namespace dhsstl {
 namespace test {
@@ -55,6 +61,8 @@ void list_test(){
     FUN_VALUE(l1.empty());
     FUN_AFTER(l1, l1.reverse());
     FUN_AFTER(l1, l1.sort());
+    FUN_AFTER(l1, l1.sort(dhsstl::greater<int>()));
+    FUN_AFTER(l1, l1.pointer_sort());
     FUN_VALUE(l1.size());
     FUN_AFTER(l1, l1.resize(30, 5));
     FUN_AFTER(l1, l1.clear());
@@ -62,6 +70,331 @@ void list_test(){
     std::cout << "[--------------------------- ------ END API test ------- -------------------------]" << std::endl;
 }
 
+//! @brief list::sort 与 pointer_sort 的稳定性, 以及比较器抛出异常时节点不丢失
+void list_sort_test(){
+    std::cout << "[=================================================================================]" << std::endl;
+    std::cout << "[--------------------------- Run API test : list::sort ---------------------------]" << std::endl;
+    typedef std::pair<int, int> item;
+    auto by_first = [](const item& a, const item& b){ return a.first < b.first; };
+    auto stable = [](const dhsstl::list<item>& l){
+        bool ok = true;
+        auto prev = l.begin();
+        for(auto it = ++l.begin(); it != l.end(); prev = it, ++it)
+            ok = ok && (prev->first < it->first || (prev->first == it->first && prev->second < it->second));
+        // prev 指针也要正确
+        size_t back = 0;
+        for(auto it = l.end(); it != l.begin(); --it)
+            ++back;
+        return ok && back == l.size();
+    };
+    std::mt19937 gen(3);
+    for(int n : { 0, 1, 2, 3, 100, 4097, 100000 }){
+        dhsstl::list<item> a, b;
+        for(int i = 0; i < n; ++i){
+            const int k = static_cast<int>(gen() % 100);
+            a.push_back(item(k, i));
+            b.push_back(item(k, i));
+        }
+        a.sort(by_first);
+        b.pointer_sort(by_first);
+        std::cout << " n = " << n << "\t sort stable : " << (stable(a) ? "true" : "false")
+                  << "\t pointer_sort stable : " << (stable(b) ? "true" : "false")
+                  << "\t size : " << a.size() << " " << b.size() << std::endl;
+    }
+    // 比较若干次之后抛出异常, 所有节点仍然在链表中, 且可以双向遍历
+    dhsstl::list<int> l;
+    long long sum = 0;
+    for(int i = 0; i < 10000; ++i){
+        l.push_back(static_cast<int>(gen() % 1000));
+        sum += l.back();
+    }
+    int calls = 0;
+    try{
+        l.sort([&](int x, int y){
+            if(++calls == 50000)
+                throw std::runtime_error("compare failed");
+            return x < y;
+        });
+    }catch(const std::runtime_error& e){
+        std::cout << " sort rethrows : " << e.what() << std::endl;
+    }
+    long long fsum = 0, bsum = 0;
+    size_t fcount = 0, bcount = 0;
+    for(auto it = l.begin(); it != l.end(); ++it, ++fcount)
+        fsum += *it;
+    for(auto it = l.rbegin(); it != l.rend(); ++it, ++bcount)
+        bsum += *it;
+    std::cout << " after exception, nodes kept : " << ((fsum == sum && bsum == sum && fcount == l.size() &&
+                                                       bcount == l.size()) ? "true" : "false") << std::endl;
+    std::cout << "[--------------------------- ------ END API test ------- -------------------------]" << std::endl;
+}
+
+//! @brief 从 chunk 中分配节点的 list<T, ChunkSize>
+void list_pool_test(){
+    std::cout << "[=================================================================================]" << std::endl;
+    std::cout << "[------------------------ Run API test : list<T, ChunkSize> ----------------------]" << std::endl;
+    typedef dhsstl::list<int, 4> pool_list;
+    pool_list l1 = {1, 3, 5, 7, 9};
+    pool_list l2(6, 2);
+    pool_list l3;
+    FUN_AFTER(l1, l1.push_back(11));
+    FUN_AFTER(l1, l1.erase(l1.begin()));
+    FUN_AFTER(l1, l1.push_front(0));
+    FUN_AFTER(l1, l1.merge(l2));
+    FUN_VALUE(l2.size());
+    FUN_AFTER(l2, l2.splice(l2.end(), l1, l1.begin()));
+    FUN_AFTER(l2, l2.splice(l2.begin(), l1, ++l1.begin(), --l1.end()));
+    FUN_AFTER(l1, l1.swap(l2));
+    FUN_AFTER(l3, l3 = dhsstl::move(l1));
+    FUN_VALUE(l1.size());
+    FUN_AFTER(l1, l1.insert(l1.end(), l3.begin(), l3.end()));
+    FUN_AFTER(l1, l1.sort(dhsstl::greater<int>()));
+    FUN_AFTER(l1, l1.clear());
+    FUN_AFTER(l1, l1.push_back(42));
+    pool_list l4(dhsstl::move(l3));
+    FUN_VALUE(l3.size());
+    FUN_VALUE(l4.size());
+    // 个数已知时所有节点放在一个 chunk 中, 删除的节点之后被复用
+    dhsstl::vector<int> v;
+    for(int i = 0; i < 20; ++i)
+        v.push_back(i);
+    pool_list l5(v.begin(), v.end());
+    FUN_AFTER(l5, l5.remove_if([](int x){ return x % 3 == 0; }));
+    FUN_AFTER(l5, l5.push_front(-1));
+    pool_list l6(l5);
+    FUN_AFTER(l6, l6.splice(l6.end(), l4));
+    FUN_AFTER(l6, l6.insert(l6.begin(), 3, 7));
+    FUN_VALUE(l4.size());
+    pool_list l7(30, 1);
+    FUN_VALUE(l7.size());
+    std::cout << "[--------------------------- ------ END API test ------- -------------------------]" << std::endl;
+}
+
+typedef std::chrono::steady_clock list_clock;
+
+template <typename L, typename F>
+double list_sort_time_ms(L& l, F&& f){
+    auto start = list_clock::now();
+    f(l);
+    return std::chrono::duration<double, std::milli>(list_clock::now() - start).count();
+}
+
+template <typename L, typename Make>
+void list_assign_random(L& l, uint64_t seed, Make make){
+    std::mt19937_64 gen(seed);
+    for(auto it = l.begin(); it != l.end(); ++it)
+        *it = make(gen());
+}
+
+// 三个链表交替插入相同的随机值, 节点在内存中的布局相同
+// shuffled 为 true 时先按值排序一次再重新赋随机值, 节点在链表中的顺序与在内存中的顺序无关, 接近长期使用后的链表
+template <typename T, typename Make>
+void list_sort_run(const char* name, size_t n, bool shuffled, Make make){
+    std::mt19937_64 gen(n);
+    std::list<T> sl;
+    dhsstl::list<T> dl, pl;
+    for(size_t i = 0; i < n; ++i){
+        const T v = make(gen());
+        sl.push_back(v);
+        dl.push_back(v);
+        pl.push_back(v);
+    }
+    if(shuffled){
+        sl.sort();
+        dl.sort();
+        pl.sort();
+        list_assign_random(sl, n + 1, make);
+        list_assign_random(dl, n + 1, make);
+        list_assign_random(pl, n + 1, make);
+    }
+    std::cout << " " << name << " x " << n << (shuffled ? " shuffled" : " in order")
+              << "\t std::list::sort : " << list_sort_time_ms(sl, [](std::list<T>& l){ l.sort(); }) << " ms"
+              << "\t sort : " << list_sort_time_ms(dl, [](dhsstl::list<T>& l){ l.sort(); }) << " ms"
+              << "\t pointer_sort : " << list_sort_time_ms(pl, [](dhsstl::list<T>& l){ l.pointer_sort(); })
+              << " ms" << std::endl;
+}
+
+//! @brief 1M / 10M 个 int 以及 string 的 list 排序
+void list_sort_perf(size_t max_n = 10000000){
+    std::cout << "[=================================================================================]" << std::endl;
+    std::cout << "[----------------------- Run performance test : list::sort -----------------------]" << std::endl;
+    auto make_int = [](uint64_t r){ return static_cast<int>(r); };
+    auto make_string = [](uint64_t r){ return std::to_string(r % 100000000); };
+    for(size_t n = 1000000; n <= max_n; n *= 10){
+        for(bool shuffled : { false, true }){
+            list_sort_run<int>("int", n, shuffled, make_int);
+            list_sort_run<std::string>("string", n, shuffled, make_string);
+        }
+    }
+    std::cout << "[--------------------------- ------ END perf test ------ -------------------------]" << std::endl;
+}
+
+
+// list_pool_perf 中遍历时读取的值
+inline size_t list_pool_touch(int v) { return static_cast<size_t>(v); }
+inline size_t list_pool_touch(const std::string& v) { return v.size(); }
+
+// 依次测量 push_back n 个元素, 遍历, n 次 erase + insert, 再遍历, clear 的耗时(毫秒), 每一项保留最小值
+// noise 为 true 时每次插入后再申请一小块无关的内存, 堆上的节点在内存中被隔开, 接近同时使用多个容器的程序
+template <typename L, typename Make>
+void list_pool_measure(double* best, size_t n, bool noise, Make make){
+    std::mt19937_64 gen(n);
+    dhsstl::vector<char*> filler;
+    if(noise)
+        filler.reserve(2 * n);
+    volatile size_t sink = 0;
+    auto ms = [](list_clock::time_point start){
+        return std::chrono::duration<double, std::milli>(list_clock::now() - start).count();
+    };
+    auto iterate = [&](const L& l){
+        size_t s = 0;
+        for(int r = 0; r < 5; ++r){
+            for(auto it = l.begin(); it != l.end(); ++it)
+                s += list_pool_touch(*it);
+        }
+        sink = s;
+    };
+    double t[5];
+    L l;
+    auto start = list_clock::now();
+    for(size_t i = 0; i < n; ++i){
+        l.push_back(make(gen()));
+        if(noise)
+            filler.push_back(new char[24]);
+    }
+    t[0] = ms(start);
+
+    start = list_clock::now();
+    iterate(l);
+    t[1] = ms(start);
+
+    // 两个游标相距 n / 2, 一个删除, 一个插入
+    start = list_clock::now();
+    auto del = l.begin();
+    auto ins = l.begin();
+    for(size_t i = 0; i < n / 2; ++i)
+        ++ins;
+    for(size_t i = 0; i < n; ++i){
+        if(del == ins)
+            ++del;
+        if(del == l.end())
+            del = l.begin();
+        del = l.erase(del);
+        if(noise)
+            filler.push_back(new char[24]);
+        if(ins == l.end())
+            ins = l.begin();
+        l.insert(ins, make(gen()));
+        ++ins;
+    }
+    t[2] = ms(start);
+
+    start = list_clock::now();
+    iterate(l);
+    t[3] = ms(start);
+
+    start = list_clock::now();
+    l.clear();
+    t[4] = ms(start);
+    for(auto p : filler)
+        delete[] p;
+    (void)sink;
+    for(int i = 0; i < 5; ++i)
+        best[i] = dhsstl::min(best[i], t[i]);
+}
+
+template <typename T, typename Make>
+void list_pool_run(const char* name, size_t n, bool noise, Make make, int rounds){
+    std::cout << " " << name << " x " << n << (noise ? " with heap noise" : "") << ", min of "
+              << rounds << " rounds, time in ms" << std::endl;
+    double best[3][5];
+    for(auto& b : best)
+        for(auto& x : b)
+            x = 1e300;
+    for(int r = 0; r < rounds; ++r){
+        list_pool_measure<std::list<T>>(best[0], n, noise, make);
+        list_pool_measure<dhsstl::list<T>>(best[1], n, noise, make);
+        list_pool_measure<dhsstl::list<T, 64>>(best[2], n, noise, make);
+    }
+    const char* impl[3] = { "std::list  ", "list<T>    ", "list<T, 64>" };
+    for(int i = 0; i < 3; ++i){
+        std::cout << "   " << impl[i] << "\t build : " << best[i][0] << "\t iterate x5 : " << best[i][1]
+                  << "\t churn : " << best[i][2] << "\t iterate x5 after churn : " << best[i][3]
+                  << "\t clear : " << best[i][4] << std::endl;
+    }
+}
+
+//! @brief 逐个分配节点的 list 与从 chunk 中分配节点的 list<T, 64> 比较遍历, 插入删除和 clear
+void list_pool_perf(size_t max_n = 10000000, int rounds = 3){
+    std::cout << "[=================================================================================]" << std::endl;
+    std::cout << "[-------------------- Run performance test : list node pool ----------------------]" << std::endl;
+    auto make_int = [](uint64_t r){ return static_cast<int>(r); };
+    auto make_string = [](uint64_t r){ return std::to_string(r % 100000000); };
+    for(size_t n = 1000000; n <= max_n; n *= 10){
+        for(bool noise : { false, true }){
+            list_pool_run<int>("int", n, noise, make_int, rounds);
+            list_pool_run<std::string>("string", n, noise, make_string, rounds);
+        }
+    }
+    std::cout << "[--------------------------- ------ END perf test ------ -------------------------]" << std::endl;
+}
+
+// 从 v 构造 list, 复制一次, 再析构两者, 每一项保留最小值(毫秒)
+template <typename L, typename T>
+void list_build_measure(double* best, const dhsstl::vector<T>& v){
+    auto ms = [](list_clock::time_point start){
+        return std::chrono::duration<double, std::milli>(list_clock::now() - start).count();
+    };
+    double t[3];
+    auto start = list_clock::now();
+    L* l = new L(v.begin(), v.end());
+    t[0] = ms(start);
+    start = list_clock::now();
+    L* c = new L(*l);
+    t[1] = ms(start);
+    start = list_clock::now();
+    delete l;
+    delete c;
+    t[2] = ms(start);
+    for(int i = 0; i < 3; ++i)
+        best[i] = dhsstl::min(best[i], t[i]);
+}
+
+template <typename T>
+void list_build_run(const char* name, const dhsstl::vector<T>& v, int rounds){
+    double best[3][3];
+    for(auto& b : best)
+        for(auto& x : b)
+            x = 1e300;
+    for(int r = 0; r < rounds; ++r){
+        list_build_measure<std::list<T>>(best[0], v);
+        list_build_measure<dhsstl::list<T>>(best[1], v);
+        list_build_measure<dhsstl::list<T, 64>>(best[2], v);
+    }
+    std::cout << " " << name << " x " << v.size() << ", min of " << rounds << " rounds, time in ms" << std::endl;
+    const char* impl[3] = { "std::list  ", "list<T>    ", "list<T, 64>" };
+    for(int i = 0; i < 3; ++i){
+        std::cout << "   " << impl[i] << "\t build : " << best[i][0] << "\t copy : " << best[i][1]
+                  << "\t destroy both : " << best[i][2] << std::endl;
+    }
+}
+
+//! @brief 从 vector 构造 n 个元素的 list, list<T, 64> 在个数已知时把所有节点放在一个 chunk 中
+void list_build_perf(size_t n = 10000000, int rounds = 3){
+    std::cout << "[=================================================================================]" << std::endl;
+    std::cout << "[------------------- Run performance test : list range build ---------------------]" << std::endl;
+    dhsstl::vector<int> vi;
+    dhsstl::vector<std::string> vs;
+    std::mt19937_64 gen(n);
+    for(size_t i = 0; i < n; ++i){
+        const uint64_t r = gen();
+        vi.push_back(static_cast<int>(r));
+        vs.push_back(std::to_string(r % 100000000));
+    }
+    list_build_run("int", vi, rounds);
+    list_build_run("string", vs, rounds);
+    std::cout << "[--------------------------- ------ END perf test ------ -------------------------]" << std::endl;
+}
 
 //! @brief Test dhsstl::vector
 void list_stl(){
@@ -0,0 +1,716 @@
+#ifndef DHSTINYSTL_TEST_MEMORY_H_
+#define DHSTINYSTL_TEST_MEMORY_H_
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "memory.h"
+#include "uninitialized.h"
+#include "algo.h"
+#include "aligned_allocator.h"
+#include "vector.h"
+#include "test.h"
+
+namespace dhsstl {
+namespace test {
+
+// 记录构造和析构次数的类型
+struct sp_counted
+{
+    static int alive;
+    uint64_t   value;
+
+    explicit sp_counted(uint64_t v = 0) : value(v) { ++alive; }
+    sp_counted(const sp_counted& rhs) : value(rhs.value) { ++alive; }
+    ~sp_counted() { --alive; }
+};
+int sp_counted::alive = 0;
+
+// 构造时抛出异常的类型
+struct sp_throwing
+{
+    explicit sp_throwing(int) { throw std::runtime_error("constructor failed"); }
+};
+
+// 48 字节的对象, 与控制块分开分配时各占一个缓存行
+struct sp_payload
+{
+    uint64_t value;
+    uint64_t pad[5];
+
+    explicit sp_payload(uint64_t v) : value(v), pad() {}
+};
+
+// 固定容量的对象池, 对象通过 shared_ptr 的删除器归还
+struct sp_pool
+{
+    dhsstl::vector<sp_payload*> free_;
+    sp_payload*                 slots_;
+
+    explicit sp_pool(size_t n) : slots_(dhsstl::allocator<sp_payload>::allocate(n)){
+        free_.reserve(n);
+        for(size_t i = n; i > 0; --i)
+            free_.push_back(slots_ + i - 1);
+    }
+    ~sp_pool() { dhsstl::allocator<sp_payload>::deallocate(slots_); }
+
+    sp_payload* acquire(uint64_t v){
+        sp_payload* p = free_.back();
+        free_.pop_back();
+        return ::new (static_cast<void*>(p)) sp_payload(v);
+    }
+    void release(sp_payload* p){
+        p->~sp_payload();
+        free_.push_back(p);
+    }
+    size_t available() const { return free_.size(); }
+};
+
+struct sp_pool_deleter
+{
+    sp_pool* pool;
+    void operator()(sp_payload* p) const { pool->release(p); }
+};
+
+// 移动构造时可以抛出异常的删除器, 用于检查构造控制块失败时对象被归还
+struct sp_throwing_deleter
+{
+    static bool throw_on_move;
+    sp_pool* pool;
+
+    explicit sp_throwing_deleter(sp_pool* p) : pool(p) {}
+    sp_throwing_deleter(const sp_throwing_deleter&) = default;
+    sp_throwing_deleter(sp_throwing_deleter&& rhs) : pool(rhs.pool){
+        if(throw_on_move)
+            throw std::runtime_error("deleter move failed");
+    }
+    void operator()(sp_payload* p) const { pool->release(p); }
+};
+bool sp_throwing_deleter::throw_on_move = false;
+
+// 记录控制块个数的静态分配器
+static long sp_live_blocks = 0;
+
+template <typename T>
+struct sp_counting_allocator
+{
+    static T* allocate(size_t n = 1){
+        ++sp_live_blocks;
+        return dhsstl::allocator<T>::allocate(n);
+    }
+    static void deallocate(T* p){
+        --sp_live_blocks;
+        dhsstl::allocator<T>::deallocate(p);
+    }
+};
+
+// 继承 intrusive_ref_counter 的类型, 记录存活的对象个数
+struct ip_counted : dhsstl::intrusive_ref_counter<ip_counted>
+{
+    static int alive;
+    uint64_t   value;
+
+    explicit ip_counted(uint64_t v = 0) : value(v) { ++alive; }
+    ip_counted(const ip_counted& rhs) : dhsstl::intrusive_ref_counter<ip_counted>(rhs), value(rhs.value) { ++alive; }
+    ~ip_counted() { --alive; }
+};
+int ip_counted::alive = 0;
+
+struct ip_derived : ip_counted
+{
+    explicit ip_derived(uint64_t v) : ip_counted(v) {}
+};
+
+// 自己提供 intrusive_ptr_add_ref / intrusive_ptr_release 的类型, 计数归零时不释放, 只做记录
+struct ip_manual
+{
+    int refs     = 0;
+    int released = 0;
+};
+inline void intrusive_ptr_add_ref(ip_manual* p) { ++p->refs; }
+inline void intrusive_ptr_release(ip_manual* p) { if(--p->refs == 0) ++p->released; }
+
+// 与 sp_payload 大小相同的对象, 计数放在对象内部
+template <typename Counter>
+struct ip_payload : dhsstl::intrusive_ref_counter<ip_payload<Counter>, Counter>
+{
+    uint64_t value;
+    uint64_t pad[4];
+
+    explicit ip_payload(uint64_t v) : value(v), pad() {}
+};
+
+//! @brief shared_ptr / weak_ptr / make_shared 的功能测试
+void shared_ptr_test(){
+    std::cout << "[=================================================================================]" << std::endl;
+    std::cout << "[------------------------ Run API test : shared_ptr ------------------------------]" << std::endl;
+    {
+        dhsstl::shared_ptr<sp_counted> a(new sp_counted(1));
+        dhsstl::shared_ptr<sp_counted> b = a;
+        FUN_VALUE(a.use_count());
+        FUN_VALUE(b->value);
+        dhsstl::shared_ptr<sp_counted> c(dhsstl::move(b));
+        FUN_VALUE((b == nullptr));
+        FUN_VALUE(c.use_count());
+        a.reset();
+        c.reset(new sp_counted(2));
+        FUN_VALUE(sp_counted::alive);
+    }
+    FUN_VALUE(sp_counted::alive);
+
+    dhsstl::weak_ptr<sp_counted> w;
+    {
+        auto p = dhsstl::make_shared<sp_counted>(3);
+        w = p;
+        FUN_VALUE(p.use_count());
+        FUN_VALUE(w.lock()->value);
+        FUN_VALUE(w.expired());
+    }
+    // 对象已经析构, 控制块由 w 保留
+    FUN_VALUE(sp_counted::alive);
+    FUN_VALUE(w.expired());
+    FUN_VALUE((w.lock() == nullptr));
+    w.reset();
+
+    // 控制块和对象按 aligned_allocator 的对齐分配
+    auto q = dhsstl::allocate_shared<sp_counted>(dhsstl::aligned_allocator<sp_counted, 64>(), 4);
+    FUN_VALUE(q->value);
+    q.reset();
+
+    try{
+        auto t = dhsstl::make_shared<sp_throwing>(5);
+    }catch(const std::runtime_error& e){
+        std::cout << " make_shared rethrows : " << e.what() << std::endl;
+    }
+    FUN_VALUE(sp_counted::alive);
+
+    {
+        auto l = dhsstl::make_local_shared<sp_counted>(6);
+        dhsstl::local_weak_ptr<sp_counted> lw(l);
+        dhsstl::local_shared_ptr<sp_counted> l2 = l;
+        FUN_VALUE(l.use_count());
+        l.reset();
+        FUN_VALUE(lw.lock()->value);
+        l2.reset();
+        FUN_VALUE(lw.expired());
+    }
+    FUN_VALUE(sp_counted::alive);
+
+    // 对象来自 pool, 由删除器归还; 控制块由 sp_counting_allocator 分配
+    sp_pool pool(4);
+    {
+        dhsstl::shared_ptr<sp_payload> a(pool.acquire(7), sp_pool_deleter{ &pool },
+                                         sp_counting_allocator<sp_payload>());
+        dhsstl::shared_ptr<sp_payload> b = a;
+        dhsstl::weak_ptr<sp_payload> wb(b);
+        FUN_VALUE(b->value);
+        FUN_VALUE(pool.available());
+        FUN_VALUE(sp_live_blocks);
+        a.reset();
+        b.reset();
+        FUN_VALUE(pool.available());
+        FUN_VALUE(sp_live_blocks);
+    }
+    FUN_VALUE(sp_live_blocks);
+    // 删除器移动到控制块时抛出异常: 控制块被释放, 对象由删除器归还
+    {
+        sp_throwing_deleter d(&pool);
+        sp_throwing_deleter::throw_on_move = true;
+        try{
+            dhsstl::shared_ptr<sp_payload> c(pool.acquire(8), d, sp_counting_allocator<sp_payload>());
+        }catch(const std::runtime_error& e){
+            std::cout << " shared_ptr(p, d, alloc) rethrows : " << e.what() << std::endl;
+        }
+        sp_throwing_deleter::throw_on_move = false;
+        FUN_VALUE(pool.available());
+        FUN_VALUE(sp_live_blocks);
+    }
+    std::cout << "[--------------------------- ------ END API test ------- -------------------------]" << std::endl;
+}
+
+void intrusive_ptr_test(){
+    std::cout << "[=================================================================================]" << std::endl;
+    std::cout << "[----------------- Run container test : intrusive_ptr ----------------------------]" << std::endl;
+    std::cout << "[--------------------------- API test ---------------------------------------------]" << std::endl;
+    FUN_VALUE(sizeof(dhsstl::intrusive_ptr<ip_counted>));
+    FUN_VALUE(sizeof(dhsstl::shared_ptr<ip_counted>));
+    {
+        dhsstl::intrusive_ptr<ip_counted> a = dhsstl::make_intrusive<ip_counted>(1);
+        dhsstl::intrusive_ptr<ip_counted> b = a;
+        FUN_VALUE(a->use_count());
+        FUN_VALUE((a == b));
+        dhsstl::intrusive_ptr<ip_counted> c(dhsstl::move(b));
+        FUN_VALUE((b == nullptr));
+        FUN_VALUE(c->use_count());
+        // detach 之后由调用者持有那个引用, 再交给不增加计数的构造函数
+        ip_counted* raw = c.detach();
+        dhsstl::intrusive_ptr<ip_counted> d(raw, false);
+        FUN_VALUE(d->use_count());
+        a.reset();
+        d.reset();
+        FUN_VALUE(ip_counted::alive);
+
+        dhsstl::intrusive_ptr<ip_derived> e = dhsstl::make_intrusive<ip_derived>(2);
+        dhsstl::intrusive_ptr<ip_counted> f = e;
+        FUN_VALUE(f->value);
+        FUN_VALUE(f->use_count());
+        f = nullptr;
+        e = nullptr;
+        FUN_VALUE(ip_counted::alive);
+    }
+    {
+        // 复制对象时计数不跟着复制
+        dhsstl::intrusive_ptr<ip_counted> a = dhsstl::make_intrusive<ip_counted>(3);
+        dhsstl::intrusive_ptr<ip_counted> b = dhsstl::make_intrusive<ip_counted>(*a);
+        FUN_VALUE(a->use_count());
+        FUN_VALUE(b->use_count());
+    }
+    FUN_VALUE(ip_counted::alive);
+    {
+        ip_manual m;
+        {
+            dhsstl::intrusive_ptr<ip_manual> a(&m);
+            dhsstl::intrusive_ptr<ip_manual> b = a;
+            FUN_VALUE(m.refs);
+        }
+        FUN_VALUE(m.refs);
+        FUN_VALUE(m.released);
+    }
+    {
+        dhsstl::vector<dhsstl::intrusive_ptr<ip_payload<thread_unsafe_counter>>> v;
+        for(uint64_t i = 0; i < 8; ++i)
+            v.push_back(dhsstl::make_intrusive<ip_payload<thread_unsafe_counter>>(7 - i));
+        dhsstl::sort(v.begin(), v.end(), [](const dhsstl::intrusive_ptr<ip_payload<thread_unsafe_counter>>& a,
+                                            const dhsstl::intrusive_ptr<ip_payload<thread_unsafe_counter>>& b){
+            return a->value < b->value;
+        });
+        std::cout << " sorted :";
+        for(auto& p : v)
+            std::cout << " " << p->value << "(" << p->use_count() << ")";
+        std::cout << std::endl;
+    }
+    std::cout << "[--------------------------- ------ END API test ------- -------------------------]" << std::endl;
+}
+
+typedef std::chrono::steady_clock memory_clock;
+
+// 依次测量: 创建 n 个对象, 按随机顺序复制并读取对象 (引用计数加一, 解引用, 减一), 复制整个数组, 销毁
+template <typename Ptr, typename Make>
+void shared_ptr_run(const char* name, size_t n, int rounds, Make make){
+    dhsstl::vector<size_t> order(n);
+    for(size_t i = 0; i < n; ++i)
+        order[i] = i;
+    std::mt19937_64 gen(n);
+    for(size_t i = n; i > 1; --i)
+        dhsstl::swap(order[i - 1], order[gen() % i]);
+
+    auto ms = [](memory_clock::time_point start){
+        return std::chrono::duration<double, std::milli>(memory_clock::now() - start).count();
+    };
+    double best[4] = { 1e300, 1e300, 1e300, 1e300 };
+    volatile uint64_t sink = 0;
+    for(int r = 0; r < rounds; ++r){
+        double t[4];
+        dhsstl::vector<Ptr> v;
+        v.reserve(n);
+        auto start = memory_clock::now();
+        for(size_t i = 0; i < n; ++i)
+            v.push_back(make(i));
+        t[0] = ms(start);
+
+        start = memory_clock::now();
+        uint64_t s = 0;
+        for(size_t i = 0; i < n; ++i){
+            Ptr p = v[order[i]];
+            s += p->value;
+        }
+        sink = s;
+        t[1] = ms(start);
+
+        start = memory_clock::now();
+        {
+            dhsstl::vector<Ptr> copy(v);
+            sink = copy.size();
+        }
+        t[2] = ms(start);
+
+        start = memory_clock::now();
+        v.clear();
+        t[3] = ms(start);
+        for(int i = 0; i < 4; ++i)
+            best[i] = dhsstl::min(best[i], t[i]);
+    }
+    (void)sink;
+    std::cout << " " << name << "\t create : " << best[0] << "\t copy + deref (random) : " << best[1]
+              << "\t copy all : " << best[2] << "\t destroy : " << best[3] << std::endl;
+}
+
+//! @brief shared_ptr(new T), make_shared 以及从对象池中分配的对象的创建, 复制, 销毁耗时
+void shared_ptr_perf(size_t n = 4000000, int rounds = 3){
+    std::cout << "[=================================================================================]" << std::endl;
+    std::cout << "[------------------------ Run performance test : shared_ptr ----------------------]" << std::endl;
+    std::cout << " " << n << " objects of " << sizeof(sp_payload) << " bytes, min of " << rounds
+              << " rounds, time in ms" << std::endl;
+    shared_ptr_run<std::shared_ptr<sp_payload>>("std::shared_ptr(new T)   ", n, rounds,
+        [](size_t i){ return std::shared_ptr<sp_payload>(new sp_payload(i)); });
+    shared_ptr_run<std::shared_ptr<sp_payload>>("std::make_shared         ", n, rounds,
+        [](size_t i){ return std::make_shared<sp_payload>(i); });
+    shared_ptr_run<dhsstl::shared_ptr<sp_payload>>("dhsstl::shared_ptr(new T)", n, rounds,
+        [](size_t i){ return dhsstl::shared_ptr<sp_payload>(new sp_payload(i)); });
+    shared_ptr_run<dhsstl::shared_ptr<sp_payload>>("dhsstl::make_shared      ", n, rounds,
+        [](size_t i){ return dhsstl::make_shared<sp_payload>(i); });
+    sp_pool pool(n);
+    shared_ptr_run<dhsstl::shared_ptr<sp_payload>>("shared_ptr(pool, deleter)", n, rounds,
+        [&pool](size_t i){ return dhsstl::shared_ptr<sp_payload>(pool.acquire(i), sp_pool_deleter{ &pool }); });
+    std::cout << "[--------------------------- ------ END perf test ------ -------------------------]" << std::endl;
+}
+
+// 与默认的 operator++ / operator-- 相同, 所有操作都是 seq_cst, 用来和 thread_safe_counter 比较
+struct seq_cst_counter
+{
+    typedef std::atomic<size_t> type;
+
+    static size_t load(const type& c) noexcept { return c.load(); }
+    static void   increment(type& c) noexcept { ++c; }
+    static bool   decrement(type& c) noexcept { return --c == 0; }
+
+    static bool increment_if_not_zero(type& c) noexcept{
+        size_t n = c.load();
+        do{
+            if(n == 0)
+                return false;
+        }while(!c.compare_exchange_weak(n, n + 1));
+        return true;
+    }
+};
+
+// threads 个线程各自把同一组 shared_ptr 复制 ops 次, 返回总耗时
+// 每次复制都是一次加一和一次减一, 多个线程时计数所在的缓存行在核之间来回传递
+template <typename Ptr>
+double shared_ptr_copy_run(const dhsstl::vector<Ptr>& src, size_t ops, size_t threads){
+    auto work = [&src, ops]{
+        const size_t k = src.size();
+        uint64_t s = 0;
+        for(size_t i = 0; i < ops; ++i){
+            Ptr p = src[i % k];
+            s += *p;
+        }
+        volatile uint64_t sink = s;
+        (void)sink;
+    };
+    auto start = memory_clock::now();
+    if(threads <= 1){
+        work();
+    }else{
+        dhsstl::vector<std::thread> ts;
+        for(size_t t = 0; t < threads; ++t)
+            ts.push_back(std::thread(work));
+        for(auto& t : ts)
+            t.join();
+    }
+    return std::chrono::duration<double, std::milli>(memory_clock::now() - start).count();
+}
+
+template <typename Ptr, typename Make>
+void shared_ptr_copy_row(const char* name, size_t ops, size_t max_threads, Make make){
+    dhsstl::vector<Ptr> src;
+    for(size_t i = 0; i < 16; ++i)
+        src.push_back(make(i));
+    std::cout << " " << name;
+    for(size_t t = 1; t <= max_threads; t *= 2)
+        std::cout << "\t " << shared_ptr_copy_run(src, ops, t);
+    std::cout << std::endl;
+}
+
+//! @brief 复制密集的 shared_ptr: seq_cst 计数, relaxed / release 计数与非原子计数的比较
+//! 注: x86 上原子加减都会编译成 lock xadd, 内存序的区别主要体现在 ARM 等弱内存模型的平台上
+void shared_ptr_copy_perf(size_t ops = 50000000, size_t max_threads = 0){
+    std::cout << "[=================================================================================]" << std::endl;
+    std::cout << "[------------------- Run performance test : shared_ptr copies --------------------]" << std::endl;
+    if(max_threads == 0)
+        max_threads = dhsstl::max<size_t>(std::thread::hardware_concurrency(), 1);
+    std::cout << " " << ops << " copies per thread, time in ms, threads :";
+    for(size_t t = 1; t <= max_threads; t *= 2)
+        std::cout << "\t " << t;
+    std::cout << std::endl;
+    auto value = [](size_t i){ return static_cast<uint64_t>(i); };
+    shared_ptr_copy_row<std::shared_ptr<uint64_t>>("std::shared_ptr            ", ops, max_threads,
+        [&](size_t i){ return std::make_shared<uint64_t>(value(i)); });
+    shared_ptr_copy_row<dhsstl::shared_ptr<uint64_t, seq_cst_counter>>("shared_ptr (seq_cst)       ", ops, max_threads,
+        [&](size_t i){ return dhsstl::detail::allocate_shared_impl<uint64_t, seq_cst_counter,
+                                                                    dhsstl::allocator<uint64_t>>(value(i)); });
+    shared_ptr_copy_row<dhsstl::shared_ptr<uint64_t>>("shared_ptr (relaxed/release)", ops, max_threads,
+        [&](size_t i){ return dhsstl::make_shared<uint64_t>(value(i)); });
+    shared_ptr_copy_row<dhsstl::local_shared_ptr<uint64_t>>("local_shared_ptr            ", ops, 1,
+        [&](size_t i){ return dhsstl::make_local_shared<uint64_t>(value(i)); });
+    std::cout << "[--------------------------- ------ END perf test ------ -------------------------]" << std::endl;
+}
+
+
+// 依次测量: 创建 n 个对象, 按随机顺序复制并读取对象, 按对象的值排序指针数组, 销毁
+template <typename Ptr, typename Make>
+void intrusive_ptr_run(const char* name, size_t n, int rounds, Make make){
+    dhsstl::vector<size_t> order(n);
+    for(size_t i = 0; i < n; ++i)
+        order[i] = i;
+    std::mt19937_64 gen(n);
+    for(size_t i = n; i > 1; --i)
+        dhsstl::swap(order[i - 1], order[gen() % i]);
+
+    auto ms = [](memory_clock::time_point start){
+        return std::chrono::duration<double, std::milli>(memory_clock::now() - start).count();
+    };
+    auto by_value = [](const Ptr& a, const Ptr& b){ return a->value < b->value; };
+    double best[4] = { 1e300, 1e300, 1e300, 1e300 };
+    volatile uint64_t sink = 0;
+    for(int r = 0; r < rounds; ++r){
+        double t[4];
+        dhsstl::vector<Ptr> v;
+        v.reserve(n);
+        auto start = memory_clock::now();
+        for(size_t i = 0; i < n; ++i)
+            v.push_back(make(order[i]));
+        t[0] = ms(start);
+
+        start = memory_clock::now();
+        uint64_t s = 0;
+        for(size_t i = 0; i < n; ++i){
+            Ptr p = v[order[i]];
+            s += p->value;
+        }
+        sink = s;
+        t[1] = ms(start);
+
+        start = memory_clock::now();
+        dhsstl::sort(v.begin(), v.end(), by_value);
+        t[2] = ms(start);
+        sink = v[n / 2]->value;
+
+        start = memory_clock::now();
+        v.clear();
+        t[3] = ms(start);
+        for(int i = 0; i < 4; ++i)
+            best[i] = dhsstl::min(best[i], t[i]);
+    }
+    (void)sink;
+    std::cout << " " << name << "\t sizeof : " << sizeof(Ptr) << "\t create : " << best[0]
+              << "\t copy + deref (random) : " << best[1] << "\t sort : " << best[2]
+              << "\t destroy : " << best[3] << std::endl;
+}
+
+//! @brief intrusive_ptr 与 make_shared 得到的 shared_ptr 的复制, 排序指针数组和销毁耗时
+void intrusive_ptr_perf(size_t n = 4000000, int rounds = 3){
+    std::cout << "[=================================================================================]" << std::endl;
+    std::cout << "[---------------------- Run performance test : intrusive_ptr ---------------------]" << std::endl;
+    std::cout << " " << n << " objects of " << sizeof(sp_payload) << " bytes, min of " << rounds
+              << " rounds, time in ms" << std::endl;
+    intrusive_ptr_run<dhsstl::shared_ptr<sp_payload>>("dhsstl::make_shared           ", n, rounds,
+        [](size_t i){ return dhsstl::make_shared<sp_payload>(i); });
+    intrusive_ptr_run<dhsstl::local_shared_ptr<sp_payload>>("dhsstl::make_local_shared     ", n, rounds,
+        [](size_t i){ return dhsstl::make_local_shared<sp_payload>(i); });
+    intrusive_ptr_run<dhsstl::intrusive_ptr<ip_payload<thread_safe_counter>>>("intrusive_ptr (atomic)        ", n, rounds,
+        [](size_t i){ return dhsstl::make_intrusive<ip_payload<thread_safe_counter>>(i); });
+    intrusive_ptr_run<dhsstl::intrusive_ptr<ip_payload<thread_unsafe_counter>>>("intrusive_ptr (thread_unsafe) ", n, rounds,
+        [](size_t i){ return dhsstl::make_intrusive<ip_payload<thread_unsafe_counter>>(i); });
+    std::cout << "[--------------------------- ------ END perf test ------ -------------------------]" << std::endl;
+}
+// ------------------------------------------------
+// uninitialized_* 的测试
+// ------------------------------------------------
+// 第 throw_at 次复制时抛出异常, alive 记录存活的对象个数
+struct un_throwing
+{
+    static int alive;
+    static int copies;
+    static int throw_at;
+    int        value;
+
+    explicit un_throwing(int v = 0) : value(v) { ++alive; }
+    un_throwing(const un_throwing& rhs) : value(rhs.value){
+        if(++copies == throw_at)
+            throw std::runtime_error("copy failed");
+        ++alive;
+    }
+    ~un_throwing() { --alive; }
+};
+int un_throwing::alive = 0;
+int un_throwing::copies = 0;
+int un_throwing::throw_at = 0;
+
+// 复制构造不平凡但不抛出异常, 走不带 try / catch 的路径
+struct un_nothrow
+{
+    int value;
+    int twice;
+
+    explicit un_nothrow(int v = 0) noexcept : value(v), twice(2 * v) {}
+    un_nothrow(const un_nothrow& rhs) noexcept : value(rhs.value), twice(rhs.twice) {}
+    un_nothrow& operator=(const un_nothrow&) = default;
+};
+
+// 执行 f, 返回是否捕获到异常
+template <typename F>
+bool un_throws(F f){
+    un_throwing::copies = 0;
+    try{
+        f();
+    }catch(const std::runtime_error&){
+        return true;
+    }
+    return false;
+}
+
+//! @brief uninitialized_copy / copy_n / fill / fill_n / move 的功能测试, 包括构造失败时的回滚
+void uninitialized_test(){
+    std::cout << "[=================================================================================]" << std::endl;
+    std::cout << "[------------------------ Run API test : uninitialized ---------------------------]" << std::endl;
+    std::cout << std::boolalpha;
+    FUN_VALUE(dhsstl::uninit_trivial_copy<int>::value);
+    FUN_VALUE(dhsstl::uninit_trivial_copy<un_nothrow>::value);
+    FUN_VALUE((std::is_nothrow_copy_constructible<un_nothrow>::value));
+    FUN_VALUE((std::is_nothrow_copy_constructible<un_throwing>::value));
+
+    {
+        int src[5] = { 1, 2, 3, 4, 5 };
+        int dst[5] = {};
+        FUN_VALUE((dhsstl::uninitialized_copy(src, src + 5, dst) == dst + 5));
+        FUN_VALUE(dst[4]);
+        dhsstl::vector<int> v(src, src + 5);
+        int n_dst[3] = {};
+        FUN_VALUE((dhsstl::uninitialized_copy_n(v.begin() + 1, 3, n_dst) == n_dst + 3));
+        FUN_VALUE(n_dst[2]);
+    }
+    {
+        // 平凡类型填充全 0 字节的值时用 memset, -0.0 不是全 0 字节, 逐个赋值
+        double d[4] = { 1.0, 1.0, 1.0, 1.0 };
+        dhsstl::uninitialized_fill(d, d + 4, 0.0);
+        FUN_VALUE(d[3]);
+        dhsstl::uninitialized_fill_n(d, 4, -0.0);
+        FUN_VALUE(std::signbit(d[3]));
+        int x = 0;
+        int* ptrs[3] = { &x, &x, &x };
+        dhsstl::uninitialized_fill_n(ptrs, 3, static_cast<int*>(nullptr));
+        FUN_VALUE((ptrs[0] == nullptr));
+    }
+    {
+        un_nothrow src[3] = { un_nothrow(1), un_nothrow(2), un_nothrow(3) };
+        alignas(un_nothrow) unsigned char raw[sizeof(src)];
+        un_nothrow* dst = reinterpret_cast<un_nothrow*>(raw);
+        dhsstl::uninitialized_copy(src, src + 3, dst);
+        FUN_VALUE(dst[2].twice);
+        dhsstl::uninitialized_fill_n(dst, 3, un_nothrow(4));
+        FUN_VALUE(dst[0].twice);
+    }
+    {
+        dhsstl::vector<std::string> src;
+        src.push_back("a");
+        src.push_back(std::string(40, 'b'));
+        alignas(std::string) unsigned char raw[2 * sizeof(std::string)];
+        std::string* dst = reinterpret_cast<std::string*>(raw);
+        dhsstl::uninitialized_move(src.begin(), src.end(), dst);
+        FUN_VALUE(dst[1].size());
+        FUN_VALUE(src[1].empty());
+        dhsstl::destroy(dst, dst + 2);
+    }
+
+    // 第 3 次复制失败: 已经构造的 2 个对象被析构, 异常传给调用者
+    {
+        un_throwing src[5] = { un_throwing(1), un_throwing(2), un_throwing(3), un_throwing(4), un_throwing(5) };
+        alignas(un_throwing) unsigned char raw[sizeof(src)];
+        un_throwing* dst = reinterpret_cast<un_throwing*>(raw);
+        un_throwing::throw_at = 3;
+        FUN_VALUE(un_throwing::alive);
+        FUN_VALUE(un_throws([&]{ dhsstl::uninitialized_copy(src, src + 5, dst); }));
+        FUN_VALUE(un_throwing::alive);
+        FUN_VALUE(un_throws([&]{ dhsstl::uninitialized_copy_n(src, 5, dst); }));
+        FUN_VALUE(un_throwing::alive);
+        FUN_VALUE(un_throws([&]{ dhsstl::uninitialized_fill(dst, dst + 5, src[0]); }));
+        FUN_VALUE(un_throwing::alive);
+        FUN_VALUE(un_throws([&]{ dhsstl::uninitialized_fill_n(dst, 5, src[0]); }));
+        FUN_VALUE(un_throwing::alive);
+        FUN_VALUE(un_throws([&]{ dhsstl::uninitialized_move(src, src + 5, dst); }));
+        FUN_VALUE(un_throwing::alive);
+        FUN_VALUE(un_throws([&]{ dhsstl::uninitialized_move_n(src, 5, dst); }));
+        FUN_VALUE(un_throwing::alive);
+        // 不抛出异常时全部构造成功
+        un_throwing::throw_at = 0;
+        FUN_VALUE(un_throws([&]{ dhsstl::uninitialized_copy_n(src, 5, dst); }));
+        FUN_VALUE(un_throwing::alive);
+        dhsstl::destroy(dst, dst + 5);
+    }
+    FUN_VALUE(un_throwing::alive);
+    std::cout << "[--------------------------- ------ END API test ------- -------------------------]" << std::endl;
+}
+
+// 24 字节的平凡类型
+struct un_pod
+{
+    int64_t a;
+    int64_t b;
+    int64_t c;
+};
+
+// 对 n 个元素重复执行 op(dst) 和 destroy, 返回每个元素的最小耗时 (ns)
+template <typename T, typename Op>
+double uninitialized_run(size_t n, int rounds, Op op){
+    T* dst = static_cast<T*>(::operator new(n * sizeof(T)));
+    double best = 1e300;
+    for(int r = 0; r < rounds; ++r){
+        auto start = memory_clock::now();
+        op(dst);
+        double t = std::chrono::duration<double, std::nano>(memory_clock::now() - start).count();
+        best = dhsstl::min(best, t / n);
+        dhsstl::destroy(dst, dst + n);
+    }
+    ::operator delete(dst);
+    return best;
+}
+
+template <typename T>
+void uninitialized_copy_row(const char* name, const dhsstl::vector<T>& src, int rounds){
+    const size_t n = src.size();
+    double std_copy = uninitialized_run<T>(n, rounds, [&](T* d){ std::uninitialized_copy(src.begin(), src.end(), d); });
+    double dhs_copy = uninitialized_run<T>(n, rounds, [&](T* d){ dhsstl::uninitialized_copy(src.begin(), src.end(), d); });
+    double std_fill = uninitialized_run<T>(n, rounds, [&](T* d){ std::uninitialized_fill_n(d, n, src[1]); });
+    double dhs_fill = uninitialized_run<T>(n, rounds, [&](T* d){ dhsstl::uninitialized_fill_n(d, n, src[1]); });
+    std::cout << " " << name << "\t copy std : " << std_copy << "\t dhsstl : " << dhs_copy
+              << "\t fill_n std : " << std_fill << "\t dhsstl : " << dhs_fill << std::endl;
+}
+
+//! @brief uninitialized_copy / fill_n 与 std 版本的比较, 以及填充 0 和非 0 值的耗时
+void uninitialized_perf(size_t n = 4000000, int rounds = 5){
+    std::cout << "[=================================================================================]" << std::endl;
+    std::cout << "[------------------------ Run performance test : uninitialized -------------------]" << std::endl;
+    std::cout << " " << n << " elements, min of " << rounds << " rounds, ns per element" << std::endl;
+    dhsstl::vector<int> ints(n);
+    dhsstl::vector<un_pod> pods(n);
+    dhsstl::vector<un_nothrow> nothrows(n);
+    dhsstl::vector<std::string> strings(n / 4);
+    for(size_t i = 0; i < n; ++i){
+        ints[i] = static_cast<int>(i);
+        pods[i] = un_pod{ static_cast<int64_t>(i), 1, 2 };
+        nothrows[i] = un_nothrow(static_cast<int>(i));
+    }
+    for(size_t i = 0; i < strings.size(); ++i)
+        strings[i] = std::to_string(i);
+    uninitialized_copy_row("int        ", ints, rounds);
+    uninitialized_copy_row("pod (24 B) ", pods, rounds);
+    uninitialized_copy_row("nothrow    ", nothrows, rounds);
+    uninitialized_copy_row("std::string", strings, rounds);
+
+    // 平凡类型的值全为 0 字节时用 memset
+    double fill_zero = uninitialized_run<un_pod>(n, rounds, [&](un_pod* d){ dhsstl::uninitialized_fill_n(d, n, un_pod{ 0, 0, 0 }); });
+    double fill_one = uninitialized_run<un_pod>(n, rounds, [&](un_pod* d){ dhsstl::uninitialized_fill_n(d, n, un_pod{ 1, 1, 1 }); });
+    std::cout << " pod (24 B) \t fill_n zero : " << fill_zero << "\t fill_n non-zero : " << fill_one << std::endl;
+    std::cout << "[--------------------------- ------ END perf test ------ -------------------------]" << std::endl;
+}
+} // namespace test
+} // namespace dhsstl
+#endif
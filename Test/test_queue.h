@@ -1,6 +1,7 @@
 #ifndef DHSTINYSTL_TEST_QUEUE_H_
 #define DHSTINYSTL_TEST_QUEUE_H_
 
+#include <ctime>
 #include <iostream>
 #include <queue>
 
@@ -141,6 +142,56 @@ void priority_queue_test() {
     std::cout << "[--------------------------- ------ END API test ------- -------------------------]" << std::endl;
 }
 
+// 统计分配次数的分配器, 用于观察 deque 缓冲区的分配
+template <typename T>
+struct counting_allocator : public dhsstl::allocator<T> {
+    static size_t count;
+    static T* allocate(){ ++count; return dhsstl::allocator<T>::allocate(); }
+    static T* allocate(size_t n){ ++count; return dhsstl::allocator<T>::allocate(n); }
+};
+template <typename T>
+size_t counting_allocator<T>::count = 0;
+
+// 先压入 depth 个元素, 再做 n 次 push / pop, 统计稳定之后的分配次数
+template <size_t BufSize>
+void queue_churn_run(size_t depth, size_t n){
+    typedef counting_allocator<int> alloc;
+    dhsstl::queue<int, dhsstl::deque<int, alloc, BufSize>> q;
+    for(size_t i = 0; i < depth; ++i)
+        q.push(static_cast<int>(i));
+    alloc::count = 0;
+    clock_t start = clock();
+    for(size_t i = 0; i < n; ++i){
+        q.push(static_cast<int>(i));
+        q.pop();
+    }
+    std::cout << " block size " << dhsstl::deque_buf_size<int, BufSize>::value << "\t: " << clock() - start
+              << ", allocations after warm-up: " << alloc::count << std::endl;
+}
+
+//! @brief queue<int> 作为 FIFO 反复 push / pop 时, 不同缓冲区大小的耗时与分配次数
+void queue_churn_perf(size_t depth = 1000, size_t n = 100000000){
+    std::cout << "[=================================================================================]" << std::endl;
+    std::cout << "[----------------------- Run performance test : queue churn -----------------------]" << std::endl;
+    clock_t start = clock();
+    {
+        std::queue<int> q;
+        for(size_t i = 0; i < depth; ++i)
+            q.push(static_cast<int>(i));
+        for(size_t i = 0; i < n; ++i){
+            q.push(static_cast<int>(i));
+            q.pop();
+        }
+    }
+    std::cout << " std::queue<int>\t: " << clock() - start << std::endl;
+    queue_churn_run<16>(depth, n);
+    queue_churn_run<64>(depth, n);
+    queue_churn_run<256>(depth, n);
+    queue_churn_run<0>(depth, n);
+    queue_churn_run<4096>(depth, n);
+    std::cout << "[--------------------------- ------ END perf test ------ -------------------------]" << std::endl;
+}
+
 } // namespace test
 } // namespace dhsstl
 #endif
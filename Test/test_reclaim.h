@@ -0,0 +1,265 @@
+#ifndef DHSTINYSTL_TEST_RECLAIM_H_
+#define DHSTINYSTL_TEST_RECLAIM_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "atomic_shared_ptr.h"
+#include "reclaim.h"
+#include "vector.h"
+#include "test.h"
+
+namespace dhsstl {
+namespace test {
+
+// 记录存活个数的节点, 多个线程同时释放
+struct rc_node
+{
+    static std::atomic<int> alive;
+    uint64_t                value;
+
+    explicit rc_node(uint64_t v = 0) : value(v) { alive.fetch_add(1, std::memory_order_relaxed); }
+    ~rc_node() { alive.fetch_sub(1, std::memory_order_relaxed); }
+};
+std::atomic<int> rc_node::alive(0);
+
+// 发布给读者的配置快照, 所有字段都等于 version, 读者可以检查读到的是否是完整的一份
+struct rc_config
+{
+    uint64_t version;
+    uint64_t values[7];
+
+    explicit rc_config(uint64_t v) : version(v){
+        for(auto& x : values)
+            x = v;
+    }
+    bool consistent() const{
+        for(auto x : values)
+            if(x != version)
+                return false;
+        return true;
+    }
+};
+
+//! @brief hazard pointer, epoch 和 atomic_shared_ptr 的功能测试
+void reclaim_test(){
+    std::cout << "[=================================================================================]" << std::endl;
+    std::cout << "[------------------------- Run API test : reclaim --------------------------------]" << std::endl;
+    {
+        // 被保护的节点在 hazard pointer 重置之前不会释放
+        std::atomic<rc_node*> head(new rc_node(1));
+        dhsstl::hazard_pointer hp;
+        rc_node* p = hp.protect(head);
+        head.store(new rc_node(2));
+        dhsstl::hazard_retire(p);
+        dhsstl::hazard_scan();
+        FUN_VALUE(p->value);
+        FUN_VALUE(dhsstl::hazard_domain::pending());
+        hp.reset();
+        dhsstl::hazard_scan();
+        FUN_VALUE(dhsstl::hazard_domain::pending());
+        delete head.load();
+        FUN_VALUE(rc_node::alive.load());
+    }
+    {
+        // 读者停在 epoch_guard 中时节点不会释放, 离开之后推进两代即可释放
+        rc_node* p = new rc_node(3);
+        {
+            dhsstl::epoch_guard g;
+            dhsstl::epoch_retire(p);
+            for(int i = 0; i < 4; ++i)
+                dhsstl::epoch_collect();
+            FUN_VALUE(dhsstl::epoch_domain::pending());
+        }
+        for(int i = 0; i < 3; ++i)
+            dhsstl::epoch_collect();
+        FUN_VALUE(dhsstl::epoch_domain::pending());
+        FUN_VALUE(rc_node::alive.load());
+    }
+    {
+        dhsstl::atomic_shared_ptr<rc_node> a;
+        FUN_VALUE(a.is_lock_free());
+        FUN_VALUE((a.load() == nullptr));
+        a.store(dhsstl::make_shared<rc_node>(4));
+        FUN_VALUE(a.load()->value);
+        {
+            auto s = a.read();
+            a.store(dhsstl::make_shared<rc_node>(5));
+            dhsstl::hazard_scan();
+            // 旧的对象仍由 snapshot 保护
+            FUN_VALUE(s->value);
+            FUN_VALUE(rc_node::alive.load());
+        }
+        dhsstl::hazard_scan();
+        FUN_VALUE(rc_node::alive.load());
+
+        dhsstl::shared_ptr<rc_node> expected = dhsstl::make_shared<rc_node>(6);
+        FUN_VALUE(a.compare_exchange_strong(expected, dhsstl::make_shared<rc_node>(7)));
+        FUN_VALUE(expected->value);
+        FUN_VALUE(a.compare_exchange_strong(expected, dhsstl::make_shared<rc_node>(8)));
+        FUN_VALUE(a.load()->value);
+        dhsstl::shared_ptr<rc_node> old = a.exchange(nullptr);
+        FUN_VALUE(old->value);
+        FUN_VALUE((a.read().get() == nullptr));
+    }
+    dhsstl::hazard_scan();
+    FUN_VALUE(rc_node::alive.load());
+    {
+        // 一个写者不停发布新的配置, 读者检查读到的快照是完整的
+        const int readers = 4;
+        const uint64_t writes = 20000;
+        std::atomic<bool> stop(false);
+        std::atomic<uint64_t> torn(0);
+        dhsstl::atomic_shared_ptr<rc_config> cfg(dhsstl::make_shared<rc_config>(0));
+        std::atomic<rc_config*> raw(new rc_config(0));
+
+        dhsstl::vector<std::thread> ts;
+        for(int r = 0; r < readers; ++r){
+            ts.push_back(std::thread([&, r]{
+                uint64_t last = 0;
+                while(!stop.load(std::memory_order_relaxed)){
+                    if(r % 2 == 0){
+                        auto s = cfg.read();
+                        if(!s->consistent() || s->version < last)
+                            torn.fetch_add(1);
+                        last = s->version;
+                    }else{
+                        dhsstl::shared_ptr<rc_config> p = cfg.load();
+                        if(!p->consistent())
+                            torn.fetch_add(1);
+                    }
+                    dhsstl::epoch_guard g;
+                    if(!raw.load(std::memory_order_acquire)->consistent())
+                        torn.fetch_add(1);
+                }
+            }));
+        }
+        for(uint64_t i = 1; i <= writes; ++i){
+            cfg.store(dhsstl::make_shared<rc_config>(i));
+            dhsstl::epoch_retire(raw.exchange(new rc_config(i), std::memory_order_acq_rel));
+            if(i % 64 == 0)
+                std::this_thread::yield();
+        }
+        stop.store(true);
+        for(auto& t : ts)
+            t.join();
+        FUN_VALUE(torn.load());
+        FUN_VALUE(cfg.load()->version);
+        delete raw.load();
+    }
+    dhsstl::hazard_scan();
+    for(int i = 0; i < 3; ++i)
+        dhsstl::epoch_collect();
+    FUN_VALUE(dhsstl::hazard_domain::pending());
+    FUN_VALUE(dhsstl::epoch_domain::pending());
+    std::cout << "[--------------------------- ------ END API test ------- -------------------------]" << std::endl;
+}
+
+typedef std::chrono::steady_clock reclaim_clock;
+
+// threads 个读者各读 reads 次快照, 同时一个写者每隔 period_us 微秒发布一次新的配置
+// 返回所有读者的总吞吐量, 单位为 百万次读 / 秒
+template <typename Read, typename Publish>
+double snapshot_run(size_t threads, uint64_t reads, unsigned period_us, Read read, Publish publish){
+    std::atomic<bool> stop(false);
+    std::thread writer([&]{
+        uint64_t v = 1;
+        while(!stop.load(std::memory_order_relaxed)){
+            publish(v++);
+            std::this_thread::sleep_for(std::chrono::microseconds(period_us));
+        }
+    });
+    auto work = [&]{
+        uint64_t s = 0;
+        for(uint64_t i = 0; i < reads; ++i)
+            s += read(i);
+        volatile uint64_t sink = s;
+        (void)sink;
+    };
+    auto start = reclaim_clock::now();
+    dhsstl::vector<std::thread> ts;
+    for(size_t t = 0; t < threads; ++t)
+        ts.push_back(std::thread(work));
+    for(auto& t : ts)
+        t.join();
+    double ms = std::chrono::duration<double, std::milli>(reclaim_clock::now() - start).count();
+    stop.store(true);
+    writer.join();
+    return static_cast<double>(reads) * threads / ms / 1000.0;
+}
+
+template <typename Read, typename Publish>
+void snapshot_row(const char* name, size_t max_threads, uint64_t reads, unsigned period_us,
+                  Read read, Publish publish){
+    std::cout << " " << name;
+    for(size_t t = 1; t <= max_threads; t *= 2)
+        std::cout << "\t " << snapshot_run(t, reads, period_us, read, publish);
+    std::cout << std::endl;
+}
+
+//! @brief 快照发布: 一个写者定期发布新配置, 1 到 max_threads 个读者反复读取
+//! std::atomic_load(std::shared_ptr) 在 libstdc++ 中用一组互斥量实现, 作为基准
+void snapshot_publish_perf(uint64_t reads = 10000000, size_t max_threads = 0, unsigned period_us = 1000){
+    std::cout << "[=================================================================================]" << std::endl;
+    std::cout << "[-------------------- Run performance test : snapshot publish --------------------]" << std::endl;
+    if(max_threads == 0)
+        max_threads = dhsstl::max<size_t>(std::thread::hardware_concurrency(), 1);
+    std::cout << " " << reads << " reads per thread, one store every " << period_us
+              << " us, million reads / s, threads :";
+    for(size_t t = 1; t <= max_threads; t *= 2)
+        std::cout << "\t " << t;
+    std::cout << std::endl;
+    {
+        std::shared_ptr<rc_config> cfg = std::make_shared<rc_config>(0);
+        snapshot_row("std::atomic_load(shared_ptr)   ", max_threads, reads, period_us,
+            [&](uint64_t i){ return std::atomic_load(&cfg)->values[i & 3]; },
+            [&](uint64_t v){ std::atomic_store(&cfg, std::make_shared<rc_config>(v)); });
+    }
+    {
+        std::mutex mtx;
+        dhsstl::shared_ptr<rc_config> cfg = dhsstl::make_shared<rc_config>(0);
+        snapshot_row("mutex + shared_ptr copy        ", max_threads, reads, period_us,
+            [&](uint64_t i){
+                dhsstl::shared_ptr<rc_config> p;
+                {
+                    std::lock_guard<std::mutex> lk(mtx);
+                    p = cfg;
+                }
+                return p->values[i & 3];
+            },
+            [&](uint64_t v){
+                dhsstl::shared_ptr<rc_config> p = dhsstl::make_shared<rc_config>(v);
+                std::lock_guard<std::mutex> lk(mtx);
+                cfg.swap(p);
+            });
+    }
+    {
+        dhsstl::atomic_shared_ptr<rc_config> cfg(dhsstl::make_shared<rc_config>(0));
+        snapshot_row("atomic_shared_ptr::load        ", max_threads, reads, period_us,
+            [&](uint64_t i){ return cfg.load()->values[i & 3]; },
+            [&](uint64_t v){ cfg.store(dhsstl::make_shared<rc_config>(v)); });
+        snapshot_row("atomic_shared_ptr::read        ", max_threads, reads, period_us,
+            [&](uint64_t i){ return cfg.read()->values[i & 3]; },
+            [&](uint64_t v){ cfg.store(dhsstl::make_shared<rc_config>(v)); });
+    }
+    {
+        std::atomic<rc_config*> cfg(new rc_config(0));
+        snapshot_row("atomic<T*> + epoch_guard       ", max_threads, reads, period_us,
+            [&](uint64_t i){
+                dhsstl::epoch_guard g;
+                return cfg.load(std::memory_order_acquire)->values[i & 3];
+            },
+            [&](uint64_t v){ dhsstl::epoch_retire(cfg.exchange(new rc_config(v), std::memory_order_acq_rel)); });
+        delete cfg.load();
+    }
+    std::cout << "[--------------------------- ------ END perf test ------ -------------------------]" << std::endl;
+}
+
+} // namespace test
+} // namespace dhsstl
+#endif
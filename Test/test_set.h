@@ -1,10 +1,14 @@
 #ifndef DHSTINYSTL_TEST_SET_H_
 #define DHSTINYSTL_TEST_SET_H_
+#include <chrono>
 #include <iostream>
+#include <random>
 #include <set>
+#include <string>
 #include <functional>
 
 #include "set.h"
+#include "vector.h"
 #include "test.h"
 
 
@@ -124,6 +128,117 @@ void set_test(){
         FUN_VALUE(s1.max_size());
         std::cout << "[--------------------------- ------ END API test ------- -------------------------]" << std::endl;
     }
+
+// ---------------------------------------------------------------------------------------------------------------------
+//! @brief 从区间构造以及复制的 set 中节点批量分配, 之后的插入删除复用块中的节点
+void set_batch_test(){
+    std::cout << "[=================================================================================]" << std::endl;
+    std::cout << "[------------------------ Run API test : set batch nodes -------------------------]" << std::endl;
+    dhsstl::vector<int> v;
+    for(int i = 0; i < 1000; ++i)
+        v.push_back(i * 7 % 1000);
+    dhsstl::set<int> s1(v.begin(), v.end());
+    FUN_VALUE(s1.size());
+    FUN_VALUE(*s1.begin());
+    FUN_VALUE(*s1.rbegin());
+    for(int i = 0; i < 1000; i += 2)
+        s1.erase(i);
+    for(int i = 1000; i < 3000; ++i)
+        s1.insert(i);
+    FUN_VALUE(s1.size());
+    FUN_VALUE(s1.count(998));
+    FUN_VALUE(s1.count(999));
+    dhsstl::set<int> s2(s1);
+    FUN_VALUE((s1 == s2));
+    dhsstl::set<int> s3;
+    s3 = s2;
+    s2.clear();
+    FUN_VALUE((s1 == s3));
+    s2.insert(v.begin(), v.end());
+    FUN_VALUE(s2.size());
+    s2.swap(s3);
+    dhsstl::set<int> s4(dhsstl::move(s2));
+    FUN_VALUE((s1 == s4));
+    FUN_VALUE(s3.size());
+    dhsstl::multiset<std::string> ms;
+    for(int i = 0; i < 100; ++i)
+        v[i] = i % 10;
+    dhsstl::vector<std::string> words;
+    for(int i = 0; i < 100; ++i)
+        words.push_back(std::to_string(v[i]));
+    ms.insert(words.begin(), words.end());
+    FUN_VALUE(ms.size());
+    FUN_VALUE(ms.count("3"));
+    ms.erase(ms.begin(), ms.find("5"));
+    FUN_VALUE(ms.size());
+    std::cout << "[--------------------------- ------ END API test ------- -------------------------]" << std::endl;
+}
+
+typedef std::chrono::steady_clock set_clock;
+
+// 从 v 构造 set, 复制一次, 再析构两者, 每一项保留最小值(毫秒)
+template <typename Set, typename Build>
+void set_build_measure(double* best, const dhsstl::vector<int>& v, Build build){
+    auto ms = [](set_clock::time_point start){
+        return std::chrono::duration<double, std::milli>(set_clock::now() - start).count();
+    };
+    double t[3];
+    auto start = set_clock::now();
+    Set* s = build(v);
+    t[0] = ms(start);
+    start = set_clock::now();
+    Set* c = new Set(*s);
+    t[1] = ms(start);
+    start = set_clock::now();
+    delete s;
+    delete c;
+    t[2] = ms(start);
+    for(int i = 0; i < 3; ++i)
+        best[i] = dhsstl::min(best[i], t[i]);
+}
+
+//! @brief 从 vector 构造 n 个元素的 set: 逐个分配节点与批量分配节点比较构造, 复制和析构
+void set_build_perf(size_t n = 10000000, int rounds = 3){
+    std::cout << "[=================================================================================]" << std::endl;
+    std::cout << "[-------------------- Run performance test : set range build ---------------------]" << std::endl;
+    for(bool shuffled : { false, true }){
+        dhsstl::vector<int> v;
+        for(size_t i = 0; i < n; ++i)
+            v.push_back(static_cast<int>(i));
+        if(shuffled){
+            std::mt19937_64 gen(n);
+            for(size_t i = n - 1; i > 0; --i)
+                dhsstl::swap(v[i], v[gen() % (i + 1)]);
+        }
+        double best[3][3];
+        for(auto& b : best)
+            for(auto& x : b)
+                x = 1e300;
+        for(int r = 0; r < rounds; ++r){
+            set_build_measure<std::set<int>>(best[0], v, [](const dhsstl::vector<int>& v){
+                return new std::set<int>(v.begin(), v.end());
+            });
+            // 逐个插入, 每个节点单独分配
+            set_build_measure<dhsstl::set<int>>(best[1], v, [](const dhsstl::vector<int>& v){
+                auto s = new dhsstl::set<int>();
+                for(auto x : v)
+                    s->insert(x);
+                return s;
+            });
+            set_build_measure<dhsstl::set<int>>(best[2], v, [](const dhsstl::vector<int>& v){
+                return new dhsstl::set<int>(v.begin(), v.end());
+            });
+        }
+        std::cout << " set<int> x " << n << (shuffled ? " shuffled" : " in order") << ", min of "
+                  << rounds << " rounds, time in ms" << std::endl;
+        const char* impl[3] = { "std::set(first, last)   ", "insert one by one       ", "set(first, last) batch  " };
+        for(int i = 0; i < 3; ++i){
+            std::cout << "   " << impl[i] << "\t build : " << best[i][0] << "\t copy : " << best[i][1]
+                      << "\t destroy both : " << best[i][2] << std::endl;
+        }
+    }
+    std::cout << "[--------------------------- ------ END perf test ------ -------------------------]" << std::endl;
+}
 } // namespace test
 } // namespace dhsstl
 
@@ -0,0 +1,186 @@
+#ifndef DHSTINYSTL_TEST_THREAD_POOL_H_
+#define DHSTINYSTL_TEST_THREAD_POOL_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+#include "thread_pool.h"
+#include "vector.h"
+#include "test.h"
+
+namespace dhsstl {
+namespace test {
+
+typedef std::chrono::steady_clock tp_clock;
+
+inline double tp_elapsed_ms(tp_clock::time_point start){
+    return std::chrono::duration<double, std::milli>(tp_clock::now() - start).count();
+}
+
+inline uint64_t fib_serial(unsigned n){
+    return n < 2 ? n : fib_serial(n - 1) + fib_serial(n - 2);
+}
+
+// fork-join 版本的 fib, n 小于 cutoff 时串行计算
+inline uint64_t fib_parallel(dhsstl::thread_pool& pool, unsigned n, unsigned cutoff){
+    if(n < cutoff)
+        return fib_serial(n);
+    uint64_t a = 0;
+    dhsstl::task_group g(pool);
+    g.spawn([&]{ a = fib_parallel(pool, n - 1, cutoff); });
+    const uint64_t b = fib_parallel(pool, n - 2, cutoff);
+    g.sync();
+    return a + b;
+}
+
+// 每块算出局部和, 再原子地累加
+inline uint64_t parallel_sum(dhsstl::thread_pool& pool, const uint64_t* data, size_t n){
+    std::atomic<uint64_t> total(0);
+    pool.parallel_for(size_t(0), n, size_t(0), [&](size_t lo, size_t hi){
+        uint64_t s = 0;
+        for(size_t i = lo; i < hi; ++i)
+            s += data[i];
+        total.fetch_add(s, std::memory_order_relaxed);
+    });
+    return total.load();
+}
+
+//! @brief 功能测试: work_stealing_deque 的窃取, parallel_for 的覆盖, 嵌套的 spawn / sync 以及异常
+void thread_pool_test(){
+    std::cout << "[=================================================================================]" << std::endl;
+    std::cout << "[-------------------------- Run API test : thread pool ---------------------------]" << std::endl;
+    {
+        // 所有者 push / pop, 同时多个窃取者 steal, 每个元素恰好被取出一次
+        const size_t n = 200000;
+        dhsstl::work_stealing_deque<size_t> dq(4);
+        std::unique_ptr<std::atomic<int>[]> seen(new std::atomic<int>[n]);
+        for(size_t i = 0; i < n; ++i)
+            seen[i].store(0);
+        std::atomic<bool> done(false);
+        dhsstl::vector<std::thread> thieves;
+        for(int i = 0; i < 3; ++i){
+            thieves.emplace_back([&]{
+                size_t x;
+                while(!done.load()){
+                    if(dq.steal(x))
+                        seen[x].fetch_add(1);
+                    else
+                        std::this_thread::yield();
+                }
+            });
+        }
+        size_t x;
+        for(size_t i = 0; i < n; ++i){
+            dq.push(i);
+            if(i % 3 == 0 && dq.pop(x))
+                seen[x].fetch_add(1);
+        }
+        while(dq.pop(x))
+            seen[x].fetch_add(1);
+        done.store(true);
+        for(auto& t : thieves)
+            t.join();
+        bool once = true;
+        for(size_t i = 0; i < n; ++i)
+            once = once && seen[i].load() == 1;
+        std::cout << " work_stealing_deque each element once : " << (once ? "true" : "false") << std::endl;
+    }
+    {
+        dhsstl::thread_pool pool(4);
+        FUN_VALUE(pool.size());
+        dhsstl::vector<int> hit(100000, 0);
+        pool.parallel_for(size_t(0), hit.size(), size_t(64), [&](size_t lo, size_t hi){
+            for(size_t i = lo; i < hi; ++i)
+                ++hit[i];
+        });
+        bool once = true;
+        for(auto h : hit)
+            once = once && h == 1;
+        std::cout << " parallel_for each index once : " << (once ? "true" : "false") << std::endl;
+        FUN_VALUE(fib_parallel(pool, 25, 10));
+        FUN_VALUE(fib_serial(25));
+
+        dhsstl::task_group g(pool);
+        g.spawn([]{ throw std::runtime_error("task failed"); });
+        g.spawn([]{});
+        try{
+            g.sync();
+            std::cout << " sync did not throw" << std::endl;
+        }
+        catch(const std::runtime_error& e){
+            std::cout << " sync rethrows : " << e.what() << std::endl;
+        }
+    }
+    {
+        // 线程池析构时还有没执行的任务: 工作线程的队列和注入队列里的任务都要被释放
+        // 每个任务持有一个 shared_ptr, 全部释放后 use_count 回到 1
+        std::unique_ptr<dhsstl::thread_pool> pool(new dhsstl::thread_pool(1));
+        dhsstl::task_group g(*pool);
+        std::shared_ptr<int> token = std::make_shared<int>(0);
+        std::atomic<bool> started(false), release(false);
+        g.spawn([&, token]{
+            for(int i = 0; i < 100; ++i)
+                g.spawn([token]{ ++*token; });
+            started.store(true);
+            while(!release.load())
+                std::this_thread::yield();
+        });
+        while(!started.load())
+            std::this_thread::yield();
+        for(int i = 0; i < 100; ++i)
+            g.spawn([token]{ ++*token; });
+        std::thread releaser([&]{
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            release.store(true);
+        });
+        pool.reset();
+        releaser.join();
+        std::cout << " pending tasks released : " << (token.use_count() == 1 ? "true" : "false") << std::endl;
+    }
+    std::cout << "[--------------------------- ------ END API test ------- -------------------------]" << std::endl;
+}
+
+//! @brief fib 和 parallel sum 在不同线程数下的耗时, 观察扩展性
+void thread_pool_perf(unsigned fib_n = 34, size_t sum_n = 100000000, size_t max_threads = 0){
+    std::cout << "[=================================================================================]" << std::endl;
+    std::cout << "[---------------------- Run performance test : thread pool ------------------------]" << std::endl;
+    const size_t hw = dhsstl::max<size_t>(std::thread::hardware_concurrency(), 1);
+    if(max_threads == 0)
+        max_threads = hw;
+    std::cout << " hardware threads : " << hw << std::endl;
+
+    auto start = tp_clock::now();
+    const uint64_t f = fib_serial(fib_n);
+    std::cout << " fib(" << fib_n << ") serial\t\t: " << tp_elapsed_ms(start) << " ms" << std::endl;
+
+    dhsstl::vector<uint64_t> data(sum_n);
+    for(size_t i = 0; i < sum_n; ++i)
+        data[i] = i;
+    start = tp_clock::now();
+    uint64_t s = 0;
+    for(size_t i = 0; i < sum_n; ++i)
+        s += data[i];
+    std::cout << " sum serial\t\t: " << tp_elapsed_ms(start) << " ms" << std::endl;
+
+    for(size_t t = 1; t <= max_threads; t *= 2){
+        dhsstl::thread_pool pool(t);
+        start = tp_clock::now();
+        const bool fib_ok = fib_parallel(pool, fib_n, 20) == f;
+        const double fib_ms = tp_elapsed_ms(start);
+        start = tp_clock::now();
+        const bool sum_ok = parallel_sum(pool, data.data(), sum_n) == s;
+        const double sum_ms = tp_elapsed_ms(start);
+        std::cout << " " << t << " threads\t fib : " << fib_ms << " ms" << (fib_ok ? "" : " (wrong)")
+                  << "\t sum : " << sum_ms << " ms" << (sum_ok ? "" : " (wrong)") << std::endl;
+    }
+    std::cout << "[--------------------------- ------ END perf test ------ -------------------------]" << std::endl;
+}
+
+} // namespace test
+} // namespace dhsstl
+#endif
@@ -1,8 +1,15 @@
 #ifndef DHSTINYSTL_TEST_VECTOR_H_
 #define DHSTINYSTL_TEST_VECTOR_H_
 
+#include <cstdint>
+#include <cstring>
+#include <ctime>
 #include <iostream>
+#include <memory>
+#include <string>
 #include <vector>
+#include "list.h"
+#include "memory.h"
 #include "vector.h"
 #include "test.h"
 
@@ -10,9 +17,9 @@
 namespace dhsstl {
 namespace test {
 
-template<typename T, typename Alloc1>
-inline bool vec_equal(const std::vector<T, Alloc1> lhs,
-                      const dhsstl::vector<T>& rhs){
+template<typename T, typename Alloc1, typename Alloc2, typename Policy>
+inline bool vec_equal(const std::vector<T, Alloc1>& lhs,
+                      const dhsstl::vector<T, Alloc2, Policy>& rhs){
     if(lhs.size() != rhs.size())
         return false;
     for(size_t i = 0; i != lhs.size(); ++i){
@@ -22,6 +29,174 @@ inline bool vec_equal(const std::vector<T, Alloc1> lhs,
     return true;
 }
 
+// 记录存活个数的元素, 析构函数不平凡, 不能按字节搬移
+struct vt_counted
+{
+    static int alive;
+    int        value;
+
+    vt_counted(int v = 0) : value(v) { ++alive; }
+    vt_counted(const vt_counted& rhs) : value(rhs.value) { ++alive; }
+    vt_counted& operator=(const vt_counted& rhs) { value = rhs.value; return *this; }
+    ~vt_counted() { --alive; }
+
+    bool operator==(const vt_counted& rhs) const { return value == rhs.value; }
+    bool operator!=(const vt_counted& rhs) const { return value != rhs.value; }
+};
+int vt_counted::alive = 0;
+
+// 在头部, 中间, 尾部 insert / emplace / erase, 每一步都与 std::vector 比较
+// tight 为 true 时每次插入前先 shrink_to_fit, 插入走重新分配的路径, 否则走备用空间足够的路径
+template <typename T>
+bool vector_insert_erase_run(bool tight){
+    dhsstl::vector<T> v;
+    std::vector<T> m;
+    for(int i = 0; i < 10; ++i){
+        v.push_back(T(i));
+        m.push_back(T(i));
+    }
+    bool ok = vec_equal(m, v);
+    auto prepare = [&]{
+        if(tight)
+            v.shrink_to_fit();
+        else
+            v.reserve(v.size() + 8);
+    };
+    const int a[] = { 100, 101, 102 };
+    for(int where = 0; where < 3; ++where){
+        auto at = [&]{ return where == 0 ? 0 : where == 1 ? v.size() / 2 : v.size(); };
+        size_t p;
+        prepare();
+        p = at();
+        v.insert(v.begin() + p, T(200 + where));
+        m.insert(m.begin() + p, T(200 + where));
+        ok = ok && vec_equal(m, v);
+        prepare();
+        p = at();
+        v.emplace(v.begin() + p, 300 + where);
+        m.emplace(m.begin() + p, 300 + where);
+        ok = ok && vec_equal(m, v);
+        prepare();
+        p = at();
+        v.insert(v.begin() + p, 3, T(400 + where));
+        m.insert(m.begin() + p, 3, T(400 + where));
+        ok = ok && vec_equal(m, v);
+        prepare();
+        p = at();
+        v.insert(v.begin() + p, a, a + 3);
+        m.insert(m.begin() + p, a, a + 3);
+        ok = ok && vec_equal(m, v);
+    }
+    for(int where = 0; where < 3; ++where){
+        size_t p = where == 0 ? 0 : where == 1 ? v.size() / 2 : v.size() - 1;
+        v.erase(v.begin() + p);
+        m.erase(m.begin() + p);
+        ok = ok && vec_equal(m, v);
+        p = where == 0 ? 0 : where == 1 ? v.size() / 2 : v.size() - 2;
+        v.erase(v.begin() + p, v.begin() + p + 2);
+        m.erase(m.begin() + p, m.begin() + p + 2);
+        ok = ok && vec_equal(m, v);
+    }
+    return ok;
+}
+
+// 对齐要求为 64 的 trivially copyable 类型, 不能交给 realloc
+struct alignas(64) vt_aligned
+{
+    int value;
+
+    vt_aligned(int v = 0) : value(v) {}
+    bool operator==(const vt_aligned& rhs) const { return value == rhs.value; }
+};
+
+// push_back 扩容, reserve, shrink_to_fit 之后元素保持不变, 且首地址按 alignof(T) 对齐
+template <typename T>
+bool vector_storage_run(){
+    dhsstl::vector<T> v;
+    auto same = [&v]{
+        if(reinterpret_cast<uintptr_t>(v.data()) % alignof(T) != 0)
+            return false;
+        for(size_t i = 0; i < v.size(); ++i){
+            if(!(v[i] == T(static_cast<int>(i))))
+                return false;
+        }
+        return true;
+    };
+    for(int i = 0; i < 100; ++i)
+        v.push_back(T(i));
+    bool ok = same() && v.size() == 100;
+    v.reserve(1000);
+    ok = ok && same() && v.capacity() == 1000;
+    for(int i = 100; i < 1500; ++i)
+        v.push_back(T(i));
+    ok = ok && same() && v.size() == 1500;
+    v.erase(v.begin() + 700, v.end());
+    v.shrink_to_fit();
+    ok = ok && same() && v.capacity() == 700;
+    v.push_back(T(700));
+    ok = ok && same() && v.capacity() > 700;
+    return ok;
+}
+
+// push_back n 个元素的过程中容量依次取过的值
+template <typename Policy>
+std::vector<size_t> vector_capacity_steps(size_t n){
+    dhsstl::vector<uint64_t, dhsstl::allocator<uint64_t>, Policy> v;
+    std::vector<size_t> caps(1, v.capacity());
+    for(size_t i = 0; i < n; ++i){
+        v.push_back(i);
+        if(v.capacity() != caps.back())
+            caps.push_back(v.capacity());
+    }
+    return caps;
+}
+
+// append_range: 来自其他容器的区间, 以及来自自身的区间(容量足够与不足两种情况)
+template <typename T>
+bool vector_append_range_run(){
+    dhsstl::vector<T> v;
+    std::vector<T> m;
+    const int a[] = { 1, 2, 3, 4, 5 };
+    v.append_range(a, a + 5);
+    m.insert(m.end(), a, a + 5);
+    bool ok = vec_equal(m, v);
+
+    dhsstl::list<T> l;
+    for(int i = 10; i < 40; ++i){
+        l.push_back(T(i));
+        m.push_back(T(i));
+    }
+    v.append_range(l.begin(), l.end());
+    ok = ok && vec_equal(m, v);
+
+    // 容量不足: 不能先 realloc 再复制, 否则来源区间已经失效
+    v.shrink_to_fit();
+    v.append_range(v.begin(), v.end());
+    const std::vector<T> before(m);
+    m.insert(m.end(), before.begin(), before.end());
+    ok = ok && vec_equal(m, v);
+    v.shrink_to_fit();
+    v.append_range(v.begin() + 3, v.begin() + 13);
+    const std::vector<T> part(m.begin() + 3, m.begin() + 13);
+    m.insert(m.end(), part.begin(), part.end());
+    ok = ok && vec_equal(m, v);
+
+    // 容量足够: 直接复制到尾部
+    v.reserve(v.size() * 2);
+    const T* data = v.data();
+    v.append_range(v.begin(), v.end());
+    const std::vector<T> all(m);
+    m.insert(m.end(), all.begin(), all.end());
+    ok = ok && vec_equal(m, v) && v.data() == data;
+    return ok;
+}
+
+// 默认构造函数不平凡的类型, 默认初始化也会调用构造函数
+struct vt_defaulted
+{
+    int value = 7;
+};
+
 //! @brief Test dhsstl::vector
 void vector_test(){
     std::cout << "[=================================================================================]" << std::endl;
@@ -69,6 +244,133 @@ void vector_test(){
     FUN_AFTER(v1, v1.resize(20, 5));
     FUN_AFTER(v1, v1.clear());
     FUN_VALUE(v1.size());
+
+    // int 按字节搬移(memmove), vt_counted 逐个移动构造和析构, shared_ptr 通过特化标记为可以按字节搬移
+    FUN_VALUE(dhsstl::is_trivially_relocatable<int>::value);
+    FUN_VALUE(dhsstl::is_trivially_relocatable<vt_counted>::value);
+    FUN_VALUE(dhsstl::is_trivially_relocatable<dhsstl::shared_ptr<int>>::value);
+    FUN_VALUE(vector_insert_erase_run<int>(false));
+    FUN_VALUE(vector_insert_erase_run<int>(true));
+    FUN_VALUE(vector_insert_erase_run<vt_counted>(false));
+    FUN_VALUE(vector_insert_erase_run<vt_counted>(true));
+    FUN_VALUE(vt_counted::alive);
+    {
+        // 按字节搬移 shared_ptr 时引用计数不变: p 的计数等于 1 + 持有 p 的元素个数
+        auto p = dhsstl::make_shared<int>(7);
+        auto q = dhsstl::make_shared<int>(8);
+        dhsstl::vector<dhsstl::shared_ptr<int>> v(10, p);
+        FUN_VALUE(p.use_count());
+        v.insert(v.begin(), q);
+        v.insert(v.begin() + 5, 3, p);
+        v.emplace(v.begin() + 2, p);
+        FUN_VALUE((p.use_count() == static_cast<long>(v.size())));
+        v.shrink_to_fit();
+        v.insert(v.begin() + v.size() / 2, p);
+        v.push_back(p);
+        v.reserve(100);
+        FUN_VALUE((p.use_count() == static_cast<long>(v.size())));
+        FUN_VALUE((v[0] == q));
+        FUN_VALUE(q.use_count());
+        v.erase(v.begin());
+        v.erase(v.begin() + 3, v.begin() + 6);
+        v.erase(v.end() - 1);
+        FUN_VALUE((p.use_count() == 1 + static_cast<long>(v.size())));
+        FUN_VALUE(q.use_count());
+        v.clear();
+        FUN_VALUE(p.use_count());
+    }
+    {
+        // 备用空间足够时 fill_insert 原地插入, 不重新分配
+        dhsstl::vector<int> v = { 1, 2, 3, 4, 5 };
+        const int* data = v.data();
+        FUN_AFTER(v, v.insert(v.begin() + 2, 3, 9));
+        FUN_VALUE((v.data() == data));
+        dhsstl::vector<vt_counted> w(5, vt_counted(1));
+        w.insert(w.begin() + 1, 2, vt_counted(8));
+        FUN_VALUE(w.size());
+        FUN_VALUE(w[2].value);
+        FUN_VALUE(w[3].value);
+        FUN_VALUE(vt_counted::alive);
+    }
+    FUN_VALUE(vt_counted::alive);
+
+    // trivially copyable 且不超过 max_align_t 对齐的类型走 realloc,
+    // 对齐要求更高或者不能按字节复制的类型退回到 allocate + 搬移 + deallocate
+    FUN_VALUE(dhsstl::allocator<uint64_t>::can_reallocate());
+    FUN_VALUE(dhsstl::allocator<vt_aligned>::can_reallocate());
+    FUN_VALUE(dhsstl::allocator<vt_counted>::can_reallocate());
+    FUN_VALUE(vector_storage_run<uint64_t>());
+    FUN_VALUE(vector_storage_run<vt_aligned>());
+    FUN_VALUE(vector_storage_run<vt_counted>());
+    FUN_VALUE(vt_counted::alive);
+
+    // 各个扩容策略下的容量序列, 默认构造时容量为 16
+    FUN_VALUE((vector_capacity_steps<dhsstl::growth_1_5x>(200) ==
+               std::vector<size_t>{ 16, 24, 36, 54, 81, 121, 181, 271 }));
+    FUN_VALUE((vector_capacity_steps<dhsstl::growth_2x>(200) ==
+               std::vector<size_t>{ 16, 32, 64, 128, 256 }));
+    // uint64_t 的容量按 4096 字节取整
+    FUN_VALUE((vector_capacity_steps<dhsstl::growth_page>(1100) ==
+               std::vector<size_t>{ 16, 512, 1024, 1536 }));
+    // 192 / 320 / 512 / 768 / 1280 / 2048 字节, 都是分配器的尺寸分级
+    FUN_VALUE((vector_capacity_steps<dhsstl::growth_size_class>(200) ==
+               std::vector<size_t>{ 16, 24, 40, 64, 96, 160, 256 }));
+    FUN_VALUE(vector_append_range_run<int>());
+    FUN_VALUE(vector_append_range_run<vt_counted>());
+    FUN_VALUE(vt_counted::alive);
+
+    // 只做默认初始化: 大小和容量与 vector(n) 相同, 平凡类型的值未定义, 不检查
+    {
+        dhsstl::vector<int> a(5, dhsstl::default_init);
+        dhsstl::vector<int> b(40, dhsstl::default_init);
+        FUN_VALUE(a.size());
+        FUN_VALUE(a.capacity());
+        FUN_VALUE(b.size());
+        FUN_VALUE(b.capacity());
+        // 默认构造函数不平凡时仍然调用构造函数
+        dhsstl::vector<vt_defaulted> c(20, dhsstl::default_init);
+        FUN_VALUE((c[0].value == 7 && c[19].value == 7));
+        dhsstl::vector<std::string> d(3, dhsstl::default_init);
+        FUN_VALUE((d.size() == 3 && d[2].empty()));
+        {
+            dhsstl::vector<vt_counted> e(10, dhsstl::default_init);
+            FUN_VALUE(vt_counted::alive);
+            // 缩小时析构多出的元素, 容量不变
+            e.resize_default_init(4);
+            FUN_VALUE(e.size());
+            FUN_VALUE(e.capacity());
+            FUN_VALUE(vt_counted::alive);
+            e.resize_default_init(30);
+            FUN_VALUE(e.size());
+            FUN_VALUE((e[29].value == 0));
+            FUN_VALUE(vt_counted::alive);
+        }
+        FUN_VALUE(vt_counted::alive);
+    }
+    {
+        dhsstl::vector<int> v = { 1, 2, 3 };
+        v.resize_default_init(10);
+        FUN_VALUE(v.size());
+        FUN_VALUE((v[0] == 1 && v[2] == 3));
+        const int* data = v.data();
+        v.resize_default_init(2);
+        FUN_VALUE(v.size());
+        FUN_VALUE((v.data() == data && v.capacity() == 16));
+        PRINT(v);
+        // append_uninitialized 返回新元素的起始位置, 之前的元素不变
+        int* p = v.append_uninitialized(3);
+        FUN_VALUE((p == v.data() + 2));
+        p[0] = 7;
+        p[1] = 8;
+        p[2] = 9;
+        p = v.append_uninitialized(20);
+        FUN_VALUE((p == v.data() + 5));
+        for(int i = 0; i < 20; ++i)
+            p[i] = i;
+        FUN_VALUE(v.size());
+        FUN_VALUE((v.capacity() >= 25));
+        FUN_VALUE((v[4] == 9 && v[5] == 0 && v[24] == 19));
+    }
     std::cout << "[--------------------------- ------ END API test ------- -------------------------]" << std::endl;
 
 //    FUN_AFTER(v1, v1.assign(8, 8));
@@ -94,6 +396,188 @@ void vector_test(){
 //    FUN_VALUE(v1.at(1));
 
 }
+
+// 在尾部插入 n 个元素(包含多次扩容), 再在头部反复插入/删除, 返回所用的 clock 数
+template <typename Vec, typename MakeValue>
+clock_t vector_relocate_run(size_t n, size_t front_ops, MakeValue make_value){
+    clock_t start = clock();
+    Vec v;
+    for(size_t i = 0; i < n; ++i)
+        v.push_back(make_value(i));
+    for(size_t i = 0; i < front_ops; ++i){
+        v.insert(v.begin(), make_value(i));
+        v.erase(v.begin());
+    }
+    v.shrink_to_fit();
+    return clock() - start;
+}
+
+//! @brief 比较 trivially relocatable 元素(unique_ptr / shared_ptr)在 dhsstl::vector 与 std::vector 中的搬移开销
+void vector_relocate_perf(){
+    std::cout << "[=================================================================================]" << std::endl;
+    std::cout << "[----------------------- Run performance test : vector relocate -------------------]" << std::endl;
+    const size_t n = 10000000;
+    const size_t front_ops = 100;
+    auto make_unique = [](size_t i){ return std::unique_ptr<size_t>(new size_t(i)); };
+    auto make_shared = [](size_t i){ return std::make_shared<size_t>(i); };
+    std::cout << " unique_ptr  std::vector    : "
+              << vector_relocate_run<std::vector<std::unique_ptr<size_t>>>(n, front_ops, make_unique) << std::endl;
+    std::cout << " unique_ptr  dhsstl::vector : "
+              << vector_relocate_run<dhsstl::vector<std::unique_ptr<size_t>>>(n, front_ops, make_unique) << std::endl;
+    std::cout << " shared_ptr  std::vector    : "
+              << vector_relocate_run<std::vector<std::shared_ptr<size_t>>>(n, front_ops, make_shared) << std::endl;
+    std::cout << " shared_ptr  dhsstl::vector : "
+              << vector_relocate_run<dhsstl::vector<std::shared_ptr<size_t>>>(n, front_ops, make_shared) << std::endl;
+    std::cout << "[--------------------------- ------ END perf test ------ -------------------------]" << std::endl;
+}
+
+//! @brief 对 vector<uint64_t> 不断 push_back, 统计 realloc 原地扩容(不需要复制)的次数和省下的复制量
+void vector_realloc_perf(size_t n = static_cast<size_t>(1) << 28){
+    std::cout << "[=================================================================================]" << std::endl;
+    std::cout << "[----------------------- Run performance test : vector realloc --------------------]" << std::endl;
+    clock_t start = clock();
+    {
+        std::vector<uint64_t> v;
+        for(size_t i = 0; i < n; ++i)
+            v.push_back(i);
+    }
+    std::cout << " std::vector<uint64_t>    push_back " << n << " : " << clock() - start << std::endl;
+
+    size_t growths = 0, in_place = 0, bytes_saved = 0;
+    start = clock();
+    {
+        dhsstl::vector<uint64_t> v;
+        for(size_t i = 0; i < n; ++i){
+            if(v.size() == v.capacity()){
+                const uint64_t* old_data = v.data();
+                v.push_back(i);
+                ++growths;
+                if(v.data() == old_data){
+                    ++in_place;
+                    bytes_saved += (v.size() - 1) * sizeof(uint64_t);
+                }
+            }else{
+                v.push_back(i);
+            }
+        }
+    }
+    std::cout << " dhsstl::vector<uint64_t> push_back " << n << " : " << clock() - start << std::endl;
+    std::cout << " growths: " << growths << ", grown in place: " << in_place
+              << ", bytes not copied: " << bytes_saved << std::endl;
+    std::cout << "[--------------------------- ------ END perf test ------ -------------------------]" << std::endl;
+}
+
+// 统计某个扩容策略下 push_back n 个元素的扩容次数, 最终的空闲比例以及耗时
+template <typename Policy>
+void vector_growth_run(const char* name, size_t n){
+    size_t growths = 0;
+    clock_t start = clock();
+    dhsstl::vector<uint64_t, dhsstl::allocator<uint64_t>, Policy> v;
+    for(size_t i = 0; i < n; ++i){
+        if(v.size() == v.capacity())
+            ++growths;
+        v.push_back(i);
+    }
+    const clock_t used = clock() - start;
+    std::cout << " " << name << " push_back " << n << " : " << used
+              << ", allocations: " << growths
+              << ", slack: " << (v.capacity() - v.size()) * 100 / v.capacity() << "%" << std::endl;
+}
+
+//! @brief 比较各个扩容策略, 以及 append_range 与逐个 push_back
+void vector_growth_perf(size_t n = static_cast<size_t>(1) << 26){
+    std::cout << "[=================================================================================]" << std::endl;
+    std::cout << "[----------------------- Run performance test : vector growth ---------------------]" << std::endl;
+    vector_growth_run<dhsstl::growth_1_5x>("growth_1_5x      ", n);
+    vector_growth_run<dhsstl::growth_2x>("growth_2x        ", n);
+    vector_growth_run<dhsstl::growth_page>("growth_page      ", n);
+    vector_growth_run<dhsstl::growth_size_class>("growth_size_class", n);
+
+    // 每次追加 chunk 个元素, 共追加 n 个
+    const size_t chunk = 1000;
+    std::vector<uint64_t> src(chunk, 7);
+    clock_t start = clock();
+    {
+        std::vector<uint64_t> v;
+        for(size_t i = 0; i < n; i += chunk)
+            v.insert(v.end(), src.begin(), src.end());
+    }
+    std::cout << " std::vector::insert(end)           : " << clock() - start << std::endl;
+    start = clock();
+    {
+        dhsstl::vector<uint64_t> v;
+        for(size_t i = 0; i < n; i += chunk)
+            for(size_t j = 0; j < chunk; ++j)
+                v.push_back(src[j]);
+    }
+    std::cout << " dhsstl::vector push_back loop      : " << clock() - start << std::endl;
+    start = clock();
+    {
+        dhsstl::vector<uint64_t> v;
+        for(size_t i = 0; i < n; i += chunk)
+            v.append_range(src.data(), src.data() + chunk);
+    }
+    std::cout << " dhsstl::vector append_range        : " << clock() - start << std::endl;
+    std::cout << "[--------------------------- ------ END perf test ------ -------------------------]" << std::endl;
+}
+
+//! @brief 比较值初始化与默认初始化: 申请 n 字节的缓冲区并马上覆盖一遍
+void vector_default_init_perf(size_t n = static_cast<size_t>(1) << 30){
+    std::cout << "[=================================================================================]" << std::endl;
+    std::cout << "[----------------------- Run performance test : vector default init ---------------]" << std::endl;
+    clock_t start = clock();
+    {
+        std::vector<uint8_t> v(n);
+        std::memset(v.data(), 0xab, n);
+    }
+    std::cout << " std::vector(n)                    + overwrite : " << clock() - start << std::endl;
+    start = clock();
+    {
+        dhsstl::vector<uint8_t> v(n);
+        std::memset(v.data(), 0xab, n);
+    }
+    std::cout << " dhsstl::vector(n)                 + overwrite : " << clock() - start << std::endl;
+    start = clock();
+    {
+        dhsstl::vector<uint8_t> v(n, dhsstl::default_init);
+        std::memset(v.data(), 0xab, n);
+    }
+    std::cout << " dhsstl::vector(n, default_init)   + overwrite : " << clock() - start << std::endl;
+    start = clock();
+    {
+        dhsstl::vector<uint8_t> v;
+        v.resize(n);
+        std::memset(v.data(), 0xab, n);
+    }
+    std::cout << " dhsstl::vector::resize            + overwrite : " << clock() - start << std::endl;
+    start = clock();
+    {
+        dhsstl::vector<uint8_t> v;
+        v.resize_default_init(n);
+        std::memset(v.data(), 0xab, n);
+    }
+    std::cout << " dhsstl::vector::resize_default_init + overwrite : " << clock() - start << std::endl;
+
+    // 模拟按块读入: 每次在尾部追加 64KB 并写满
+    const size_t chunk = static_cast<size_t>(1) << 16;
+    start = clock();
+    {
+        dhsstl::vector<uint8_t> v;
+        for(size_t i = 0; i < n; i += chunk){
+            v.resize(v.size() + chunk);
+            std::memset(v.data() + v.size() - chunk, 0xab, chunk);
+        }
+    }
+    std::cout << " dhsstl::vector resize chunks          : " << clock() - start << std::endl;
+    start = clock();
+    {
+        dhsstl::vector<uint8_t> v;
+        for(size_t i = 0; i < n; i += chunk)
+            std::memset(v.append_uninitialized(chunk), 0xab, chunk);
+    }
+    std::cout << " dhsstl::vector append_uninitialized   : " << clock() - start << std::endl;
+    std::cout << "[--------------------------- ------ END perf test ------ -------------------------]" << std::endl;
+}
 } // namespace test
 } // namespace dhsstl
 #endif